@@ -0,0 +1,36 @@
+/******************************************************************************
+ * File: flashmap.h (Control_Bootloader)
+ * Description: Control ECU flash layout (256 KB, 1 KB pages). The linker
+ *              files (bootloader.icf, Control_ECU/app.icf) and
+ *              Control_ECU/flashlog.h must agree with it.
+ *
+ *   0x00000 - 0x03BFF  Bootloader
+ *   0x03C00 - 0x03FFF  Boot descriptor (one page)
+ *   0x04000 - 0x1FFFF  Application (Control_ECU)
+ *   0x20000 - 0x3BFFF  Download slot
+ *   0x3C000 - 0x3FFFF  Event log (Control_ECU/flashlog.c)
+ ******************************************************************************/
+
+#ifndef FLASHMAP_H_
+#define FLASHMAP_H_
+
+#define FLASH_PAGE_SIZE     0x400
+
+#define DESCRIPTOR_ADDRESS  0x00003C00
+#define APP_BASE            0x00004000
+#define SLOT_BASE           0x00020000
+#define IMAGE_MAX_SIZE      (SLOT_BASE - APP_BASE)      /* 112 KB */
+
+/* Address at which flash is read: 0 on the chip. The host build (host/)
+ * points it at its simulated flash array */
+#ifndef FLASH_MEMORY_BASE
+#define FLASH_MEMORY_BASE   0u
+#endif
+#define FLASH_READ_ADDR(address)    (FLASH_MEMORY_BASE + (address))
+
+/* EEPROM word the application sets to ask for update mode; must match
+ * UPDATE_FLAG_ADDRESS in Control_ECU/eeprom.h */
+#define UPDATE_FLAG_ADDRESS 0x0040
+#define UPDATE_REQUESTED    0x55504400                  /* "UPD" */
+
+#endif /* FLASHMAP_H_ */
@@ -0,0 +1,46 @@
+/******************************************************************************
+ * File: flashops.c (Control_Bootloader)
+ * Description: SRAM-resident flash erase/program via the flash memory
+ *              controller registers. Nothing here may call into flash:
+ *              a flash read stalls until the operation finishes.
+ ******************************************************************************/
+
+#include "flashops.h"
+#include <stdint.h>
+#include "inc/hw_types.h"
+#include "inc/hw_flash.h"
+
+/* FMC write key: depends on BOOTCFG.KEY (same choice as driverlib) */
+#define FMC_KEY_LEGACY 0x71D50000
+
+static __ramfunc uint32_t FlashOps_Key(void)
+{
+    return (HWREG(FLASH_BOOTCFG) & FLASH_BOOTCFG_KEY) ? FLASH_FMC_WRKEY
+                                                      : FMC_KEY_LEGACY;
+}
+
+__ramfunc void FlashOps_ErasePage(uint32_t address)
+{
+    HWREG(FLASH_FMA) = address;
+    HWREG(FLASH_FMC) = FlashOps_Key() | FLASH_FMC_ERASE;
+    while (HWREG(FLASH_FMC) & FLASH_FMC_ERASE)
+    {
+    }
+}
+
+__ramfunc void FlashOps_Program(uint32_t address, const uint32_t *data, uint32_t count)
+{
+    uint32_t key = FlashOps_Key();
+
+    while (count >= 4)
+    {
+        HWREG(FLASH_FMA) = address;
+        HWREG(FLASH_FMD) = *data++;
+        HWREG(FLASH_FMC) = key | FLASH_FMC_WRITE;
+        while (HWREG(FLASH_FMC) & FLASH_FMC_WRITE)
+        {
+        }
+        address += 4;
+        count -= 4;
+    }
+}
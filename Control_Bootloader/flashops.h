@@ -0,0 +1,26 @@
+/******************************************************************************
+ * File: flashops.h (Control_Bootloader)
+ * Description: Flash erase/program that run from SRAM, so the UART receive
+ *              interrupt (also in SRAM) keeps running while the flash is
+ *              busy and the next chunk arrives during programming.
+ ******************************************************************************/
+
+#ifndef FLASHOPS_H_
+#define FLASHOPS_H_
+
+#include <stdint.h>
+
+/*
+ * FlashOps_ErasePage
+ * Erases the 1 KB page at address (page aligned).
+ */
+void FlashOps_ErasePage(uint32_t address);
+
+/*
+ * FlashOps_Program
+ * Programs count bytes (multiple of 4) from data at address (word
+ * aligned; the page must be erased).
+ */
+void FlashOps_Program(uint32_t address, const uint32_t *data, uint32_t count);
+
+#endif /* FLASHOPS_H_ */
@@ -0,0 +1,141 @@
+/******************************************************************************
+ * File: image.c (Control_Bootloader)
+ * Module: Firmware Image
+ * Description: Boot descriptor handling, slot-to-application copy and jump
+ ******************************************************************************/
+
+#include "image.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* TivaWare includes */
+#include "inc/hw_types.h"
+#include "inc/hw_nvic.h"
+#include "crc32.h"
+#include "flashmap.h"
+#include "flashops.h"
+
+#define SRAM_BASE   0x20000000u
+#define SRAM_END    0x20008000u
+
+static uint32_t page_buf[FLASH_PAGE_SIZE / 4];
+
+static const BootDescriptor *Image_Descriptor(void)
+{
+    const BootDescriptor *d = (const BootDescriptor *)FLASH_READ_ADDR(DESCRIPTOR_ADDRESS);
+    return (d->magic == DESCRIPTOR_MAGIC) ? d : 0;
+}
+
+static void Image_WriteDescriptor(const BootDescriptor *d)
+{
+    FlashOps_ErasePage(DESCRIPTOR_ADDRESS);
+    FlashOps_Program(DESCRIPTOR_ADDRESS, (const uint32_t *)d, sizeof(*d));
+}
+
+/*
+ * Image_Copy
+ * Copies len bytes from the slot to the application area a page at a
+ * time through SRAM (flash cannot be read while it is being programmed).
+ */
+static void Image_Copy(uint32_t len)
+{
+    uint32_t offset, i;
+    const uint32_t *src;
+
+    for (offset = 0; offset < len; offset += FLASH_PAGE_SIZE)
+    {
+        src = (const uint32_t *)FLASH_READ_ADDR(SLOT_BASE + offset);
+        for (i = 0; i < FLASH_PAGE_SIZE / 4; i++)
+            page_buf[i] = src[i];
+
+        FlashOps_ErasePage(APP_BASE + offset);
+        FlashOps_Program(APP_BASE + offset, page_buf, FLASH_PAGE_SIZE);
+    }
+}
+
+/******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+
+uint32_t Image_Crc(uint32_t address, uint32_t len)
+{
+    return CRC32_Update(CRC32_INIT, (const void *)FLASH_READ_ADDR(address), len);
+}
+
+void Image_Recover(void)
+{
+    const BootDescriptor *d = Image_Descriptor();
+    BootDescriptor done;
+
+    if (d == 0 || d->state != IMAGE_SLOT_READY)
+        return;
+    if (d->slot_len == 0 || d->slot_len > IMAGE_MAX_SIZE ||
+        Image_Crc(SLOT_BASE, d->slot_len) != d->slot_crc)
+        return;     /* Slot damaged too: Image_AppValid decides */
+
+    Image_Copy(d->slot_len);
+
+    done = *d;
+    done.state = IMAGE_APP_VALID;
+    done.app_len = d->slot_len;
+    done.app_crc = d->slot_crc;
+    Image_WriteDescriptor(&done);
+}
+
+bool Image_AppValid(void)
+{
+    const BootDescriptor *d = Image_Descriptor();
+    const uint32_t *vectors = (const uint32_t *)FLASH_READ_ADDR(APP_BASE);
+
+    if (d != 0)
+    {
+        return d->state == IMAGE_APP_VALID &&
+               d->app_len != 0 && d->app_len <= IMAGE_MAX_SIZE &&
+               Image_Crc(APP_BASE, d->app_len) == d->app_crc;
+    }
+
+    /* No descriptor: initial stack in SRAM, reset handler in the app area */
+    return vectors[0] > SRAM_BASE && vectors[0] <= SRAM_END &&
+           vectors[1] > APP_BASE && vectors[1] < SLOT_BASE;
+}
+
+void Image_Install(uint32_t len, uint32_t crc)
+{
+    BootDescriptor d;
+
+    d.magic = DESCRIPTOR_MAGIC;
+    d.state = IMAGE_SLOT_READY;
+    d.app_len = 0;
+    d.app_crc = 0;
+    d.slot_len = len;
+    d.slot_crc = crc;
+    Image_WriteDescriptor(&d);
+
+    Image_Copy(len);
+
+    d.state = IMAGE_APP_VALID;
+    d.app_len = len;
+    d.app_crc = crc;
+    Image_WriteDescriptor(&d);
+}
+
+/*
+ * Image_Start
+ * Loads the stack pointer and reset handler from the vector table in R0
+ * (the argument) and branches to it. Stackless: MSP is replaced before
+ * the branch, so nothing may be left on the old stack.
+ */
+static __stackless void Image_Start(uint32_t vectors)
+{
+    (void)vectors;
+    __asm("LDR   R1, [R0]");
+    __asm("MSR   MSP, R1");
+    __asm("LDR   R1, [R0, #4]");
+    __asm("BX    R1");
+}
+
+void Image_Jump(void)
+{
+    HWREG(NVIC_VTABLE) = APP_BASE;
+    Image_Start(APP_BASE);      /* Does not return */
+}
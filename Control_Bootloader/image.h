@@ -0,0 +1,72 @@
+/******************************************************************************
+ * File: image.h (Control_Bootloader)
+ * Module: Firmware Image
+ * Description: Boot descriptor, image verification, installation from the
+ *              download slot and the jump into the application.
+ *
+ * The descriptor page records what is in the application area. An update
+ * is staged and verified in the download slot, the descriptor is switched
+ * to SLOT_READY, the slot is copied, and only then is it marked APP_VALID.
+ * A reset during the copy finds SLOT_READY and copies again, so the
+ * application area is never left holding an unverified image.
+ ******************************************************************************/
+
+#ifndef IMAGE_H_
+#define IMAGE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define DESCRIPTOR_MAGIC    0x444C5442u     /* "BTLD" */
+
+typedef enum
+{
+    IMAGE_APP_VALID  = 0x41505056u,         /* Application area verified */
+    IMAGE_SLOT_READY = 0x534C4F54u          /* Slot verified, copy pending */
+} ImageState;
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t state;         /* ImageState */
+    uint32_t app_len;
+    uint32_t app_crc;
+    uint32_t slot_len;
+    uint32_t slot_crc;
+} BootDescriptor;
+
+/*
+ * Image_Crc
+ * CRC-32 of len bytes of flash at address.
+ */
+uint32_t Image_Crc(uint32_t address, uint32_t len);
+
+/*
+ * Image_Recover
+ * Finishes an installation interrupted by a reset (SLOT_READY with an
+ * intact slot).
+ */
+void Image_Recover(void);
+
+/*
+ * Image_AppValid
+ * True if the application area passes its descriptor CRC, or, when no
+ * descriptor was ever written (application flashed over JTAG), if its
+ * vector table looks plausible.
+ */
+bool Image_AppValid(void);
+
+/*
+ * Image_Install
+ * Marks the verified slot image (len bytes, crc) SLOT_READY, copies it to
+ * the application area and marks it APP_VALID.
+ */
+void Image_Install(uint32_t len, uint32_t crc);
+
+/*
+ * Image_Jump
+ * Starts the application. Call before enabling any interrupt.
+ */
+void Image_Jump(void);
+
+#endif /* IMAGE_H_ */
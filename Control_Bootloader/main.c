@@ -0,0 +1,339 @@
+/******************************************************************************
+ * File: main.c (Control_Bootloader)
+ * Description: Control ECU bootloader. Boots the application unless it is
+ *              invalid or an update was requested over the link, otherwise
+ *              receives a new image over UART2 into the download slot,
+ *              verifies it and installs it.
+ *
+ * Update protocol (115200 8N1, replies '1' = accepted, '0' = rejected):
+ *   <- "BLD\n"                   Announced every second while idle
+ *   -> "IMG:<size>,<crc32>\n"    Decimal; starts a transfer
+ *   -> 'B'<seq:u16 LE><1024 data bytes, last one 0xFF padded><sum8>
+ *                                sum8 = byte sum of seq and data.
+ *                                '0' asks for the block again; a repeat
+ *                                of the previous block is acknowledged.
+ *                                Only 'B' at the start of a line opens a
+ *                                block, so a resent block is never taken
+ *                                for "END" whatever its sequence number
+ *   -> "END\n"                   '1': image CRC matched, installing and
+ *                                restarting. '0': mismatch, nothing
+ *                                installed
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/eeprom.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "flashmap.h"
+#include "flashops.h"
+#include "image.h"
+#include "uart.h"
+
+#define TICKS_PER_MS            16000U      /* 16 MHz system clock */
+#define ANNOUNCE_MS             1000U
+#define IDLE_TIMEOUT_MS         30000U      /* Back to a valid app if no host */
+#define BLOCK_TIMEOUT_MS        2000U       /* Silence inside a block */
+#define TRANSFER_TIMEOUT_MS     10000U      /* Silence between blocks */
+
+#define BLOCK_MARKER            'B'
+#define BLOCK_DATA_SIZE         FLASH_PAGE_SIZE
+#define BLOCK_SIZE              (1 + 2 + BLOCK_DATA_SIZE + 1)
+#define LINE_SIZE               32
+
+/* Transfer in progress */
+static bool receiving = false;
+static uint32_t image_size;
+static uint32_t image_crc;
+static uint16_t block_count;
+static uint16_t next_seq;
+
+static uint8_t block[BLOCK_SIZE];
+static uint16_t block_pos;
+static uint32_t page_buf[BLOCK_DATA_SIZE / 4];
+
+/******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+static bool UpdateRequested(void);
+static void Timer_Init(void);
+static uint32_t Timer_ElapsedMs(uint32_t since);
+static void Update_Run(bool app_valid);
+static void Update_Line(const char *line);
+static void Update_Block(void);
+static bool ParseImageHeader(const char *p);
+
+/******************************************************************************
+ * Main Function
+ ******************************************************************************/
+int main(void)
+{
+    bool requested, app_valid;
+
+    SysCtlClockSet(SYSCTL_SYSDIV_1 | SYSCTL_USE_OSC |
+                   SYSCTL_XTAL_16MHZ | SYSCTL_OSC_MAIN);
+
+    requested = UpdateRequested();
+    Image_Recover();
+    app_valid = Image_AppValid();
+
+    /* Normal boot: nothing but the EEPROM has been touched */
+    if (app_valid && !requested)
+        Image_Jump();
+
+    Timer_Init();
+    UART2_Init();
+    Update_Run(app_valid);
+
+    /* Leave update mode through a reset so the application starts from a
+     * clean peripheral state */
+    UART2_WaitTxDone();
+    SysCtlReset();
+    while (1)
+    {
+    }
+}
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+/*
+ * UpdateRequested
+ * Reads and clears the update request left by the application's UPD
+ * command, so a failed update does not keep the ECU in the bootloader.
+ */
+static bool UpdateRequested(void)
+{
+    uint32_t flag = 0;
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_EEPROM0);
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_EEPROM0));
+    if (EEPROMInit() != EEPROM_INIT_OK)
+        return false;
+
+    EEPROMRead(&flag, UPDATE_FLAG_ADDRESS, sizeof(flag));
+    if (flag != UPDATE_REQUESTED)
+        return false;
+
+    flag = 0;
+    EEPROMProgram(&flag, UPDATE_FLAG_ADDRESS, sizeof(flag));
+    return true;
+}
+
+/*
+ * Timer_Init
+ * Free-running Timer0 as the time base. Polled rather than interrupt
+ * driven: a flash-resident tick ISR would stall during every erase.
+ */
+static void Timer_Init(void)
+{
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER0);
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_TIMER0));
+    TimerConfigure(TIMER0_BASE, TIMER_CFG_PERIODIC_UP);
+    TimerLoadSet(TIMER0_BASE, TIMER_A, 0xFFFFFFFF);
+    TimerEnable(TIMER0_BASE, TIMER_A);
+}
+
+static uint32_t Timer_Now(void)
+{
+    return TimerValueGet(TIMER0_BASE, TIMER_A);
+}
+
+/* Valid for intervals under ~268 s (32-bit wrap at 16 MHz) */
+static uint32_t Timer_ElapsedMs(uint32_t since)
+{
+    return (Timer_Now() - since) / TICKS_PER_MS;
+}
+
+/*
+ * Update_Run
+ * Serves the update protocol. Returns when an image has been installed,
+ * or after IDLE_TIMEOUT_MS without a transfer if the current application
+ * is still valid.
+ */
+static void Update_Run(bool app_valid)
+{
+    char line[LINE_SIZE];
+    uint8_t line_len = 0;
+    uint32_t announced = Timer_Now();
+    uint32_t activity = Timer_Now();
+    char c;
+
+    UART2_SendString("BLD\n");
+
+    while (1)
+    {
+        if (UART2_IsDataAvailable())
+        {
+            c = UART2_ReceiveChar();
+            activity = Timer_Now();
+
+            if (receiving && line_len == 0 &&
+                (block_pos > 0 || c == BLOCK_MARKER))
+            {
+                /* Binary block, opened by its marker */
+                block[block_pos++] = (uint8_t)c;
+                if (block_pos == BLOCK_SIZE)
+                {
+                    Update_Block();
+                    block_pos = 0;
+                }
+            }
+            else if (c == '\n')
+            {
+                line[line_len] = '\0';
+                line_len = 0;
+                if (strcmp(line, "END") == 0 && receiving)
+                {
+                    receiving = false;
+                    if (next_seq == block_count &&
+                        Image_Crc(SLOT_BASE, image_size) == image_crc)
+                    {
+                        UART2_SendChar('1');
+                        UART2_WaitTxDone();
+                        Image_Install(image_size, image_crc);
+                        return;
+                    }
+                    UART2_SendChar('0');
+                }
+                else
+                {
+                    Update_Line(line);
+                }
+            }
+            else if (line_len < LINE_SIZE - 1)
+            {
+                line[line_len++] = c;
+            }
+        }
+        else if (receiving && block_pos > 0 &&
+                 Timer_ElapsedMs(activity) >= BLOCK_TIMEOUT_MS)
+        {
+            /* Partial block: drop it, the host resends after no reply */
+            block_pos = 0;
+            UART2_SendChar('0');
+        }
+        else if (line_len > 0 && Timer_ElapsedMs(activity) >= BLOCK_TIMEOUT_MS)
+        {
+            /* Unterminated line, e.g. a block that lost its marker: the
+             * host's resend must start on a clean line */
+            line_len = 0;
+        }
+        else if (receiving && Timer_ElapsedMs(activity) >= TRANSFER_TIMEOUT_MS)
+        {
+            receiving = false;  /* Host gone: accept a new IMG */
+        }
+
+        if (UART2_TakeOverflow() && receiving)
+        {
+            block_pos = 0;      /* The block is damaged; its sum will fail */
+            line_len = 0;
+        }
+
+        if (!receiving && Timer_ElapsedMs(announced) >= ANNOUNCE_MS)
+        {
+            UART2_SendString("BLD\n");
+            announced = Timer_Now();
+        }
+
+        if (app_valid && !receiving &&
+            Timer_ElapsedMs(activity) >= IDLE_TIMEOUT_MS)
+            return;
+    }
+}
+
+/*
+ * Update_Line
+ * Text commands outside a block. Anything but IMG is ignored.
+ */
+static void Update_Line(const char *line)
+{
+    if (strncmp(line, "IMG:", 4) == 0 && ParseImageHeader(line + 4))
+    {
+        block_count = (uint16_t)((image_size + BLOCK_DATA_SIZE - 1) / BLOCK_DATA_SIZE);
+        next_seq = 0;
+        block_pos = 0;
+        receiving = true;
+        UART2_SendChar('1');
+    }
+    else if (strncmp(line, "IMG:", 4) == 0)
+    {
+        receiving = false;
+        UART2_SendChar('0');
+    }
+}
+
+/*
+ * Update_Block
+ * Checks a complete block, acknowledges it, then programs it. The host
+ * starts sending the next block on the acknowledgement; it collects in the
+ * receive ring while this page is erased and programmed.
+ */
+static void Update_Block(void)
+{
+    uint16_t seq = (uint16_t)(block[1] | (block[2] << 8));
+    uint8_t sum = 0;
+    uint16_t i;
+
+    for (i = 1; i < BLOCK_SIZE - 1; i++)
+        sum += block[i];
+
+    if (sum != block[BLOCK_SIZE - 1])
+    {
+        UART2_SendChar('0');
+        return;
+    }
+    if (seq + 1u == next_seq)
+    {
+        UART2_SendChar('1');    /* Our acknowledgement was lost */
+        return;
+    }
+    if (seq != next_seq || seq >= block_count)
+    {
+        UART2_SendChar('0');
+        return;
+    }
+
+    memcpy(page_buf, &block[3], BLOCK_DATA_SIZE);
+    next_seq++;
+    UART2_SendChar('1');
+
+    FlashOps_ErasePage(SLOT_BASE + (uint32_t)seq * BLOCK_DATA_SIZE);
+    FlashOps_Program(SLOT_BASE + (uint32_t)seq * BLOCK_DATA_SIZE,
+                     page_buf, BLOCK_DATA_SIZE);
+}
+
+/*
+ * ParseImageHeader
+ * "<size>,<crc32>" in decimal. The size must fit the application area.
+ */
+static bool ParseImageHeader(const char *p)
+{
+    uint32_t size = 0, crc = 0;
+    bool digits = false;
+
+    while (*p >= '0' && *p <= '9')
+    {
+        size = size * 10 + (uint32_t)(*p++ - '0');
+        digits = true;
+    }
+    if (!digits || *p++ != ',')
+        return false;
+
+    digits = false;
+    while (*p >= '0' && *p <= '9')
+    {
+        crc = crc * 10 + (uint32_t)(*p++ - '0');
+        digits = true;
+    }
+    if (!digits || *p != '\0' || size == 0 || size > IMAGE_MAX_SIZE)
+        return false;
+
+    image_size = size;
+    image_crc = crc;
+    return true;
+}
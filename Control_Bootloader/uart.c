@@ -0,0 +1,142 @@
+/******************************************************************************
+ * File: uart.c (Control_Bootloader)
+ * Module: UART
+ * Description: UART2 driver with an SRAM-resident receive ISR
+ ******************************************************************************/
+
+#include "uart.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* TivaWare includes */
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "inc/hw_gpio.h"
+#include "inc/hw_uart.h"
+#include "inc/hw_ints.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/gpio.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/uart.h"
+#include "driverlib/pin_map.h"
+
+#define UART2_BAUD_RATE   115200U
+
+/* Larger than one transfer block, so a whole block can arrive while the
+ * previous one is being programmed */
+#define RX_RING_SIZE      2048      /* Power of two */
+
+static volatile uint8_t rx_ring[RX_RING_SIZE];
+static volatile uint16_t rx_head = 0;   /* Written by the ISR */
+static volatile uint16_t rx_tail = 0;   /* Written by the main loop */
+static volatile bool rx_overflow = false;
+
+/*
+ * UART2_RxISR
+ * Drains the RX FIFO into the ring. Register access only: this must not
+ * touch flash while an erase/program is in progress.
+ */
+static __ramfunc void UART2_RxISR(void)
+{
+    uint32_t data;
+    uint16_t next;
+
+    HWREG(UART2_BASE + UART_O_ICR) = UART_ICR_RXIC | UART_ICR_RTIC | UART_ICR_OEIC;
+
+    while (!(HWREG(UART2_BASE + UART_O_FR) & UART_FR_RXFE))
+    {
+        data = HWREG(UART2_BASE + UART_O_DR);
+        if (data & 0xF00)   /* FE/PE/BE/OE bits */
+            rx_overflow = true;
+
+        next = (uint16_t)((rx_head + 1) & (RX_RING_SIZE - 1));
+        if (next == rx_tail)
+        {
+            rx_overflow = true;
+        }
+        else
+        {
+            rx_ring[rx_head] = (uint8_t)data;
+            rx_head = next;
+        }
+    }
+}
+
+void UART2_Init(void)
+{
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UART2);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOD);
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_UART2));
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOD));
+
+    /* Unlock PD7 (NMI pin) */
+    HWREG(GPIO_PORTD_BASE + GPIO_O_LOCK) = GPIO_LOCK_KEY;
+    HWREG(GPIO_PORTD_BASE + GPIO_O_CR) |= GPIO_PIN_7;
+    HWREG(GPIO_PORTD_BASE + GPIO_O_LOCK) = 0;
+
+    GPIOPinConfigure(GPIO_PD6_U2RX);
+    GPIOPinConfigure(GPIO_PD7_U2TX);
+    GPIOPinTypeUART(GPIO_PORTD_BASE, GPIO_PIN_6 | GPIO_PIN_7);
+
+    UARTConfigSetExpClk(UART2_BASE, SysCtlClockGet(), UART2_BAUD_RATE,
+                        (UART_CONFIG_WLEN_8 |
+                         UART_CONFIG_STOP_ONE |
+                         UART_CONFIG_PAR_NONE));
+    UARTFIFOLevelSet(UART2_BASE, UART_FIFO_TX1_8, UART_FIFO_RX4_8);
+
+    /* UARTIntRegister copies the vector table to SRAM */
+    UARTIntRegister(UART2_BASE, UART2_RxISR);
+    UARTIntEnable(UART2_BASE, UART_INT_RX | UART_INT_RT | UART_INT_OE);
+    UARTEnable(UART2_BASE);
+}
+
+void UART2_Deinit(void)
+{
+    UARTIntDisable(UART2_BASE, UART_INT_RX | UART_INT_RT | UART_INT_OE);
+    IntDisable(INT_UART2);
+    UARTDisable(UART2_BASE);
+}
+
+void UART2_SendChar(char data)
+{
+    UARTCharPut(UART2_BASE, data);
+}
+
+void UART2_SendString(const char *str)
+{
+    while (*str != '\0')
+    {
+        UART2_SendChar(*str);
+        str++;
+    }
+}
+
+uint8_t UART2_IsDataAvailable(void)
+{
+    return (rx_head != rx_tail) ? 1u : 0u;
+}
+
+char UART2_ReceiveChar(void)
+{
+    char c;
+
+    if (rx_head == rx_tail)
+        return 0;
+    c = (char)rx_ring[rx_tail];
+    rx_tail = (uint16_t)((rx_tail + 1) & (RX_RING_SIZE - 1));
+    return c;
+}
+
+bool UART2_TakeOverflow(void)
+{
+    bool lost = rx_overflow;
+    rx_overflow = false;
+    return lost;
+}
+
+void UART2_WaitTxDone(void)
+{
+    while (UARTBusy(UART2_BASE))
+    {
+    }
+}
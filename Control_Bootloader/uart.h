@@ -0,0 +1,53 @@
+/******************************************************************************
+ * File: uart.h (Control_Bootloader)
+ * Module: UART
+ * Description: UART2 (PD6 RX, PD7 TX, 115200 8N1) with an interrupt-driven
+ *              receive ring. The receive ISR runs from SRAM so bytes keep
+ *              arriving while the flash is being erased or programmed.
+ ******************************************************************************/
+
+#ifndef UART_H_
+#define UART_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * UART2_Init
+ * Initializes UART2 and its receive interrupt (vector table moves to SRAM).
+ */
+void UART2_Init(void);
+
+/*
+ * UART2_Deinit
+ * Disables the UART2 interrupt before jumping to the application.
+ */
+void UART2_Deinit(void);
+
+/*
+ * UART2_SendChar / UART2_SendString
+ * Blocking transmit.
+ */
+void UART2_SendChar(char data);
+void UART2_SendString(const char *str);
+
+/*
+ * UART2_IsDataAvailable / UART2_ReceiveChar
+ * Receive ring access. ReceiveChar returns 0 when the ring is empty.
+ */
+uint8_t UART2_IsDataAvailable(void);
+char UART2_ReceiveChar(void);
+
+/*
+ * UART2_TakeOverflow
+ * True if bytes were lost (ring full or FIFO overrun) since the last call.
+ */
+bool UART2_TakeOverflow(void);
+
+/*
+ * UART2_WaitTxDone
+ * Waits until the last byte has left the shift register.
+ */
+void UART2_WaitTxDone(void);
+
+#endif /* UART_H_ */
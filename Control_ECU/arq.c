@@ -0,0 +1,120 @@
+/******************************************************************************
+ * File: arq.c (Control_ECU)
+ * Description: Request sequence tags and the per-session replay cache
+ ******************************************************************************/
+
+#include "arq.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include "command.h"
+#include "stats.h"
+#include "transport.h"
+
+typedef struct
+{
+    char seq;                       /* 0: nothing cached */
+    uint16_t hash;                  /* Of the line, see LineHash */
+    uint8_t len;
+    char reply[ARQ_REPLY_CACHE];
+    char deferred_seq;              /* Tag of a reply still to come, or 0 */
+} ArqEntry;
+
+static ArqEntry cache[COMMAND_SESSIONS];
+
+/*
+ * LineHash
+ * FNV-1a folded to 16 bits. A restarted HMI reuses sequence numbers, so a
+ * repeat must match the command too, not only the tag.
+ */
+static uint16_t LineHash(const char *line)
+{
+    uint32_t h = 2166136261UL;
+
+    while (*line != '\0' && *line != '\n' && *line != '\r')
+    {
+        h ^= (uint8_t)*line++;
+        h *= 16777619UL;
+    }
+    return (uint16_t)(h ^ (h >> 16));
+}
+
+void Arq_Process(uint8_t session, const char *line)
+{
+    ArqEntry *e = &cache[(session < COMMAND_SESSIONS) ? session : 0];
+    char seq;
+    uint16_t hash;
+    uint8_t i, len;
+    bool deferred;
+
+    /* Stray CR/LF from the previous line may precede the tag */
+    while (*line == '\r' || *line == '\n')
+        line++;
+
+    if (line[0] != ARQ_TAG || line[1] < ARQ_SEQ_FIRST || line[1] > ARQ_SEQ_LAST)
+    {
+        /* A resend that lost its tag bytes must not run the command again;
+         * the HMI ignores the untagged reply and keeps resending */
+        if (e->seq != 0 && e->hash == LineHash(line))
+        {
+            Stats_Increment(STAT_ARQ_REPLAYS);
+            return;
+        }
+        if (ProcessCommand(session, line))
+            e->deferred_seq = 0;
+        return;
+    }
+    seq = line[1];
+    hash = LineHash(line + 2);
+
+    Transport_SendChar(ARQ_TAG);
+    Transport_SendChar(seq);
+
+    if (e->seq == seq && e->hash == hash)
+    {
+        /* Retransmission: the command already ran */
+        for (i = 0; i < e->len; i++)
+            Transport_SendChar(e->reply[i]);
+        Stats_Increment(STAT_ARQ_REPLAYS);
+        return;
+    }
+
+    Transport_Capture(e->reply, ARQ_REPLY_CACHE);
+    deferred = ProcessCommand(session, line + 2);
+    len = Transport_EndCapture();
+
+    /* Cached empty until the reply is sent: a resend gets the tag only */
+    if (deferred)
+    {
+        e->seq = seq;
+        e->hash = hash;
+        e->len = 0;
+        e->deferred_seq = seq;
+        return;
+    }
+
+    /* A garbled copy gets no reply; keep the entry for the clean resend */
+    if (len == 0)
+        return;
+
+    e->seq = (len <= ARQ_REPLY_CACHE) ? seq : 0;
+    e->hash = hash;
+    e->len = len;
+}
+
+void Arq_SendDeferred(uint8_t session, char reply)
+{
+    ArqEntry *e = &cache[(session < COMMAND_SESSIONS) ? session : 0];
+
+    if (e->deferred_seq != 0)
+    {
+        Transport_SendChar(ARQ_TAG);
+        Transport_SendChar(e->deferred_seq);
+        if (e->seq == e->deferred_seq && e->len == 0)
+        {
+            e->reply[0] = reply;
+            e->len = 1;
+        }
+        e->deferred_seq = 0;
+    }
+    Transport_SendChar(reply);
+}
@@ -0,0 +1,56 @@
+/******************************************************************************
+ * File: arq.h (Control_ECU)
+ * Description: Exactly-once execution of retransmitted requests.
+ *
+ * The HMI tags each request line with a sequence character:
+ *   "^<seq><command line>"      seq 'a'..'z', next one per new request
+ * and the reply is sent back behind the same tag, "^<seq><reply>", so a
+ * late reply to an earlier attempt can be told apart. When the HMI hears
+ * nothing it resends the same line with the same seq. The last reply of
+ * each session is cached: a repeated seq with the same line is answered
+ * from the cache without running the command again, so a PWD whose reply
+ * was lost does not cycle the door twice.
+ *
+ * A SET/TMO reply waits for its EEPROM write: the tag goes out at once,
+ * the tagged reply follows in its own frame (Arq_SendDeferred) and is
+ * cached then. A resend in between gets the tag alone.
+ *
+ * Replies longer than ARQ_REPLY_CACHE (LOG, STAT, BOT, EXP, PRF, TRC, WAI)
+ * are not cached and a repeat runs the command again; they are all
+ * read-only. Untagged lines (host tools) are processed as before, except a
+ * copy of the cached line, which is a resend that lost its tag.
+ ******************************************************************************/
+
+#ifndef ARQ_H_
+#define ARQ_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#define ARQ_TAG          '^'
+#define ARQ_SEQ_FIRST    'a'
+#define ARQ_SEQ_LAST     'z'
+#define ARQ_REPLY_CACHE  12     /* Longest reply kept for replays */
+
+/******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+/*
+ * Arq_Process
+ * Handles one received line from session: tagged lines go through the
+ * replay cache, untagged ones straight to ProcessCommand.
+ */
+void Arq_Process(uint8_t session, const char *line);
+
+/*
+ * Arq_SendDeferred
+ * Sends the reply to the session's deferred command behind its tag (if
+ * the command came tagged) and caches it.
+ */
+void Arq_SendDeferred(uint8_t session, char reply);
+
+#endif /* ARQ_H_ */
@@ -0,0 +1,35 @@
+/******************************************************************************
+ * File: boottime.c (Control_ECU)
+ * Description: Per-phase boot timestamps
+ ******************************************************************************/
+
+#include "boottime.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include "systick.h"
+
+static uint32_t phase_ms[BOOT_PHASE_COUNT];
+static bool phase_marked[BOOT_PHASE_COUNT];
+
+void BootTime_Mark(BootPhase phase)
+{
+    if (phase >= BOOT_PHASE_COUNT || phase_marked[phase])
+        return;
+    phase_ms[phase] = SysTick_GetMs();
+    phase_marked[phase] = true;
+}
+
+void BootTime_Set(BootPhase phase, uint32_t ms)
+{
+    if (phase >= BOOT_PHASE_COUNT)
+        return;
+    phase_ms[phase] = ms;
+    phase_marked[phase] = true;
+}
+
+uint32_t BootTime_Get(BootPhase phase)
+{
+    if (phase >= BOOT_PHASE_COUNT)
+        return 0;
+    return phase_ms[phase];
+}
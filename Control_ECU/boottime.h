@@ -0,0 +1,50 @@
+/******************************************************************************
+ * File: boottime.h (Control_ECU)
+ * Description: Per-phase boot timestamps. Each phase is stamped once with
+ *              SysTick_GetMs(), i.e. milliseconds since startup.
+ ******************************************************************************/
+
+#ifndef BOOTTIME_H_
+#define BOOTTIME_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ * Definitions
+ ******************************************************************************/
+typedef enum
+{
+    BOOT_CLOCK,         /* System clock and SysTick running */
+    BOOT_UART,          /* UART2 up */
+    BOOT_EEPROM,        /* EEPROM controller ready */
+    BOOT_ACTUATORS,     /* Motor and buzzer ready */
+    BOOT_EVENTLOG,      /* Flash log scanned */
+    BOOT_READY,         /* RDY frame sent: serving requests */
+    BOOT_HMI_PROMPT,    /* HMI's cold-boot-to-first-prompt, reported by BTM */
+    BOOT_PHASE_COUNT
+} BootPhase;
+
+/******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+/*
+ * BootTime_Mark
+ * Stamps phase with the current time. Later marks of the same phase are
+ * ignored.
+ */
+void BootTime_Mark(BootPhase phase);
+
+/*
+ * BootTime_Set
+ * Records a time measured elsewhere (BOOT_HMI_PROMPT).
+ */
+void BootTime_Set(BootPhase phase, uint32_t ms);
+
+/*
+ * BootTime_Get
+ * Timestamp of phase in ms, 0 if not reached yet.
+ */
+uint32_t BootTime_Get(BootPhase phase);
+
+#endif /* BOOTTIME_H_ */
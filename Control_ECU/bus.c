@@ -0,0 +1,204 @@
+/******************************************************************************
+ * File: bus.c (Control_ECU)
+ * Description: Link line assembly and RS-485 multidrop polling
+ ******************************************************************************/
+
+#include "bus.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "arq.h"
+#include "command.h"
+#include "config.h"
+#include "stats.h"
+#include "systick.h"
+#include "transport.h"
+
+#define BUFFER_SIZE COMMAND_BUFFER_SIZE
+
+typedef enum
+{
+    BUS_IDLE,       /* Next poll due */
+    BUS_WAIT        /* Poll sent, collecting the node's answer */
+} BusState;
+
+static char buffer[BUFFER_SIZE];
+static uint8_t bufferIndex = 0;
+static bool discarding = false;     // Dropping the rest of an over-long line
+
+static BusState state = BUS_IDLE;
+static uint8_t node = 0;            // Node polled last
+static uint8_t round_pos = 0;       // Present node reached in this round
+static uint8_t probe = 0;           // Absent address probed last
+static uint32_t poll_ms = 0;
+static uint32_t present = 0;        // Bit n: node n answered its last poll
+static char payload[BUS_PAYLOAD_SIZE];
+static uint8_t payload_len = 0;
+static bool payload_overflow = false;
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+/*
+ * Bus_TakeChar
+ * Adds one received byte to the line buffer and processes the line once its
+ * terminator arrives.
+ */
+static void Bus_TakeChar(uint8_t session, char receivedChar)
+{
+    if (discarding)
+    {
+        // Resynchronise on the next line ending; never parse the tail
+        if (receivedChar == '\n' || receivedChar == '\r')
+            discarding = false;
+    }
+    else if (bufferIndex < (BUFFER_SIZE - 1))
+    {
+        buffer[bufferIndex++] = receivedChar;
+        buffer[bufferIndex] = '\0';
+        if (receivedChar == '\n' || receivedChar == '\r')
+        {
+            Arq_Process(session, buffer);
+            Transport_Flush();
+            bufferIndex = 0;
+            memset(buffer, 0, BUFFER_SIZE);
+        }
+    }
+    else
+    {
+        bufferIndex = 0;
+        memset(buffer, 0, BUFFER_SIZE);
+        discarding = (receivedChar != '\n' && receivedChar != '\r');
+        Stats_Increment(STAT_RX_OVERFLOWS);
+    }
+}
+
+/*
+ * Bus_NextNode
+ * The present nodes in address order; at the end of each round one absent
+ * address, in turn. Finding a new terminal thus costs at most one poll
+ * timeout per round instead of a burst of them.
+ */
+static uint8_t Bus_NextNode(void)
+{
+    uint8_t i;
+
+    while (round_pos < UART2_MAX_NODE)
+    {
+        if (present & (1UL << ++round_pos))
+            return round_pos;
+    }
+
+    round_pos = 0;
+    for (i = 0; i < UART2_MAX_NODE; i++)
+    {
+        probe = (uint8_t)(probe % UART2_MAX_NODE + 1);
+        if (!(present & (1UL << probe)))
+            return probe;
+    }
+
+    round_pos = 1;  // Every address answers: straight into the next round
+    return round_pos;
+}
+
+/*
+ * Bus_Answer
+ * Processes every line of a node's payload and sends all the replies back in
+ * one frame, only once the node has released the bus.
+ */
+static void Bus_Answer(void)
+{
+    uint8_t i;
+
+    if (payload_overflow)
+        Stats_Increment(STAT_RX_OVERFLOWS);
+    if (payload_len == 0 || payload_overflow)
+        return;
+
+    bufferIndex = 0;
+    discarding = false;
+    UART2_BeginFrame(node, UART2_FRAME_DATA);
+    for (i = 0; i < payload_len; i++)
+        Bus_TakeChar(node, payload[i]);
+    UART2_EndFrame();
+}
+
+/*
+ * Bus_SendDeferred
+ * Sends the SET/TMO replies whose EEPROM writes have finished, each in a
+ * frame of its own. Multidrop: only between polls, while nobody else talks.
+ */
+static void Bus_SendDeferred(void)
+{
+    uint8_t session;
+    char reply;
+
+    while (TakeDeferredReply(&session, &reply))
+    {
+        UART2_BeginFrame(session, UART2_FRAME_DATA);
+        Arq_SendDeferred(session, reply);
+        UART2_EndFrame();
+        Transport_Flush();
+    }
+}
+
+static void Bus_Multidrop(void)
+{
+    uint8_t src;
+
+    if (state == BUS_IDLE)
+    {
+        Bus_SendDeferred();
+        node = Bus_NextNode();
+        payload_len = 0;
+        payload_overflow = false;
+        UART2_BeginFrame(node, UART2_FRAME_POLL);
+        UART2_EndFrame();
+        poll_ms = SysTick_GetMs();
+        state = BUS_WAIT;
+        return;
+    }
+
+    while (UART2_IsDataAvailable())
+    {
+        if (payload_len < BUS_PAYLOAD_SIZE)
+            payload[payload_len++] = UART2_ReceiveChar();
+        else
+        {
+            UART2_ReceiveChar();
+            payload_overflow = true;
+        }
+    }
+
+    if (UART2_TakeFrameEnd(&src) && src == node)
+    {
+        present |= (1UL << node);
+        state = BUS_IDLE;
+        Bus_Answer();
+    }
+    else if ((SysTick_GetMs() - poll_ms) >= BUS_POLL_TIMEOUT_MS)
+    {
+        present &= ~(1UL << node);
+        state = BUS_IDLE;
+    }
+}
+
+/******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+
+void Bus_Service(void)
+{
+    if (UART2_MULTIDROP)
+    {
+        Bus_Multidrop();
+        return;
+    }
+
+    Bus_SendDeferred();
+    if (Config_ImportService())
+        return;     // The import's blocks are not lines
+    if (Transport_IsDataAvailable())
+        Bus_TakeChar(0, Transport_ReceiveChar());
+}
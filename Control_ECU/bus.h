@@ -0,0 +1,43 @@
+/******************************************************************************
+ * File: bus.h (Control_ECU)
+ * Description: Link line assembly. Point-to-point, lines are handed to
+ *              ProcessCommand as they arrive; on an RS-485 multidrop bus
+ *              (UART2_MULTIDROP) the Control ECU is the master and polls each
+ *              HMI terminal in turn for its queued request lines.
+ *
+ * Multidrop cycle, one node at a time:
+ *   POLL frame to node n -> n answers with one DATA frame (possibly empty)
+ *   within BUS_POLL_TIMEOUT_MS -> each line in it is processed with session
+ *   n and all the replies go back in one DATA frame to n.
+ * A node that misses a poll is marked absent. A round polls the present
+ * nodes, then one absent address in turn, so the empty addresses of a bus
+ * with few terminals cost one BUS_POLL_TIMEOUT_MS per round at most.
+ * Replies that wait for an EEPROM write (SET, TMO) go out in a frame of
+ * their own once it is done, before the next poll.
+ ******************************************************************************/
+
+#ifndef BUS_H_
+#define BUS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#define BUS_POLL_TIMEOUT_MS 10   /* Poll to end of the node's answer */
+#define BUS_PAYLOAD_SIZE    64   /* Request bytes one node may queue */
+
+/******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+/*
+ * Bus_Service
+ * Call from the main loop. Reads what has arrived and processes complete
+ * lines; in multidrop mode also runs the polling cycle. Never blocks
+ * longer than one reply takes to send.
+ */
+void Bus_Service(void);
+
+#endif /* BUS_H_ */
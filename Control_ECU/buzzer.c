@@ -6,6 +6,12 @@
 #include "driverlib/gpio.h"
 #include "driverlib/timer.h"
 #include "buzzer.h"
+#include "motor.h"
+#include "stats.h"
+#include "wait.h"
+
+// Timer1 expiry later than this past the requested delay means it is not running
+#define BUZZER_SLACK_US 10000U
 
 //
 // Function to initialize GPTM Timer for buzzer delays
@@ -22,6 +28,15 @@ static void buzzer_timer_init(void)
     TimerConfigure(TIMER1_BASE, TIMER_CFG_A_ONE_SHOT);
 }
 
+//
+// Wait_Until condition: door cycles keep their timing meanwhile
+//
+static bool buzzer_timer_done(void)
+{
+    motor_service();
+    return (TimerIntStatus(TIMER1_BASE, false) & TIMER_TIMA_TIMEOUT) != 0;
+}
+
 //
 // Function to delay using GPTM Timer (in milliseconds)
 //
@@ -39,9 +54,7 @@ static void buzzer_delay_ms(uint32_t milliseconds)
     TimerEnable(TIMER1_BASE, TIMER_A);
 
     // Wait for timeout flag
-    while (!(TimerIntStatus(TIMER1_BASE, false) & TIMER_TIMA_TIMEOUT))
-    {
-    }
+    Wait_Until(WAIT_BUZZER, buzzer_timer_done, milliseconds * 1000U + BUZZER_SLACK_US);
 
     // Clear flag and stop timer
     TimerIntClear(TIMER1_BASE, TIMER_TIMA_TIMEOUT);
@@ -89,6 +102,8 @@ void alarm(void)
 {
     uint8_t i;
 
+    Stats_Increment(STAT_ALARMS);
+
     // Beep 3 times
     for (i = 0; i < 3; i++)
     {
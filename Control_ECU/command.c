@@ -0,0 +1,894 @@
+/******************************************************************************
+ * File: command.c (Control_ECU)
+ * Description: Logic for PWD, CHK, SET, ALM, TMO, LOG, LCK, BOT, BTM, HBT,
+ *              STAT, UPD, DOR, CLK, SCH, PRF, OTK, EXP, IMP, TRC, WAI, ENT
+ ******************************************************************************/
+
+#include "command.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <stdlib.h> // For atoi
+#include "boottime.h"
+#include "buzzer.h"
+#include "config.h"
+#include "eeprom.h"
+#include "eventlog.h"
+#include "fmt.h"
+#include "motor.h"
+#include "profile.h"
+#include "rtc.h"
+#include "schedule.h"
+#include "stats.h"
+#include "systick.h"
+#include "totp.h"
+#include "trace.h"
+#include "transport.h"
+#include "wait.h"
+
+/* TivaWare includes */
+#include "driverlib/sysctl.h"
+
+#define OPCODE_LENGTH 3
+
+/* Opcodes in StatOp order (STAT is the only 4-letter one) */
+static const char *const opcode_names[STAT_OP_COUNT] = {
+    "STS", "HBT", "SET", "CHK", "PWD", "LCK",
+    "ALM", "LOG", "BOT", "BTM", "TMO", "UPD", "DOR", "CLK", "SCH", "PRF",
+    "OTK", "EXP", "IMP", "TRC", "WAI", "ENT", "STAT"
+};
+
+/* Lockout state lives here, not on the HMI, so resetting the HMI cannot
+ * clear it. One per session (bus node), so a keypad being guessed at does
+ * not lock out the other terminals. */
+typedef struct
+{
+    uint8_t failed_attempts;
+    bool locked_out;
+    uint32_t lockout_start_ms;
+    bool alarm_pending;
+    bool write_pending;         /* SET/TMO reply waits for the EEPROM */
+    StatOp write_op;
+    uint8_t write_event;
+    uint32_t write_ticket;
+    uint32_t write_failures;    /* EEPROM_WriteFailures() when queued */
+    uint32_t write_start_us;
+    uint8_t entry_count;        /* ENT digits streamed since the last reset */
+    uint8_t entry_diff;         /* OR of digit ^ stored digit: 0 = match */
+    uint32_t entry_ticket;      /* EEPROM_LastTicket() when stored was read */
+    char entry[PASSWORD_LENGTH];
+    uint8_t stored[8];          /* EEPROM password, read on the first digit */
+} Session;
+
+static Session sessions[COMMAND_SESSIONS];
+
+/******************************************************************************
+ * Private Helpers
+ ******************************************************************************/
+
+/*
+ * SkipNoise
+ * Skips anything before the opcode (stray CR/LF from the previous line,
+ * line noise), so a frame is recognised only by its leading opcode.
+ */
+static const char *SkipNoise(const char *line)
+{
+    uint8_t i = 0;
+    while (i < COMMAND_BUFFER_SIZE && line[i] != '\0' &&
+           (line[i] < 'A' || line[i] > 'Z'))
+        i++;
+    return &line[i];
+}
+
+static bool IsEndOfLine(char c)
+{
+    return c == '\0' || c == '\n' || c == '\r';
+}
+
+/*
+ * LookupOpcode
+ * Opcode at the start of line, which must be followed by ':' or the end of
+ * the line ("STSX" is not STS). STAT_OP_COUNT if none matches.
+ */
+static StatOp LookupOpcode(const char *line)
+{
+    uint8_t op;
+    size_t len;
+
+    for (op = 0; op < STAT_OP_COUNT; op++)
+    {
+        len = strlen(opcode_names[op]);
+        if (strncmp(line, opcode_names[op], len) == 0 &&
+            (line[len] == ':' || IsEndOfLine(line[len])))
+            return (StatOp)op;
+    }
+    return STAT_OP_COUNT;
+}
+
+/*
+ * SplitDoor
+ * Copies line into body without its optional ",<door>" suffix
+ * ("PWD:12345,1"). door is 0 when there is no suffix. Returns false if the
+ * suffix is not a door on this board.
+ */
+static bool SplitDoor(const char *line, char *body, uint8_t *door)
+{
+    uint8_t i = 0, value = 0, digits = 0;
+
+    while (i < COMMAND_BUFFER_SIZE - 1 && line[i] != ',' && !IsEndOfLine(line[i]))
+    {
+        body[i] = line[i];
+        i++;
+    }
+    body[i] = '\0';
+    *door = 0;
+
+    if (line[i] != ',')
+        return true;
+    for (i++; i < COMMAND_BUFFER_SIZE && line[i] >= '0' && line[i] <= '9'; i++)
+    {
+        value = (uint8_t)(value * 10 + (line[i] - '0'));
+        if (++digits > 2)
+            return false;
+    }
+    if (digits == 0 || (i < COMMAND_BUFFER_SIZE && !IsEndOfLine(line[i])) ||
+        value >= MOTOR_DOOR_COUNT)
+        return false;
+    *door = value;
+    return true;
+}
+
+/*
+ * ParseQuarterHour
+ * "HHMM" (digits already checked) to a slot of the day. The time must be on
+ * a slot boundary; "2400" is the end of the day.
+ */
+static bool ParseQuarterHour(const char *hhmm, uint8_t *slot)
+{
+    uint8_t hh = (uint8_t)((hhmm[0] - '0') * 10 + (hhmm[1] - '0'));
+    uint8_t mm = (uint8_t)((hhmm[2] - '0') * 10 + (hhmm[3] - '0'));
+
+    if (mm >= 60 || (mm % RTC_SLOT_MINUTES) != 0 || hh > 24 || (hh == 24 && mm != 0))
+        return false;
+    *slot = (uint8_t)(hh * (60 / RTC_SLOT_MINUTES) + mm / RTC_SLOT_MINUTES);
+    return true;
+}
+
+/*
+ * ParseWindow
+ * "DDDDDDDHHMMHHMM": seven 0/1 day flags, Monday first, then the start and
+ * end time of the window.
+ */
+static bool ParseWindow(const char *field, uint8_t *days, uint8_t *start_slot,
+                        uint8_t *end_slot)
+{
+    uint8_t i;
+
+    if (strlen(field) != 15)
+        return false;
+
+    *days = 0;
+    for (i = 0; i < 7; i++)
+    {
+        if (field[i] == '1')
+            *days |= (uint8_t)(1u << i);
+        else if (field[i] != '0')
+            return false;
+    }
+    return ParseQuarterHour(&field[7], start_slot) &&
+           ParseQuarterHour(&field[11], end_slot);
+}
+
+/*
+ * ParseKeyChunk
+ * "<hex>[,p]": up to TOTP_KEY_CHUNK key bytes as hex digit pairs, and the
+ * part they are (0 unless given).
+ */
+static bool ParseKeyChunk(const char *field, uint8_t *bytes, uint8_t *len, uint8_t *part)
+{
+    uint8_t i, nibble;
+
+    *len = 0;
+    *part = 0;
+    for (i = 0; i < 2 * TOTP_KEY_CHUNK && !IsEndOfLine(field[i]) && field[i] != ','; i++)
+    {
+        if (field[i] >= '0' && field[i] <= '9')
+            nibble = (uint8_t)(field[i] - '0');
+        else if (field[i] >= 'A' && field[i] <= 'F')
+            nibble = (uint8_t)(field[i] - 'A' + 10);
+        else if (field[i] >= 'a' && field[i] <= 'f')
+            nibble = (uint8_t)(field[i] - 'a' + 10);
+        else
+            return false;
+
+        if ((i & 1) == 0)
+            bytes[i / 2] = (uint8_t)(nibble << 4);
+        else
+            bytes[(*len)++] |= nibble;
+    }
+    if (i == 0 || (i & 1) != 0)
+        return false;
+
+    if (field[i] == ',')
+    {
+        if (field[i + 1] != '0' && field[i + 1] != '1')
+            return false;
+        *part = (uint8_t)(field[i + 1] - '0');
+        i += 2;
+    }
+    return IsEndOfLine(field[i]);
+}
+
+/*
+ * ParseImportHeader
+ * "<size>,<crc32>" in decimal, as Control_Bootloader's IMG.
+ */
+static bool ParseImportHeader(const char *field, uint32_t *size, uint32_t *crc)
+{
+    bool digits = false;
+
+    *size = 0;
+    *crc = 0;
+    while (*field >= '0' && *field <= '9')
+    {
+        *size = *size * 10 + (uint32_t)(*field++ - '0');
+        digits = true;
+    }
+    if (!digits || *field++ != ',')
+        return false;
+
+    digits = false;
+    while (*field >= '0' && *field <= '9')
+    {
+        *crc = *crc * 10 + (uint32_t)(*field++ - '0');
+        digits = true;
+    }
+    return digits && IsEndOfLine(*field);
+}
+
+/*
+ * SendDecimal
+ * Sends value as ASCII digits followed by terminator.
+ */
+static void SendDecimal(uint32_t value, char terminator)
+{
+    char digits[FMT_U32_DIGITS + 1];
+
+    Fmt_U32(digits, value);
+    Transport_SendString(digits);
+    Transport_SendChar(terminator);
+}
+
+static char StatusReply(void)
+{
+    return EEPROM_IsPasswordSet() ? '1' : '0';
+}
+
+/*
+ * Lockout_RemainingMs
+ * Time left in the current lockout; ends it once the period has elapsed.
+ */
+static uint32_t Lockout_RemainingMs(Session *s)
+{
+    uint32_t elapsed;
+
+    if (!s->locked_out)
+        return 0;
+
+    elapsed = SysTick_GetMs() - s->lockout_start_ms;
+    if (elapsed >= LOCKOUT_DURATION_MS)
+    {
+        s->locked_out = false;
+        s->failed_attempts = 0;
+        return 0;
+    }
+    return LOCKOUT_DURATION_MS - elapsed;
+}
+
+/*
+ * Entry_Reset
+ * Forgets the streamed digits and the copy of the stored password.
+ */
+static void Entry_Reset(Session *s)
+{
+    memset(s->entry, 0, sizeof(s->entry));
+    memset(s->stored, 0, sizeof(s->stored));
+    s->entry_count = 0;
+    s->entry_diff = 0;
+}
+
+/*
+ * Entry_Digit
+ * One streamed keypress (ENT:d). The comparison with the stored password
+ * is folded in as the digits arrive, the same work whatever they are, so
+ * the verdict is ready when the CHK/PWD line comes. Digits past
+ * PASSWORD_LENGTH spoil the entry.
+ */
+static void Entry_Digit(Session *s, char digit)
+{
+    if (s->entry_count == 0)
+    {
+        EEPROM_ReadPassword(s->stored);
+        s->entry_ticket = EEPROM_LastTicket();
+    }
+    if (s->entry_count < PASSWORD_LENGTH)
+    {
+        s->entry[s->entry_count] = digit;
+        s->entry_diff |= (uint8_t)(digit ^ s->stored[s->entry_count]);
+        s->entry_count++;
+    }
+    else
+    {
+        s->entry_count = PASSWORD_LENGTH + 1;
+    }
+}
+
+/*
+ * MatchPassword
+ * The stored-password check for a CHK/PWD password: the verdict prepared
+ * from the streamed digits if they are exactly this password and nothing
+ * was written to the EEPROM since it was read, else ValidatePassword.
+ * Either way the entry is used up.
+ */
+static bool MatchPassword(Session *s, const char *password)
+{
+    bool match;
+
+    if (s->entry_count == PASSWORD_LENGTH && strlen(password) == PASSWORD_LENGTH &&
+        memcmp(s->entry, password, PASSWORD_LENGTH) == 0 &&
+        s->entry_ticket == EEPROM_LastTicket())
+        match = (s->entry_diff == 0);
+    else
+        match = ValidatePassword(password);
+    Entry_Reset(s);
+    return match;
+}
+
+/*
+ * CheckCredential
+ * Applies the attempt policy to one CHK/PWD password: the stored PIN, else
+ * the current one-time PIN (used up only if use_otp, i.e. by PWD).
+ * Returns '1' (PIN match), 'G' (one-time PIN match), '0' (mismatch) or 'L'
+ * (locked out: either already, in which case the password is not even
+ * checked, or by this failure).
+ */
+static char CheckCredential(Session *s, bool data_ok, const char *password,
+                            bool use_otp)
+{
+    char reply = '0';
+
+    if (Lockout_RemainingMs(s) > 0)
+    {
+        Entry_Reset(s);
+        return 'L';
+    }
+
+    if (data_ok && MatchPassword(s, password))
+        reply = '1';
+    else if (data_ok && Totp_Check(password, use_otp))
+        reply = 'G';
+
+    if (reply != '0')
+    {
+        s->failed_attempts = 0;
+        return reply;
+    }
+
+    if (++s->failed_attempts >= MAX_FAILED_ATTEMPTS)
+    {
+        s->locked_out = true;
+        s->lockout_start_ms = SysTick_GetMs();
+        s->alarm_pending = true; // Sounded after the reply has gone out
+        return 'L';
+    }
+    return '0';
+}
+
+/*
+ * DeferReply
+ * Holds back the reply to a SET/TMO until its queued EEPROM write is
+ * verified (TakeDeferredReply); the event is logged then too.
+ */
+static void DeferReply(Session *s, StatOp op, uint8_t event, uint32_t ticket,
+                       uint32_t start_us)
+{
+    s->write_pending = true;
+    s->write_op = op;
+    s->write_event = event;
+    s->write_ticket = ticket;
+    s->write_failures = EEPROM_WriteFailures();
+    s->write_start_us = start_us;
+}
+
+static uint8_t ResultCode(const Session *s, char reply)
+{
+    if (reply == '1' || reply == 'G')
+        return EVT_RESULT_OK;
+    if (reply == 'L' && !s->alarm_pending)
+        return EVT_RESULT_LOCKED;
+    if (reply == 'S')
+        return EVT_RESULT_DENIED;
+    return EVT_RESULT_FAIL;
+}
+
+/******************************************************************************
+ * ProcessCommand
+ * Protocol:
+ * "STS"        -> '1' (Exists) / '0' (Empty)
+ * "HBT"        -> '1' (Link heartbeat)
+ * "SET:xxxxx"  -> Save Pass
+ * "CHK:xxxxx"  -> Verify Only; 'G' for a valid one-time PIN (see totp.h)
+ * "PWD:xxxxx"  -> Verify + start the door cycle (does not wait for it);
+ *                 the stored PIN or a one-time PIN, which is used up;
+ *                 'S' instead of '1' outside the door's access schedule
+ *                 (or, for a door with one, while the RTC is unset)
+ *                 CHK/PWD reply 'L' instead of '0' on the 3rd consecutive
+ *                 failure (alarm sounds) and, unchecked, for the 20 s after
+ * "LCK"        -> Remaining lockout seconds as ASCII digits + '\n' ("0\n")
+ * "ALM"        -> Trigger Buzzer
+ * "TMO:xx"     -> Save Timeout
+ *                 PWD/TMO/SCH take an optional door suffix, ",d" (door d,
+ *                 default 0); an unknown door is answered with '0'
+ *                 SET/TMO reply once the value is written and read back
+ *                 ('0' if that failed); meanwhile other commands are
+ *                 served, but another SET/TMO of the session gets '0'
+ * "DOR"        -> One state digit per door (MotorState) + '\n'
+ * "LOG"        -> Bulk export of the access event log (see eventlog.h)
+ * "LOG:n"      -> Export only the newest n events
+ * "BOT"        -> Boot phase times in ms, comma separated, '\n' terminated
+ *                 (see BootPhase; last field is the HMI's first prompt)
+ * "BTM:ms"     -> HMI reports its cold-boot-to-first-prompt time (no reply)
+ * "STAT"       -> Binary counters and service-time histograms (see stats.h)
+ * "UPD"        -> '1' and restart into the bootloader's update mode
+ *                 (see Control_Bootloader/main.c); '0' during a lockout
+ * "CLK"        -> RTC local time in seconds since 1970 + '\n' ("0\n" unset)
+ * "CLK:s"      -> Set the RTC
+ * "SCH:DDDDDDDHHMMHHMM" -> Allow the door on the flagged days (Monday
+ *                 first) from HHMM to HHMM, on quarter-hours (see schedule.h)
+ * "SCH:0"      -> Remove the door's schedule
+ * "PRF"        -> Binary PC-sample histogram (see profile.h; empty unless
+ *                 built with PROFILE = 1)
+ * "PRF:0"      -> Clear the histogram
+ * "OTK:<hex>[,p]" -> One-time PIN key, 1-10 bytes as hex; part 1 appends a
+ *                 second 10 bytes (see totp.h)
+ * "OTK:0"      -> Remove the key
+ * "EXP"        -> Binary configuration image (see config.h)
+ * "IMP:<size>,<crc32>" -> '1' and start a configuration import; the blocks
+ *                 and "END" that follow go to config.c. '0' for a wrong
+ *                 size, during a lockout or on a multidrop bus
+ * "TRC"        -> Binary link traffic trace (see trace.h; empty unless
+ *                 built with TRACE = 1)
+ * "TRC:0"      -> Clear the trace
+ * "WAI"        -> Binary bounded-wait statistics and the last watchdog
+ *                 stall (see wait.h)
+ * "WAI:0"      -> Clear the wait statistics
+ * "ENT:d"      -> One digit of a password as it is typed (no reply); the
+ *                 next CHK/PWD of the session with the same password
+ *                 takes the verdict prepared from them (see MatchPassword)
+ * "ENT"        -> Restart the entry ('#' on the keypad; no reply)
+ *
+ * The opcode must start the line. Value commands with a missing, non-numeric
+ * or wrong-length field are answered with '0', except CHK/PWD: a password
+ * that is not PASSWORD_LENGTH digits gets no reply and is not counted as a
+ * failed attempt. CHK/PWD/LCK/UPD see only the lockout of the given session.
+ ******************************************************************************/
+bool ProcessCommand(uint8_t session, const char *buffer)
+{
+    Session *s = &sessions[(session < COMMAND_SESSIONS) ? session : 0];
+    char extracted_data[COMMAND_DATA_SIZE];
+    char body[COMMAND_BUFFER_SIZE];
+    const char *line = SkipNoise(buffer);
+    uint32_t start_us = SysTick_GetUs();
+    StatOp op = LookupOpcode(line);
+    bool has_data, data_ok, door_ok = true, key_clear = false, deferred = false;
+    uint8_t key[TOTP_KEY_CHUNK], key_len = 0, key_part = 0;
+    uint32_t import_size = 0, import_crc = 0;
+    char reply;
+    uint8_t data_len, slot, door = 0;
+
+    if (op == STAT_OP_COUNT)
+    {
+        if (line[0] != '\0') // Not just the other half of a CR/LF pair
+            Stats_Increment(STAT_UNKNOWN_LINES);
+        return false;
+    }
+
+    if (op == STAT_OP_PWD || op == STAT_OP_TMO || op == STAT_OP_SCH)
+    {
+        door_ok = SplitDoor(line, body, &door);
+        line = body;
+    }
+
+    has_data = (line[OPCODE_LENGTH] == ':');
+    if (op == STAT_OP_OTK)
+    {
+        // Hex key bytes, or "0" to remove the key
+        key_clear = has_data && line[OPCODE_LENGTH + 1] == '0' &&
+                    IsEndOfLine(line[OPCODE_LENGTH + 2]);
+        data_ok = key_clear ||
+                  (has_data && ParseKeyChunk(&line[OPCODE_LENGTH + 1], key, &key_len, &key_part));
+        extracted_data[0] = '\0';
+    }
+    else if (op == STAT_OP_IMP)
+    {
+        data_ok = has_data &&
+                  ParseImportHeader(&line[OPCODE_LENGTH + 1], &import_size, &import_crc);
+        extracted_data[0] = '\0';
+    }
+    else
+    {
+        data_ok = door_ok && has_data &&
+                  ExtractData(line, extracted_data, sizeof(extracted_data));
+    }
+    if (!data_ok)
+        extracted_data[0] = '\0';
+    if (has_data && !data_ok)
+        Stats_Increment(STAT_GARBLED_LINES);
+    data_len = (uint8_t)strlen(extracted_data);
+
+    /* STAT: Diagnostics */
+    if (op == STAT_OP_STAT)
+    {
+        Stats_Export();
+    }
+    /* STS: Status */
+    else if (strncmp(line, "STS", OPCODE_LENGTH) == 0)
+    {
+        Transport_SendChar(StatusReply());
+    }
+    /* HBT: Heartbeat (no side effects, so RTT reflects the link) */
+    else if (strncmp(line, "HBT", OPCODE_LENGTH) == 0)
+    {
+        Transport_SendChar('1');
+    }
+    /* SET: Save Password */
+    else if (strncmp(line, "SET", OPCODE_LENGTH) == 0)
+    {
+        if (data_ok && data_len == PASSWORD_LENGTH && !s->write_pending)
+        {
+            DeferReply(s, op, EVT_PASSWORD_SET, SavePassword(extracted_data), start_us);
+            deferred = true;
+        }
+        else
+        {
+            Transport_SendChar('0');
+            EventLog_Append(EVT_PASSWORD_SET, EVT_SLOT_PIN, EVT_RESULT_FAIL);
+        }
+    }
+    /* CHK/PWD with a password of the wrong length: the keypad always sends
+     * PASSWORD_LENGTH digits, so the line lost bytes on the wire. No reply
+     * and no failed attempt; the HMI resends it */
+    else if ((op == STAT_OP_CHK || op == STAT_OP_PWD) && door_ok &&
+             data_len != PASSWORD_LENGTH)
+    {
+        if (data_ok || !has_data)
+            Stats_Increment(STAT_GARBLED_LINES);
+    }
+    /* CHK: Verify Only */
+    else if (strncmp(line, "CHK", OPCODE_LENGTH) == 0)
+    {
+        reply = CheckCredential(s, data_ok, extracted_data, false);
+        Transport_SendChar(reply);
+        EventLog_Append(EVT_VERIFY, (reply == 'G') ? EVT_SLOT_OTP : EVT_SLOT_PIN,
+                        ResultCode(s, reply));
+    }
+    /* PWD: Open Door (cycle runs from motor_service) */
+    else if (strncmp(line, "PWD", OPCODE_LENGTH) == 0)
+    {
+        reply = CheckCredential(s, data_ok, extracted_data, true);
+        slot = (reply == 'G') ? EVT_SLOT_OTP : EVT_SLOT_PIN;
+        if (reply == 'G')
+            reply = '1'; // A guest opens the door like the PIN does
+        if (reply == '1' && !Schedule_Allows(door))
+            reply = 'S'; // Not counted as a failed attempt
+        Transport_SendChar(reply);
+        EventLog_Append(EVT_UNLOCK, slot, ResultCode(s, reply));
+        if (reply == '1')
+            motor_open(door); // Stored timeout of this door
+    }
+    /* LCK: Lockout Status */
+    else if (strncmp(line, "LCK", OPCODE_LENGTH) == 0)
+    {
+        SendDecimal((Lockout_RemainingMs(s) + 999) / 1000, '\n');
+    }
+    /* ALM: Alarm (Triggered by HMI) */
+    else if (strncmp(line, "ALM", OPCODE_LENGTH) == 0)
+    {
+        EventLog_Append(EVT_ALARM, EVT_SLOT_NONE, EVT_RESULT_OK);
+        alarm(); // Buzzer beep 3 times
+    }
+    /* LOG: Export Event Log */
+    else if (strncmp(line, "LOG", OPCODE_LENGTH) == 0)
+    {
+        if (!has_data || data_ok)
+            EventLog_Export((uint32_t)atoi(extracted_data)); // Empty -> 0 -> all
+    }
+    /* BOT: Boot Timing Report */
+    else if (strncmp(line, "BOT", OPCODE_LENGTH) == 0)
+    {
+        uint8_t phase;
+        for (phase = 0; phase < BOOT_PHASE_COUNT; phase++)
+            SendDecimal(BootTime_Get((BootPhase)phase),
+                        (phase + 1 < BOOT_PHASE_COUNT) ? ',' : '\n');
+    }
+    /* BTM: HMI Boot Time */
+    else if (strncmp(line, "BTM", OPCODE_LENGTH) == 0)
+    {
+        if (data_ok && data_len > 0)
+            BootTime_Set(BOOT_HMI_PROMPT, (uint32_t)atol(extracted_data));
+    }
+    /* DOR: Door States */
+    else if (strncmp(line, "DOR", OPCODE_LENGTH) == 0)
+    {
+        uint8_t d;
+        for (d = 0; d < MOTOR_DOOR_COUNT; d++)
+            Transport_SendChar((char)('0' + motor_state(d)));
+        Transport_SendChar('\n');
+    }
+    /* CLK: Real-Time Clock */
+    else if (strncmp(line, "CLK", OPCODE_LENGTH) == 0)
+    {
+        if (!has_data)
+        {
+            SendDecimal(RTC_IsSet() ? RTC_Get() : 0, '\n');
+        }
+        else if (data_ok && data_len > 0 &&
+                 (data_len < 10 || strcmp(extracted_data, "4294967295") <= 0))
+        {
+            RTC_Set((uint32_t)strtoul(extracted_data, NULL, 10));
+            Transport_SendChar('1');
+        }
+        else
+        {
+            Transport_SendChar('0');
+        }
+    }
+    /* SCH: Access Schedule */
+    else if (strncmp(line, "SCH", OPCODE_LENGTH) == 0)
+    {
+        uint8_t days, start_slot, end_slot;
+        if (data_ok && strcmp(extracted_data, "0") == 0)
+        {
+            Schedule_Clear(door);
+            Transport_SendChar('1');
+        }
+        else if (data_ok && ParseWindow(extracted_data, &days, &start_slot, &end_slot) &&
+                 Schedule_AddWindow(door, days, start_slot, end_slot))
+        {
+            Transport_SendChar('1');
+        }
+        else
+        {
+            Transport_SendChar('0');
+        }
+    }
+    /* PRF: Profiler */
+    else if (strncmp(line, "PRF", OPCODE_LENGTH) == 0)
+    {
+        if (!has_data)
+        {
+            Profile_Export(Transport_SendChar);
+        }
+        else if (data_ok && strcmp(extracted_data, "0") == 0)
+        {
+            Profile_Reset();
+            Transport_SendChar('1');
+        }
+        else
+        {
+            Transport_SendChar('0');
+        }
+    }
+    /* OTK: One-Time PIN Key */
+    else if (strncmp(line, "OTK", OPCODE_LENGTH) == 0)
+    {
+        if (key_clear)
+        {
+            Totp_ClearKey();
+            Transport_SendChar('1');
+        }
+        else if (data_ok && Totp_SetKey(key_part, key, key_len))
+        {
+            Transport_SendChar('1');
+        }
+        else
+        {
+            Transport_SendChar('0');
+        }
+    }
+    /* EXP: Configuration Export */
+    else if (strncmp(line, "EXP", OPCODE_LENGTH) == 0)
+    {
+        Config_Export(Transport_SendChar);
+    }
+    /* IMP: Configuration Import */
+    else if (strncmp(line, "IMP", OPCODE_LENGTH) == 0)
+    {
+        if (data_ok && !UART2_MULTIDROP && Lockout_RemainingMs(s) == 0 &&
+            Config_BeginImport(import_size, import_crc))
+        {
+            Transport_SendChar('1');
+        }
+        else
+        {
+            Transport_SendChar('0');
+        }
+    }
+    /* TRC: Link Traffic Trace */
+    else if (strncmp(line, "TRC", OPCODE_LENGTH) == 0)
+    {
+        if (!has_data)
+        {
+            Trace_Export(Transport_SendChar);
+        }
+        else if (data_ok && strcmp(extracted_data, "0") == 0)
+        {
+            Trace_Reset();
+            Transport_SendChar('1');
+        }
+        else
+        {
+            Transport_SendChar('0');
+        }
+    }
+    /* WAI: Bounded Waits */
+    else if (strncmp(line, "WAI", OPCODE_LENGTH) == 0)
+    {
+        if (!has_data)
+        {
+            Wait_Export(Transport_SendChar);
+        }
+        else if (data_ok && strcmp(extracted_data, "0") == 0)
+        {
+            Wait_Reset();
+            Transport_SendChar('1');
+        }
+        else
+        {
+            Transport_SendChar('0');
+        }
+    }
+    /* ENT: Streamed Password Entry (never answered: nothing to learn from) */
+    else if (strncmp(line, "ENT", OPCODE_LENGTH) == 0)
+    {
+        if (data_ok && data_len == 1)
+            Entry_Digit(s, extracted_data[0]);
+        else
+            Entry_Reset(s);
+    }
+    /* UPD: Firmware Update */
+    else if (strncmp(line, "UPD", OPCODE_LENGTH) == 0)
+    {
+        if (Lockout_RemainingMs(s) > 0)
+        {
+            Transport_SendChar('0');
+        }
+        else
+        {
+            Transport_SendChar('1');
+            EEPROM_RequestUpdate();
+            EventLog_Flush();
+            Transport_WaitTxDone();
+            SysCtlReset(); // Does not return
+        }
+    }
+    /* TMO: Set Timeout */
+    else if (strncmp(line, "TMO", OPCODE_LENGTH) == 0)
+    {
+        // Convert extracted data (e.g. "25") to integer; at most 2 digits
+        int t = (data_ok && data_len >= 1 && data_len <= 2) ? atoi(extracted_data) : 0;
+        if (t >= 5 && t <= 30 && !s->write_pending)
+        {
+            DeferReply(s, op, EVT_TIMEOUT_SET,
+                       EEPROM_WriteTimeout(door, (uint8_t)t), start_us);
+            deferred = true;
+        }
+        else
+        {
+            Transport_SendChar('0');
+            EventLog_Append(EVT_TIMEOUT_SET, EVT_SLOT_NONE, EVT_RESULT_FAIL);
+        }
+    }
+
+    /* Lockout just started: sound the alarm now the reply is out */
+    if (s->alarm_pending)
+    {
+        Transport_Flush();
+        s->alarm_pending = false;
+        EventLog_Append(EVT_ALARM, EVT_SLOT_NONE, EVT_RESULT_OK);
+        alarm();
+    }
+
+    if (!deferred)
+        Stats_RecordCommand(op, SysTick_GetUs() - start_us);
+    return deferred;
+}
+
+bool TakeDeferredReply(uint8_t *session, char *reply)
+{
+    Session *s;
+    bool ok;
+    uint8_t i;
+
+    for (i = 0; i < COMMAND_SESSIONS; i++)
+    {
+        s = &sessions[i];
+        if (!s->write_pending || !EEPROM_IsWritten(s->write_ticket))
+            continue;
+
+        ok = (EEPROM_WriteFailures() == s->write_failures);
+        s->write_pending = false;
+        EventLog_Append(s->write_event,
+                        (s->write_event == EVT_PASSWORD_SET) ? EVT_SLOT_PIN : EVT_SLOT_NONE,
+                        ok ? EVT_RESULT_OK : EVT_RESULT_FAIL);
+        Stats_RecordCommand(s->write_op, SysTick_GetUs() - s->write_start_us);
+        *session = i;
+        *reply = ok ? '1' : '0';
+        return true;
+    }
+    return false;
+}
+
+/******************************************************************************
+ * Helper Functions
+ ******************************************************************************/
+void SendReadyFrame(void)
+{
+    UART2_BeginFrame(UART2_BROADCAST, UART2_FRAME_DATA);
+    Transport_SendString("RDY:");
+    Transport_SendChar(StatusReply());
+    Transport_SendChar('\n');
+    UART2_EndFrame();
+    Transport_Flush();
+}
+
+bool ExtractData(const char *buffer, char *data, uint8_t data_size)
+{
+    uint8_t i, data_index = 0;
+    bool found_colon = false;
+
+    data[0] = '\0';
+    for (i = 0; i < COMMAND_BUFFER_SIZE && !IsEndOfLine(buffer[i]); i++)
+    {
+        if (found_colon)
+        {
+            // Digits only for Password/Timeout
+            if (buffer[i] < '0' || buffer[i] > '9')
+                return false;
+            if (data_index >= data_size - 1)
+                return false;
+            data[data_index++] = buffer[i];
+            data[data_index] = '\0';
+        }
+        else if (buffer[i] == ':')
+        {
+            found_colon = true;
+        }
+    }
+    return found_colon;
+}
+
+uint32_t SavePassword(const char *received_password)
+{
+    uint8_t pwd_bytes[8] = {0}; // EEPROM slot is 8 bytes; pad past the digits
+    uint8_t i;
+    for (i = 0; i < PASSWORD_LENGTH && received_password[i] != '\0'; i++)
+        pwd_bytes[i] = received_password[i];
+    EEPROM_WritePassword(pwd_bytes);
+    return EEPROM_MarkPasswordSet();
+}
+
+bool ValidatePassword(const char *received_password)
+{
+    uint8_t stored_password[8];
+    uint8_t i;
+    if (strlen(received_password) != PASSWORD_LENGTH)
+        return false;
+    EEPROM_ReadPassword(stored_password);
+    for (i = 0; i < PASSWORD_LENGTH; i++)
+    {
+        if (received_password[i] != stored_password[i])
+            return false;
+    }
+    return true;
+}
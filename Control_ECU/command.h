@@ -0,0 +1,74 @@
+/******************************************************************************
+ * File: command.h (Control_ECU)
+ * Description: Command line parsing and dispatch for the UART protocol.
+ *              Depends only on the driver headers, so it can be linked
+ *              against stub drivers off-target.
+ ******************************************************************************/
+
+#ifndef COMMAND_H_
+#define COMMAND_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uart.h"
+
+/******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#define COMMAND_BUFFER_SIZE 32  /* Longest accepted line incl. terminator */
+#define COMMAND_DATA_SIZE   16  /* Longest digit field after ':' + 1 */
+
+/* Consecutive CHK/PWD failures before lockout, and its length */
+#define MAX_FAILED_ATTEMPTS 3
+#define LOCKOUT_DURATION_MS 20000u
+
+/* Independent lockout sessions: one per bus node (see uart.h); session 0 is
+ * the point-to-point link */
+#define COMMAND_SESSIONS    (UART2_MAX_NODE + 1)
+
+/******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+/*
+ * ProcessCommand
+ * Parses one received line (NUL-terminated, at most COMMAND_BUFFER_SIZE
+ * bytes read) from the given session (bus node) and sends the reply.
+ * Unknown or malformed lines are ignored. Returns true if nothing was sent
+ * because the reply waits for an EEPROM write (see TakeDeferredReply).
+ */
+bool ProcessCommand(uint8_t session, const char *buffer);
+
+/*
+ * TakeDeferredReply
+ * Finds a SET/TMO whose EEPROM write has finished and returns its session
+ * and reply: '1', or '0' if any queued write failed its read-back in the
+ * meantime. The caller sends it. False if there is none.
+ */
+bool TakeDeferredReply(uint8_t *session, char *reply);
+
+/*
+ * SendReadyFrame
+ * Sends the unsolicited "RDY:<s>\n" frame once startup is complete; <s> is
+ * the STS reply ('1' password set, '0' not).
+ */
+void SendReadyFrame(void);
+
+/*
+ * ExtractData
+ * Copies the digits following the first ':' into data (at most
+ * data_size - 1 of them, always NUL-terminated). Returns false if the field
+ * contains a non-digit or is longer than data_size - 1.
+ */
+bool ExtractData(const char *buffer, char *data, uint8_t data_size);
+
+/*
+ * ValidatePassword / SavePassword
+ * Compare against / store the EEPROM password. Both expect exactly
+ * PASSWORD_LENGTH digits. SavePassword only queues the write and returns
+ * its ticket (EEPROM_IsWritten).
+ */
+bool ValidatePassword(const char *received_password);
+uint32_t SavePassword(const char *received_password);
+
+#endif /* COMMAND_H_ */
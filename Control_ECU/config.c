@@ -0,0 +1,327 @@
+/******************************************************************************
+ * File: config.c (Control_ECU)
+ * Description: Configuration image export and pipelined, CRC-checked import
+ ******************************************************************************/
+
+#include "config.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "crc32.h"
+#include "eeprom.h"
+#include "eventlog.h"
+#include "schedule.h"
+#include "systick.h"
+#include "totp.h"
+#include "transport.h"
+
+#define FRAME_SIZE (1 + 2 + CONFIG_BLOCK_SIZE + 4) /* marker, seq, data, CRC-32 */
+
+typedef struct
+{
+    uint32_t address;
+    uint32_t bytes;
+} Region;
+
+/* Image order; the sizes add up to CONFIG_IMAGE_SIZE */
+static const Region regions[] = {
+    { PASSWORD_ADDRESS, 8 },
+    { TIMEOUT_ADDRESS, 4 * TIMEOUT_SLOTS },
+    { SETUP_FLAG_ADDRESS, 4 },
+    { SCHEDULE_ADDRESS, SCHEDULE_BYTES * MOTOR_DOOR_COUNT },
+    { TOTP_KEY_ADDRESS, TOTP_KEY_BYTES },
+};
+
+#define REGION_COUNT (sizeof(regions) / sizeof(regions[0]))
+
+static bool importing = false;
+static uint8_t frame[FRAME_SIZE];
+static uint8_t frame_pos = 0;
+static uint16_t next_seq = 0;
+static uint32_t image_crc = 0;
+static uint32_t activity_ms = 0;
+static uint32_t failures_before = 0;    // EEPROM_WriteFailures() at the start
+static char line[4];                    // "END"
+static uint8_t line_len = 0;
+static uint32_t backup[CONFIG_IMAGE_SIZE / 4];
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+static uint32_t GetU32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint8_t SendByte(void (*put)(char), uint8_t value, uint8_t sum)
+{
+    put((char)value);
+    return (uint8_t)(sum + value);
+}
+
+/*
+ * Image_Read
+ * Reads count bytes of the image from offset (both word-aligned).
+ */
+static void Image_Read(uint32_t *data, uint32_t offset, uint32_t count)
+{
+    uint32_t start = 0, n;
+    uint8_t r;
+
+    for (r = 0; r < REGION_COUNT && count > 0; r++)
+    {
+        if (offset < start + regions[r].bytes)
+        {
+            n = start + regions[r].bytes - offset;
+            if (n > count)
+                n = count;
+            EEPROM_ReadWords(data, regions[r].address + (offset - start), n);
+            data += n / 4;
+            offset += n;
+            count -= n;
+        }
+        start += regions[r].bytes;
+    }
+}
+
+/*
+ * Image_Write
+ * Queues count bytes (at most CONFIG_BLOCK_SIZE) of the image at offset,
+ * one EEPROM write per region they touch.
+ */
+static void Image_Write(const uint32_t *data, uint32_t offset, uint32_t count)
+{
+    uint32_t start = 0, n;
+    uint8_t r;
+
+    for (r = 0; r < REGION_COUNT && count > 0; r++)
+    {
+        if (offset < start + regions[r].bytes)
+        {
+            n = start + regions[r].bytes - offset;
+            if (n > count)
+                n = count;
+            EEPROM_QueueWrite(regions[r].address + (offset - start), data, (uint8_t)(n / 4));
+            data += n / 4;
+            offset += n;
+            count -= n;
+        }
+        start += regions[r].bytes;
+    }
+}
+
+/*
+ * Image_Crc
+ * CRC-32 of the image as stored, a block at a time.
+ */
+static uint32_t Image_Crc(void)
+{
+    uint32_t block[CONFIG_BLOCK_SIZE / 4];
+    uint32_t offset, n, crc = CRC32_INIT;
+
+    for (offset = 0; offset < CONFIG_IMAGE_SIZE; offset += n)
+    {
+        n = CONFIG_IMAGE_SIZE - offset;
+        if (n > CONFIG_BLOCK_SIZE)
+            n = CONFIG_BLOCK_SIZE;
+        Image_Read(block, offset, n);
+        crc = CRC32_Update(crc, block, n);
+    }
+    return crc;
+}
+
+static void Import_Reply(char reply)
+{
+    Transport_SendChar(reply);
+    Transport_Flush();
+}
+
+/*
+ * Import_Finish
+ * Closes the import. Unless committed, writes the configuration from
+ * before the import back. Waits for the EEPROM either way.
+ */
+static void Import_Finish(bool commit)
+{
+    uint32_t offset, n;
+
+    importing = false;
+    if (!commit)
+    {
+        for (offset = 0; offset < CONFIG_IMAGE_SIZE; offset += n)
+        {
+            n = CONFIG_IMAGE_SIZE - offset;
+            if (n > CONFIG_BLOCK_SIZE)
+                n = CONFIG_BLOCK_SIZE;
+            Image_Write(&backup[offset / 4], offset, n);
+        }
+    }
+    EEPROM_Flush();
+
+    // Both may have changed; everything else is read from EEPROM when used
+    Schedule_Init();
+    Totp_Init();
+    EventLog_Append(EVT_CONFIG_IMPORT, EVT_SLOT_NONE, commit ? EVT_RESULT_OK : EVT_RESULT_FAIL);
+}
+
+/*
+ * Import_End
+ * "END": commits if every block arrived and the EEPROM now holds the
+ * announced image.
+ */
+static void Import_End(void)
+{
+    bool ok = (next_seq == CONFIG_BLOCKS);
+
+    if (ok)
+    {
+        EEPROM_Flush();
+        ok = (EEPROM_WriteFailures() == failures_before) && (Image_Crc() == image_crc);
+    }
+    Import_Reply(ok ? '1' : '0');
+    Import_Finish(ok);
+}
+
+/*
+ * Import_Block
+ * Checks a complete frame, acknowledges it, then queues its writes. The
+ * host sends the next block on the acknowledgement; it collects in the
+ * receive ring while the EEPROM is programmed.
+ */
+static void Import_Block(void)
+{
+    uint32_t data[CONFIG_BLOCK_SIZE / 4];
+    uint16_t seq = (uint16_t)(frame[1] | (frame[2] << 8));
+    uint32_t offset, n;
+
+    if (CRC32_Update(CRC32_INIT, &frame[1], FRAME_SIZE - 5) != GetU32(&frame[FRAME_SIZE - 4]))
+    {
+        Import_Reply('0');
+        return;
+    }
+    if (seq + 1u == next_seq)
+    {
+        Import_Reply('1');  // Our acknowledgement was lost
+        return;
+    }
+    if (seq != next_seq || seq >= CONFIG_BLOCKS)
+    {
+        Import_Reply('0');
+        return;
+    }
+
+    memcpy(data, &frame[3], CONFIG_BLOCK_SIZE);
+    next_seq++;
+    Import_Reply('1');
+
+    offset = (uint32_t)seq * CONFIG_BLOCK_SIZE;
+    n = CONFIG_IMAGE_SIZE - offset;
+    if (n > CONFIG_BLOCK_SIZE)
+        n = CONFIG_BLOCK_SIZE;
+    Image_Write(data, offset, n);
+}
+
+/******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+
+void Config_Export(void (*put)(char))
+{
+    uint32_t block[CONFIG_BLOCK_SIZE / 4];
+    const uint8_t *bytes = (const uint8_t *)block;
+    uint32_t offset, n, i, crc = CRC32_INIT;
+    uint16_t len = 1 + CONFIG_IMAGE_SIZE + 4;
+    uint8_t sum = 0;
+
+    sum = SendByte(put, (uint8_t)len, sum);
+    sum = SendByte(put, (uint8_t)(len >> 8), sum);
+    sum = SendByte(put, CONFIG_VERSION, sum);
+
+    for (offset = 0; offset < CONFIG_IMAGE_SIZE; offset += n)
+    {
+        n = CONFIG_IMAGE_SIZE - offset;
+        if (n > CONFIG_BLOCK_SIZE)
+            n = CONFIG_BLOCK_SIZE;
+        Image_Read(block, offset, n);
+        crc = CRC32_Update(crc, block, n);
+        for (i = 0; i < n; i++)
+            sum = SendByte(put, bytes[i], sum);
+    }
+
+    for (i = 0; i < 4; i++)
+        sum = SendByte(put, (uint8_t)(crc >> (8 * i)), sum);
+    put((char)sum);
+}
+
+bool Config_BeginImport(uint32_t size, uint32_t crc)
+{
+    if (size != CONFIG_IMAGE_SIZE)
+        return false;
+
+    Image_Read(backup, 0, CONFIG_IMAGE_SIZE);
+    failures_before = EEPROM_WriteFailures();
+    image_crc = crc;
+    next_seq = 0;
+    frame_pos = 0;
+    line_len = 0;
+    activity_ms = SysTick_GetMs();
+    importing = true;
+    return true;
+}
+
+bool Config_ImportService(void)
+{
+    char c;
+
+    if (!importing)
+        return false;
+
+    while (importing && Transport_IsDataAvailable())
+    {
+        c = Transport_ReceiveChar();
+        activity_ms = SysTick_GetMs();
+
+        if (line_len == 0 && (frame_pos > 0 || c == CONFIG_BLOCK_MARKER))
+        {
+            // Block, opened by its marker at the start of a line
+            frame[frame_pos++] = (uint8_t)c;
+            if (frame_pos == FRAME_SIZE)
+            {
+                Import_Block();
+                frame_pos = 0;
+            }
+        }
+        else if (c == '\n' || c == '\r')
+        {
+            if (line_len == 3 && memcmp(line, "END", 3) == 0)
+            {
+                Import_End();
+            }
+            else
+            {
+                Import_Reply('0');
+                Import_Finish(false);
+            }
+        }
+        else if (line_len < sizeof(line))
+        {
+            line[line_len++] = c;
+        }
+    }
+
+    if (importing && (frame_pos > 0 || line_len > 0) &&
+        (SysTick_GetMs() - activity_ms) >= CONFIG_BLOCK_TIMEOUT_MS)
+    {
+        // Partial block or line: drop it, the host resends after no reply
+        frame_pos = 0;
+        line_len = 0;
+        Import_Reply('0');
+    }
+    else if (importing && (SysTick_GetMs() - activity_ms) >= CONFIG_TRANSFER_TIMEOUT_MS)
+    {
+        Import_Finish(false);   // Host gone
+    }
+    return true;
+}
@@ -0,0 +1,86 @@
+/******************************************************************************
+ * File: config.h (Control_ECU)
+ * Description: Export and import of the persistent configuration image, to
+ *              back up a unit or commission replacement boards from a host
+ *              (tools/config.py).
+ *
+ * The image is these EEPROM ranges back to back, as stored:
+ *   password (8 bytes), timeouts (TIMEOUT_SLOTS words), setup flag (word),
+ *   schedules (SCHEDULE_BYTES per door), one-time PIN key record
+ *   (TOTP_KEY_BYTES)
+ * The boot count, the update flag and the last one-time PIN step used
+ * belong to the board and are left out: an import cannot take the step
+ * back and let used codes in again.
+ *
+ * EXP reply (binary, little-endian):
+ *   len        uint16  number of payload bytes that follow
+ *   payload:
+ *     version  uint8   CONFIG_VERSION
+ *     image    CONFIG_IMAGE_SIZE bytes
+ *     crc      uint32  CRC-32 of the image (crc32.h), the digest to compare
+ *   checksum   uint8   sum of all preceding bytes (len included)
+ *
+ * Import, the Control_Bootloader update protocol in small:
+ *   -> "IMP:<size>,<crc32>\n"  decimal; '1' if size is CONFIG_IMAGE_SIZE
+ *   -> 'B'<seq:u16 LE><CONFIG_BLOCK_SIZE data bytes, last one 0 padded>
+ *      <crc32:u32 LE of seq and data>
+ *                              '1' accepted, '0' send it again; a repeat
+ *                              of the previous block is acknowledged.
+ *                              Only 'B' at the start of a line opens a
+ *                              block, so a resent block is never taken
+ *                              for "END" whatever its sequence number
+ *   -> "END\n"                 '1' the EEPROM holds the image (read back,
+ *                              CRC-32 matched); '0' mismatch
+ * Each block is acknowledged before its EEPROM writes are queued, so the
+ * next block arrives while they are programmed. On '0' to END, or when
+ * the host goes quiet for CONFIG_TRANSFER_TIMEOUT_MS, the configuration
+ * from before the import is written back.
+ *
+ * While an import is open it owns the link: no other commands are served.
+ ******************************************************************************/
+
+#ifndef CONFIG_H_
+#define CONFIG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "eeprom.h"
+#include "motor.h"
+
+/******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#define CONFIG_VERSION 2
+#define CONFIG_IMAGE_SIZE (8 + 4 * TIMEOUT_SLOTS + 4 + \
+                           SCHEDULE_BYTES * MOTOR_DOOR_COUNT + TOTP_KEY_BYTES)
+#define CONFIG_BLOCK_MARKER 'B'
+#define CONFIG_BLOCK_SIZE (4 * EEPROM_QUEUE_WORDS)  /* One queued write */
+#define CONFIG_BLOCKS ((CONFIG_IMAGE_SIZE + CONFIG_BLOCK_SIZE - 1) / CONFIG_BLOCK_SIZE)
+#define CONFIG_BLOCK_TIMEOUT_MS 2000U       /* Silence inside a block */
+#define CONFIG_TRANSFER_TIMEOUT_MS 10000U   /* Silence: import abandoned */
+
+/******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+/*
+ * Config_Export
+ * Sends the EXP reply described above through put.
+ */
+void Config_Export(void (*put)(char));
+
+/*
+ * Config_BeginImport
+ * Opens an import of an image of size bytes with the given CRC-32. The
+ * caller sends the '1'. False (nothing changed) if size does not match.
+ */
+bool Config_BeginImport(uint32_t size, uint32_t crc);
+
+/*
+ * Config_ImportService
+ * Call from the main loop before line assembly. While an import is open,
+ * takes the link's bytes, answers them and returns true.
+ */
+bool Config_ImportService(void);
+
+#endif /* CONFIG_H_ */
@@ -0,0 +1,22 @@
+/******************************************************************************
+ * File: crc32.h
+ * Module: CRC-32
+ * Description: Standard CRC-32 (IEEE 802.3, reflected, poly 0xEDB88320),
+ *              identical to zlib/Python binascii.crc32.
+ ******************************************************************************/
+
+#ifndef CRC32_H_
+#define CRC32_H_
+
+#include <stdint.h>
+
+#define CRC32_INIT 0x00000000u
+
+/*
+ * CRC32_Update
+ * Continues a CRC over len more bytes. Start with CRC32_INIT; the value
+ * returned after the last chunk is the final CRC.
+ */
+uint32_t CRC32_Update(uint32_t crc, const void *data, uint32_t len);
+
+#endif /* CRC32_H_ */
@@ -8,9 +8,186 @@
 #include <stdbool.h>
 
 /* TivaWare includes */
+#include "inc/hw_ints.h"
 #include "inc/hw_memmap.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/eeprom.h"
+#include "driverlib/flash.h"
+#include "driverlib/interrupt.h"
+#include "stats.h"
+#include "wait.h"
+
+/* A word takes well under a millisecond; compacting a full block far longer */
+#define EEPROM_BUSY_TIMEOUT_US 500000U
+
+typedef struct
+{
+    uint32_t address;
+    uint32_t data[EEPROM_QUEUE_WORDS];
+    uint8_t words;
+    uint8_t attempts;           /* Reprogrammed after a failed read-back */
+    uint32_t ticket;            /* Of the oldest write folded into it */
+} QueuedWrite;
+
+/* Ring of writes; the head is the one being programmed. Changed by the
+ * done interrupt, so the main loop touches it with INT_FLASH masked. */
+static QueuedWrite queue[EEPROM_QUEUE_SIZE];
+static volatile uint8_t queue_head = 0;
+static volatile uint8_t queue_count = 0;
+static volatile uint8_t next_word = 0;      // Of the head, to program next
+static uint32_t last_ticket = 0;            // Issued
+static volatile uint32_t done_ticket = 0;
+static volatile uint32_t write_failures = 0;
+
+/******************************************************************************
+ * Write Queue
+ ******************************************************************************/
+
+static bool Queue_Verify(const QueuedWrite *w)
+{
+    uint32_t readback[EEPROM_QUEUE_WORDS];
+    uint8_t i;
+
+    EEPROMRead(readback, w->address, 4u * w->words);
+    for (i = 0; i < w->words; i++)
+    {
+        if (readback[i] != w->data[i])
+            return false;
+    }
+    return true;
+}
+
+/*
+ * Queue_Advance
+ * Call with the EEPROM idle. Starts the next word of the head write, or,
+ * all of it programmed, reads it back and moves on to the next write.
+ */
+static void Queue_Advance(void)
+{
+    QueuedWrite *w;
+
+    while (queue_count != 0)
+    {
+        w = &queue[queue_head];
+        if (next_word < w->words)
+        {
+            EEPROMProgramNonBlocking(w->data[next_word], w->address + 4u * next_word);
+            next_word++;
+            return;     // The done interrupt calls back
+        }
+
+        next_word = 0;
+        if (!Queue_Verify(w))
+        {
+            if (++w->attempts <= EEPROM_VERIFY_RETRIES)
+                continue;
+            write_failures++;
+            Stats_Increment(STAT_EEPROM_FAILURES);
+        }
+
+        queue_head = (uint8_t)((queue_head + 1) % EEPROM_QUEUE_SIZE);
+        queue_count--;
+        done_ticket = (queue_count == 0) ? last_ticket : queue[queue_head].ticket - 1;
+    }
+}
+
+/*
+ * EEPROM_DoneISR
+ * The EEPROM interrupt comes in on the flash controller's vector.
+ */
+static void EEPROM_DoneISR(void)
+{
+    EEPROMIntClear(EEPROM_INT_PROGRAM);
+    if (!(EEPROMStatusGet() & EEPROM_RC_WORKING))
+        Queue_Advance();
+}
+
+/*
+ * Queue_Write
+ * Queues words (at most EEPROM_QUEUE_WORDS) for address, or replaces the
+ * data of a write to the same address still waiting. Returns its ticket.
+ */
+static uint32_t Queue_Write(uint32_t address, const uint32_t *data, uint8_t words)
+{
+    QueuedWrite *w = 0;
+    uint8_t i;
+
+    if (queue_count >= EEPROM_QUEUE_SIZE)
+        EEPROM_Flush();
+
+    IntDisable(INT_FLASH);
+    // Not the head: part of it may already be programmed
+    for (i = 1; i < queue_count && w == 0; i++)
+    {
+        w = &queue[(queue_head + i) % EEPROM_QUEUE_SIZE];
+        if (w->address != address || w->words != words)
+            w = 0;
+    }
+    if (w == 0)
+    {
+        w = &queue[(queue_head + queue_count) % EEPROM_QUEUE_SIZE];
+        w->address = address;
+        w->words = words;
+        w->ticket = last_ticket + 1;
+        queue_count++;
+        Stats_Increment(STAT_EEPROM_WRITES);
+    }
+    w->attempts = 0;
+    for (i = 0; i < words; i++)
+        w->data[i] = data[i];
+    last_ticket++;
+
+    if (queue_count == 1)
+        Queue_Advance();    // Was idle: start it
+    IntEnable(INT_FLASH);
+    return last_ticket;
+}
+
+/*
+ * Queue_Overlay
+ * Patches data read from address with the queued writes, oldest first.
+ */
+static void Queue_Overlay(uint32_t *data, uint32_t address, uint32_t count)
+{
+    const QueuedWrite *w;
+    uint32_t offset;
+    uint8_t i, k;
+
+    for (i = 0; i < queue_count; i++)
+    {
+        w = &queue[(queue_head + i) % EEPROM_QUEUE_SIZE];
+        for (k = 0; k < w->words; k++)
+        {
+            offset = w->address + 4u * k - address;
+            if (offset < count)
+                data[offset / 4] = w->data[k];
+        }
+    }
+}
+
+/* Wait_Until condition */
+static bool Eeprom_Idle(void)
+{
+    return (EEPROMStatusGet() & EEPROM_RC_WORKING) == 0;
+}
+
+/* Counted accessors: every EEPROM transfer goes through these */
+static void CountedRead(uint32_t *data, uint32_t address, uint32_t count)
+{
+    Stats_Increment(STAT_EEPROM_READS);
+    IntDisable(INT_FLASH);
+    Wait_Until(WAIT_EEPROM, Eeprom_Idle, EEPROM_BUSY_TIMEOUT_US);   // At most one word in progress
+    EEPROMRead(data, address, count);
+    Queue_Overlay(data, address, count);
+    IntEnable(INT_FLASH);
+}
+
+static void CountedProgram(uint32_t *data, uint32_t address, uint32_t count)
+{
+    Stats_Increment(STAT_EEPROM_WRITES);
+    EEPROM_Flush();
+    EEPROMProgram(data, address, count);
+}
 
 void EEPROM_Init(void)
 {
@@ -18,28 +195,67 @@ void EEPROM_Init(void)
     while (!SysCtlPeripheralReady(SYSCTL_PERIPH_EEPROM0))
         ;
     EEPROMInit();
+    FlashIntRegister(EEPROM_DoneISR);
+    EEPROMIntEnable(EEPROM_INT_PROGRAM);
+}
+
+bool EEPROM_IsWritten(uint32_t ticket)
+{
+    return ticket <= done_ticket;
+}
+
+uint32_t EEPROM_LastTicket(void)
+{
+    return last_ticket;
+}
+
+void EEPROM_ReadWords(uint32_t *data, uint32_t address, uint32_t count)
+{
+    CountedRead(data, address, count);
+}
+
+uint32_t EEPROM_QueueWrite(uint32_t address, const uint32_t *data, uint8_t words)
+{
+    return Queue_Write(address, data, words);
+}
+
+uint32_t EEPROM_WriteFailures(void)
+{
+    return write_failures;
+}
+
+void EEPROM_Flush(void)
+{
+    IntDisable(INT_FLASH);
+    while (queue_count != 0)
+    {
+        Wait_Until(WAIT_EEPROM, Eeprom_Idle, EEPROM_BUSY_TIMEOUT_US);
+        EEPROMIntClear(EEPROM_INT_PROGRAM);
+        Queue_Advance();
+    }
+    IntEnable(INT_FLASH);
 }
 
-void EEPROM_WritePassword(uint8_t *password)
+uint32_t EEPROM_WritePassword(uint8_t *password)
 {
-    EEPROMProgram((uint32_t *)password, PASSWORD_ADDRESS, 8);
+    return Queue_Write(PASSWORD_ADDRESS, (const uint32_t *)password, 2);
 }
 
 void EEPROM_ReadPassword(uint8_t *password)
 {
-    EEPROMRead((uint32_t *)password, PASSWORD_ADDRESS, 8);
+    CountedRead((uint32_t *)password, PASSWORD_ADDRESS, 8);
 }
 
-void EEPROM_WriteTimeout(uint8_t timeout_seconds)
+uint32_t EEPROM_WriteTimeout(uint8_t door, uint8_t timeout_seconds)
 {
     uint32_t timeout_data = timeout_seconds;
-    EEPROMProgram(&timeout_data, TIMEOUT_ADDRESS, 4);
+    return Queue_Write(TIMEOUT_ADDRESS + 4u * door, &timeout_data, 1);
 }
 
-uint8_t EEPROM_ReadTimeout(void)
+uint8_t EEPROM_ReadTimeout(uint8_t door)
 {
     uint32_t timeout_data;
-    EEPROMRead(&timeout_data, TIMEOUT_ADDRESS, 4);
+    CountedRead(&timeout_data, TIMEOUT_ADDRESS + 4u * door, 4);
 
     if (timeout_data >= 5 && timeout_data <= 30)
     {
@@ -51,12 +267,65 @@ uint8_t EEPROM_ReadTimeout(void)
 bool EEPROM_IsPasswordSet(void)
 {
     uint32_t setup_flag;
-    EEPROMRead(&setup_flag, SETUP_FLAG_ADDRESS, 4);
+    CountedRead(&setup_flag, SETUP_FLAG_ADDRESS, 4);
     return (setup_flag == SETUP_COMPLETE);
 }
 
-void EEPROM_MarkPasswordSet(void)
+uint32_t EEPROM_MarkPasswordSet(void)
 {
     uint32_t setup_flag = SETUP_COMPLETE;
-    EEPROMProgram(&setup_flag, SETUP_FLAG_ADDRESS, 4);
-}
\ No newline at end of file
+    return Queue_Write(SETUP_FLAG_ADDRESS, &setup_flag, 1);
+}
+
+uint32_t EEPROM_IncrementBootCount(void)
+{
+    uint32_t boot_count;
+    CountedRead(&boot_count, BOOT_COUNT_ADDRESS, 4);
+    if (boot_count == 0xFFFFFFFF) // Erased
+        boot_count = 0;
+    boot_count++;
+    CountedProgram(&boot_count, BOOT_COUNT_ADDRESS, 4);
+    return boot_count;
+}
+
+/*
+ * EEPROM_RequestUpdate
+ * Asks the bootloader to stay in update mode on the next reset.
+ */
+void EEPROM_RequestUpdate(void)
+{
+    uint32_t flag = UPDATE_REQUESTED;
+    CountedProgram(&flag, UPDATE_FLAG_ADDRESS, 4);
+}
+
+void EEPROM_ReadSchedule(uint8_t door, uint32_t *bitmap)
+{
+    CountedRead(bitmap, SCHEDULE_ADDRESS + (uint32_t)SCHEDULE_BYTES * door, SCHEDULE_BYTES);
+}
+
+void EEPROM_WriteSchedule(uint8_t door, uint32_t *bitmap)
+{
+    CountedProgram(bitmap, SCHEDULE_ADDRESS + (uint32_t)SCHEDULE_BYTES * door, SCHEDULE_BYTES);
+}
+
+void EEPROM_ReadTotpKey(uint32_t *record)
+{
+    CountedRead(record, TOTP_KEY_ADDRESS, TOTP_KEY_BYTES);
+}
+
+void EEPROM_WriteTotpKey(uint32_t *record)
+{
+    CountedProgram(record, TOTP_KEY_ADDRESS, TOTP_KEY_BYTES);
+}
+
+uint32_t EEPROM_ReadTotpStep(void)
+{
+    uint32_t step;
+    CountedRead(&step, TOTP_STEP_ADDRESS, 4);
+    return (step == 0xFFFFFFFF) ? 0 : step; // Erased: nothing used yet
+}
+
+void EEPROM_WriteTotpStep(uint32_t step)
+{
+    CountedProgram(&step, TOTP_STEP_ADDRESS, 4);
+}
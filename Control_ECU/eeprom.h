@@ -1,6 +1,17 @@
 /******************************************************************************
  * File: eeprom.h
  * Description: EEPROM Setup - Changed Flag to force New Password Setup
+ *
+ * The password, setup flag, timeouts and configuration imports (config.h)
+ * are written in the background: the
+ * write is queued and returns a ticket, and the EEPROM done interrupt
+ * programs it one word at a time (EEPROMProgramNonBlocking), then reads it
+ * back. A mismatch is programmed again up to EEPROM_VERIFY_RETRIES times.
+ * A queued write to the same address replaces the older data instead of
+ * programming twice. Reads see queued data as if it were already written.
+ *
+ * All other writes still block: they wait for the queue to drain, then
+ * program directly.
  ******************************************************************************/
 
 #ifndef EEPROM_H_
@@ -14,8 +25,23 @@
  ******************************************************************************/
 #define PASSWORD_LENGTH 5
 #define PASSWORD_ADDRESS 0x0000
-#define TIMEOUT_ADDRESS 0x0010
+#define TIMEOUT_ADDRESS 0x0010     /* One word per door */
+#define TIMEOUT_SLOTS 4             /* Doors that fit before SETUP_FLAG_ADDRESS */
 #define SETUP_FLAG_ADDRESS 0x0020
+#define BOOT_COUNT_ADDRESS 0x0030
+#define UPDATE_FLAG_ADDRESS 0x0040  /* Read and cleared by Control_Bootloader */
+#define SCHEDULE_ADDRESS 0x0080     /* SCHEDULE_BYTES per door */
+#define SCHEDULE_BYTES 84           /* 7 days x 96 quarter-hours, 1 bit each */
+#define TOTP_KEY_ADDRESS 0x0200     /* Length word, then the key (totp.h) */
+#define TOTP_KEY_BYTES 24
+#define TOTP_STEP_ADDRESS 0x0218    /* Last time step whose code was used */
+
+#define EEPROM_QUEUE_SIZE 4         /* Writes waiting for the EEPROM */
+#define EEPROM_QUEUE_WORDS 8        /* Longest queued write (an import block) */
+#define EEPROM_VERIFY_RETRIES 2
+
+/* Must match Control_Bootloader/flashmap.h */
+#define UPDATE_REQUESTED 0x55504400
 
 /*
  * CHANGED VALUE: 0x55
@@ -29,11 +55,55 @@
  ******************************************************************************/
 
 void EEPROM_Init(void);
-void EEPROM_WritePassword(uint8_t *password);
+uint32_t EEPROM_WritePassword(uint8_t *password);
 void EEPROM_ReadPassword(uint8_t *password);
-void EEPROM_WriteTimeout(uint8_t timeout_seconds);
-uint8_t EEPROM_ReadTimeout(void);
+uint32_t EEPROM_WriteTimeout(uint8_t door, uint8_t timeout_seconds);
+uint8_t EEPROM_ReadTimeout(uint8_t door);
 bool EEPROM_IsPasswordSet(void);
-void EEPROM_MarkPasswordSet(void);
+uint32_t EEPROM_MarkPasswordSet(void);
+uint32_t EEPROM_IncrementBootCount(void);
+void EEPROM_RequestUpdate(void);
+void EEPROM_ReadSchedule(uint8_t door, uint32_t *bitmap);
+void EEPROM_WriteSchedule(uint8_t door, uint32_t *bitmap);
+void EEPROM_ReadTotpKey(uint32_t *record);
+void EEPROM_WriteTotpKey(uint32_t *record);
+uint32_t EEPROM_ReadTotpStep(void);
+void EEPROM_WriteTotpStep(uint32_t step);
+
+/*
+ * EEPROM_ReadWords / EEPROM_QueueWrite
+ * Raw access for the configuration image. Reads count bytes (a multiple of
+ * 4); writes are queued like the password, at most EEPROM_QUEUE_WORDS
+ * words, and return the ticket.
+ */
+void EEPROM_ReadWords(uint32_t *data, uint32_t address, uint32_t count);
+uint32_t EEPROM_QueueWrite(uint32_t address, const uint32_t *data, uint8_t words);
+
+/*
+ * EEPROM_IsWritten
+ * True once the queued write that returned ticket, and every write queued
+ * before it, has been programmed and read back (or given up on).
+ */
+bool EEPROM_IsWritten(uint32_t ticket);
+
+/*
+ * EEPROM_LastTicket
+ * Ticket of the newest queued write (0 before any): unchanged means nothing
+ * has been written since.
+ */
+uint32_t EEPROM_LastTicket(void);
+
+/*
+ * EEPROM_WriteFailures
+ * Queued writes given up on since reset: still wrong after
+ * EEPROM_VERIFY_RETRIES reprogramming attempts.
+ */
+uint32_t EEPROM_WriteFailures(void);
+
+/*
+ * EEPROM_Flush
+ * Blocks until every queued write is done. Call before a reset.
+ */
+void EEPROM_Flush(void);
 
 #endif /* EEPROM_H_ */
\ No newline at end of file
@@ -0,0 +1,122 @@
+/******************************************************************************
+ * File: eventlog.c
+ * Module: Access Event Log
+ * Description: Access records on top of the flash append-only store.
+ *              Appends go to a small RAM batch so a burst of attempts costs
+ *              no flash programming time in the command path; the batch is
+ *              committed from the main loop.
+ ******************************************************************************/
+
+#include "eventlog.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include "eeprom.h"
+#include "flashlog.h"
+#include "rtc.h"
+#include "systick.h"
+#include "transport.h"
+
+#define EVENTLOG_RECORD_SIZE  sizeof(EventRecord)
+
+static EventRecord pending[EVENTLOG_BATCH_SIZE];
+static uint8_t pending_count = 0;
+static uint8_t boot_id = 0;
+static uint32_t last_append_ms = 0;
+
+/*
+ * EventLog_SendByte
+ * Sends one export byte and folds it into the running checksum.
+ */
+static void EventLog_SendByte(uint8_t b, uint8_t *checksum)
+{
+    *checksum += b;
+    Transport_SendChar((char)b);
+}
+
+void EventLog_Init(void)
+{
+    FlashLog_Init();
+    boot_id = (uint8_t)EEPROM_IncrementBootCount();
+    pending_count = 0;
+
+    EventLog_Append(EVT_BOOT, EVT_SLOT_NONE, EVT_RESULT_OK);
+}
+
+void EventLog_Append(uint8_t type, uint8_t slot, uint8_t result)
+{
+    EventRecord *rec;
+
+    if (pending_count >= EVENTLOG_BATCH_SIZE)
+        EventLog_Flush();
+
+    rec = &pending[pending_count++];
+    if (RTC_IsSet())
+        rec->time = RTC_Get();
+    else
+        rec->time = EVT_TIME_UPTIME | (SysTick_GetMs() / 1000);
+    rec->type = type;
+    rec->slot = slot;
+    rec->result = result;
+    rec->boot = boot_id;
+
+    last_append_ms = SysTick_GetMs();
+}
+
+void EventLog_Service(void)
+{
+    if (pending_count == 0)
+        return;
+
+    if (pending_count >= EVENTLOG_BATCH_SIZE ||
+        (SysTick_GetMs() - last_append_ms) >= EVENTLOG_FLUSH_DELAY_MS)
+    {
+        EventLog_Flush();
+    }
+}
+
+void EventLog_Flush(void)
+{
+    uint8_t i;
+
+    if (pending_count == 0)
+        return;
+    EEPROM_Flush(); // The flash controller also runs the EEPROM: one at a time
+    for (i = 0; i < pending_count; i++)
+        FlashLog_Append(&pending[i]);
+    pending_count = 0;
+}
+
+void EventLog_Export(uint32_t last_n)
+{
+    EventRecord rec;
+    uint8_t *bytes = (uint8_t *)&rec;
+    uint32_t seq, end, count, i;
+    uint8_t checksum = 0;
+
+    EventLog_Flush();
+
+    end = FlashLog_NextSeq();
+    count = end - FlashLog_FirstSeq();
+    if (last_n != 0 && last_n < count)
+        count = last_n;
+
+    EventLog_SendByte((uint8_t)(count & 0xFF), &checksum);
+    EventLog_SendByte((uint8_t)(count >> 8), &checksum);
+
+    /* Direct range lookup: no scan of older records */
+    for (seq = end - count; seq != end; seq++)
+    {
+        if (!FlashLog_Read(seq, &rec))
+        {
+            rec.time = 0;
+            rec.type = EVT_CORRUPT;
+            rec.slot = EVT_SLOT_NONE;
+            rec.result = EVT_RESULT_FAIL;
+            rec.boot = 0;
+        }
+        for (i = 0; i < EVENTLOG_RECORD_SIZE; i++)
+            EventLog_SendByte(bytes[i], &checksum);
+    }
+
+    Transport_SendChar((char)checksum);
+}
@@ -0,0 +1,102 @@
+/******************************************************************************
+ * File: eventlog.h
+ * Module: Access Event Log
+ * Description: Persistent log of fixed-size binary access records kept in
+ *              the flash append-only store, with batched writes and bulk
+ *              UART export.
+ ******************************************************************************/
+
+#ifndef EVENTLOG_H_
+#define EVENTLOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Event types */
+#define EVT_CORRUPT       0x00  /* Exported in place of a record failing CRC */
+#define EVT_BOOT          0x01  /* Control ECU powered up */
+#define EVT_UNLOCK        0x02  /* PWD: door open attempt */
+#define EVT_VERIFY        0x03  /* CHK: password check */
+#define EVT_PASSWORD_SET  0x04  /* SET: new password stored */
+#define EVT_TIMEOUT_SET   0x05  /* TMO: door timeout changed */
+#define EVT_ALARM         0x06  /* Lockout started / ALM: alarm sounded */
+#define EVT_CONFIG_IMPORT 0x07  /* IMP: configuration image imported */
+
+/* Result codes */
+#define EVT_RESULT_FAIL   0x00
+#define EVT_RESULT_OK     0x01
+#define EVT_RESULT_LOCKED 0x02  /* Rejected unchecked: lockout in force */
+#define EVT_RESULT_DENIED 0x03  /* Right password outside the door's schedule */
+
+/* User slots */
+#define EVT_SLOT_PIN      0x00  /* The stored keypad PIN */
+#define EVT_SLOT_OTP      0x01  /* A one-time PIN (totp.h) */
+#define EVT_SLOT_NONE     0xFF  /* Event not tied to a credential */
+
+/* EventRecord.time holds seconds since boot, not RTC time, when this bit
+ * is set: the clock had not been set (CLK) when the event happened */
+#define EVT_TIME_UPTIME   0x80000000UL
+
+/* Records held in RAM before they are committed to flash */
+#define EVENTLOG_BATCH_SIZE      8
+/* Quiet time after the last event before a partial batch is committed */
+#define EVENTLOG_FLUSH_DELAY_MS  250
+
+/*
+ * EventRecord
+ * 8-byte record (one flash store payload), stored and exported little-endian
+ * exactly as laid out here.
+ */
+typedef struct
+{
+    uint32_t time;   /* RTC seconds since 1970, or EVT_TIME_UPTIME | uptime */
+    uint8_t type;    /* EVT_* */
+    uint8_t slot;    /* EVT_SLOT_* */
+    uint8_t result;  /* EVT_RESULT_* */
+    uint8_t boot;    /* Low byte of the boot counter */
+} EventRecord;
+
+/******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+/*
+ * EventLog_Init
+ * Rebuilds the flash store index and records an EVT_BOOT event.
+ * Must be called after EEPROM_Init, SysTick_Init and RTC_Init.
+ */
+void EventLog_Init(void);
+
+/*
+ * EventLog_Append
+ * Queues a record in RAM. Never touches flash unless the batch is full.
+ */
+void EventLog_Append(uint8_t type, uint8_t slot, uint8_t result);
+
+/*
+ * EventLog_Service
+ * Commits queued records once a full batch is pending or the log has been
+ * quiet for EVENTLOG_FLUSH_DELAY_MS. Call from the main loop.
+ */
+void EventLog_Service(void);
+
+/*
+ * EventLog_Flush
+ * Commits all queued records to flash immediately.
+ */
+void EventLog_Flush(void);
+
+/*
+ * EventLog_Export
+ * Streams the newest last_n records (0 = everything retained) over UART2,
+ * oldest first:
+ *   count (uint16 LE) | count * EventRecord | checksum (uint8, sum of all
+ *   preceding bytes including the count)
+ */
+void EventLog_Export(uint32_t last_n);
+
+#endif /* EVENTLOG_H_ */
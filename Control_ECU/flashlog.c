@@ -0,0 +1,211 @@
+/******************************************************************************
+ * File: flashlog.c
+ * Module: Flash Append-Only Store
+ * Description: Page-rotating record log in internal flash with a RAM index.
+ *
+ * Every page except the newest is full, and records are numbered
+ * consecutively, so the page and slot holding any sequence number are
+ * computed directly from the tail page without scanning flash.
+ ******************************************************************************/
+
+#include "flashlog.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+/* TivaWare includes */
+#include "driverlib/flash.h"
+#include "crc32.h"
+
+#define FLASHLOG_PAGE_ADDR(page)        (FLASHLOG_BASE + (page) * FLASHLOG_PAGE_SIZE)
+#define FLASHLOG_SLOT_ADDR(page, slot)  (FLASHLOG_PAGE_ADDR(page) + (slot) * FLASHLOG_RECORD_SIZE)
+#define FLASHLOG_READ_ADDR(addr)        (FLASH_MEMORY_BASE + (addr))
+#define FLASH_ERASED_WORD               0xFFFFFFFFu
+
+/* RAM index */
+static uint8_t head_page;        /* Page receiving appends */
+static uint8_t tail_page;        /* Oldest retained page */
+static uint32_t head_generation;
+static uint32_t head_used;       /* Records in the head page */
+static uint32_t first_seq;       /* Oldest retained record */
+static uint32_t next_seq;
+
+static const FlashLogPageHeader *FlashLog_Header(uint8_t page)
+{
+    return (const FlashLogPageHeader *)FLASHLOG_READ_ADDR(FLASHLOG_PAGE_ADDR(page));
+}
+
+static const FlashLogRecord *FlashLog_Slot(uint8_t page, uint32_t slot)
+{
+    return (const FlashLogRecord *)FLASHLOG_READ_ADDR(FLASHLOG_SLOT_ADDR(page, slot));
+}
+
+static bool FlashLog_HeaderValid(const FlashLogPageHeader *hdr)
+{
+    return hdr->magic == FLASHLOG_PAGE_MAGIC &&
+           hdr->crc == CRC32_Update(CRC32_INIT, hdr, 12);
+}
+
+static bool FlashLog_SlotErased(uint8_t page, uint32_t slot)
+{
+    const uint32_t *w = (const uint32_t *)FLASHLOG_READ_ADDR(FLASHLOG_SLOT_ADDR(page, slot));
+    return w[0] == FLASH_ERASED_WORD && w[1] == FLASH_ERASED_WORD &&
+           w[2] == FLASH_ERASED_WORD && w[3] == FLASH_ERASED_WORD;
+}
+
+/*
+ * FlashLog_StartPage
+ * Erases page and stamps a header opening it at seq.
+ */
+static void FlashLog_StartPage(uint8_t page, uint32_t generation, uint32_t seq)
+{
+    FlashLogPageHeader hdr;
+
+    FlashErase(FLASHLOG_PAGE_ADDR(page));
+
+    hdr.magic = FLASHLOG_PAGE_MAGIC;
+    hdr.generation = generation;
+    hdr.first_seq = seq;
+    hdr.crc = CRC32_Update(CRC32_INIT, &hdr, 12);
+    FlashProgram((uint32_t *)&hdr, FLASHLOG_PAGE_ADDR(page), sizeof(hdr));
+
+    head_page = page;
+    head_generation = generation;
+    head_used = 0;
+}
+
+void FlashLog_Init(void)
+{
+    const FlashLogPageHeader *hdr;
+    uint32_t lo, hi, mid;
+    uint32_t oldest_generation = FLASH_ERASED_WORD;
+    bool found = false;
+    uint8_t page;
+
+    /* 1) Find newest and oldest valid pages from the headers */
+    for (page = 0; page < FLASHLOG_PAGES; page++)
+    {
+        hdr = FlashLog_Header(page);
+        if (!FlashLog_HeaderValid(hdr))
+            continue;
+
+        if (!found || hdr->generation > head_generation)
+        {
+            head_page = page;
+            head_generation = hdr->generation;
+        }
+        if (!found || hdr->generation < oldest_generation)
+        {
+            tail_page = page;
+            oldest_generation = hdr->generation;
+        }
+        found = true;
+    }
+
+    if (!found)
+    {
+        /* Blank or foreign contents: format */
+        FlashLog_StartPage(0, 1, 0);
+        tail_page = 0;
+        first_seq = 0;
+        next_seq = 0;
+        return;
+    }
+
+    /* 2) Binary search the head page for its first erased slot */
+    lo = 1;
+    hi = FLASHLOG_RECORDS_PER_PAGE + 1;
+    while (lo < hi)
+    {
+        mid = (lo + hi) / 2;
+        if (FlashLog_SlotErased(head_page, mid))
+            hi = mid;
+        else
+            lo = mid + 1;
+    }
+    head_used = lo - 1;
+
+    first_seq = FlashLog_Header(tail_page)->first_seq;
+    next_seq = FlashLog_Header(head_page)->first_seq + head_used;
+}
+
+uint32_t FlashLog_Append(const void *payload)
+{
+    FlashLogRecord rec;
+    uint8_t next_page;
+    uint32_t seq;
+
+    if (head_used >= FLASHLOG_RECORDS_PER_PAGE)
+    {
+        /* Rotate: reclaim the oldest page */
+        next_page = (uint8_t)((head_page + 1) % FLASHLOG_PAGES);
+        if (next_page == tail_page)
+        {
+            tail_page = (uint8_t)((tail_page + 1) % FLASHLOG_PAGES);
+            first_seq += FLASHLOG_RECORDS_PER_PAGE;
+        }
+        FlashLog_StartPage(next_page, head_generation + 1, next_seq);
+    }
+
+    seq = next_seq;
+    rec.seq = seq;
+    memcpy(rec.payload, payload, FLASHLOG_PAYLOAD_SIZE);
+    rec.crc = CRC32_Update(CRC32_INIT, &rec, 4 + FLASHLOG_PAYLOAD_SIZE);
+
+    FlashProgram((uint32_t *)&rec, FLASHLOG_SLOT_ADDR(head_page, head_used + 1),
+                 sizeof(rec));
+
+    head_used++;
+    next_seq++;
+    return seq;
+}
+
+uint32_t FlashLog_FirstSeq(void)
+{
+    return first_seq;
+}
+
+uint32_t FlashLog_NextSeq(void)
+{
+    return next_seq;
+}
+
+bool FlashLog_Read(uint32_t seq, void *payload)
+{
+    const FlashLogRecord *rec;
+    uint32_t offset;
+    uint8_t page;
+
+    if (seq < first_seq || seq >= next_seq)
+        return false;
+
+    offset = seq - first_seq;
+    page = (uint8_t)((tail_page + offset / FLASHLOG_RECORDS_PER_PAGE) % FLASHLOG_PAGES);
+    rec = FlashLog_Slot(page, (offset % FLASHLOG_RECORDS_PER_PAGE) + 1);
+
+    if (rec->seq != seq ||
+        rec->crc != CRC32_Update(CRC32_INIT, rec, 4 + FLASHLOG_PAYLOAD_SIZE))
+        return false;
+
+    memcpy(payload, rec->payload, FLASHLOG_PAYLOAD_SIZE);
+    return true;
+}
+
+uint32_t FlashLog_ReadRange(uint32_t from_seq, void *payloads, uint32_t max_count)
+{
+    uint8_t *out = (uint8_t *)payloads;
+    uint32_t n = 0;
+
+    if (from_seq < first_seq)
+        from_seq = first_seq;
+
+    while (n < max_count && from_seq < next_seq)
+    {
+        if (!FlashLog_Read(from_seq, out))
+            memset(out, 0, FLASHLOG_PAYLOAD_SIZE);
+        out += FLASHLOG_PAYLOAD_SIZE;
+        from_seq++;
+        n++;
+    }
+    return n;
+}
@@ -0,0 +1,96 @@
+/******************************************************************************
+ * File: flashlog.h
+ * Module: Flash Append-Only Store
+ * Description: Append-only record store in the top pages of internal flash.
+ *              Records carry a sequence number and CRC; the oldest page is
+ *              erased when the newest one fills.
+ *
+ * Flash layout (FLASHLOG_PAGES x 1 KB erase blocks):
+ *   Slot 0 of each page : FlashLogPageHeader
+ *   Slots 1..63         : FlashLogRecord, consecutive sequence numbers
+ ******************************************************************************/
+
+#ifndef FLASHLOG_H_
+#define FLASHLOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Top 16 KB of the 256 KB flash; must stay clear of the application image */
+#define FLASHLOG_BASE             0x0003C000u
+
+/* Address at which flash is read: 0 on the chip. The host build (host/)
+ * points it at its simulated flash array */
+#ifndef FLASH_MEMORY_BASE
+#define FLASH_MEMORY_BASE         0u
+#endif
+#define FLASHLOG_PAGES            16u
+#define FLASHLOG_PAGE_SIZE        1024u
+#define FLASHLOG_PAYLOAD_SIZE     8u
+
+#define FLASHLOG_RECORD_SIZE      16u
+#define FLASHLOG_RECORDS_PER_PAGE ((FLASHLOG_PAGE_SIZE / FLASHLOG_RECORD_SIZE) - 1u)
+
+#define FLASHLOG_PAGE_MAGIC       0x474F4C46u  /* "FLOG" */
+
+typedef struct
+{
+    uint32_t magic;       /* FLASHLOG_PAGE_MAGIC */
+    uint32_t generation;  /* Increments on every page rotation */
+    uint32_t first_seq;   /* Sequence number of slot 1 */
+    uint32_t crc;         /* CRC-32 of the three words above */
+} FlashLogPageHeader;
+
+typedef struct
+{
+    uint32_t seq;
+    uint8_t payload[FLASHLOG_PAYLOAD_SIZE];
+    uint32_t crc;         /* CRC-32 of seq + payload */
+} FlashLogRecord;
+
+/******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+/*
+ * FlashLog_Init
+ * Rebuilds the RAM head/tail index from the page headers (16 header reads
+ * plus a binary search of the newest page). Formats the region if empty.
+ */
+void FlashLog_Init(void);
+
+/*
+ * FlashLog_Append
+ * Programs one record; rotates to the oldest page (erasing it) when the
+ * current page is full. Returns the sequence number assigned.
+ */
+uint32_t FlashLog_Append(const void *payload);
+
+/*
+ * FlashLog_FirstSeq / FlashLog_NextSeq
+ * Oldest retained sequence number, and the number the next append will get.
+ * The store holds NextSeq - FirstSeq records.
+ */
+uint32_t FlashLog_FirstSeq(void);
+uint32_t FlashLog_NextSeq(void);
+
+/*
+ * FlashLog_Read
+ * Copies the payload of record seq in O(1). Returns false if seq is not
+ * retained or the record fails its CRC (e.g. torn by a power loss).
+ */
+bool FlashLog_Read(uint32_t seq, void *payload);
+
+/*
+ * FlashLog_ReadRange
+ * Copies up to max_count payloads starting at from_seq into payloads
+ * (FLASHLOG_PAYLOAD_SIZE bytes each); corrupt records are zero-filled.
+ * Returns the number of records copied.
+ */
+uint32_t FlashLog_ReadRange(uint32_t from_seq, void *payloads, uint32_t max_count);
+
+#endif /* FLASHLOG_H_ */
@@ -0,0 +1,75 @@
+/******************************************************************************
+ * File: fmt.c
+ * Module: Formatting
+ ******************************************************************************/
+
+#include "fmt.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+static const char hex_digits[] = "0123456789ABCDEF";
+
+void Fmt_Init(FmtBuf *f, char *buf, uint8_t size)
+{
+    f->buf = buf;
+    f->size = size;
+    f->len = 0;
+    buf[0] = '\0';
+}
+
+void Fmt_Char(FmtBuf *f, char c)
+{
+    if (f->len + 1 >= f->size)
+        return;     /* Full: truncate */
+    f->buf[f->len++] = c;
+    f->buf[f->len] = '\0';
+}
+
+void Fmt_Str(FmtBuf *f, const char *str)
+{
+    while (*str != '\0' && f->len + 1 < f->size)
+        f->buf[f->len++] = *str++;
+    f->buf[f->len] = '\0';
+}
+
+void Fmt_StrPad(FmtBuf *f, const char *str, uint8_t width)
+{
+    uint8_t start = f->len;
+
+    Fmt_Str(f, str);
+    while ((uint8_t)(f->len - start) < width && f->len + 1 < f->size)
+        f->buf[f->len++] = ' ';
+    f->buf[f->len] = '\0';
+}
+
+void Fmt_DecField(FmtBuf *f, uint32_t value, uint8_t width, char pad)
+{
+    char digits[FMT_U32_DIGITS];
+    uint8_t n = 0;
+
+    /* Digits come out lowest first; emit them reversed */
+    do
+    {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+
+    while (width > n)
+    {
+        Fmt_Char(f, pad);
+        width--;
+    }
+    while (n > 0)
+        Fmt_Char(f, digits[--n]);
+}
+
+void Fmt_Hex(FmtBuf *f, uint32_t value, uint8_t digits)
+{
+    if (digits > 8)
+        digits = 8;
+    while (digits > 0)
+    {
+        digits--;
+        Fmt_Char(f, hex_digits[(value >> (4 * digits)) & 0xF]);
+    }
+}
@@ -0,0 +1,96 @@
+/******************************************************************************
+ * File: fmt.h
+ * Module: Formatting
+ * Description: Allocation-free text formatting for LCD lines and protocol
+ *              fields, in place of sprintf/snprintf (which pull in the full
+ *              libc formatter and parse the format string on every call).
+ *
+ * Output is built left to right into a caller-owned buffer through a FmtBuf
+ * cursor. Every call truncates at the buffer size and keeps the text
+ * NUL-terminated, like snprintf. The common shapes are inline wrappers
+ * around one decimal routine, so a constant width and pad fold away at
+ * compile time.
+ *
+ *   FmtBuf f;
+ *   Fmt_Init(&f, line, sizeof(line));
+ *   Fmt_Str(&f, "Wait ");
+ *   Fmt_DecPad(&f, left, 2, ' ');      // "%2lu"
+ *   Fmt_Str(&f, "s...");
+ ******************************************************************************/
+
+#ifndef FMT_H_
+#define FMT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#define FMT_U32_DIGITS 10   /* Longest uint32_t in decimal */
+
+typedef struct
+{
+    char *buf;
+    uint8_t size;           /* Including the NUL */
+    uint8_t len;
+} FmtBuf;
+
+/******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+/*
+ * Fmt_Init
+ * Starts an empty string in buf (size bytes including the NUL, at least 1).
+ */
+void Fmt_Init(FmtBuf *f, char *buf, uint8_t size);
+
+void Fmt_Char(FmtBuf *f, char c);
+void Fmt_Str(FmtBuf *f, const char *str);
+
+/*
+ * Fmt_StrPad
+ * str left-aligned in a field of width characters ("%-8s").
+ */
+void Fmt_StrPad(FmtBuf *f, const char *str, uint8_t width);
+
+/*
+ * Fmt_DecField
+ * value in decimal, right-aligned in a field of at least width characters
+ * filled with pad (' ' or '0'). Called through the wrappers below.
+ */
+void Fmt_DecField(FmtBuf *f, uint32_t value, uint8_t width, char pad);
+
+/*
+ * Fmt_Hex
+ * value as exactly digits upper-case hex digits (the low ones), zero padded.
+ */
+void Fmt_Hex(FmtBuf *f, uint32_t value, uint8_t digits);
+
+/* "%lu" */
+static inline void Fmt_Dec(FmtBuf *f, uint32_t value)
+{
+    Fmt_DecField(f, value, 0, ' ');
+}
+
+/* "%*lu" / "%0*lu" */
+static inline void Fmt_DecPad(FmtBuf *f, uint32_t value, uint8_t width, char pad)
+{
+    Fmt_DecField(f, value, width, pad);
+}
+
+/*
+ * Fmt_U32
+ * Writes value in decimal to out (at least FMT_U32_DIGITS + 1 bytes) and
+ * returns the length.
+ */
+static inline uint8_t Fmt_U32(char *out, uint32_t value)
+{
+    FmtBuf f;
+    Fmt_Init(&f, out, FMT_U32_DIGITS + 1);
+    Fmt_Dec(&f, value);
+    return f.len;
+}
+
+#endif /* FMT_H_ */
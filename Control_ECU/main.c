@@ -1,203 +1,100 @@
 /******************************************************************************
  * File: main.c (Control_ECU)
- * Description: Logic for PWD, CHK, SET, ALM, TMO
+ * Description: Startup and the main loop; lines are assembled in bus.c and
+ *              handled in command.c
  ******************************************************************************/
 
 #include <stdint.h>
 #include <stdbool.h>
-#include <string.h>
-#include <stdlib.h> // For atoi
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
 #include "driverlib/sysctl.h"
+#include "boottime.h"
+#include "bus.h"
 #include "buzzer.h"
+#include "command.h"
 #include "eeprom.h"
+#include "eventlog.h"
 #include "motor.h"
+#include "profile.h"
+#include "rtc.h"
+#include "schedule.h"
+#include "stats.h"
+#include "totp.h"
 #include "systick.h"
-#include "uart.h"
-
-
-#define PASSWORD_LENGTH 5
-#define BUFFER_SIZE 32
+#include "transport.h"
+#include "wait.h"
 
 /******************************************************************************
  * Function Prototypes
  ******************************************************************************/
-bool ValidatePassword(const char *received_password);
-void SavePassword(const char *received_password);
-void ProcessCommand(const char *buffer);
-void ExtractData(const char *buffer, char *data);
 void FlushUARTBuffer(void);
+static void EnablePeripherals(void);
 
 /******************************************************************************
  * Main Function
  ******************************************************************************/
 int main(void)
 {
-    char receivedChar;
-    char buffer[BUFFER_SIZE];
-    uint8_t bufferIndex = 0;
-
     SysCtlClockSet(SYSCTL_SYSDIV_1 | SYSCTL_USE_OSC |
                    SYSCTL_XTAL_16MHZ | SYSCTL_OSC_MAIN);
 
-    SysTick_Init(16000, SYSTICK_NOINT);
-    UART2_Init();
+    SysTick_Init(16000, SYSTICK_INT);
+    BootTime_Mark(BOOT_CLOCK);
+    Profile_Init(); // PROFILE builds: sample from here on
+    Wait_Init();    // Watchdog from here on: init must not stall WATCHDOG_MS
+
+    EnablePeripherals();
+    Transport_Init();
+    BootTime_Mark(BOOT_UART);
     EEPROM_Init();
+    RTC_Init();
+    Schedule_Init();
+    Totp_Init();
+    BootTime_Mark(BOOT_EEPROM);
     enable_motor();
     enable_buzzer();
+    BootTime_Mark(BOOT_ACTUATORS);
+    EventLog_Init();
+    BootTime_Mark(BOOT_EVENTLOG);
 
-    memset(buffer, 0, BUFFER_SIZE);
-    FlushUARTBuffer();
+    FlushUARTBuffer(); // Requests that arrived during init are answered by RDY
 
-    while (1)
-    {
-        if (UART2_IsDataAvailable())
-        {
-            receivedChar = UART2_ReceiveChar();
-            if (bufferIndex < (BUFFER_SIZE - 1))
-            {
-                buffer[bufferIndex++] = receivedChar;
-                buffer[bufferIndex] = '\0';
-                if (receivedChar == '\n' || receivedChar == '\r')
-                {
-                    ProcessCommand(buffer);
-                    bufferIndex = 0;
-                    memset(buffer, 0, BUFFER_SIZE);
-                }
-            }
-            else
-            {
-                bufferIndex = 0;
-                memset(buffer, 0, BUFFER_SIZE);
-            }
-        }
-    }
-}
+    /* Tell the HMI we are serving requests instead of letting it retry */
+    SendReadyFrame();
+    BootTime_Mark(BOOT_READY);
 
-/******************************************************************************
- * ProcessCommand
- * Protocol:
- * "STS"        -> '1' (Exists) / '0' (Empty)
- * "SET:xxxxx"  -> Save Pass
- * "CHK:xxxxx"  -> Verify Only
- * "PWD:xxxxx"  -> Verify + Motor (No Alarm on fail)
- * "ALM"        -> Trigger Buzzer
- * "TMO:xx"     -> Save Timeout
- ******************************************************************************/
-void ProcessCommand(const char *buffer)
-{
-    char extracted_data[BUFFER_SIZE];
-    ExtractData(buffer, extracted_data);
-
-    /* STS: Status */
-    if (strstr(buffer, "STS") != NULL)
-    {
-        if (EEPROM_IsPasswordSet())
-            UART2_SendChar('1');
-        else
-            UART2_SendChar('0');
-    }
-    /* SET: Save Password */
-    else if (strstr(buffer, "SET:") != NULL)
-    {
-        SavePassword(extracted_data);
-        UART2_SendChar('1');
-    }
-    /* CHK: Verify Only */
-    else if (strstr(buffer, "CHK:") != NULL)
-    {
-        if (ValidatePassword(extracted_data))
-            UART2_SendChar('1');
-        else
-            UART2_SendChar('0');
-    }
-    /* PWD: Open Door (Wait for motor logic) */
-    else if (strstr(buffer, "PWD:") != NULL)
-    {
-        if (ValidatePassword(extracted_data))
-        {
-            UART2_SendChar('1'); // Send ACK first
-            DelayMs(50);
-            motor_sequence(); // Run motor with stored timeout
-        }
-        else
-        {
-            UART2_SendChar('0'); // Just return Fail, HMI handles retry/alarm
-        }
-    }
-    /* ALM: Alarm (Triggered by HMI) */
-    else if (strstr(buffer, "ALM") != NULL)
-    {
-        alarm(); // Buzzer beep 3 times
-    }
-    /* TMO: Set Timeout */
-    else if (strstr(buffer, "TMO:") != NULL)
+    while (1)
     {
-        // Convert extracted data (e.g. "25") to integer
-        int t = atoi(extracted_data);
-        if (t >= 5 && t <= 30)
-        {
-            EEPROM_WriteTimeout((uint8_t)t);
-            UART2_SendChar('1');
-        }
-        else
-        {
-            UART2_SendChar('0');
-        }
+        Wait_Kick();
+        EventLog_Service();
+        Stats_RecordUartErrors(Transport_TakeRxErrors());
+        motor_service(); // Door cycles run alongside the command loop
+        Bus_Service();   // Line assembly / multidrop polling
     }
 }
 
 /******************************************************************************
  * Helper Functions
  ******************************************************************************/
-void ExtractData(const char *buffer, char *data)
-{
-    uint8_t i, data_index = 0;
-    bool found_colon = false;
-    for (i = 0; i < BUFFER_SIZE && buffer[i] != '\0'; i++)
-    {
-        if (found_colon)
-        {
-            // Allow Digits for Password/Timeout
-            if ((buffer[i] >= '0' && buffer[i] <= '9'))
-            {
-                data[data_index++] = buffer[i];
-            }
-        }
-        if (buffer[i] == ':')
-            found_colon = true;
-    }
-    data[data_index] = '\0';
-}
-
-void SavePassword(const char *received_password)
-{
-    uint8_t pwd_bytes[8];
-    uint8_t i;
-    for (i = 0; i < PASSWORD_LENGTH; i++)
-        pwd_bytes[i] = received_password[i];
-    EEPROM_WritePassword(pwd_bytes);
-    EEPROM_MarkPasswordSet();
-}
-
-bool ValidatePassword(const char *received_password)
+/*
+ * EnablePeripherals
+ * Turns on every peripheral clock at once so their ready waits overlap;
+ * each driver's own enable/ready check then returns immediately.
+ */
+static void EnablePeripherals(void)
 {
-    uint8_t stored_password[8];
-    uint8_t i;
-    if (strlen(received_password) != PASSWORD_LENGTH)
-        return false;
-    EEPROM_ReadPassword(stored_password);
-    for (i = 0; i < PASSWORD_LENGTH; i++)
-    {
-        if (received_password[i] != stored_password[i])
-            return false;
-    }
-    return true;
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UART2);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOD);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOE);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_EEPROM0);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_HIBERNATE);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER1);
 }
 
 void FlushUARTBuffer(void)
 {
-    while (UART2_IsDataAvailable())
-        UART2_ReceiveChar();
+    while (Transport_IsDataAvailable())
+        Transport_ReceiveChar();
 }
\ No newline at end of file
@@ -1,109 +1,208 @@
 /******************************************************************************
  * File: motor.c (Control_ECU)
- * Description: Motor Control with EEPROM Timeout using GPTM Timers
+ * Description: Lock motor channels. Every door runs its own non-blocking
+ *              unlock -> hold -> lock state machine off the SysTick time
+ *              base, so cycles on different doors overlap.
  ******************************************************************************/
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/gpio.h"
-#include "driverlib/timer.h"
 #include "motor.h"
 #include "eeprom.h"
+#include "stats.h"
+#include "systick.h"
+
+#if MOTOR_DOOR_COUNT > TIMEOUT_SLOTS
+#error "No EEPROM timeout slot for every door"
+#endif
 
 //
-// Function to initialize GPTM Timer for delays
+// Channel wiring. IN1 high unlocks, IN2 high locks. The door sensor (a
+// switch to ground, closed when the door is shut) is optional: with
+// sensor_port 0 the bolt is thrown as soon as the hold time is over.
+// Neither door below has one yet.
 //
-static void motor_timer_init(void)
+typedef struct
 {
-    // Enable Timer0 peripheral
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER0);
-    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_TIMER0))
-    {
-    }
+    uint32_t periph;        // GPIO peripheral of the motor pins
+    uint32_t port;
+    uint8_t in1;
+    uint8_t in2;
+    uint32_t sensor_periph;
+    uint32_t sensor_port;   // 0 = no door sensor
+    uint8_t sensor_pin;
+} MotorChannel;
+
+static const MotorChannel channels[MOTOR_DOOR_COUNT] = {
+    // Door 0: PD0/PD1 (the original single-door wiring)
+    { SYSCTL_PERIPH_GPIOD, GPIO_PORTD_BASE, GPIO_PIN_0, GPIO_PIN_1, 0, 0, 0 },
+    // Door 1: PE1/PE2
+    { SYSCTL_PERIPH_GPIOE, GPIO_PORTE_BASE, GPIO_PIN_1, GPIO_PIN_2, 0, 0, 0 },
+};
+
+typedef struct
+{
+    MotorState state;
+    uint32_t since_ms;      // Entry time of the current state
+    uint32_t hold_ms;
+    bool reopen;            // Open requested while locking
+} MotorDoor;
 
-    // Configure Timer0A as one-shot; we reload each second
-    TimerConfigure(TIMER0_BASE, TIMER_CFG_A_ONE_SHOT);
-}
+static MotorDoor doors[MOTOR_DOOR_COUNT];
 
 //
-// Function to delay using GPTM Timer (in seconds)
+// Drive one channel: IN1 only (unlock), IN2 only (lock) or neither (stop)
 //
-static void motor_delay_seconds(uint8_t seconds)
+static void motor_drive(const MotorChannel *ch, uint8_t pins)
 {
-    uint8_t i;
-    for (i = 0; i < seconds; i++)
-    {
-        // Load 1s interval and clear any stale flag before starting
-        TimerLoadSet(TIMER0_BASE, TIMER_A, SysCtlClockGet() - 1);
-        TimerIntClear(TIMER0_BASE, TIMER_TIMA_TIMEOUT);
+    GPIOPinWrite(ch->port, ch->in1 | ch->in2, pins);
+}
 
-        // Enable the timer
-        TimerEnable(TIMER0_BASE, TIMER_A);
+static bool door_closed(const MotorChannel *ch)
+{
+    if (ch->sensor_port == 0)
+        return true;
+    return GPIOPinRead(ch->sensor_port, ch->sensor_pin) == 0;
+}
 
-        // Wait for timeout flag
-        while (!(TimerIntStatus(TIMER0_BASE, false) & TIMER_TIMA_TIMEOUT))
-        {
-        }
+static void enter_state(MotorDoor *door, MotorState state)
+{
+    door->state = state;
+    door->since_ms = SysTick_GetMs();
+}
 
-        // Clear flag and stop timer
-        TimerIntClear(TIMER0_BASE, TIMER_TIMA_TIMEOUT);
-        TimerDisable(TIMER0_BASE, TIMER_A);
-    }
+static void start_unlock(uint8_t id)
+{
+    doors[id].hold_ms = (uint32_t)EEPROM_ReadTimeout(id) * 1000u;
+    doors[id].reopen = false;
+    Stats_Increment(STAT_MOTOR_CYCLES);
+
+    motor_drive(&channels[id], channels[id].in1);
+    enter_state(&doors[id], MOTOR_UNLOCKING);
 }
 
 //
-// Function to enable and configure the motor
+// Function to enable and configure the motor channels
 //
 void enable_motor(void)
 {
-    // Enable GPIO Port D (Motor)
-    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOD);
+    const MotorChannel *ch;
+    uint8_t i;
 
-    // Wait for the GPIO module to be ready
-    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOD))
+    for (i = 0; i < MOTOR_DOOR_COUNT; i++)
     {
-    }
+        ch = &channels[i];
 
-    // Configure PD0 (IN1) and PD1 (IN2) as outputs for the motor
-    GPIOPinTypeGPIOOutput(GPIO_PORTD_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+        SysCtlPeripheralEnable(ch->periph);
+        while (!SysCtlPeripheralReady(ch->periph))
+        {
+        }
 
-    // Increase drive strength
-    GPIOPadConfigSet(GPIO_PORTD_BASE, GPIO_PIN_0 | GPIO_PIN_1, GPIO_STRENGTH_8MA_SC, GPIO_PIN_TYPE_STD);
+        // Outputs with increased drive strength, motor stopped
+        GPIOPinTypeGPIOOutput(ch->port, ch->in1 | ch->in2);
+        GPIOPadConfigSet(ch->port, ch->in1 | ch->in2, GPIO_STRENGTH_8MA_SC, GPIO_PIN_TYPE_STD);
+        motor_drive(ch, 0);
 
-    // Initialize Motor: Stopped (IN1=0, IN2=0)
-    GPIOPinWrite(GPIO_PORTD_BASE, GPIO_PIN_0 | GPIO_PIN_1, 0);
+        if (ch->sensor_port != 0)
+        {
+            SysCtlPeripheralEnable(ch->sensor_periph);
+            while (!SysCtlPeripheralReady(ch->sensor_periph))
+            {
+            }
+            GPIOPinTypeGPIOInput(ch->sensor_port, ch->sensor_pin);
+            GPIOPadConfigSet(ch->sensor_port, ch->sensor_pin, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPU);
+        }
 
-    // Initialize GPTM Timer for motor delays
-    motor_timer_init();
+        doors[i].state = MOTOR_LOCKED;
+        doors[i].reopen = false;
+    }
 }
 
-//
-// Motor sequence: Turn right -> Wait (Variable Timeout) -> Turn left
-//
-void motor_sequence(void)
+bool motor_open(uint8_t id)
 {
-    // Read timeout from EEPROM (Returns 5-30, or 10 default)
-    uint8_t delay_seconds = EEPROM_ReadTimeout();
+    MotorDoor *door;
 
-    // 1. Turn Right (Unlocking)
-    // PD0=1, PD1=0
-    GPIOPinWrite(GPIO_PORTD_BASE, GPIO_PIN_0 | GPIO_PIN_1, GPIO_PIN_0);
-    motor_delay_seconds(1); // 1 second delay using GPTM
+    if (id >= MOTOR_DOOR_COUNT)
+        return false;
+    door = &doors[id];
 
-    // 2. Stop motor and wait for configured timeout
-    GPIOPinWrite(GPIO_PORTD_BASE, GPIO_PIN_0 | GPIO_PIN_1, 0);
+    switch (door->state)
+    {
+    case MOTOR_LOCKED:
+        start_unlock(id);
+        break;
+    case MOTOR_UNLOCKING:
+        break;                      // Hold starts once unlocked
+    case MOTOR_OPEN:
+    case MOTOR_WAIT_CLOSED:
+        door->hold_ms = (uint32_t)EEPROM_ReadTimeout(id) * 1000u;
+        enter_state(door, MOTOR_OPEN);  // Restart the hold
+        break;
+    case MOTOR_LOCKING:
+        door->reopen = true;
+        break;
+    }
+    return true;
+}
+
+//
+// Sequence per door: Turn right (unlock) -> Wait (door timeout, then door
+// closed) -> Turn left (lock)
+//
+void motor_service(void)
+{
+    const MotorChannel *ch;
+    MotorDoor *door;
+    uint32_t elapsed;
+    uint8_t i;
 
-    // Wait for configured timeout using GPTM timer
-    motor_delay_seconds(delay_seconds);
+    for (i = 0; i < MOTOR_DOOR_COUNT; i++)
+    {
+        ch = &channels[i];
+        door = &doors[i];
+        elapsed = SysTick_GetMs() - door->since_ms;
 
-    // 3. Turn Left (Locking)
-    // PD0=0, PD1=1
-    GPIOPinWrite(GPIO_PORTD_BASE, GPIO_PIN_0 | GPIO_PIN_1, GPIO_PIN_1);
-    motor_delay_seconds(1); // 1 second delay using GPTM
+        switch (door->state)
+        {
+        case MOTOR_LOCKED:
+            break;
+        case MOTOR_UNLOCKING:
+            if (elapsed >= MOTOR_DRIVE_MS)
+            {
+                motor_drive(ch, 0);
+                enter_state(door, MOTOR_OPEN);
+            }
+            break;
+        case MOTOR_OPEN:
+            if (elapsed >= door->hold_ms)
+                enter_state(door, MOTOR_WAIT_CLOSED);
+            break;
+        case MOTOR_WAIT_CLOSED:
+            if (door_closed(ch))
+            {
+                motor_drive(ch, ch->in2);
+                enter_state(door, MOTOR_LOCKING);
+            }
+            break;
+        case MOTOR_LOCKING:
+            if (elapsed >= MOTOR_DRIVE_MS)
+            {
+                motor_drive(ch, 0);
+                enter_state(door, MOTOR_LOCKED);
+                if (door->reopen)
+                    start_unlock(i);
+            }
+            break;
+        }
+    }
+}
 
-    // 4. Stop motor
-    GPIOPinWrite(GPIO_PORTD_BASE, GPIO_PIN_0 | GPIO_PIN_1, 0);
-}
\ No newline at end of file
+MotorState motor_state(uint8_t id)
+{
+    return (id < MOTOR_DOOR_COUNT) ? doors[id].state : MOTOR_LOCKED;
+}
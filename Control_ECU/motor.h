@@ -1,7 +1,36 @@
 #ifndef MOTOR_H
 #define MOTOR_H
 
+#include <stdint.h>
+#include <stdbool.h>
+
+// Lock channels on this board (see the channel table in motor.c). Each has
+// its own H-bridge inputs, hold timeout (EEPROM) and optional door sensor.
+// No door on this board has a sensor wired, so MOTOR_WAIT_CLOSED is never
+// entered here and has not been tested on hardware or in the simulator.
+#define MOTOR_DOOR_COUNT 2
+
+#define MOTOR_DRIVE_MS 1000 // Bolt travel time, each direction
+
+typedef enum
+{
+    MOTOR_LOCKED,       // Idle, bolt thrown
+    MOTOR_UNLOCKING,
+    MOTOR_OPEN,         // Unlocked, hold timeout running
+    MOTOR_WAIT_CLOSED,  // Hold over, waiting for the door sensor
+    MOTOR_LOCKING
+} MotorState;
+
 void enable_motor(void);
-void motor_sequence(void);
+
+// Starts the unlock -> hold -> lock cycle on door, or extends the hold if it
+// is already open. A door that is locking reopens once the bolt is home.
+// Returns false for an unknown door. Never blocks.
+bool motor_open(uint8_t door);
+
+// Advances every door's cycle; call continuously from the main loop
+void motor_service(void);
+
+MotorState motor_state(uint8_t door);
 
 #endif // MOTOR_H
@@ -0,0 +1,161 @@
+/******************************************************************************
+ * File: profile.c
+ * Module: PC-Sampling Profiler
+ * Description: Timer3A sampling interrupt and histogram export
+ ******************************************************************************/
+
+#include "profile.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+
+#if PROFILE
+static uint16_t counts[PROFILE_BUCKETS];
+#endif
+static volatile uint32_t samples = 0;
+static volatile uint32_t outside = 0;
+
+/* Called from the assembly stub below only */
+void Profile_Sample(const uint32_t *frame);
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+/*
+ * Profile_Sample
+ * frame is the exception frame of the interrupted code: r0-r3, r12, lr,
+ * pc, xpsr. Counts its pc.
+ */
+void Profile_Sample(const uint32_t *frame)
+{
+    uint32_t offset = frame[6] - PROFILE_BASE;
+
+    TimerIntClear(TIMER3_BASE, TIMER_TIMA_TIMEOUT);
+
+    samples++;
+    if (offset >= PROFILE_SPAN)
+    {
+        outside++;
+        return;
+    }
+#if PROFILE
+    if (counts[offset >> PROFILE_SHIFT] != 0xFFFF)
+        counts[offset >> PROFILE_SHIFT]++;
+#endif
+}
+
+/*
+ * Profile_TimerISR
+ * Stackless, so the frame is still on top of whichever stack was in use
+ * (EXC_RETURN bit 2 says which). Passes it on in r0; Profile_Sample
+ * returns straight from the exception.
+ */
+static __stackless void Profile_TimerISR(void)
+{
+    __asm("TST   LR, #4");
+    __asm("ITE   EQ");
+    __asm("MRSEQ R0, MSP");
+    __asm("MRSNE R0, PSP");
+    __asm("B     Profile_Sample");
+}
+
+static uint8_t SendByte(void (*put)(char), uint8_t value, uint8_t sum)
+{
+    put((char)value);
+    return (uint8_t)(sum + value);
+}
+
+static uint8_t SendU16(void (*put)(char), uint16_t value, uint8_t sum)
+{
+    sum = SendByte(put, (uint8_t)value, sum);
+    return SendByte(put, (uint8_t)(value >> 8), sum);
+}
+
+static uint8_t SendU32(void (*put)(char), uint32_t value, uint8_t sum)
+{
+    sum = SendU16(put, (uint16_t)value, sum);
+    return SendU16(put, (uint16_t)(value >> 16), sum);
+}
+
+/******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+
+void Profile_Init(void)
+{
+    if (!PROFILE)
+        return;
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER3);
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_TIMER3))
+        ;
+    TimerConfigure(TIMER3_BASE, TIMER_CFG_PERIODIC);
+    TimerLoadSet(TIMER3_BASE, TIMER_A, SysCtlClockGet() / PROFILE_HZ - 1);
+    TimerIntRegister(TIMER3_BASE, TIMER_A, Profile_TimerISR);
+    IntPrioritySet(INT_TIMER3A, 0);     // Also samples lower-priority ISRs
+    TimerIntEnable(TIMER3_BASE, TIMER_TIMA_TIMEOUT);
+    TimerEnable(TIMER3_BASE, TIMER_A);
+}
+
+void Profile_Reset(void)
+{
+    if (PROFILE)
+        TimerIntDisable(TIMER3_BASE, TIMER_TIMA_TIMEOUT);
+#if PROFILE
+    memset(counts, 0, sizeof(counts));
+#endif
+    samples = 0;
+    outside = 0;
+    if (PROFILE)
+        TimerIntEnable(TIMER3_BASE, TIMER_TIMA_TIMEOUT);
+}
+
+void Profile_Export(void (*put)(char))
+{
+    uint8_t sum = 0;
+    uint16_t entries = 0;
+#if PROFILE
+    uint16_t i;
+#endif
+
+    // Paused, so the export neither changes under us nor shows up in it
+    if (PROFILE)
+        TimerIntDisable(TIMER3_BASE, TIMER_TIMA_TIMEOUT);
+
+#if PROFILE
+    for (i = 0; i < PROFILE_BUCKETS; i++)
+    {
+        if (counts[i] != 0)
+            entries++;
+    }
+#endif
+
+    sum = SendU16(put, (uint16_t)(20 + 4 * entries), sum);
+    sum = SendByte(put, PROFILE_VERSION, sum);
+    sum = SendByte(put, PROFILE_SHIFT, sum);
+    sum = SendU32(put, PROFILE_BASE, sum);
+    sum = SendU32(put, PROFILE ? PROFILE_HZ : 0, sum);
+    sum = SendU32(put, samples, sum);
+    sum = SendU32(put, outside, sum);
+    sum = SendU16(put, entries, sum);
+
+#if PROFILE
+    for (i = 0; i < PROFILE_BUCKETS; i++)
+    {
+        if (counts[i] == 0)
+            continue;
+        sum = SendU16(put, i, sum);
+        sum = SendU16(put, counts[i], sum);
+    }
+#endif
+    put((char)sum);
+
+    if (PROFILE)
+        TimerIntEnable(TIMER3_BASE, TIMER_TIMA_TIMEOUT);
+}
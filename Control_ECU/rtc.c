@@ -0,0 +1,62 @@
+/******************************************************************************
+ * File: rtc.c
+ * Module: Real-Time Clock (Hibernation module)
+ ******************************************************************************/
+
+#include "rtc.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* TivaWare includes */
+#include "inc/hw_memmap.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/hibernate.h"
+
+#define SECONDS_PER_DAY 86400UL
+#define RTC_SET_MARKER  0x434C4B31UL    /* "CLK1" in hibernation memory word 0 */
+#define EPOCH_WEEKDAY   3               /* 1970-01-01 was a Thursday */
+
+void RTC_Init(void)
+{
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_HIBERNATE);
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_HIBERNATE))
+        ;
+
+    /* Already running from before the reset: leave the count alone */
+    if (HibernateIsActive())
+        return;
+
+    HibernateEnableExpClk(SysCtlClockGet());
+    HibernateClockConfig(HIBERNATE_OSC_LOWDRIVE);
+    HibernateRTCEnable();
+}
+
+uint32_t RTC_Get(void)
+{
+    return HibernateRTCGet();
+}
+
+void RTC_Set(uint32_t seconds)
+{
+    uint32_t marker = RTC_SET_MARKER;
+
+    HibernateRTCSet(seconds);
+    HibernateDataSet(&marker, 1);
+}
+
+bool RTC_IsSet(void)
+{
+    uint32_t marker;
+
+    HibernateDataGet(&marker, 1);
+    return marker == RTC_SET_MARKER;
+}
+
+uint16_t RTC_WeekSlot(void)
+{
+    uint32_t now = RTC_Get();   /* One read: day and slot must agree */
+    uint32_t weekday = ((now / SECONDS_PER_DAY) + EPOCH_WEEKDAY) % 7;
+
+    return (uint16_t)(weekday * RTC_SLOTS_PER_DAY +
+                      (now % SECONDS_PER_DAY) / (RTC_SLOT_MINUTES * 60));
+}
@@ -0,0 +1,48 @@
+/******************************************************************************
+ * File: rtc.h
+ * Module: Real-Time Clock (Hibernation module)
+ * Description: Calendar time for access schedules. The Hibernation RTC
+ *              counts seconds on the 32.768 kHz oscillator and keeps
+ *              running across resets while VBAT is powered.
+ *
+ * Time is local wall time in seconds since 1970-01-01 00:00 (set with
+ * "CLK:<seconds>"); there is no time zone or DST handling on the target.
+ ******************************************************************************/
+
+#ifndef RTC_H_
+#define RTC_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#define RTC_SLOT_MINUTES  15
+#define RTC_SLOTS_PER_DAY (24 * 60 / RTC_SLOT_MINUTES)
+#define RTC_SLOTS_PER_WEEK (7 * RTC_SLOTS_PER_DAY)
+
+/******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void RTC_Init(void);
+
+/* Seconds since 1970-01-01 00:00 local time */
+uint32_t RTC_Get(void);
+void RTC_Set(uint32_t seconds);
+
+/*
+ * RTC_IsSet
+ * False until CLK has set the clock since the Hibernation module last lost
+ * power (the marker lives in its battery-backed memory).
+ */
+bool RTC_IsSet(void);
+
+/*
+ * RTC_WeekSlot
+ * Current 15-minute slot of the week: weekday * RTC_SLOTS_PER_DAY + slot of
+ * the day, with Monday 00:00 as slot 0.
+ */
+uint16_t RTC_WeekSlot(void);
+
+#endif /* RTC_H_ */
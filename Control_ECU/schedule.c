@@ -0,0 +1,93 @@
+/******************************************************************************
+ * File: schedule.c (Control_ECU)
+ * Description: Weekly access schedules as quarter-hour bitmaps
+ ******************************************************************************/
+
+#include "schedule.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "eeprom.h"
+#include "motor.h"
+#include "rtc.h"
+
+#if (SCHEDULE_ADDRESS + MOTOR_DOOR_COUNT * SCHEDULE_BYTES) > 0x0800
+#error "Schedules for MOTOR_DOOR_COUNT doors do not fit in the EEPROM"
+#endif
+
+static uint32_t bitmaps[MOTOR_DOOR_COUNT][SCHEDULE_WORDS];
+static bool restricted[MOTOR_DOOR_COUNT];
+
+static bool IsAllOnes(const uint32_t *bitmap)
+{
+    uint8_t i;
+
+    for (i = 0; i < SCHEDULE_WORDS; i++)
+        if (bitmap[i] != 0xFFFFFFFF)
+            return false;
+    return true;
+}
+
+void Schedule_Init(void)
+{
+    uint8_t door;
+
+    for (door = 0; door < MOTOR_DOOR_COUNT; door++)
+    {
+        EEPROM_ReadSchedule(door, bitmaps[door]);
+        restricted[door] = !IsAllOnes(bitmaps[door]);
+    }
+}
+
+bool Schedule_Allows(uint8_t door)
+{
+    uint16_t slot;
+
+    if (door >= MOTOR_DOOR_COUNT || !restricted[door])
+        return true;
+    if (!RTC_IsSet())
+        return false;   // No time to check against: fail closed
+
+    slot = RTC_WeekSlot();
+    return (bitmaps[door][slot >> 5] & (1UL << (slot & 31))) != 0;
+}
+
+bool Schedule_AddWindow(uint8_t door, uint8_t days, uint8_t start_slot, uint8_t end_slot)
+{
+    uint8_t day, slot;
+    uint16_t bit;
+
+    if (door >= MOTOR_DOOR_COUNT || (days & 0x7F) == 0 ||
+        start_slot >= end_slot || end_slot > RTC_SLOTS_PER_DAY)
+        return false;
+
+    if (!restricted[door])
+    {
+        memset(bitmaps[door], 0, sizeof(bitmaps[door]));
+        restricted[door] = true;
+    }
+
+    for (day = 0; day < 7; day++)
+    {
+        if (!(days & (1u << day)))
+            continue;
+        for (slot = start_slot; slot < end_slot; slot++)
+        {
+            bit = (uint16_t)(day * RTC_SLOTS_PER_DAY + slot);
+            bitmaps[door][bit >> 5] |= 1UL << (bit & 31);
+        }
+    }
+
+    EEPROM_WriteSchedule(door, bitmaps[door]);
+    return true;
+}
+
+void Schedule_Clear(uint8_t door)
+{
+    if (door >= MOTOR_DOOR_COUNT)
+        return;
+
+    memset(bitmaps[door], 0xFF, sizeof(bitmaps[door]));
+    restricted[door] = false;
+    EEPROM_WriteSchedule(door, bitmaps[door]);
+}
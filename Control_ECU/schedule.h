@@ -0,0 +1,56 @@
+/******************************************************************************
+ * File: schedule.h (Control_ECU)
+ * Description: Per-door weekly access schedules. Each door has a bitmap of
+ *              the week's 672 quarter-hours (Monday 00:00 first); a set bit
+ *              means PWD may open the door in that slot. Rules are compiled
+ *              into the bitmap when added, so the check at PWD time is a
+ *              single bit test.
+ *
+ * An all-ones bitmap (also the erased EEPROM state) is unrestricted. Adding
+ * the first window to an unrestricted door clears it, so the door is then
+ * open only during the windows added. Until the RTC has been set a door
+ * with a schedule stays shut, since no slot can be checked.
+ ******************************************************************************/
+
+#ifndef SCHEDULE_H_
+#define SCHEDULE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "eeprom.h"
+#include "rtc.h"
+
+#define SCHEDULE_WORDS (SCHEDULE_BYTES / 4)
+
+#if SCHEDULE_BYTES * 8 != RTC_SLOTS_PER_WEEK
+#error "SCHEDULE_BYTES must hold one bit per RTC slot of the week"
+#endif
+
+/*
+ * Schedule_Init
+ * Loads every door's bitmap from EEPROM. Call after EEPROM_Init().
+ */
+void Schedule_Init(void);
+
+/*
+ * Schedule_Allows
+ * True if the door may be opened now.
+ */
+bool Schedule_Allows(uint8_t door);
+
+/*
+ * Schedule_AddWindow
+ * Allows [start_slot, end_slot) on every day set in days (bit 0 = Monday)
+ * and stores the result. Slots are quarter-hours of the day, end_slot up to
+ * RTC_SLOTS_PER_DAY. Returns false (nothing changed) for an empty or
+ * out-of-range window.
+ */
+bool Schedule_AddWindow(uint8_t door, uint8_t days, uint8_t start_slot, uint8_t end_slot);
+
+/*
+ * Schedule_Clear
+ * Removes the door's restrictions.
+ */
+void Schedule_Clear(uint8_t door);
+
+#endif /* SCHEDULE_H_ */
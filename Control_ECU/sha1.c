@@ -0,0 +1,77 @@
+/******************************************************************************
+ * File: sha1.c
+ * Module: SHA-1
+ * Description: Compact SHA-1 block function with a 16-word rolling message
+ *              schedule (64 bytes of stack instead of 320).
+ ******************************************************************************/
+
+#include "sha1.h"
+#include <stdint.h>
+
+#define ROL(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+void SHA1_Init(uint32_t state[SHA1_STATE_WORDS])
+{
+    state[0] = 0x67452301u;
+    state[1] = 0xEFCDAB89u;
+    state[2] = 0x98BADCFEu;
+    state[3] = 0x10325476u;
+    state[4] = 0xC3D2E1F0u;
+}
+
+void SHA1_Compress(uint32_t state[SHA1_STATE_WORDS], const uint8_t block[SHA1_BLOCK_SIZE])
+{
+    uint32_t w[16];
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+    uint32_t f, k, t;
+    uint8_t i;
+
+    for (i = 0; i < 16; i++)
+    {
+        w[i] = ((uint32_t)block[4 * i] << 24) | ((uint32_t)block[4 * i + 1] << 16) |
+               ((uint32_t)block[4 * i + 2] << 8) | block[4 * i + 3];
+    }
+
+    for (i = 0; i < 80; i++)
+    {
+        if (i >= 16)
+        {
+            t = w[(i + 13) & 15] ^ w[(i + 8) & 15] ^ w[(i + 2) & 15] ^ w[i & 15];
+            w[i & 15] = ROL(t, 1);
+        }
+
+        if (i < 20)
+        {
+            f = d ^ (b & (c ^ d));
+            k = 0x5A827999u;
+        }
+        else if (i < 40)
+        {
+            f = b ^ c ^ d;
+            k = 0x6ED9EBA1u;
+        }
+        else if (i < 60)
+        {
+            f = (b & c) | (d & (b | c));
+            k = 0x8F1BBCDCu;
+        }
+        else
+        {
+            f = b ^ c ^ d;
+            k = 0xCA62C1D6u;
+        }
+
+        t = ROL(a, 5) + f + e + k + w[i & 15];
+        e = d;
+        d = c;
+        c = ROL(b, 30);
+        b = a;
+        a = t;
+    }
+
+    state[0] += a;
+    state[1] += b;
+    state[2] += c;
+    state[3] += d;
+    state[4] += e;
+}
@@ -0,0 +1,30 @@
+/******************************************************************************
+ * File: sha1.h
+ * Module: SHA-1
+ * Description: The SHA-1 block function (FIPS 180-4) on its own. Callers
+ *              pad the message themselves; HMAC (totp.c) starts from
+ *              precomputed states and never needs more than one block.
+ ******************************************************************************/
+
+#ifndef SHA1_H_
+#define SHA1_H_
+
+#include <stdint.h>
+
+#define SHA1_BLOCK_SIZE  64
+#define SHA1_DIGEST_SIZE 20
+#define SHA1_STATE_WORDS 5
+
+/*
+ * SHA1_Init
+ * Loads the initial hash value.
+ */
+void SHA1_Init(uint32_t state[SHA1_STATE_WORDS]);
+
+/*
+ * SHA1_Compress
+ * Folds one 64-byte block (big-endian words) into state.
+ */
+void SHA1_Compress(uint32_t state[SHA1_STATE_WORDS], const uint8_t block[SHA1_BLOCK_SIZE]);
+
+#endif /* SHA1_H_ */
@@ -0,0 +1,122 @@
+/******************************************************************************
+ * File: stats.c (Control_ECU)
+ * Description: Runtime counters and per-command service-time histograms
+ ******************************************************************************/
+
+#include "stats.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/hw_memmap.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/uart.h"
+#include "systick.h"
+#include "transport.h"
+#include "wait.h"
+
+#define STATS_PAYLOAD_SIZE (4 + 4 + STAT_COUNTER_COUNT * 4 + \
+                            STAT_OP_COUNT * (4 + STATS_BUCKETS * 2))
+
+static uint32_t counters[STAT_COUNTER_COUNT];
+static uint32_t op_count[STAT_OP_COUNT];
+static uint16_t op_hist[STAT_OP_COUNT][STATS_BUCKETS];
+
+/******************************************************************************
+ * Private Helpers
+ ******************************************************************************/
+
+static uint8_t SendByte(uint8_t value, uint8_t sum)
+{
+    Transport_SendChar((char)value);
+    return (uint8_t)(sum + value);
+}
+
+static uint8_t SendU16(uint16_t value, uint8_t sum)
+{
+    sum = SendByte((uint8_t)value, sum);
+    return SendByte((uint8_t)(value >> 8), sum);
+}
+
+static uint8_t SendU32(uint32_t value, uint8_t sum)
+{
+    sum = SendU16((uint16_t)value, sum);
+    return SendU16((uint16_t)(value >> 16), sum);
+}
+
+/*
+ * Counter_Add
+ * The EEPROM done interrupt counts too: the read-modify-write must not be
+ * split by it.
+ */
+static void Counter_Add(StatCounter counter)
+{
+    bool was_masked = IntMasterDisable();
+
+    counters[counter]++;
+    if (!was_masked)
+        IntMasterEnable();
+}
+
+/******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+
+void Stats_Increment(StatCounter counter)
+{
+    if (counter < STAT_COUNTER_COUNT)
+        Counter_Add(counter);
+}
+
+void Stats_RecordCommand(StatOp op, uint32_t service_us)
+{
+    uint8_t bucket = 0;
+
+    if (op >= STAT_OP_COUNT)
+        return;
+
+    while (bucket < STATS_BUCKETS - 1 && (service_us >> (2 * (bucket + 1))) != 0)
+        bucket++;
+
+    op_count[op]++;
+    if (op_hist[op][bucket] != 0xFFFF)
+        op_hist[op][bucket]++;
+}
+
+void Stats_RecordUartErrors(uint32_t rx_errors)
+{
+    if (rx_errors & UART_RXERROR_FRAMING)
+        Counter_Add(STAT_UART_FRAMING);
+    if (rx_errors & UART_RXERROR_OVERRUN)
+        Counter_Add(STAT_UART_OVERRUN);
+    if (rx_errors & UART_RXERROR_PARITY)
+        Counter_Add(STAT_UART_PARITY);
+    if (rx_errors & UART_RXERROR_BREAK)
+        Counter_Add(STAT_UART_BREAK);
+}
+
+void Stats_Export(void)
+{
+    uint8_t sum = 0;
+    uint8_t i, b;
+
+    counters[STAT_WAIT_SPIN_1S] = Wait_SpinPpm(false);
+    counters[STAT_WAIT_SPIN_TOTAL] = Wait_SpinPpm(true);
+
+    sum = SendU16(STATS_PAYLOAD_SIZE, sum);
+    sum = SendByte(STATS_VERSION, sum);
+    sum = SendByte(STAT_COUNTER_COUNT, sum);
+    sum = SendByte(STAT_OP_COUNT, sum);
+    sum = SendByte(STATS_BUCKETS, sum);
+    sum = SendU32(SysTick_GetMs() / 1000, sum);
+
+    for (i = 0; i < STAT_COUNTER_COUNT; i++)
+        sum = SendU32(counters[i], sum);
+
+    for (i = 0; i < STAT_OP_COUNT; i++)
+    {
+        sum = SendU32(op_count[i], sum);
+        for (b = 0; b < STATS_BUCKETS; b++)
+            sum = SendU16(op_hist[i][b], sum);
+    }
+
+    Transport_SendChar((char)sum);
+}
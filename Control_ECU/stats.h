@@ -0,0 +1,114 @@
+/******************************************************************************
+ * File: stats.h (Control_ECU)
+ * Description: Runtime counters and per-command service-time histograms,
+ *              exported by the STAT command.
+ *
+ * STAT reply (binary, little-endian):
+ *   len        uint16  number of payload bytes that follow
+ *   payload:
+ *     version    uint8   STATS_VERSION
+ *     counters   uint8   STAT_COUNTER_COUNT
+ *     opcodes    uint8   STAT_OP_COUNT
+ *     buckets    uint8   STATS_BUCKETS
+ *     uptime     uint32  seconds since boot
+ *     counter    uint32  x counters (StatCounter order; the gauges are
+ *                        read when the reply is sent)
+ *     per opcode (StatOp order):
+ *       count    uint32  commands received
+ *       hist     uint16  x buckets (saturating)
+ *   checksum   uint8   sum of all preceding bytes (len included)
+ *
+ * Histogram bucket 0 holds service times below 4us, bucket i
+ * [4^i, 4^(i+1)) us, and the last bucket everything longer. Service time
+ * runs from line complete to handler done, so a granted PWD includes the
+ * door sequence.
+ ******************************************************************************/
+
+#ifndef STATS_H_
+#define STATS_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#define STATS_VERSION 1
+#define STATS_BUCKETS 12
+
+typedef enum
+{
+    STAT_OP_STS,
+    STAT_OP_HBT,
+    STAT_OP_SET,
+    STAT_OP_CHK,
+    STAT_OP_PWD,
+    STAT_OP_LCK,
+    STAT_OP_ALM,
+    STAT_OP_LOG,
+    STAT_OP_BOT,
+    STAT_OP_BTM,
+    STAT_OP_TMO,
+    STAT_OP_UPD,
+    STAT_OP_DOR,
+    STAT_OP_CLK,
+    STAT_OP_SCH,
+    STAT_OP_PRF,
+    STAT_OP_OTK,
+    STAT_OP_EXP,
+    STAT_OP_IMP,
+    STAT_OP_TRC,
+    STAT_OP_WAI,
+    STAT_OP_ENT,
+    STAT_OP_STAT,
+    STAT_OP_COUNT
+} StatOp;
+
+typedef enum
+{
+    STAT_UNKNOWN_LINES,     /* No known opcode at the start of the line */
+    STAT_GARBLED_LINES,     /* Known opcode, malformed field after ':' */
+    STAT_RX_OVERFLOWS,      /* Lines longer than the receive buffer */
+    STAT_UART_FRAMING,
+    STAT_UART_OVERRUN,
+    STAT_UART_PARITY,
+    STAT_UART_BREAK,
+    STAT_EEPROM_READS,
+    STAT_EEPROM_WRITES,
+    STAT_MOTOR_CYCLES,
+    STAT_ALARMS,
+    STAT_ARQ_REPLAYS,       /* Retransmitted requests answered from the cache */
+    STAT_EEPROM_FAILURES,   /* Queued writes still wrong after the retries */
+    STAT_WAIT_SPIN_1S,      /* Gauge: ppm of cycles spent in waits, last second */
+    STAT_WAIT_SPIN_TOTAL,   /* Gauge: the same since boot (see wait.h) */
+    STAT_COUNTER_COUNT
+} StatCounter;
+
+/******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+/*
+ * Stats_Increment
+ * Adds one to counter. Safe to call from interrupt handlers.
+ */
+void Stats_Increment(StatCounter counter);
+
+/*
+ * Stats_RecordCommand
+ * Counts one op and files its service time into the op's histogram.
+ */
+void Stats_RecordCommand(StatOp op, uint32_t service_us);
+
+/*
+ * Stats_RecordUartErrors
+ * Counts the UART_RXERROR_* flags set in rx_errors (from UARTRxErrorGet).
+ */
+void Stats_RecordUartErrors(uint32_t rx_errors);
+
+/*
+ * Stats_Export
+ * Sends the STAT reply described above over UART2.
+ */
+void Stats_Export(void);
+
+#endif /* STATS_H_ */
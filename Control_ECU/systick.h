@@ -7,6 +7,11 @@
 #define SYSTICK_INT     1
 
 void SysTick_Init(uint32_t reload, uint8_t mode);
-void DelayMs(uint32_t ms);
+
+// Milliseconds since SysTick_Init (SYSTICK_INT mode only; wraps after ~49 days)
+uint32_t SysTick_GetMs(void);
+
+// Microsecond timestamp for short intervals (SYSTICK_INT mode, reload = 1 ms)
+uint32_t SysTick_GetUs(void);
 
 #endif
@@ -0,0 +1,202 @@
+/******************************************************************************
+ * File: totp.c (Control_ECU)
+ * Description: RFC 6238 one-time PINs over precomputed HMAC-SHA1 pad states
+ ******************************************************************************/
+
+#include "totp.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "eeprom.h"
+#include "rtc.h"
+#include "sha1.h"
+
+#define RECORD_WORDS (TOTP_KEY_BYTES / 4)
+
+/* SHA-1 states after the key ^ ipad / key ^ opad block. The key itself is
+ * not kept in RAM. */
+static uint32_t ipad_state[SHA1_STATE_WORDS];
+static uint32_t opad_state[SHA1_STATE_WORDS];
+static uint8_t key_len = 0;
+static uint32_t last_step = 0;
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+static void PutU32(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)(value >> 24);
+    p[1] = (uint8_t)(value >> 16);
+    p[2] = (uint8_t)(value >> 8);
+    p[3] = (uint8_t)value;
+}
+
+/*
+ * Totp_Precompute
+ * Folds the padded key blocks into the inner and outer states.
+ */
+static void Totp_Precompute(const uint8_t *key, uint8_t len)
+{
+    uint8_t block[SHA1_BLOCK_SIZE];
+    uint8_t i;
+
+    for (i = 0; i < SHA1_BLOCK_SIZE; i++)
+        block[i] = (uint8_t)(((i < len) ? key[i] : 0) ^ 0x36);
+    SHA1_Init(ipad_state);
+    SHA1_Compress(ipad_state, block);
+
+    for (i = 0; i < SHA1_BLOCK_SIZE; i++)
+        block[i] ^= 0x36 ^ 0x5C;
+    SHA1_Init(opad_state);
+    SHA1_Compress(opad_state, block);
+
+    memset(block, 0, sizeof(block));
+    key_len = len;
+}
+
+/*
+ * Totp_Load
+ * Takes a key record (length word, then the key bytes).
+ */
+static void Totp_Load(const uint32_t *record)
+{
+    if (record[0] == 0 || record[0] > TOTP_KEY_MAX) // Also the erased state
+        key_len = 0;
+    else
+        Totp_Precompute((const uint8_t *)&record[1], (uint8_t)record[0]);
+}
+
+/*
+ * Totp_Code
+ * HOTP value of one time step, before truncation to decimal digits. The
+ * 8-byte counter and the inner digest each fit one padded block.
+ */
+static uint32_t Totp_Code(uint32_t step)
+{
+    uint8_t block[SHA1_BLOCK_SIZE];
+    uint32_t state[SHA1_STATE_WORDS];
+    uint8_t i, offset;
+
+    memset(block, 0, sizeof(block));
+    PutU32(&block[4], step);        // High word stays 0 until 2106
+    block[8] = 0x80;
+    block[62] = 0x02;               // (64 + 8) bytes = 0x240 bits
+    block[63] = 0x40;
+    memcpy(state, ipad_state, sizeof(state));
+    SHA1_Compress(state, block);
+
+    memset(block, 0, sizeof(block));
+    for (i = 0; i < SHA1_STATE_WORDS; i++)
+        PutU32(&block[4 * i], state[i]);
+    block[SHA1_DIGEST_SIZE] = 0x80;
+    block[62] = 0x02;               // (64 + 20) bytes = 0x2A0 bits
+    block[63] = 0xA0;
+    memcpy(state, opad_state, sizeof(state));
+    SHA1_Compress(state, block);
+
+    // Dynamic truncation (RFC 4226 5.3), the digest being block[0..19]
+    for (i = 0; i < SHA1_STATE_WORDS; i++)
+        PutU32(&block[4 * i], state[i]);
+    offset = block[SHA1_DIGEST_SIZE - 1] & 0x0F;
+    return ((uint32_t)(block[offset] & 0x7F) << 24) | ((uint32_t)block[offset + 1] << 16) |
+           ((uint32_t)block[offset + 2] << 8) | block[offset + 3];
+}
+
+/******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+
+void Totp_Init(void)
+{
+    uint32_t record[RECORD_WORDS];
+
+    EEPROM_ReadTotpKey(record);
+    Totp_Load(record);
+    memset(record, 0, sizeof(record));
+    last_step = EEPROM_ReadTotpStep();
+}
+
+bool Totp_SetKey(uint8_t part, const uint8_t *bytes, uint8_t len)
+{
+    uint32_t record[RECORD_WORDS];
+    uint8_t *key = (uint8_t *)&record[1];
+
+    if (len == 0 || len > TOTP_KEY_CHUNK || part > 1)
+        return false;
+
+    if (part == 0)
+    {
+        memset(record, 0, sizeof(record));
+    }
+    else
+    {
+        EEPROM_ReadTotpKey(record);
+        if (record[0] != TOTP_KEY_CHUNK)
+            return false;
+    }
+
+    memcpy(&key[part * TOTP_KEY_CHUNK], bytes, len);
+    record[0] = (uint32_t)(part * TOTP_KEY_CHUNK + len);
+    EEPROM_WriteTotpKey(record);
+    Totp_Load(record);
+    memset(record, 0, sizeof(record));
+    return true;
+}
+
+void Totp_ClearKey(void)
+{
+    uint32_t record[RECORD_WORDS];
+
+    memset(record, 0, sizeof(record));
+    EEPROM_WriteTotpKey(record);
+    key_len = 0;
+}
+
+bool Totp_Match(const char *code, uint32_t step, uint32_t *matched)
+{
+    uint32_t value = 0, modulus = 1;
+    bool found = false;
+    uint32_t s;
+    uint8_t i;
+
+    for (i = 0; i < PASSWORD_LENGTH; i++)
+    {
+        if (code[i] < '0' || code[i] > '9')
+            return false;
+        value = value * 10 + (uint32_t)(code[i] - '0');
+        modulus *= 10;
+    }
+    if (code[PASSWORD_LENGTH] != '\0')
+        return false;
+
+    // Every step is computed, so the time taken does not give away which
+    for (i = 0; i <= 2 * TOTP_WINDOW; i++)
+    {
+        if (step + i < TOTP_WINDOW)
+            continue;
+        s = step + i - TOTP_WINDOW;
+        if (Totp_Code(s) % modulus == value)
+        {
+            found = true;
+            *matched = s;
+        }
+    }
+    return found;
+}
+
+bool Totp_Check(const char *code, bool use)
+{
+    uint32_t step;
+
+    if (key_len == 0 || !RTC_IsSet())
+        return false;
+    if (!Totp_Match(code, RTC_Get() / TOTP_STEP_S, &step) || step <= last_step)
+        return false;
+    if (!use)
+        return true;
+
+    last_step = step;
+    EEPROM_WriteTotpStep(step);
+    return true;
+}
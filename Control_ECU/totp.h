@@ -0,0 +1,71 @@
+/******************************************************************************
+ * File: totp.h (Control_ECU)
+ * Description: Time-based one-time PINs (RFC 6238, HMAC-SHA1, 30 s steps)
+ *              for guests: PWD accepts them alongside the stored PIN, CHK
+ *              answers 'G' for one. Codes are truncated to PASSWORD_LENGTH
+ *              digits so they fit the keypad.
+ *
+ * The HMAC inner and outer pad states are computed once when the key is
+ * loaded; checking a code then costs two SHA-1 blocks per time step, and
+ * the TOTP_WINDOW steps either side of now are checked in one pass. Each
+ * step's code is accepted once: the last step used is kept in EEPROM.
+ *
+ * Time steps count from the RTC's seconds. The RTC holds local time (see
+ * rtc.h), so the code generator must use the same clock (tools/totp.py
+ * --offset). No codes are accepted until the RTC has been set.
+ ******************************************************************************/
+
+#ifndef TOTP_H_
+#define TOTP_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ * Definitions
+ ******************************************************************************/
+#define TOTP_KEY_MAX    20      /* Bytes; RFC 4226 recommends 20 */
+#define TOTP_KEY_CHUNK  10      /* Key bytes per OTK line */
+#define TOTP_STEP_S     30
+#define TOTP_WINDOW     1       /* Steps accepted either side of now */
+
+/******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+/*
+ * Totp_Init
+ * Loads the key from EEPROM. Call after EEPROM_Init().
+ */
+void Totp_Init(void);
+
+/*
+ * Totp_SetKey
+ * Part 0 replaces the key with len bytes (1..TOTP_KEY_CHUNK); part 1
+ * appends len more to a TOTP_KEY_CHUNK-byte part 0. Stored in EEPROM.
+ * Returns false (key unchanged) for anything else.
+ */
+bool Totp_SetKey(uint8_t part, const uint8_t *bytes, uint8_t len);
+
+/*
+ * Totp_ClearKey
+ * Removes the key; only the stored PIN is accepted from then on.
+ */
+void Totp_ClearKey(void);
+
+/*
+ * Totp_Match
+ * Checks code (PASSWORD_LENGTH digits) against every step within
+ * TOTP_WINDOW of step, all of them, whatever matches. On a match stores
+ * the step in *matched. Does not look at the clock or at earlier use.
+ */
+bool Totp_Match(const char *code, uint32_t step, uint32_t *matched);
+
+/*
+ * Totp_Check
+ * True if code is the current one-time PIN and its step has not been used.
+ * With use set the step is used up (PWD); CHK only looks.
+ */
+bool Totp_Check(const char *code, bool use);
+
+#endif /* TOTP_H_ */
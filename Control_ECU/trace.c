@@ -0,0 +1,97 @@
+/******************************************************************************
+ * File: trace.c
+ * Module: Link Traffic Trace
+ * Description: RAM ring of timestamped link bytes and its export
+ ******************************************************************************/
+
+#include "trace.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include "systick.h"
+
+#if TRACE
+static uint32_t times[TRACE_RECORDS];
+static uint8_t bytes[TRACE_RECORDS];
+#endif
+static uint16_t head = 0;           // Next slot to write
+static uint16_t count = 0;
+static uint32_t dropped = 0;
+static bool paused = false;
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+static uint8_t SendByte(void (*put)(char), uint8_t value, uint8_t sum)
+{
+    put((char)value);
+    return (uint8_t)(sum + value);
+}
+
+static uint8_t SendU16(void (*put)(char), uint16_t value, uint8_t sum)
+{
+    sum = SendByte(put, (uint8_t)value, sum);
+    return SendByte(put, (uint8_t)(value >> 8), sum);
+}
+
+static uint8_t SendU32(void (*put)(char), uint32_t value, uint8_t sum)
+{
+    sum = SendU16(put, (uint16_t)value, sum);
+    return SendU16(put, (uint16_t)(value >> 16), sum);
+}
+
+/******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+
+void Trace_Byte(bool sent, char byte)
+{
+#if TRACE
+    if (paused)
+        return;
+
+    times[head] = (SysTick_GetUs() & ~TRACE_SENT) | (sent ? TRACE_SENT : 0);
+    bytes[head] = (uint8_t)byte;
+    head = (uint16_t)((head + 1) % TRACE_RECORDS);
+    if (count < TRACE_RECORDS)
+        count++;
+    else
+        dropped++;
+#else
+    (void)sent;
+    (void)byte;
+#endif
+}
+
+void Trace_Reset(void)
+{
+    head = 0;
+    count = 0;
+    dropped = 0;
+}
+
+void Trace_Export(void (*put)(char))
+{
+    uint8_t sum = 0;
+#if TRACE
+    uint16_t i, slot = (uint16_t)((head + TRACE_RECORDS - count) % TRACE_RECORDS);
+#endif
+
+    paused = true;
+    sum = SendU16(put, (uint16_t)(8 + 5 * count), sum);
+    sum = SendByte(put, TRACE_VERSION, sum);
+    sum = SendByte(put, TRACE_ECU, sum);
+    sum = SendU16(put, count, sum);
+    sum = SendU32(put, dropped, sum);
+
+#if TRACE
+    for (i = 0; i < count; i++)
+    {
+        sum = SendU32(put, times[slot], sum);
+        sum = SendByte(put, bytes[slot], sum);
+        slot = (uint16_t)((slot + 1) % TRACE_RECORDS);
+    }
+#endif
+    put((char)sum);
+    paused = false;
+}
@@ -0,0 +1,76 @@
+/******************************************************************************
+ * File: trace.h
+ * Module: Link Traffic Trace
+ * Description: Optional recorder of the link's byte stream (TRACE = 1 in the
+ *              IAR preprocessor defines). Every byte sent or received
+ *              through the transport is stored with a microsecond timestamp
+ *              in a RAM ring; the oldest are overwritten once it is full.
+ *              tools/replay.py shows the session and replays it against a
+ *              Control ECU to compare reply latencies.
+ *
+ * Bytes are timestamped when they pass the transport (Transport_SendChar,
+ * Transport_ReceiveChar), not on the wire. Multidrop builds
+ * (UART2_MULTIDROP) frame their traffic below the transport and record
+ * nothing.
+ *
+ * Export (binary, little-endian, same framing as STAT):
+ *   len        uint16  number of payload bytes that follow
+ *   payload:
+ *     version    uint8   TRACE_VERSION
+ *     ecu        uint8   TRACE_ECU: 0 Control ECU, 1 HMI ECU
+ *     count      uint16  records that follow, oldest first
+ *     dropped    uint32  records overwritten since the last reset
+ *     per record:
+ *       time     uint32  bits 0-30: SysTick_GetUs() (wraps after 35 min),
+ *                        bit 31: TRACE_SENT, sent by this ECU
+ *       byte     uint8
+ *   checksum   uint8   sum of all preceding bytes (len included)
+ *
+ * With TRACE = 0 nothing is recorded, the ring takes no RAM and the export
+ * has no records.
+ ******************************************************************************/
+
+#ifndef TRACE_H_
+#define TRACE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#ifndef TRACE
+#define TRACE 0
+#endif
+
+#define TRACE_VERSION 1
+#define TRACE_ECU     0                 /* Control ECU */
+#define TRACE_RECORDS 640               /* 5 bytes each */
+#define TRACE_SENT    0x80000000u
+
+/******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+/*
+ * Trace_Byte
+ * Records one byte, sent if sent is true, else received. Main loop only.
+ */
+void Trace_Byte(bool sent, char byte);
+
+/*
+ * Trace_Reset
+ * Empties the ring and the dropped count.
+ */
+void Trace_Reset(void);
+
+/*
+ * Trace_Export
+ * Sends the export described above through put, oldest record first.
+ * Recording pauses meanwhile, so an export over the link does not trace
+ * itself.
+ */
+void Trace_Export(void (*put)(char));
+
+#endif /* TRACE_H_ */
@@ -0,0 +1,100 @@
+/******************************************************************************
+ * File: transport.c
+ * Module: Inter-ECU Transport
+ * Description: Dispatch to the UART2 or CAN0 backend
+ ******************************************************************************/
+
+#include "transport.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include "can.h"
+#include "trace.h"
+#include "uart.h"
+
+/* TivaWare includes */
+#include "driverlib/uart.h"
+
+static char *capture_buf = 0;
+static uint8_t capture_size = 0;
+static uint8_t capture_len = 0;
+
+void Transport_Init(void)
+{
+    if (TRANSPORT_CAN)
+        CAN0_Init();
+    else
+        UART2_Init();
+}
+
+void Transport_SendChar(char data)
+{
+    if (TRACE)
+        Trace_Byte(true, data);
+
+    if (capture_buf != 0)
+    {
+        if (capture_len < capture_size)
+            capture_buf[capture_len] = data;
+        if (capture_len <= capture_size)
+            capture_len++;
+    }
+
+    if (TRANSPORT_CAN)
+        CAN0_SendChar(data);
+    else
+        UART2_SendChar(data);
+}
+
+void Transport_SendString(const char *str)
+{
+    while (*str != '\0')
+        Transport_SendChar(*str++);
+}
+
+void Transport_Flush(void)
+{
+    if (TRANSPORT_CAN)
+        CAN0_Flush();
+}
+
+void Transport_WaitTxDone(void)
+{
+    if (TRANSPORT_CAN)
+        CAN0_WaitTxDone();
+    else
+        UART2_WaitTxDone();
+}
+
+char Transport_ReceiveChar(void)
+{
+    char c = TRANSPORT_CAN ? CAN0_ReceiveChar() : UART2_ReceiveChar();
+
+    if (TRACE)
+        Trace_Byte(false, c);
+    return c;
+}
+
+uint8_t Transport_IsDataAvailable(void)
+{
+    return TRANSPORT_CAN ? CAN0_IsDataAvailable() : UART2_IsDataAvailable();
+}
+
+void Transport_Capture(char *buf, uint8_t size)
+{
+    capture_buf = buf;
+    capture_size = size;
+    capture_len = 0;
+}
+
+uint8_t Transport_EndCapture(void)
+{
+    capture_buf = 0;
+    return capture_len;
+}
+
+uint32_t Transport_TakeRxErrors(void)
+{
+    if (TRANSPORT_CAN)
+        return (CAN0_TakeLostFrames() != 0) ? UART_RXERROR_OVERRUN : 0;
+    return UART2_TakeRxErrors();
+}
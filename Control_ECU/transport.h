@@ -0,0 +1,52 @@
+/******************************************************************************
+ * File: transport.h
+ * Module: Inter-ECU Transport
+ * Description: One send/receive API for the link to the other ECU, over
+ *              UART2 (default) or CAN0 (TRANSPORT_CAN = 1, see can.h).
+ *
+ * Both backends carry the same byte stream, so the command protocol and
+ * everything above it are unchanged. Call Transport_Flush() at the end of
+ * each reply or request: CAN sends partial frames only then, UART sends
+ * every byte at once anyway.
+ ******************************************************************************/
+
+#ifndef TRANSPORT_H_
+#define TRANSPORT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uart.h"
+
+#ifndef TRANSPORT_CAN
+#define TRANSPORT_CAN 0
+#endif
+
+#if TRANSPORT_CAN && UART2_MULTIDROP
+#error "UART2_MULTIDROP framing needs the UART transport"
+#endif
+
+void Transport_Init(void);
+void Transport_SendChar(char data);
+void Transport_SendString(const char *str);
+void Transport_Flush(void);
+void Transport_WaitTxDone(void);
+char Transport_ReceiveChar(void);
+uint8_t Transport_IsDataAvailable(void);
+
+/*
+ * Transport_Capture / Transport_EndCapture
+ * Copies everything sent in between into buf (for the ARQ reply cache).
+ * EndCapture returns the number of bytes sent, size + 1 if they did not
+ * all fit.
+ */
+void Transport_Capture(char *buf, uint8_t size);
+uint8_t Transport_EndCapture(void);
+
+/*
+ * Transport_TakeRxErrors
+ * UART_RXERROR_* flags latched since the last call; lost CAN frames are
+ * reported as UART_RXERROR_OVERRUN.
+ */
+uint32_t Transport_TakeRxErrors(void);
+
+#endif /* TRANSPORT_H_ */
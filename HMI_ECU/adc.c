@@ -1,6 +1,7 @@
 #include "adc.h"
 
 #include <stdbool.h>
+#include "wait.h"
 #include "inc/hw_memmap.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/gpio.h"
@@ -17,13 +18,25 @@ void ADC_Init(void)
     ADCIntClear(ADC0_BASE, 3);
 }
 
+/* One conversion takes about 1us; far longer means the ADC is not running */
+#define ADC_TIMEOUT_US 1000U
+
+static uint32_t last_value = 0;
+
+static bool ADC_Done(void)
+{
+    return ADCIntStatus(ADC0_BASE, 3, false) != 0;
+}
+
+/* The previous reading if the conversion does not complete */
 uint32_t ADC_Read(void)
 {
     uint32_t adc_value[1];
     ADCProcessorTrigger(ADC0_BASE, 3);
-    while (!ADCIntStatus(ADC0_BASE, 3, false))
-        ;
+    if (!Wait_Until(WAIT_ADC, ADC_Done, ADC_TIMEOUT_US))
+        return last_value;
     ADCIntClear(ADC0_BASE, 3);
     ADCSequenceDataGet(ADC0_BASE, 3, adc_value);
-    return adc_value[0];
+    last_value = adc_value[0];
+    return last_value;
 }
@@ -6,4 +6,10 @@
 void ADC_Init(void);
 uint32_t ADC_Read(void);
 
+// Maps a 12-bit reading linearly onto lo..hi (the timeout pot: 5-30 s)
+static inline uint32_t ADC_Scale(uint32_t value, uint32_t lo, uint32_t hi)
+{
+    return lo + (value * (hi - lo)) / 4095U;
+}
+
 #endif // ADC_H
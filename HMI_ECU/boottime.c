@@ -0,0 +1,32 @@
+/******************************************************************************
+ * File: boottime.c (HMI_ECU)
+ * Description: Per-phase boot timestamps
+ ******************************************************************************/
+
+#include "boottime.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include "systick.h"
+
+static volatile uint32_t phase_ms[BOOT_PHASE_COUNT];
+static volatile bool phase_marked[BOOT_PHASE_COUNT];
+
+void BootTime_Mark(BootPhase phase)
+{
+    if (phase >= BOOT_PHASE_COUNT || phase_marked[phase])
+        return;
+    phase_ms[phase] = SysTick_GetMs();
+    phase_marked[phase] = true;
+}
+
+uint32_t BootTime_Get(BootPhase phase)
+{
+    if (phase >= BOOT_PHASE_COUNT)
+        return 0;
+    return phase_ms[phase];
+}
+
+bool BootTime_IsMarked(BootPhase phase)
+{
+    return phase < BOOT_PHASE_COUNT && phase_marked[phase];
+}
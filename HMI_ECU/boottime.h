@@ -0,0 +1,44 @@
+/******************************************************************************
+ * File: boottime.h (HMI_ECU)
+ * Description: Per-phase boot timestamps. Each phase is stamped once with
+ *              SysTick_GetMs(), i.e. milliseconds since startup.
+ ******************************************************************************/
+
+#ifndef BOOTTIME_H_
+#define BOOTTIME_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ * Definitions
+ ******************************************************************************/
+typedef enum
+{
+    BOOT_CLOCK,         /* System clock and SysTick running */
+    BOOT_PERIPHERALS,   /* UART, keypad, ADC, LEDs up; LCD power-up queued */
+    BOOT_LCD,           /* LCD power-up sequence and splash drawn */
+    BOOT_CONTROL_READY, /* Control ECU answered STS or sent RDY */
+    BOOT_FIRST_PROMPT,  /* First "Enter Password:" screen */
+    BOOT_PHASE_COUNT
+} BootPhase;
+
+/******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+/*
+ * BootTime_Mark
+ * Stamps phase with the current time. Later marks of the same phase are
+ * ignored. Safe to call from an ISR.
+ */
+void BootTime_Mark(BootPhase phase);
+
+/*
+ * BootTime_Get / BootTime_IsMarked
+ * Timestamp of phase in ms (0 if not reached yet) / whether it was reached.
+ */
+uint32_t BootTime_Get(BootPhase phase);
+bool BootTime_IsMarked(BootPhase phase);
+
+#endif /* BOOTTIME_H_ */
@@ -0,0 +1,253 @@
+/******************************************************************************
+ * File: can.c
+ * Module: CAN (Controller Area Network)
+ * Description: Source file for the TM4C123GH6PM CAN0 byte-stream driver
+ *
+ * Configuration:
+ *   - CAN0 (PE4: RX, PE5: TX), 500 kbit/s
+ *   - Message object 1: transmit
+ *   - Message objects 2..9: receive FIFO (object 9 ends it)
+ ******************************************************************************/
+
+#include "can.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "wait.h"
+
+/* TivaWare includes */
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/gpio.h"
+#include "driverlib/can.h"
+#include "driverlib/pin_map.h"
+
+#define TX_OBJ          1
+#define RX_FIRST_OBJ    2
+#define RX_OBJS         8
+#define RX_RING_SIZE    128         /* Power of two */
+#define RX_TIMEOUT_US   2000U       /* A byte announced as available is there */
+#define OPCODE_LENGTH   3           /* Enough to tell the opcodes apart */
+
+/* This board sends to the other side and listens on its own direction */
+#define TX_ID   CAN_ID_TO_CONTROL
+#define RX_ID   CAN_ID_TO_HMI
+
+/* Arbitration level of each request (see can.h); anything else, replies
+ * included, goes at the level of the last frame received */
+static const struct
+{
+    char opcode[OPCODE_LENGTH + 1];
+    uint8_t level;
+} levels[] = {
+    { "PWD", CAN_LEVEL_ACCESS },  { "CHK", CAN_LEVEL_ACCESS },
+    { "ENT", CAN_LEVEL_ACCESS },  { "ALM", CAN_LEVEL_ACCESS },
+    { "LCK", CAN_LEVEL_ACCESS },
+    { "STS", CAN_LEVEL_CONTROL }, { "HBT", CAN_LEVEL_CONTROL },
+    { "SET", CAN_LEVEL_CONTROL }, { "TMO", CAN_LEVEL_CONTROL },
+    { "DOR", CAN_LEVEL_CONTROL }, { "CLK", CAN_LEVEL_CONTROL },
+    { "SCH", CAN_LEVEL_CONTROL }, { "OTK", CAN_LEVEL_CONTROL },
+    { "BTM", CAN_LEVEL_CONTROL }, { "UPD", CAN_LEVEL_CONTROL },
+    { "LOG", CAN_LEVEL_BULK },    { "STA", CAN_LEVEL_BULK },      /* STAT */
+    { "EXP", CAN_LEVEL_BULK },    { "IMP", CAN_LEVEL_BULK },
+    { "TRC", CAN_LEVEL_BULK },    { "PRF", CAN_LEVEL_BULK },
+    { "WAI", CAN_LEVEL_BULK },    { "BOT", CAN_LEVEL_BULK },
+};
+
+static uint8_t tx_frame[8];
+static uint8_t tx_len = 0;
+static uint32_t tx_id = TX_ID + CAN_ID_LEVEL(CAN_LEVEL_CONTROL);
+static bool tx_line_start = true;    /* Next frame starts a message */
+static uint8_t rx_level = CAN_LEVEL_CONTROL;
+static uint8_t rx_ring[RX_RING_SIZE];
+static uint8_t rx_head = 0, rx_tail = 0;
+static uint32_t lost = 0;
+
+/*
+ * CAN0_LineLevel
+ * Level of the message starting in tx_frame: its opcode's, after an ARQ
+ * tag ("^a"), or the level of the last frame received.
+ */
+static uint8_t CAN0_LineLevel(void)
+{
+    uint8_t start = (tx_len >= 2 && tx_frame[0] == '^') ? 2u : 0u;
+    uint8_t i;
+
+    if (tx_len - start < OPCODE_LENGTH)
+        return rx_level;
+    for (i = 0; i < sizeof(levels) / sizeof(levels[0]); i++)
+    {
+        if (memcmp(&tx_frame[start], levels[i].opcode, OPCODE_LENGTH) == 0)
+            return levels[i].level;
+    }
+    return rx_level;
+}
+
+/*
+ * CAN0_WaitTxObject
+ * Waits for the transmit object to become free; gives up after
+ * CAN_TX_TIMEOUT_MS (nobody acknowledging), the pending frame is then
+ * replaced by the next one.
+ */
+static bool TxObjectFree(void)
+{
+    return (CANStatusGet(CAN0_BASE, CAN_STS_TXREQUEST) & (1UL << (TX_OBJ - 1))) == 0;
+}
+
+static void CAN0_WaitTxObject(void)
+{
+    if (!Wait_Until(WAIT_CAN_TX, TxObjectFree, CAN_TX_TIMEOUT_MS * 1000U))
+        lost++;
+}
+
+/*
+ * CAN0_Pump
+ * Moves received frames from the FIFO objects into the byte ring, lowest
+ * object first. A frame stays in the controller until the ring has room for
+ * it, so a slow reader backs up into the FIFO instead of losing bytes.
+ */
+static void CAN0_Pump(void)
+{
+    tCANMsgObject msg;
+    uint8_t data[8];
+    uint32_t newdat = CANStatusGet(CAN0_BASE, CAN_STS_NEWDAT);
+    uint8_t obj, i;
+
+    for (obj = RX_FIRST_OBJ; obj < RX_FIRST_OBJ + RX_OBJS; obj++)
+    {
+        if (!(newdat & (1UL << (obj - 1))))
+            continue;
+        if ((uint8_t)(rx_head - rx_tail) > RX_RING_SIZE - 8)
+            return;
+
+        msg.pui8MsgData = data;
+        CANMessageGet(CAN0_BASE, obj, &msg, true);
+        if (msg.ui32Flags & MSG_OBJ_DATA_LOST)
+            lost++;
+        rx_level = (uint8_t)((msg.ui32MsgID >> 8) - 1U);
+        if (rx_level > CAN_LEVEL_BULK)
+            rx_level = CAN_LEVEL_BULK;
+        for (i = 0; i < msg.ui32MsgLen && i < 8; i++)
+        {
+            rx_ring[rx_head & (RX_RING_SIZE - 1)] = data[i];
+            rx_head++;
+        }
+    }
+}
+
+/*
+ * CAN0_Init
+ * Initializes CAN0 on PE4 (RX) and PE5 (TX).
+ */
+void CAN0_Init(void)
+{
+    tCANMsgObject rx;
+    uint8_t obj;
+
+    /* 1) Enable CAN0 and Port E peripherals */
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_CAN0);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOE);
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_CAN0));
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOE));
+
+    /* 2) Pin muxing */
+    GPIOPinConfigure(GPIO_PE4_CAN0RX);
+    GPIOPinConfigure(GPIO_PE5_CAN0TX);
+    GPIOPinTypeCAN(GPIO_PORTE_BASE, GPIO_PIN_4 | GPIO_PIN_5);
+
+    /* 3) Controller and bit timing */
+    CANInit(CAN0_BASE);
+    CANBitRateSet(CAN0_BASE, SysCtlClockGet(), CAN0_BIT_RATE);
+
+    /* 4) Receive FIFO on our direction, every level */
+    rx.ui32MsgID = RX_ID;
+    rx.ui32MsgIDMask = CAN_ID_DIRECTION;
+    rx.ui32MsgLen = 8;
+    rx.pui8MsgData = 0;
+    for (obj = RX_FIRST_OBJ; obj < RX_FIRST_OBJ + RX_OBJS; obj++)
+    {
+        rx.ui32Flags = MSG_OBJ_USE_ID_FILTER;
+        if (obj < RX_FIRST_OBJ + RX_OBJS - 1)
+            rx.ui32Flags |= MSG_OBJ_FIFO;
+        CANMessageSet(CAN0_BASE, obj, &rx, MSG_OBJ_TYPE_RX);
+    }
+
+    /* 5) Enable CAN0 (automatic retransmission is on by default) */
+    CANEnable(CAN0_BASE);
+}
+
+/*
+ * CAN0_SendFrame
+ * Sends the bytes collected so far. The first frame of a message (what is
+ * sent between two CAN0_Flush calls) picks the identifier for all of it.
+ */
+static void CAN0_SendFrame(void)
+{
+    tCANMsgObject msg;
+
+    if (tx_len == 0)
+        return;
+
+    if (tx_line_start)
+        tx_id = TX_ID + CAN_ID_LEVEL(CAN0_LineLevel());
+    tx_line_start = false;
+
+    CAN0_WaitTxObject();
+    msg.ui32MsgID = tx_id;
+    msg.ui32MsgIDMask = 0;
+    msg.ui32Flags = MSG_OBJ_NO_FLAGS;
+    msg.ui32MsgLen = tx_len;
+    msg.pui8MsgData = tx_frame;
+    CANMessageSet(CAN0_BASE, TX_OBJ, &msg, MSG_OBJ_TYPE_TX);
+    tx_len = 0;
+}
+
+void CAN0_SendChar(char data)
+{
+    tx_frame[tx_len++] = (uint8_t)data;
+    if (tx_len == sizeof(tx_frame))
+        CAN0_SendFrame();
+}
+
+void CAN0_Flush(void)
+{
+    CAN0_SendFrame();
+    tx_line_start = true;
+}
+
+void CAN0_WaitTxDone(void)
+{
+    CAN0_Flush();
+    CAN0_WaitTxObject();
+}
+
+static bool RxReady(void)
+{
+    CAN0_Pump();
+    return rx_head != rx_tail;
+}
+
+char CAN0_ReceiveChar(void)
+{
+    char c;
+
+    if (!Wait_Until(WAIT_CAN_RX, RxReady, RX_TIMEOUT_US))
+        return '\0';
+    c = (char)rx_ring[rx_tail & (RX_RING_SIZE - 1)];
+    rx_tail++;
+    return c;
+}
+
+uint8_t CAN0_IsDataAvailable(void)
+{
+    CAN0_Pump();
+    return (rx_head != rx_tail) ? 1u : 0u;
+}
+
+uint32_t CAN0_TakeLostFrames(void)
+{
+    uint32_t n = lost;
+    lost = 0;
+    return n;
+}
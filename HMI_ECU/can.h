@@ -0,0 +1,88 @@
+/******************************************************************************
+ * File: can.h
+ * Module: CAN (Controller Area Network)
+ * Description: Header file for the TM4C123GH6PM CAN0 byte-stream driver
+ *
+ * Configuration:
+ *   - CAN0 (PE4: RX, PE5: TX), external transceiver (e.g. SN65HVD230)
+ *   - Bit rate: 500 kbit/s, standard 11-bit identifiers
+ *   - Identifier = direction + arbitration level:
+ *       CAN_ID_TO_CONTROL : HMI -> Control ECU (0x100, 0x200, 0x300)
+ *       CAN_ID_TO_HMI     : Control ECU -> HMI (0x180, 0x280, 0x380)
+ *     A request's level comes from its opcode (CAN_LEVEL_*, table in
+ *     can.c); a message without a known opcode, such as a reply, takes
+ *     the level of the last frame received. The lower identifier wins
+ *     arbitration, so a PWD exchange goes ahead of a LOG or STAT transfer
+ *     in either direction, whoever else shares the bus.
+ *
+ * The line protocol is carried unchanged: bytes are packed into frames of
+ * up to 8 and a partial frame goes out on CAN0_Flush(). The controller adds
+ * the CRC and retransmits frames that were not acknowledged.
+ ******************************************************************************/
+
+#ifndef CAN_H_
+#define CAN_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define CAN0_BIT_RATE       500000U
+#define CAN_ID_TO_CONTROL   0x100U
+#define CAN_ID_TO_HMI       0x180U
+#define CAN_ID_DIRECTION    0x0FFU  /* Receive filter mask: any level */
+#define CAN_ID_LEVEL(level) ((uint32_t)(level) << 8)
+
+/* Arbitration levels, most urgent first */
+#define CAN_LEVEL_ACCESS    0U      /* PWD, CHK, ENT, ALM, LCK */
+#define CAN_LEVEL_CONTROL   1U      /* Status and settings */
+#define CAN_LEVEL_BULK      2U      /* LOG, STAT, EXP, IMP, TRC, ... */
+#define CAN_TX_TIMEOUT_MS   10U     /* Unacknowledged frame is dropped */
+
+/*
+ * CAN0_Init
+ * Initializes CAN0 on PE4/PE5 at CAN0_BIT_RATE with one transmit object and
+ * an 8-object receive FIFO filtering on this board's direction, any level.
+ */
+void CAN0_Init(void);
+
+/*
+ * CAN0_SendChar
+ * Adds a byte to the frame being built; sends it once it holds 8 bytes.
+ */
+void CAN0_SendChar(char data);
+
+/*
+ * CAN0_Flush
+ * Sends the partial frame, if any. Waits at most CAN_TX_TIMEOUT_MS for the
+ * previous frame to be acknowledged. Ends a message: the next byte starts
+ * one, whose first frame fixes the identifier for all of its frames.
+ */
+void CAN0_Flush(void);
+
+/*
+ * CAN0_WaitTxDone
+ * Flushes and blocks until the last frame has left (or timed out).
+ */
+void CAN0_WaitTxDone(void);
+
+/*
+ * CAN0_ReceiveChar
+ * Receives a single byte (blocking, bounded: see wait.h; '\0' if none
+ * arrived).
+ */
+char CAN0_ReceiveChar(void);
+
+/*
+ * CAN0_IsDataAvailable
+ * Returns 1 if a received byte is waiting, 0 otherwise.
+ */
+uint8_t CAN0_IsDataAvailable(void);
+
+/*
+ * CAN0_TakeLostFrames
+ * Returns the number of frames lost since the last call (receive FIFO
+ * overrun or transmit timeout) and clears it.
+ */
+uint32_t CAN0_TakeLostFrames(void);
+
+#endif /* CAN_H_ */
@@ -0,0 +1,289 @@
+/******************************************************************************
+ * File: diag.c
+ * Module: Diagnostics Pages
+ * Description: Page layout for the diagnostics screen. The STAT payload
+ *              layout is documented in the Control ECU's stats.h.
+ ******************************************************************************/
+
+#include "diag.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include "boottime.h"
+#include "fmt.h"
+#include "link.h"
+#include "wait.h"
+
+#define LOCAL_PAGES 6           /* RTT x2, heartbeats, boot time, CPU, waits */
+#define STAT_HEADER_SIZE 8      /* version, counts, uptime */
+
+/* StatCounter / StatOp order on the Control ECU */
+static const char *const counter_names[] = {
+    "Unknown", "Garbled", "RX ovf", "UART FE", "UART OE", "UART PE",
+    "UART BRK", "EE reads", "EE write", "Motor", "Alarms", "ARQ rply",
+    "EE vfail", "Spin 1s", "Spin all"
+};
+static const char *const op_names[] = {
+    "STS", "HBT", "SET", "CHK", "PWD", "LCK",
+    "ALM", "LOG", "BOT", "BTM", "TMO", "UPD", "DOR", "CLK",
+    "SCH", "PRF", "OTK", "EXP", "IMP", "TRC", "WAI", "ENT", "STAT"
+};
+
+/* WaitSite order of this ECU */
+static const char *const wait_site_names[WAIT_SITE_COUNT] = {
+    "UART2 RX", "UART2 TX", "UART2 dr", "UART0 RX", "UART0 TX",
+    "CAN TX", "CAN RX", "ADC", "LCD q"
+};
+
+#define COUNTER_NAMES (sizeof(counter_names) / sizeof(counter_names[0]))
+#define OP_NAMES (sizeof(op_names) / sizeof(op_names[0]))
+
+static uint8_t payload[DIAG_PAYLOAD_MAX];
+static bool loaded = false;
+static uint8_t n_counters, n_ops, n_buckets;
+
+/******************************************************************************
+ * Private Helpers
+ ******************************************************************************/
+
+static uint16_t GetU16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t GetU32(const uint8_t *p)
+{
+    return (uint32_t)GetU16(p) | ((uint32_t)GetU16(p + 2) << 16);
+}
+
+static uint16_t OpRecordSize(void)
+{
+    return (uint16_t)(4 + 2 * n_buckets);
+}
+
+static const uint8_t *OpRecord(uint8_t op)
+{
+    return &payload[STAT_HEADER_SIZE + 4 * n_counters + op * OpRecordSize()];
+}
+
+/* Compact duration: "850u", "16m", "4s" */
+static void FormatUs(FmtBuf *f, uint32_t us)
+{
+    if (us < 1000)
+    {
+        Fmt_Dec(f, us);
+        Fmt_Char(f, 'u');
+    }
+    else if (us < 1000000)
+    {
+        Fmt_Dec(f, us / 1000);
+        Fmt_Char(f, 'm');
+    }
+    else
+    {
+        Fmt_Dec(f, us / 1000000);
+        Fmt_Char(f, 's');
+    }
+}
+
+/*
+ * FormatPercentile
+ * "<edge" for the bucket holding the pct-th percentile, ">edge" for the
+ * open last bucket. Bucket i ends at 4^(i+1) us.
+ */
+static void FormatPercentile(FmtBuf *f, const uint8_t *hist, uint8_t pct)
+{
+    uint32_t total = 0, seen = 0;
+    uint8_t b;
+
+    for (b = 0; b < n_buckets; b++)
+        total += GetU16(&hist[2 * b]);
+    if (total == 0)
+    {
+        Fmt_Char(f, '-');
+        return;
+    }
+
+    for (b = 0; b < n_buckets - 1; b++)
+    {
+        seen += GetU16(&hist[2 * b]);
+        if (seen * 100 >= total * pct)
+            break;
+    }
+    Fmt_Char(f, (b < n_buckets - 1) ? '<' : '>');
+    FormatUs(f, (b < n_buckets - 1) ? (4UL << (2 * b)) : (1UL << (2 * b)));
+}
+
+/* Share of cycles outside waits: "99.12%" */
+static void FormatWorkPct(FmtBuf *f, uint32_t spin_ppm)
+{
+    uint32_t work = (spin_ppm < 1000000) ? 1000000 - spin_ppm : 0;
+
+    Fmt_Dec(f, work / 10000);
+    Fmt_Char(f, '.');
+    Fmt_DecPad(f, (work / 100) % 100, 2, '0');
+    Fmt_Char(f, '%');
+}
+
+static void FormatLocalPage(uint8_t page, FmtBuf *l1, FmtBuf *l2)
+{
+    const LinkRttStats *rtt = Link_RttStats();
+    WaitSite site;
+
+    switch (page)
+    {
+    case 0:
+        Fmt_Str(l1, "RTT avg/p99 us");
+        Fmt_Dec(l2, Link_RttAvgUs());
+        Fmt_Char(l2, '/');
+        Fmt_Dec(l2, Link_RttP99Us());
+        break;
+    case 1:
+        Fmt_Str(l1, "RTT min/max us");
+        Fmt_Dec(l2, rtt->count ? rtt->min_us : 0);
+        Fmt_Char(l2, '/');
+        Fmt_Dec(l2, rtt->max_us);
+        break;
+    case 2:
+        Fmt_Str(l1, "HB ok ");
+        Fmt_Dec(l1, rtt->count);
+        Fmt_Str(l2, "lost ");
+        Fmt_Dec(l2, rtt->lost);
+        Fmt_Str(l2, " rtx ");
+        Fmt_Dec(l2, rtt->retransmits);
+        break;
+    case 3:
+        Fmt_Str(l1, "Boot to prompt");
+        Fmt_Dec(l2, BootTime_Get(BOOT_FIRST_PROMPT));
+        Fmt_Str(l2, " ms");
+        break;
+    case 4:
+        Fmt_Str(l1, "Work 1s  ");
+        FormatWorkPct(l1, Wait_SpinPpm(false));
+        Fmt_Str(l2, "Work all ");
+        FormatWorkPct(l2, Wait_SpinPpm(true));
+        break;
+    default:
+        site = Wait_StallSite();
+        Fmt_Str(l1, "Stall ");
+        Fmt_Str(l1, (site < WAIT_SITE_COUNT) ? wait_site_names[site] : "-");
+        Fmt_Str(l2, "WDT ");
+        Fmt_Dec(l2, Wait_WatchdogResets());
+        Fmt_Str(l2, " TO ");
+        Fmt_Dec(l2, Wait_Timeouts());
+        break;
+    }
+}
+
+/******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+
+uint8_t *Diag_Buffer(void)
+{
+    return payload;
+}
+
+bool Diag_Load(uint16_t len)
+{
+    loaded = false;
+    if (len < STAT_HEADER_SIZE || payload[0] != 1) // STATS_VERSION
+        return false;
+
+    n_counters = payload[1];
+    n_ops = payload[2];
+    n_buckets = payload[3];
+    if (n_buckets == 0 ||
+        len != STAT_HEADER_SIZE + 4 * n_counters + n_ops * OpRecordSize())
+        return false;
+
+    loaded = true;
+    return true;
+}
+
+void Diag_Clear(void)
+{
+    loaded = false;
+}
+
+uint8_t Diag_PageCount(void)
+{
+    if (!loaded)
+        return LOCAL_PAGES;
+    /* uptime, counters two per page, one per opcode */
+    return (uint8_t)(LOCAL_PAGES + 1 + (n_counters + 1) / 2 + n_ops);
+}
+
+void Diag_FormatPage(uint8_t page, char *line1, char *line2)
+{
+    uint8_t counter_pages = (uint8_t)((n_counters + 1) / 2);
+    uint8_t i, op;
+    const uint8_t *rec;
+    FmtBuf l1, l2, *line;
+
+    Fmt_Init(&l1, line1, DIAG_LINE_SIZE);
+    Fmt_Init(&l2, line2, DIAG_LINE_SIZE);
+
+    if (page < LOCAL_PAGES)
+    {
+        FormatLocalPage(page, &l1, &l2);
+        return;
+    }
+    page -= LOCAL_PAGES;
+    if (!loaded)
+        return;
+
+    if (page == 0)
+    {
+        Fmt_Str(&l1, "Ctl uptime");
+        Fmt_Dec(&l2, GetU32(&payload[4]));
+        Fmt_Str(&l2, " s");
+        return;
+    }
+    page -= 1;
+
+    if (page < counter_pages)
+    {
+        for (i = 0; i < 2; i++)
+        {
+            uint8_t c = (uint8_t)(page * 2 + i);
+            line = (i == 0) ? &l1 : &l2;
+            if (c >= n_counters)
+                break;
+            if (c < COUNTER_NAMES)
+            {
+                Fmt_StrPad(line, counter_names[c], 8);
+            }
+            else
+            {
+                Fmt_Str(line, "Ctr");
+                Fmt_Dec(line, c);
+                while (line->len < 8)
+                    Fmt_Char(line, ' ');
+            }
+            Fmt_Char(line, ' ');
+            Fmt_Dec(line, GetU32(&payload[STAT_HEADER_SIZE + 4 * c]));
+        }
+        return;
+    }
+    page -= counter_pages;
+
+    op = page;
+    if (op >= n_ops)
+        return;
+    rec = OpRecord(op);
+    if (op < OP_NAMES)
+    {
+        Fmt_Str(&l1, op_names[op]);
+    }
+    else
+    {
+        Fmt_Str(&l1, "Op");
+        Fmt_Dec(&l1, op);
+    }
+    Fmt_Str(&l1, " n=");
+    Fmt_Dec(&l1, GetU32(rec));
+    Fmt_Str(&l2, "p50");
+    FormatPercentile(&l2, rec + 4, 50);
+    Fmt_Str(&l2, " p99");
+    FormatPercentile(&l2, rec + 4, 99);
+}
@@ -0,0 +1,56 @@
+/******************************************************************************
+ * File: diag.h
+ * Module: Diagnostics Pages
+ * Description: Formats link statistics, boot timing and the Control ECU's
+ *              STAT reply into 16x2 pages for the hidden diagnostics screen.
+ ******************************************************************************/
+
+#ifndef DIAG_H_
+#define DIAG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define DIAG_PAYLOAD_MAX 1024   /* Largest STAT payload accepted */
+#define DIAG_LINE_SIZE 17       /* One LCD row + NUL */
+
+/******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+/*
+ * Diag_Buffer
+ * Receive buffer (DIAG_PAYLOAD_MAX bytes) for the STAT payload.
+ */
+uint8_t *Diag_Buffer(void);
+
+/*
+ * Diag_Load
+ * Validates the len-byte STAT payload now in Diag_Buffer(). Returns false
+ * (and drops the Control ECU pages) if the layout does not add up.
+ */
+bool Diag_Load(uint16_t len);
+
+/*
+ * Diag_Clear
+ * Drops the Control ECU pages (no STAT reply).
+ */
+void Diag_Clear(void);
+
+/*
+ * Diag_PageCount
+ * Local pages plus, once loaded, the Control ECU pages.
+ */
+uint8_t Diag_PageCount(void);
+
+/*
+ * Diag_FormatPage
+ * Writes page into line1/line2 (DIAG_LINE_SIZE bytes each, truncated).
+ */
+void Diag_FormatPage(uint8_t page, char *line1, char *line2);
+
+#endif /* DIAG_H_ */
@@ -8,6 +8,7 @@
 
 #include "keypad.h"
 #include "dio.h"
+#include "systick.h"
 
 /*
  * Keypad mapping array.
@@ -38,7 +39,7 @@ const char keypad_codes[4][4] = {
  * Initializes the GPIO pins for keypad operation.
  * - Rows are set as inputs with internal pull-up resistors (PortA).
  * - Columns are set as outputs and driven HIGH (PortB).
- * This function must be called before using Keypad_GetKey.
+ * This function must be called before using Keypad_Poll.
  */
 void Keypad_Init(void) {
     uint8_t row_pins[4] = KEYPAD_ROW_PINS;
@@ -57,17 +58,16 @@ void Keypad_Init(void) {
 
 
 /*
- * Keypad_GetKey
- * Scans the keypad and returns the character of the pressed key.
- * Returns 0 if no key is pressed.
+ * Keypad_Scan
+ * Single pass over the matrix without waiting for release.
+ * Returns the first pressed key found, or 0 if none.
  *
  * Scanning logic:
  *   1. Set each column LOW one at a time, others HIGH.
  *   2. Read all row inputs; if any row reads LOW, a key is pressed.
- *   3. Wait for key release (debounce).
- *   4. Return the mapped character from keypad_codes.
+ *   3. Return the mapped character from keypad_codes.
  */
-char Keypad_GetKey(void) {
+static char Keypad_Scan(void) {
     uint8_t row_pins[4] = KEYPAD_ROW_PINS;
     uint8_t col_pins[4] = KEYPAD_COL_PINS;
     for (uint8_t col = 0; col < 4; col++) {
@@ -84,12 +84,32 @@ char Keypad_GetKey(void) {
             uint8_t pin_val = DIO_ReadPin(KEYPAD_ROW_PORT, row_pins[row]);
             if (pin_val == LOW) {
                 // Key detected at (col, row)
-                // Wait for key release (debounce)
-                while (DIO_ReadPin(KEYPAD_ROW_PORT, row_pins[row]) == LOW);
-                // Return the mapped character from keypad_codes
                 return keypad_codes[row][col];
             }
         }
     }
     return 0; // No key pressed
 }
+
+/*
+ * Keypad_Poll
+ * Non-blocking: returns a key once when it has been held stable for
+ * KEYPAD_DEBOUNCE_MS, 0 otherwise (including while it stays held).
+ */
+char Keypad_Poll(void) {
+    static char candidate = 0;  // Last raw reading
+    static char reported = 0;   // Key state last acted on
+    static uint32_t since = 0;  // When candidate was first seen
+    char key = Keypad_Scan();
+
+    if (key != candidate) {
+        candidate = key;
+        since = SysTick_GetMs();
+        return 0;
+    }
+    if (key != reported && (SysTick_GetMs() - since) >= KEYPAD_DEBOUNCE_MS) {
+        reported = key;
+        return key; // 0 on release: nothing to report
+    }
+    return 0;
+}
@@ -21,16 +21,20 @@ extern const char keypad_codes[4][4];
 #define KEYPAD_ROWS 4
 #define KEYPAD_COLS 4
 
+/* A key must read stable this long before Keypad_Poll reports it */
+#define KEYPAD_DEBOUNCE_MS 20
+
 /*
  * Initializes the keypad GPIO pins.
- * Must be called before using Keypad_GetKey.
+ * Must be called before using Keypad_Poll.
  */
 void Keypad_Init(void);
 
 /*
- * Scans the keypad and returns the character of the pressed key.
- * Returns 0 if no key is pressed.
+ * Non-blocking scan with debounce and press-edge detection.
+ * Returns each key press exactly once, 0 otherwise.
+ * Requires SysTick in SYSTICK_INT mode.
  */
-char Keypad_GetKey(void);
+char Keypad_Poll(void);
 
 #endif // KEYPAD_H
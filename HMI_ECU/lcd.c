@@ -1,6 +1,8 @@
 /*****************************************************************************
  * File: lcd.c
  * Description: 16x2 LCD Driver Implementation (4-bit mode)
+ *              Asynchronous: writes are queued as nibbles and drained by a
+ *              Timer2A interrupt at the controller's pace.
  * Author: Ahmedhh
  * Date: December 4, 2025
  * 
@@ -14,8 +16,12 @@
  *****************************************************************************/
 
 #include "lcd.h"
+#include <stddef.h>
 #include "dio.h"
-#include "systick.h"
+#include "wait.h"
+#include "inc/hw_memmap.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
 
 /******************************************************************************
  *                            Pin Definitions                                  *
@@ -29,34 +35,147 @@
 #define LCD_D6          PIN4
 #define LCD_D7          PIN5
 
+/******************************************************************************
+ *                            Nibble Queue                                     *
+ ******************************************************************************/
+
+/*
+ * Each queue entry is one nibble write:
+ *   bits 0-3  nibble for D4-D7
+ *   OP_RS     RS level (1 = data)
+ *   OP_EXEC   last nibble of a byte: wait for the controller to execute it
+ *   OP_SLOW   clear/home: long execution time
+ *   OP_WAIT   no write: pause for the low 7 bits in ms (power-up sequence)
+ * Timer2A (one-shot) drains the queue, one nibble per interrupt, reloading
+ * itself with the wait the controller needs before the next one.
+ */
+#define OP_RS           0x10
+#define OP_EXEC         0x20
+#define OP_SLOW         0x40
+#define OP_WAIT         0x80
+
+#define LCD_QUEUE_SIZE  256     /* uint8_t indices wrap at the size */
+
+#define LCD_NIBBLE_US   2       /* Between the two nibbles of a byte */
+#define LCD_EXEC_US     50      /* Most instructions and data writes (37us) */
+#define LCD_SLOW_US     2000    /* Clear / home (1.52ms) */
+#define LCD_QUEUE_TIMEOUT_US 200000 /* Longest OP_WAIT pause and then some */
+
+static volatile uint8_t queue[LCD_QUEUE_SIZE];
+static volatile uint8_t queue_head = 0;     /* Written by the caller */
+static volatile uint8_t queue_tail = 0;     /* Written by the ISR */
+static volatile bool running = false;       /* Timer2A armed */
+static void (*volatile idle_callback)(void) = NULL;
+static uint32_t ticks_per_us;
+
 /******************************************************************************
  *                          Private Functions                                  *
  ******************************************************************************/
 
 /*
- * LCD_EnablePulse
- * Generates a high-to-low pulse on the EN pin to latch data/command.
+ * LCD_WriteNibble
+ * Puts a nibble on D4-D7 and latches it with an EN pulse. No delays: the
+ * pin writes themselves exceed the 450ns EN pulse width.
  */
-static void LCD_EnablePulse(void)
+static void LCD_WriteNibble(uint8_t nibble)
 {
+    DIO_WritePin(LCD_PORT, LCD_D4, (nibble >> 0) & 0x01);
+    DIO_WritePin(LCD_PORT, LCD_D5, (nibble >> 1) & 0x01);
+    DIO_WritePin(LCD_PORT, LCD_D6, (nibble >> 2) & 0x01);
+    DIO_WritePin(LCD_PORT, LCD_D7, (nibble >> 3) & 0x01);
     DIO_WritePin(LCD_PORT, LCD_EN, HIGH);
-    DelayMs(1);  /* Enable pulse width */
     DIO_WritePin(LCD_PORT, LCD_EN, LOW);
-    DelayMs(1);  /* Wait for command to execute */
 }
 
 /*
- * LCD_Send4Bits
- * Sends 4 bits of data to the LCD via D4-D7 pins.
- * Parameters: nibble - 4-bit value to send (bits 0-3 used)
+ * LCD_StartTimer
+ * Arms Timer2A to fire after us microseconds.
  */
-static void LCD_Send4Bits(uint8_t nibble)
+static void LCD_StartTimer(uint32_t us)
 {
-    DIO_WritePin(LCD_PORT, LCD_D4, (nibble >> 0) & 0x01);
-    DIO_WritePin(LCD_PORT, LCD_D5, (nibble >> 1) & 0x01);
-    DIO_WritePin(LCD_PORT, LCD_D6, (nibble >> 2) & 0x01);
-    DIO_WritePin(LCD_PORT, LCD_D7, (nibble >> 3) & 0x01);
-    LCD_EnablePulse();
+    TimerLoadSet(TIMER2_BASE, TIMER_A, us * ticks_per_us - 1);
+    TimerEnable(TIMER2_BASE, TIMER_A);
+}
+
+/*
+ * LCD_TimerISR
+ * Writes the next queued nibble, then waits out its execution time. When
+ * the queue is empty after the last wait the LCD is idle.
+ */
+static void LCD_TimerISR(void)
+{
+    uint8_t op;
+    void (*callback)(void);
+
+    TimerIntClear(TIMER2_BASE, TIMER_TIMA_TIMEOUT);
+
+    if (queue_tail == queue_head) {
+        running = false;
+        callback = idle_callback;
+        if (callback != NULL) {
+            callback();
+        }
+        return;
+    }
+
+    op = queue[queue_tail];
+    queue_tail++;
+
+    if (op & OP_WAIT) {
+        LCD_StartTimer((uint32_t)(op & 0x7F) * 1000);
+        return;
+    }
+
+    DIO_WritePin(LCD_PORT, LCD_RS, (op & OP_RS) ? HIGH : LOW);
+    LCD_WriteNibble(op & 0x0F);
+
+    if (op & OP_SLOW) {
+        LCD_StartTimer(LCD_SLOW_US);
+    } else if (op & OP_EXEC) {
+        LCD_StartTimer(LCD_EXEC_US);
+    } else {
+        LCD_StartTimer(LCD_NIBBLE_US);
+    }
+}
+
+/* Wait_Until condition */
+static bool LCD_QueueHasRoom(void)
+{
+    return (uint8_t)(queue_head + 1) != queue_tail;
+}
+
+/*
+ * LCD_Enqueue
+ * Queues one nibble write and starts the drain if it is stopped. Waits
+ * only if the queue is full.
+ */
+static void LCD_Enqueue(uint8_t op)
+{
+    /* Full: the ISR frees a slot within LCD_SLOW_US; if it has stopped,
+     * the op is dropped */
+    if (!Wait_Until(WAIT_LCD_QUEUE, LCD_QueueHasRoom, LCD_QUEUE_TIMEOUT_US)) {
+        return;
+    }
+
+    queue[queue_head] = op;
+    queue_head++;
+
+    TimerIntDisable(TIMER2_BASE, TIMER_TIMA_TIMEOUT);
+    if (!running) {
+        running = true;
+        LCD_StartTimer(LCD_NIBBLE_US);
+    }
+    TimerIntEnable(TIMER2_BASE, TIMER_TIMA_TIMEOUT);
+}
+
+/*
+ * LCD_EnqueueByte
+ * Queues both nibbles of a command (rs = 0) or data byte (rs = OP_RS).
+ */
+static void LCD_EnqueueByte(uint8_t value, uint8_t rs, uint8_t exec)
+{
+    LCD_Enqueue(rs | (value >> 4));
+    LCD_Enqueue(rs | exec | (value & 0x0F));
 }
 
 /******************************************************************************
@@ -65,7 +184,8 @@ static void LCD_Send4Bits(uint8_t nibble)
 
 /*
  * LCD_Init
- * Initializes the LCD in 4-bit mode.
+ * Initializes the LCD in 4-bit mode. Returns at once; the ~60ms power-up
+ * sequence runs from the timer interrupt.
  */
 void LCD_Init(void)
 {
@@ -81,25 +201,31 @@ void LCD_Init(void)
     DIO_WritePin(LCD_PORT, LCD_RS, LOW);
     DIO_WritePin(LCD_PORT, LCD_EN, LOW);
     
-    /* Wait for LCD to power up (>15ms after VCC reaches 4.5V) */
-    DelayMs(50);
-    
-    /* Initialization sequence for 4-bit mode */
-    /* Send 0x03 three times to ensure 8-bit mode is cleared */
-    DIO_WritePin(LCD_PORT, LCD_RS, LOW);  /* Command mode */
-    
-    LCD_Send4Bits(0x03);
-    DelayMs(5);
-    
-    LCD_Send4Bits(0x03);
-    DelayMs(1);
-    
-    LCD_Send4Bits(0x03);
-    DelayMs(1);
+    /* Timer2A drains the nibble queue */
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER2);
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_TIMER2)) {
+    }
+    TimerConfigure(TIMER2_BASE, TIMER_CFG_A_ONE_SHOT);
+    ticks_per_us = SysCtlClockGet() / 1000000;
+    TimerIntRegister(TIMER2_BASE, TIMER_A, LCD_TimerISR);
+    TimerIntEnable(TIMER2_BASE, TIMER_TIMA_TIMEOUT);
     
-    /* Set to 4-bit mode */
-    LCD_Send4Bits(0x02);
-    DelayMs(1);
+    /*
+     * Power-up sequence, queued like everything else so the caller can
+     * bring up other peripherals meanwhile (RS stays 0 for these nibbles).
+     * Wait for LCD to power up (>15ms after VCC reaches 4.5V), then send
+     * 0x03 three times to ensure 8-bit mode is cleared, then 0x02 for
+     * 4-bit mode.
+     */
+    LCD_Enqueue(OP_WAIT | 50);
+    LCD_Enqueue(0x03);
+    LCD_Enqueue(OP_WAIT | 5);
+    LCD_Enqueue(0x03);
+    LCD_Enqueue(OP_WAIT | 1);
+    LCD_Enqueue(0x03);
+    LCD_Enqueue(OP_WAIT | 1);
+    LCD_Enqueue(0x02);
+    LCD_Enqueue(OP_WAIT | 1);
     
     /* Function set: 4-bit mode, 2 lines, 5x8 font */
     LCD_SendCommand(LCD_4BIT_MODE);
@@ -116,41 +242,24 @@ void LCD_Init(void)
 
 /*
  * LCD_SendCommand
- * Sends a command to the LCD (RS = 0).
+ * Queues a command for the LCD (RS = 0). Returns immediately.
  */
 void LCD_SendCommand(uint8_t command)
 {
-    DIO_WritePin(LCD_PORT, LCD_RS, LOW);  /* Command mode */
-    
-    /* Send upper nibble */
-    LCD_Send4Bits(command >> 4);
-    
-    /* Send lower nibble */
-    LCD_Send4Bits(command & 0x0F);
-    
-    /* Wait for command to execute */
     if (command == LCD_CLEAR || command == LCD_HOME) {
-        DelayMs(2);  /* Clear and home commands take longer */
+        LCD_EnqueueByte(command, 0, OP_SLOW);  /* Clear and home take longer */
     } else {
-        DelayMs(1);
+        LCD_EnqueueByte(command, 0, OP_EXEC);
     }
 }
 
 /*
  * LCD_SendData
- * Sends a data byte to the LCD (RS = 1).
+ * Queues a data byte for the LCD (RS = 1). Returns immediately.
  */
 void LCD_SendData(uint8_t data)
 {
-    DIO_WritePin(LCD_PORT, LCD_RS, HIGH);  /* Data mode */
-    
-    /* Send upper nibble */
-    LCD_Send4Bits(data >> 4);
-    
-    /* Send lower nibble */
-    LCD_Send4Bits(data & 0x0F);
-    
-    DelayMs(1);  /* Wait for data to be written */
+    LCD_EnqueueByte(data, OP_RS, OP_EXEC);
 }
 
 /*
@@ -160,7 +269,6 @@ void LCD_SendData(uint8_t data)
 void LCD_Clear(void)
 {
     LCD_SendCommand(LCD_CLEAR);
-    DelayMs(2);  /* Clear command takes longer to execute */
 }
 
 /*
@@ -203,3 +311,13 @@ void LCD_WriteChar(char c)
 {
     LCD_SendData(c);
 }
+
+/*
+ * LCD_SetIdleCallback
+ * Registers a function called (from the timer ISR) each time the queue
+ * finishes draining. NULL disables it.
+ */
+void LCD_SetIdleCallback(void (*callback)(void))
+{
+    idle_callback = callback;
+}
@@ -1,6 +1,8 @@
 /*****************************************************************************
  * File: lcd.h
  * Description: Header for 16x2 LCD Driver (4-bit mode)
+ *              Writes are queued and drained by a Timer2A interrupt; the
+ *              functions below return without waiting for the LCD.
  * Author: Ahmedhh
  * Date: December 4, 2025
  * 
@@ -39,20 +41,21 @@
 /*
  * LCD_Init
  * Initializes the LCD in 4-bit mode.
- * Must be called before any other LCD function.
+ * Must be called before any other LCD function. Returns immediately; the
+ * power-up sequence is queued ahead of later writes.
  */
 void LCD_Init(void);
 
 /*
  * LCD_SendCommand
- * Sends a command to the LCD (RS = 0).
+ * Queues a command for the LCD (RS = 0).
  * Parameters: command - LCD command byte
  */
 void LCD_SendCommand(uint8_t command);
 
 /*
  * LCD_SendData
- * Sends a data byte to the LCD (RS = 1).
+ * Queues a data byte for the LCD (RS = 1).
  * Parameters: data - Character to display
  */
 void LCD_SendData(uint8_t data);
@@ -86,4 +89,12 @@ void LCD_WriteString(const char *str);
  */
 void LCD_WriteChar(char c);
 
+/*
+ * LCD_SetIdleCallback
+ * Registers a function called from the timer interrupt each time the
+ * queue finishes draining (keep it short). NULL disables it.
+ * Parameters: callback - Function to call, or NULL
+ */
+void LCD_SetIdleCallback(void (*callback)(void));
+
 #endif /* LCD_H */
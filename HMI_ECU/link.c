@@ -0,0 +1,512 @@
+/******************************************************************************
+ * File: link.c
+ * Module: Control ECU Link
+ * Description: Non-blocking request/reply exchange with the Control ECU,
+ *              plus idle-time heartbeats for RTT statistics and loss
+ *              detection. On an RS-485 multidrop bus (UART2_MULTIDROP) the
+ *              lines are queued and sent when the Control ECU polls us.
+ *              Requests carry a sequence tag and are resent with
+ *              exponential backoff until a reply with that tag starts
+ *              (see the Control ECU's arq.h).
+ ******************************************************************************/
+
+#include "link.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "fmt.h"
+#include "systick.h"
+#include "transport.h"
+
+static bool busy = false;
+static bool heartbeat = false;          // The outstanding request is ours
+static bool numeric = false;
+static uint8_t *block_buf = NULL;       // Binary reply expected when set
+static uint16_t block_size = 0;
+static uint16_t block_len = 0;
+static uint16_t block_pos = 0;          // Bytes received, header included
+static uint8_t block_sum = 0;
+static bool got_digit = false;
+static uint32_t number = 0;
+static uint32_t sent_ms = 0;
+static uint32_t sent_us = 0;
+static uint16_t timeout = 0;
+static bool line_start = true;          // Last byte was '\n', or none yet
+static uint8_t ready_pos = 0;           // Of "RDY:" matched at a line start
+static bool in_ready_frame = false;     // Inside "RDY:<s>\n"
+static char ready_status = '0';
+
+static bool online = true;
+static uint8_t missed = 0;
+static uint32_t last_traffic_ms = 0;
+static LinkRttStats rtt = { 0, 0, 0xFFFFFFFF, 0, 0, { 0 }, 0 };
+
+static char seq = LINK_SEQ_LAST;        // Tag of the outstanding request
+static char line_buf[LINK_LINE_SIZE];   // Its line, kept for resending
+static bool matched = false;            // Reply tag for seq received
+static bool tag_pending = false;        // Tag character seen, seq next
+static uint8_t retries_left = 0;
+static uint16_t rto_ms = 0;
+static uint32_t activity_ms = 0;       // Last send or received byte
+static bool first_attempt = false;      // Not yet sent (multidrop queue)
+static bool settle = false;             // A rerun reply may still arrive
+static bool held = false;               // Not sent until the line is quiet
+
+static char tx_buf[LINK_TX_SIZE];       // Multidrop: lines awaiting a poll
+static uint8_t tx_len = 0;
+static uint8_t request_pos = 0;         // Where the queued request starts
+static bool request_queued = false;     // Request in tx_buf, not yet sent
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+/*
+ * Link_Put
+ * Sends a string now, or in multidrop mode queues it for the next poll.
+ * Whatever does not fit in the queue is dropped; the request then times out.
+ */
+static void Link_Put(const char *str)
+{
+    if (!UART2_MULTIDROP)
+    {
+        Transport_SendString(str);
+        return;
+    }
+
+    while (*str != '\0' && tx_len < LINK_TX_SIZE)
+        tx_buf[tx_len++] = *str++;
+}
+
+/*
+ * Link_AnswerPoll
+ * Multidrop only: answers a poll with everything queued (an empty frame if
+ * nothing is). The reply timer of a queued request restarts here, so time
+ * spent waiting for our turn on the bus is not counted as link latency.
+ */
+static void Link_AnswerPoll(void)
+{
+    uint8_t i;
+
+    if (!UART2_MULTIDROP || !UART2_TakePoll())
+        return;
+
+    UART2_BeginFrame(0, UART2_FRAME_DATA);
+    for (i = 0; i < tx_len; i++)
+        UART2_SendChar(tx_buf[i]);
+    UART2_EndFrame();
+    tx_len = 0;
+
+    if (request_queued)
+    {
+        request_queued = false;
+        activity_ms = SysTick_GetMs();
+        if (first_attempt)
+        {
+            first_attempt = false;
+            sent_ms = activity_ms;
+            sent_us = SysTick_GetUs();
+        }
+    }
+}
+
+/*
+ * Link_Transmit
+ * Sends (or queues) line_buf; a queued copy not yet sent is replaced.
+ */
+static void Link_Transmit(void)
+{
+    if (request_queued)
+        tx_len = request_pos;   // Superseded before it was ever sent
+    request_pos = tx_len;
+    Link_Put(line_buf);
+    Transport_Flush();
+    request_queued = UART2_MULTIDROP;
+    activity_ms = SysTick_GetMs();
+}
+
+static void Link_Send(const char *prefix, const char *data, uint16_t timeout_ms)
+{
+    FmtBuf f;
+
+    // A request cuts an outstanding heartbeat short: its reply is dropped
+    // below, so it is never answered
+    if (busy && heartbeat)
+        rtt.lost++;
+    while (Transport_IsDataAvailable())
+        Transport_ReceiveChar();
+
+    seq = (seq >= LINK_SEQ_LAST) ? LINK_SEQ_FIRST : (char)(seq + 1);
+    Fmt_Init(&f, line_buf, sizeof(line_buf));
+    Fmt_Char(&f, LINK_SEQ_TAG);
+    Fmt_Char(&f, seq);
+    Fmt_Str(&f, prefix);
+    Fmt_Str(&f, data);
+    Fmt_Char(&f, '\n');
+    // After a rerun reply, wait for the line to go quiet (Link_Receive)
+    held = settle;
+    settle = false;
+    if (held)
+        activity_ms = SysTick_GetMs();
+    else
+        Link_Transmit();
+    first_attempt = UART2_MULTIDROP;
+    matched = false;
+    tag_pending = false;
+    retries_left = LINK_ARQ_RETRIES;
+    rto_ms = LINK_ARQ_RTO_MS;
+
+    busy = true;
+    heartbeat = false;
+    line_start = true;
+    ready_pos = 0;
+    in_ready_frame = false;
+    got_digit = false;
+    number = 0;
+    block_pos = 0;
+    block_sum = 0;
+    sent_ms = SysTick_GetMs();
+    sent_us = SysTick_GetUs();
+    timeout = timeout_ms;
+    last_traffic_ms = sent_ms;
+}
+
+/*
+ * Link_ReceiveBlock
+ * Takes one byte of a binary reply. Any byte value is data here, so RDY
+ * frames are not recognised until the block is complete.
+ */
+static char Link_ReceiveBlock(uint8_t b)
+{
+    if (block_pos >= 2 && block_pos == block_len + 2u)
+    {
+        busy = false;   // Checksum byte
+        return (b == block_sum) ? LINK_BLOCK : LINK_CORRUPT;
+    }
+
+    if (block_pos == 0)
+    {
+        block_len = b;
+    }
+    else if (block_pos == 1)
+    {
+        block_len |= (uint16_t)b << 8;
+        if (block_len > block_size)
+        {
+            busy = false;
+            return LINK_CORRUPT;
+        }
+    }
+    else
+    {
+        block_buf[block_pos - 2] = b;
+    }
+
+    block_sum += b;
+    block_pos++;
+    return LINK_PENDING;
+}
+
+/*
+ * Link_MatchReady
+ * True while c continues "RDY:" from the start of a line; the frame's
+ * status and '\n' follow. Anything else ends the match and is parsed as
+ * part of a reply.
+ */
+static bool Link_MatchReady(char c, bool at_line_start)
+{
+    static const char prefix[] = "RDY:";
+
+    if (c != prefix[ready_pos] || (ready_pos == 0 && !at_line_start))
+    {
+        ready_pos = 0;
+        return false;
+    }
+    if (++ready_pos == sizeof(prefix) - 1)
+    {
+        ready_pos = 0;
+        in_ready_frame = true;
+    }
+    return true;
+}
+
+/*
+ * Link_Receive
+ * Parses the reply to the outstanding request (whoever owns it). A held
+ * request goes out once nothing has arrived for LINK_SETTLE_MS; what
+ * arrives before that is dropped.
+ */
+static char Link_Receive(void)
+{
+    char c, r;
+    bool at_line_start;
+
+    if (held)
+    {
+        while (Transport_IsDataAvailable())
+        {
+            Transport_ReceiveChar();
+            activity_ms = SysTick_GetMs();
+        }
+        if ((SysTick_GetMs() - activity_ms) >= LINK_SETTLE_MS)
+        {
+            held = false;
+            Link_Transmit();
+            sent_us = SysTick_GetUs();
+        }
+    }
+
+    while (!held && Transport_IsDataAvailable())
+    {
+        c = Transport_ReceiveChar();
+        activity_ms = SysTick_GetMs();
+        at_line_start = line_start;
+        line_start = (c == '\n');
+        if (matched && block_buf != NULL)
+        {
+            r = Link_ReceiveBlock((uint8_t)c);
+            if (r != LINK_PENDING)
+                return r;
+        }
+        else if (in_ready_frame)
+        {
+            if (c == '\n')
+            {
+                in_ready_frame = false;
+                busy = false;
+                return LINK_READY;
+            }
+            if (c == '0' || c == '1')
+                ready_status = c;
+        }
+        else if (Link_MatchReady(c, at_line_start))
+        {
+            // Unsolicited RDY frame: the Control ECU restarted
+        }
+        else if (!matched)
+        {
+            // Skip everything up to our tag (late replies to older requests)
+            if (tag_pending)
+                matched = (c == seq);
+            tag_pending = (c == LINK_SEQ_TAG);
+        }
+        else if (numeric)
+        {
+            if (c >= '0' && c <= '9')
+            {
+                number = number * 10 + (uint32_t)(c - '0');
+                got_digit = true;
+            }
+            else if (c == '\n' && got_digit)
+            {
+                busy = false;
+                return LINK_NUMBER;
+            }
+        }
+        else if (c == '0' || c == '1' || c == 'L' || c == 'S' || c == 'G')
+        {
+            busy = false;
+            return c;
+        }
+    }
+
+    if ((SysTick_GetMs() - sent_ms) >= timeout)
+    {
+        busy = false;
+        return LINK_TIMEOUT;
+    }
+
+    // Reply lost or stalled: resend with the same tag, backing off. A reply
+    // still streaming in keeps activity_ms fresh and is left alone.
+    if (!held && retries_left > 0 && (SysTick_GetMs() - activity_ms) >= rto_ms)
+    {
+        retries_left--;
+        rto_ms = (rto_ms * 2 < LINK_ARQ_RTO_MAX_MS) ? (uint16_t)(rto_ms * 2) : LINK_ARQ_RTO_MAX_MS;
+        matched = false;
+        tag_pending = false;
+        in_ready_frame = false;     // A frame cut short by a lost byte
+        ready_pos = 0;
+        got_digit = false;
+        number = 0;
+        block_pos = 0;
+        block_sum = 0;
+        rtt.retransmits++;
+        Link_Transmit();
+    }
+    return LINK_PENDING;
+}
+
+/*
+ * Link_Track
+ * Updates liveness from the outcome of any exchange.
+ */
+static void Link_Track(char result)
+{
+    if (result == LINK_PENDING)
+        return;
+
+    if (result == LINK_TIMEOUT)
+    {
+        if (missed < LINK_MAX_MISSED)
+            missed++;
+        if (missed >= LINK_MAX_MISSED)
+            online = false;
+    }
+    else
+    {
+        missed = 0;
+        online = true;
+    }
+    last_traffic_ms = SysTick_GetMs();
+}
+
+static void Link_RecordRtt(uint32_t us)
+{
+    uint8_t bucket = 0;
+
+    while (bucket < LINK_RTT_BUCKETS - 1 && (us >> (bucket + 1)) != 0)
+        bucket++;
+    if (rtt.hist[bucket] != 0xFFFF)
+        rtt.hist[bucket]++;
+
+    rtt.count++;
+    rtt.sum_us += us;
+    if (us < rtt.min_us)
+        rtt.min_us = us;
+    if (us > rtt.max_us)
+        rtt.max_us = us;
+}
+
+/******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+
+void Link_Request(const char *prefix, const char *data, uint16_t timeout_ms)
+{
+    numeric = false;
+    block_buf = NULL;
+    Link_Send(prefix, data, timeout_ms);
+}
+
+void Link_RequestNumber(const char *prefix, const char *data, uint16_t timeout_ms)
+{
+    numeric = true;
+    block_buf = NULL;
+    Link_Send(prefix, data, timeout_ms);
+}
+
+void Link_RequestBlock(const char *prefix, const char *data,
+                       uint8_t *buf, uint16_t size, uint16_t timeout_ms)
+{
+    numeric = false;
+    block_buf = buf;
+    block_size = size;
+    Link_Send(prefix, data, timeout_ms);
+}
+
+uint16_t Link_BlockLength(void)
+{
+    return block_len;
+}
+
+char Link_Poll(void)
+{
+    char r;
+
+    Link_AnswerPoll();
+    if (!busy || heartbeat)
+        return LINK_PENDING;
+
+    r = Link_Receive();
+    // Block and number replies are not cached: a resent request ran twice,
+    // and the second reply may still be on its way
+    if (r != LINK_PENDING && (block_buf != NULL || numeric) &&
+        retries_left < LINK_ARQ_RETRIES)
+        settle = true;
+    Link_Track(r);
+    return r;
+}
+
+void Link_Service(void)
+{
+    char r;
+
+    Link_AnswerPoll();
+    if (busy && heartbeat)
+    {
+        r = Link_Receive();
+        if (r == LINK_PENDING)
+            return;
+        if (r == '1')
+            Link_RecordRtt(SysTick_GetUs() - sent_us);
+        else if (r == LINK_TIMEOUT)
+            rtt.lost++;
+        Link_Track(r);
+    }
+    else if (!busy && (SysTick_GetMs() - last_traffic_ms) >= LINK_HEARTBEAT_MS)
+    {
+        numeric = false;
+        block_buf = NULL;
+        Link_Send("HBT", "", LINK_HEARTBEAT_TIMEOUT_MS);
+        heartbeat = true;
+        retries_left = 0;   // A lost heartbeat is the measurement
+    }
+}
+
+void Link_Notify(const char *prefix, const char *data)
+{
+    Link_Put(prefix);
+    Link_Put(data);
+    Link_Put("\n");
+    Transport_Flush();
+    last_traffic_ms = SysTick_GetMs();
+}
+
+bool Link_IsOnline(void)
+{
+    return online;
+}
+
+const LinkRttStats *Link_RttStats(void)
+{
+    return &rtt;
+}
+
+uint32_t Link_RttAvgUs(void)
+{
+    return rtt.count ? (uint32_t)(rtt.sum_us / rtt.count) : 0;
+}
+
+uint32_t Link_RttP99Us(void)
+{
+    uint32_t total = 0, seen = 0;
+    uint8_t i;
+
+    for (i = 0; i < LINK_RTT_BUCKETS; i++)
+        total += rtt.hist[i];
+    if (total == 0)
+        return 0;
+
+    for (i = 0; i < LINK_RTT_BUCKETS - 1; i++)
+    {
+        seen += rtt.hist[i];
+        if (seen * 100 >= total * 99)
+            return (2UL << i) - 1;  // Upper edge of bucket i
+    }
+    return rtt.max_us;
+}
+
+char Link_ReadyStatus(void)
+{
+    return ready_status;
+}
+
+uint32_t Link_Number(void)
+{
+    return number;
+}
+
+bool Link_Busy(void)
+{
+    return busy && !heartbeat;
+}
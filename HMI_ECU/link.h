@@ -0,0 +1,176 @@
+/******************************************************************************
+ * File: link.h
+ * Module: Control ECU Link
+ * Description: Non-blocking request/reply exchange with the Control ECU over
+ *              UART2. One request is outstanding at a time; the caller polls
+ *              for the reply instead of waiting for it. While the line is
+ *              idle, Link_Service exchanges heartbeats to measure round-trip
+ *              time and detect a lost Control ECU.
+ ******************************************************************************/
+
+#ifndef LINK_H_
+#define LINK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+/* Link_Poll results besides the reply byte itself ('0', '1', 'L', 'S', 'G') */
+#define LINK_PENDING   0    /* Still waiting */
+#define LINK_TIMEOUT   'X'  /* No reply within the request's timeout */
+#define LINK_NUMBER    'N'  /* Numeric line reply complete: see Link_Number */
+#define LINK_READY     'R'  /* Control ECU (re)started: see Link_ReadyStatus */
+#define LINK_BLOCK     'B'  /* Binary reply complete: see Link_BlockLength */
+#define LINK_CORRUPT   'C'  /* Binary reply too long or bad checksum */
+
+#define LINK_DEFAULT_TIMEOUT_MS 5000
+
+/*
+ * Heartbeat ("HBT" -> '1'): sent after LINK_HEARTBEAT_MS without traffic,
+ * so it costs nothing while requests are flowing. The link is declared
+ * offline after LINK_MAX_MISSED consecutive heartbeats or requests go
+ * unanswered, i.e. within
+ *   LINK_MAX_MISSED * (LINK_HEARTBEAT_MS + LINK_HEARTBEAT_TIMEOUT_MS)
+ * (2.1 s with the defaults) of the Control ECU going silent.
+ */
+#define LINK_HEARTBEAT_MS           500
+#define LINK_HEARTBEAT_TIMEOUT_MS   200
+#define LINK_MAX_MISSED             3
+
+/*
+ * Retransmission: each request goes out as "^<seq><line>" (seq 'a'..'z').
+ * If nothing arrives for LINK_ARQ_RTO_MS before the reply is complete, it
+ * is resent up to LINK_ARQ_RETRIES times, the wait doubling each time up to
+ * LINK_ARQ_RTO_MAX_MS; the request's own timeout still bounds the whole
+ * exchange. The Control ECU answers a resent line from its reply cache,
+ * so commands run once. Heartbeats are never resent.
+ *
+ * Number and block replies (BOT, LOG, STAT, ...) are too long for that
+ * cache: a resend runs the command again and its reply follows the first.
+ * After such an exchange the next request is held until nothing has
+ * arrived for LINK_SETTLE_MS, and what arrives meanwhile is dropped.
+ */
+#define LINK_SEQ_TAG            '^'
+#define LINK_SEQ_FIRST          'a'
+#define LINK_SEQ_LAST           'z'
+#define LINK_ARQ_RTO_MS         150
+#define LINK_ARQ_RTO_MAX_MS     1200
+#define LINK_ARQ_RETRIES        6
+#define LINK_SETTLE_MS          20
+#define LINK_LINE_SIZE          32  /* Control ECU's COMMAND_BUFFER_SIZE */
+
+/* Multidrop: bytes of requests/notifications queued between polls (matches
+ * the Control ECU's BUS_PAYLOAD_SIZE) */
+#define LINK_TX_SIZE 64
+
+/* RTT histogram: bucket i counts RTTs in [2^i, 2^(i+1)) us, the last one
+ * everything above */
+#define LINK_RTT_BUCKETS 16
+
+typedef struct
+{
+    uint32_t count;                     /* Heartbeats answered */
+    uint32_t lost;                      /* Heartbeats unanswered or cut short */
+    uint32_t min_us;
+    uint32_t max_us;
+    uint64_t sum_us;
+    uint16_t hist[LINK_RTT_BUCKETS];    /* Saturating counters */
+    uint32_t retransmits;               /* Requests resent (ARQ) */
+} LinkRttStats;
+
+/******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+/*
+ * Link_Request
+ * Discards stale RX bytes, sends "<prefix><data>\n" and arms the timeout.
+ * The reply is a single status byte ('0', '1', 'L', 'S' or 'G').
+ */
+void Link_Request(const char *prefix, const char *data, uint16_t timeout_ms);
+
+/*
+ * Link_RequestNumber
+ * As Link_Request, for commands answered with ASCII digits + '\n' (LCK).
+ */
+void Link_RequestNumber(const char *prefix, const char *data, uint16_t timeout_ms);
+
+/*
+ * Link_RequestBlock
+ * As Link_Request, for commands answered with a binary block (STAT):
+ * uint16 LE payload length, payload, 8-bit sum of all preceding bytes.
+ * The payload is stored in buf (at most size bytes).
+ */
+void Link_RequestBlock(const char *prefix, const char *data,
+                       uint8_t *buf, uint16_t size, uint16_t timeout_ms);
+
+/*
+ * Link_BlockLength
+ * Payload length of the last completed binary reply.
+ */
+uint16_t Link_BlockLength(void);
+
+/*
+ * Link_Poll
+ * Non-blocking. Returns LINK_PENDING while waiting, otherwise the reply byte,
+ * LINK_NUMBER, LINK_BLOCK, LINK_CORRUPT, LINK_READY or LINK_TIMEOUT (each
+ * reported once per request).
+ */
+char Link_Poll(void);
+
+/*
+ * Link_Notify
+ * Sends "<prefix><data>\n" for a command that has no reply (BTM). Does not
+ * touch an outstanding request.
+ */
+void Link_Notify(const char *prefix, const char *data);
+
+/*
+ * Link_ReadyStatus
+ * Status byte of the last "RDY:<s>" frame ('1' password set, '0' not).
+ * The frame is only recognised at the start of a line.
+ * A RDY frame arriving while a request is outstanding ends that request
+ * with LINK_READY: the Control ECU restarted and will not answer it.
+ */
+char Link_ReadyStatus(void);
+
+/*
+ * Link_Service
+ * Call every main loop pass: sends heartbeats while idle and collects
+ * their replies.
+ */
+void Link_Service(void);
+
+/*
+ * Link_IsOnline
+ * False once LINK_MAX_MISSED exchanges in a row went unanswered; true again
+ * on the next reply (or RDY frame).
+ */
+bool Link_IsOnline(void);
+
+/*
+ * Link_RttStats / Link_RttAvgUs / Link_RttP99Us
+ * Heartbeat round-trip statistics. The p99 is the upper edge of the
+ * histogram bucket holding the 99th percentile (0 with no samples).
+ */
+const LinkRttStats *Link_RttStats(void);
+uint32_t Link_RttAvgUs(void);
+uint32_t Link_RttP99Us(void);
+
+/*
+ * Link_Number
+ * Value of the last completed numeric reply.
+ */
+uint32_t Link_Number(void);
+
+/*
+ * Link_Busy
+ * True while a request is outstanding (heartbeats do not count: a request
+ * simply takes over from one in flight).
+ */
+bool Link_Busy(void);
+
+#endif /* LINK_H_ */
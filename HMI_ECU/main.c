@@ -1,38 +1,225 @@
 /******************************************************************************
- * File: main_sender.c (HMI_ECU)
- * Description: Full System with 3-Attempt Lockout for Open & Change Password
+ * File: main.c (HMI_ECU)
+ * Description: Door lock user flows as a UI screen table (see ui.h).
+ *              Login/setup, open door, change password, set timeout and
+ *              lockout are all non-blocking; replies from the Control ECU
+ *              are polled through link.c.
  ******************************************************************************/
 
 #include <stdint.h>
 #include <stdbool.h>
 #include <string.h>
-#include <stdio.h>
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/gpio.h"
 #include "adc.h"
+#include "boottime.h"
+#include "diag.h"
+#include "fmt.h"
 #include "keypad.h"
 #include "lcd.h"
 #include "led.h"
+#include "link.h"
+#include "profile.h"
 #include "systick.h"
+#include "trace.h"
+#include "transport.h"
 #include "uart.h"
+#include "ui.h"
+#include "wait.h"
 
 #define PASSWORD_LENGTH 5
+#define MAX_ATTEMPTS 3
+#define LOCKOUT_SECONDS 20      // Shown until the Control ECU reports the real value
+#define STS_RETRIES 5
+#define STS_RETRY_MS 300
+#define LCK_TIMEOUT_MS 500
+#define BOOT_STS_TIMEOUT_MS 1000 // Re-ask only if neither STS reply nor RDY came
+#define ADC_SAMPLE_MS 100       // Timeout adjust refresh
+#define STAT_TIMEOUT_MS 1000
+
+/******************************************************************************
+ * Screens
+ ******************************************************************************/
+enum
+{
+    SCR_SPLASH,
+    SCR_BOOT_LOCK_CHECK,
+    /* Login / first-time setup */
+    SCR_LOGIN_ENTER,
+    SCR_LOGIN_STATUS,
+    SCR_LOGIN_CHECK,
+    SCR_LOGIN_WRONG,
+    SCR_LOGIN_NO_REPLY,
+    SCR_WELCOME,
+    SCR_GUEST_OPEN,
+    SCR_GUEST_GRANTED,
+    SCR_GUEST_DENIED,
+    SCR_SETUP_CONFIRM,
+    SCR_SETUP_SAVE,
+    SCR_SETUP_DONE,
+    SCR_SETUP_FAILED,
+    SCR_SETUP_MISMATCH,
+    /* Main menu */
+    SCR_MENU,
+    /* A: Open door */
+    SCR_OPEN_ENTER,
+    SCR_OPEN_VERIFY,
+    SCR_OPEN_GRANTED,
+    SCR_OPEN_WRONG,
+    SCR_OPEN_DENIED,
+    SCR_NO_REPLY,
+    /* B: Change password */
+    SCR_CHG_OLD_ENTER,
+    SCR_CHG_OLD_CHECK,
+    SCR_CHG_OLD_WRONG,
+    SCR_CHG_NEW_ENTER,
+    SCR_CHG_NEW_CONFIRM,
+    SCR_CHG_SAVE,
+    SCR_CHG_DONE,
+    SCR_CHG_SAVE_ERR,
+    SCR_CHG_MISMATCH,
+    /* *: Set timeout */
+    SCR_TMO_ADJUST,
+    SCR_TMO_CONFIRM_MSG,
+    SCR_TMO_ENTER,
+    SCR_TMO_CHECK,
+    SCR_TMO_SAVE,
+    SCR_TMO_SAVED,
+    SCR_TMO_SAVE_ERR,
+    SCR_TMO_WRONG,
+    /* Lockout */
+    SCR_LOCKOUT,
+    /* Link lost */
+    SCR_OFFLINE,
+    /* D (hidden): diagnostics */
+    SCR_DIAG,
+    /* C (hidden): firmware update bridge */
+    SCR_BRIDGE,
+    SCR_COUNT
+};
+
+/******************************************************************************
+ * Flow State
+ ******************************************************************************/
+static char password[PASSWORD_LENGTH + 1];
+static char new_pass1[PASSWORD_LENGTH + 1];
+static char new_pass2[PASSWORD_LENGTH + 1];
+static uint8_t attempts;
+static uint8_t sts_retries;
+static uint8_t timeout_val;
+static uint32_t adc_sampled_ms;
+static uint8_t diag_page;
+static UiScreenId lockout_exit;         // Where to go once the lockout ends
+static uint32_t lockout_remaining;      // Seconds, from lockout_start_ms
+static uint32_t lockout_start_ms;
+static uint32_t lockout_shown;
+static bool lockout_confirming;
 
 /******************************************************************************
  * Function Prototypes
  ******************************************************************************/
-void SystemLoginSequence(void);
-void MainMenu(void);
-void OpenDoorSequence(void);
-void ChangePasswordSequence(void);
-void SetTimeoutSequence(void);
-void CollectPassword(char *password);
-void SendCommandToControl(const char *prefix, const char *data);
-char CheckSystemStatus(void);
-char WaitForResponse(void);
-void LED_Init(void);
+static void LcdIdle(void);
+static void PasswordEntry_Key(char key);
+static void Boot_Enter(void);
+static void Boot_Tick(void);
+static void BootLockCheck_Enter(void);
+static void BootLockCheck_Tick(void);
+static void LoginEnter_Enter(void);
+static void LoginStatus_Enter(void);
+static void LoginStatus_Tick(void);
+static void LoginCheck_Enter(void);
+static void LoginCheck_Tick(void);
+static void GuestOpen_Enter(void);
+static void GuestOpen_Tick(void);
+static void SetupSave_Enter(void);
+static void ChgSave_Enter(void);
+static void PasswordSave_Tick(void);
+static void Menu_Key(char key);
+static void AttemptGuard_Enter(void);
+static void OpenVerify_Enter(void);
+static void OpenVerify_Tick(void);
+static void ChgOldCheck_Enter(void);
+static void ChgOldCheck_Tick(void);
+static void TmoAdjust_Enter(void);
+static void TmoAdjust_Tick(void);
+static void TmoAdjust_Key(char key);
+static void TmoCheck_Enter(void);
+static void TmoCheck_Tick(void);
+static void TmoSave_Enter(void);
+static void TmoSave_Tick(void);
+static void Lockout_Enter(void);
+static void Lockout_Tick(void);
+static void Offline_Tick(void);
+static void Diag_Enter(void);
+static void Diag_Tick(void);
+static void Diag_Key(char key);
+static void Bridge_Enter(void);
+static void Bridge_Tick(void);
+static void Bridge_Key(char key);
+static void CheckLink(void);
+
+/*
+ * Screen table.
+ * { line1, line2, led, hold_ms, next, entry, entry_len, on_enter, on_key, on_tick }
+ */
+static const UiScreen screens[SCR_COUNT] = {
+    [SCR_SPLASH]          = { "Door Lock System", NULL, UI_LED_OFF, 0, 0, NULL, 0, Boot_Enter, NULL, Boot_Tick },
+    [SCR_BOOT_LOCK_CHECK] = { "Door Lock System", NULL, UI_LED_OFF, 0, 0, NULL, 0, BootLockCheck_Enter, NULL, BootLockCheck_Tick },
+
+    [SCR_LOGIN_ENTER]     = { "Enter Password:", NULL, UI_LED_OFF, 0, SCR_LOGIN_STATUS, password, PASSWORD_LENGTH, LoginEnter_Enter, PasswordEntry_Key, NULL },
+    [SCR_LOGIN_STATUS]    = { "Processing...", NULL, UI_LED_OFF, 0, 0, NULL, 0, LoginStatus_Enter, NULL, LoginStatus_Tick },
+    [SCR_LOGIN_CHECK]     = { "Processing...", NULL, UI_LED_OFF, 0, 0, NULL, 0, LoginCheck_Enter, NULL, LoginCheck_Tick },
+    [SCR_LOGIN_WRONG]     = { "Wrong Password", NULL, LED_RED, 2000, SCR_LOGIN_ENTER, NULL, 0, NULL, NULL, NULL },
+    [SCR_LOGIN_NO_REPLY]  = { "No Response", "Try Again", LED_RED, 2000, SCR_LOGIN_ENTER, NULL, 0, NULL, NULL, NULL },
+    [SCR_WELCOME]         = { "Welcome Back!", NULL, LED_GREEN, 1000, SCR_MENU, NULL, 0, NULL, NULL, NULL },
+    [SCR_GUEST_OPEN]      = { "Verifying...", NULL, UI_LED_OFF, 0, 0, NULL, 0, GuestOpen_Enter, NULL, GuestOpen_Tick },
+    [SCR_GUEST_GRANTED]   = { "Welcome, Guest", "Door Unlocking", LED_GREEN, 3000, SCR_LOGIN_ENTER, NULL, 0, NULL, NULL, NULL },
+    [SCR_GUEST_DENIED]    = { "Access Denied", "Outside Hours", LED_RED, 2000, SCR_LOGIN_ENTER, NULL, 0, NULL, NULL, NULL },
+    [SCR_SETUP_CONFIRM]   = { "Re-enter to Set:", NULL, UI_LED_OFF, 0, SCR_SETUP_SAVE, new_pass2, PASSWORD_LENGTH, NULL, NULL, NULL },
+    [SCR_SETUP_SAVE]      = { "Processing...", NULL, UI_LED_OFF, 0, 0, NULL, 0, SetupSave_Enter, NULL, PasswordSave_Tick },
+    [SCR_SETUP_DONE]      = { "Setup Complete!", NULL, LED_GREEN, 1000, SCR_MENU, NULL, 0, NULL, NULL, NULL },
+    [SCR_SETUP_FAILED]    = { "Setup Failed!", NULL, LED_RED, 1000, SCR_LOGIN_ENTER, NULL, 0, NULL, NULL, NULL },
+    [SCR_SETUP_MISMATCH]  = { "Mismatch!", NULL, LED_RED, 2000, SCR_LOGIN_ENTER, NULL, 0, NULL, NULL, NULL },
+
+    [SCR_MENU]            = { "A:Open B:ChgPass", "*:Set Timeout", UI_LED_OFF, 0, 0, NULL, 0, NULL, Menu_Key, NULL },
+
+    [SCR_OPEN_ENTER]      = { "Enter Password:", NULL, UI_LED_OFF, 0, SCR_OPEN_VERIFY, password, PASSWORD_LENGTH, AttemptGuard_Enter, PasswordEntry_Key, NULL },
+    [SCR_OPEN_VERIFY]     = { "Verifying...", NULL, UI_LED_OFF, 0, 0, NULL, 0, OpenVerify_Enter, NULL, OpenVerify_Tick },
+    [SCR_OPEN_GRANTED]    = { "Access Granted", "Door Unlocking", LED_GREEN, 3000, SCR_MENU, NULL, 0, NULL, NULL, NULL },
+    [SCR_OPEN_WRONG]      = { "Wrong Password", "Try Again", LED_RED, 1500, SCR_OPEN_ENTER, NULL, 0, NULL, NULL, NULL },
+    [SCR_OPEN_DENIED]     = { "Access Denied", "Outside Hours", LED_RED, 2000, SCR_MENU, NULL, 0, NULL, NULL, NULL },
+    [SCR_NO_REPLY]        = { "No Response", "Try Again", LED_RED, 2000, SCR_MENU, NULL, 0, NULL, NULL, NULL },
+
+    [SCR_CHG_OLD_ENTER]   = { "Enter Old Pass:", NULL, UI_LED_OFF, 0, SCR_CHG_OLD_CHECK, password, PASSWORD_LENGTH, AttemptGuard_Enter, PasswordEntry_Key, NULL },
+    [SCR_CHG_OLD_CHECK]   = { "Checking...", NULL, UI_LED_OFF, 0, 0, NULL, 0, ChgOldCheck_Enter, NULL, ChgOldCheck_Tick },
+    [SCR_CHG_OLD_WRONG]   = { "Wrong Old Pass", NULL, LED_RED, 1500, SCR_CHG_OLD_ENTER, NULL, 0, NULL, NULL, NULL },
+    [SCR_CHG_NEW_ENTER]   = { "Enter New Pass:", NULL, UI_LED_OFF, 0, SCR_CHG_NEW_CONFIRM, new_pass1, PASSWORD_LENGTH, NULL, NULL, NULL },
+    [SCR_CHG_NEW_CONFIRM] = { "Confirm New:", NULL, UI_LED_OFF, 0, SCR_CHG_SAVE, new_pass2, PASSWORD_LENGTH, NULL, NULL, NULL },
+    [SCR_CHG_SAVE]        = { "Saving...", NULL, UI_LED_OFF, 0, 0, NULL, 0, ChgSave_Enter, NULL, PasswordSave_Tick },
+    [SCR_CHG_DONE]        = { "Pass Changed!", NULL, LED_GREEN, 2000, SCR_MENU, NULL, 0, NULL, NULL, NULL },
+    [SCR_CHG_SAVE_ERR]    = { "Save Error!", NULL, LED_RED, 2000, SCR_CHG_NEW_ENTER, NULL, 0, NULL, NULL, NULL },
+    [SCR_CHG_MISMATCH]    = { "Mismatch!", NULL, LED_RED, 2000, SCR_CHG_NEW_ENTER, NULL, 0, NULL, NULL, NULL },
+
+    [SCR_TMO_ADJUST]      = { "Adjust Timeout:", NULL, UI_LED_OFF, 0, 0, NULL, 0, TmoAdjust_Enter, TmoAdjust_Key, TmoAdjust_Tick },
+    [SCR_TMO_CONFIRM_MSG] = { "Confirm w/ Pass:", NULL, UI_LED_OFF, 1000, SCR_TMO_ENTER, NULL, 0, NULL, NULL, NULL },
+    [SCR_TMO_ENTER]       = { "Enter Password:", NULL, UI_LED_OFF, 0, SCR_TMO_CHECK, password, PASSWORD_LENGTH, NULL, PasswordEntry_Key, NULL },
+    [SCR_TMO_CHECK]       = { "Verifying...", NULL, UI_LED_OFF, 0, 0, NULL, 0, TmoCheck_Enter, NULL, TmoCheck_Tick },
+    [SCR_TMO_SAVE]        = { "Saving...", NULL, UI_LED_OFF, 0, 0, NULL, 0, TmoSave_Enter, NULL, TmoSave_Tick },
+    [SCR_TMO_SAVED]       = { "Timeout Saved!", NULL, LED_GREEN, 1500, SCR_MENU, NULL, 0, NULL, NULL, NULL },
+    [SCR_TMO_SAVE_ERR]    = { "Save Error!", NULL, LED_RED, 1500, SCR_MENU, NULL, 0, NULL, NULL, NULL },
+    [SCR_TMO_WRONG]       = { "Wrong Password", NULL, LED_RED, 1500, SCR_MENU, NULL, 0, NULL, NULL, NULL },
+
+    [SCR_LOCKOUT]         = { "System Locked!", NULL, LED_RED, 0, 0, NULL, 0, Lockout_Enter, NULL, Lockout_Tick },
+
+    [SCR_OFFLINE]         = { "Controller", "offline", LED_RED, 0, 0, NULL, 0, NULL, NULL, Offline_Tick },
+
+    [SCR_DIAG]            = { NULL, NULL, LED_BLUE, 0, 0, NULL, 0, Diag_Enter, Diag_Key, Diag_Tick },
+
+    [SCR_BRIDGE]          = { "Update bridge", "*:Exit", LED_BLUE, 0, 0, NULL, 0, Bridge_Enter, Bridge_Key, Bridge_Tick },
+};
+
 /******************************************************************************
  * Main Function
  ******************************************************************************/
@@ -42,520 +229,623 @@ int main(void)
     SysCtlClockSet(SYSCTL_SYSDIV_1 | SYSCTL_USE_OSC |
                    SYSCTL_XTAL_16MHZ | SYSCTL_OSC_MAIN);
 
-    SysTick_Init(16000, SYSTICK_NOINT);
-    UART2_Init();
+    SysTick_Init(16000, SYSTICK_INT);
+    BootTime_Mark(BOOT_CLOCK);
+    Profile_Init(); // PROFILE builds: sample from here on
+    Wait_Init();    // Watchdog from here on: init must not stall WATCHDOG_MS
+
+    /* LCD first: its ~60ms power-up runs from the timer ISR meanwhile */
     LCD_Init();
+    LCD_SetIdleCallback(LcdIdle);
+    Transport_Init();
     Keypad_Init();
     ADC_Init(); // Initialize Potentiometer
     LED_Init(); // Initialize LED
+    BootTime_Mark(BOOT_PERIPHERALS);
 
-    /* Startup Message */
-    LCD_Clear();
-    LCD_SetCursor(0, 0);
-    LCD_WriteString("Door Lock System");
-    DelayMs(1000);
+    UI_Init(screens, SCR_SPLASH);
 
-    /* Step 1: Login/Setup */
-    SystemLoginSequence();
-
-    /* Step 2: Main Menu */
     while (1)
     {
-        MainMenu();
+        Wait_Kick();
+
+        // The bridge hands the link to the update tool on the PC
+        if (UI_Current() != SCR_BRIDGE)
+        {
+            Link_Service();
+            CheckLink();
+        }
+        UI_Service();
     }
 }
 
 /******************************************************************************
- * Step 1: Login/Setup
+ * Helpers
  ******************************************************************************/
-void SystemLoginSequence(void)
+
+/*
+ * EnterLockout
+ * Shows the lockout countdown, then continues at exit_to.
+ */
+static void EnterLockout(UiScreenId exit_to)
 {
-    char pass1[PASSWORD_LENGTH + 1];
-    char pass2[PASSWORD_LENGTH + 1];
-    char status, response;
-    bool access_granted = false;
-    uint8_t i;
+    lockout_exit = exit_to;
+    UI_Goto(SCR_LOCKOUT);
+}
 
-    while (!access_granted)
-    {
-        for (i = 0; i < PASSWORD_LENGTH + 1; i++)
-        {
-            pass1[i] = 0;
-            pass2[i] = 0;
-        }
+/******************************************************************************
+ * Boot: wait for the Control ECU (STS reply or its RDY frame), then resume
+ * a lockout it still holds
+ ******************************************************************************/
 
-        LCD_Clear();
-        LCD_SetCursor(0, 0);
-        LCD_WriteString("Enter Password:");
-        LCD_SetCursor(1, 0);
-        CollectPassword(pass1);
+/* First time the LCD queue drains: power-up done and splash painted */
+static void LcdIdle(void)
+{
+    BootTime_Mark(BOOT_LCD);
+    LCD_SetIdleCallback(NULL);
+}
 
-        LCD_Clear();
-        LCD_WriteString("Processing...");
+static void Boot_Enter(void)
+{
+    // Answered at once if the Control ECU is up, else RDY ends the wait
+    Link_Request("STS", "", BOOT_STS_TIMEOUT_MS);
+}
 
-        status = CheckSystemStatus();
+static void Boot_Tick(void)
+{
+    char r = Link_Poll();
+    if (r == LINK_PENDING)
+        return;
 
-        if (status == '1')
-        {
-            /* Login Mode */
-            SendCommandToControl("CHK:", pass1);
-            response = WaitForResponse();
-            if (response == '1')
-            {
-                LED_On(LED_GREEN);
-                LCD_Clear();
-                LCD_WriteString("Welcome Back!");
-                DelayMs(1000);
-                access_granted = true;
-                LED_AllOff();
-            }
-            else
-            {
-                LED_On(LED_RED);
-                LCD_Clear();
-                LCD_WriteString("Wrong Password");
-                DelayMs(2000);
-                LED_AllOff();
-            }
-        }
-        else
-        {
-            /* Setup Mode */
-            LCD_Clear();
-            LCD_WriteString("Re-enter to Set:");
-            LCD_SetCursor(1, 0);
-            CollectPassword(pass2);
-            if (strcmp(pass1, pass2) == 0)
-            {
-                SendCommandToControl("SET:", pass1);
-                if (WaitForResponse() == '1')
-                {
-                    LED_On(LED_GREEN);
-                    LCD_Clear();
-                    LCD_WriteString("Setup Complete!");
-                    DelayMs(1000);
-                    access_granted = true;
-                    LED_AllOff();
-                }
-                else
-                {
-                    LED_On(LED_RED);
-                    LCD_Clear();
-                    LCD_WriteString("Setup Failed!");
-                    DelayMs(1000);
-                    LED_AllOff();
-                }
-            }
-            else
-            {
-                LED_On(LED_RED);
-                LCD_Clear();
-                LCD_WriteString("Mismatch!");
-                DelayMs(2000);
-                LED_AllOff();
-            }
-        }
+    if (r == LINK_TIMEOUT)
+    {
+        UI_SetLine(1, "Waiting for ECU");
+        Link_Request("STS", "", BOOT_STS_TIMEOUT_MS);
+        return;
     }
+
+    BootTime_Mark(BOOT_CONTROL_READY);
+    UI_Goto(SCR_BOOT_LOCK_CHECK);
+}
+
+static void BootLockCheck_Enter(void)
+{
+    Link_RequestNumber("LCK", "", LCK_TIMEOUT_MS);
+}
+
+static void BootLockCheck_Tick(void)
+{
+    char r = Link_Poll();
+    if (r == LINK_PENDING)
+        return;
+
+    if (r == LINK_NUMBER && Link_Number() > 0)
+        EnterLockout(SCR_LOGIN_ENTER);
+    else
+        UI_Goto(SCR_LOGIN_ENTER);
 }
 
 /******************************************************************************
- * Step 2: Main Menu
+ * Password Entry
  ******************************************************************************/
-void MainMenu(void)
+
+/*
+ * PasswordEntry_Key
+ * Entries of the stored password stream each key to the Control ECU as it
+ * is typed (ENT), so the CHK/PWD that follows the last digit is answered
+ * without reading the EEPROM. '#' and the first digit restart its copy.
+ * ENT has no reply; CHK/PWD still carry the whole password.
+ */
+static void PasswordEntry_Key(char key)
 {
-    char key = 0;
-    LCD_Clear();
-    LCD_SetCursor(0, 0);
-    LCD_WriteString("A:Open B:ChgPass");
-    LCD_SetCursor(1, 0);
-    LCD_WriteString("*:Set Timeout");
+    char digit[2] = { key, '\0' };
 
-    while (1)
-    {
-        key = Keypad_GetKey();
-        if (key == 'A')
-        {
-            OpenDoorSequence();
-            break;
-        }
-        else if (key == 'B')
-        {
-            ChangePasswordSequence();
-            break;
-        }
-        else if (key == '*')
-        {
-            SetTimeoutSequence();
-            break;
-        }
-        DelayMs(50);
-    }
+    if (key == '#' || password[1] == '\0')
+        Link_Notify("ENT", "");
+    if (key != '#')
+        Link_Notify("ENT:", digit);
 }
 
 /******************************************************************************
- * Step 3: Open Door (3 Attempts Logic)
+ * Login / Setup
  ******************************************************************************/
-void OpenDoorSequence(void)
+
+/* Reports cold-boot-to-first-prompt to the Control ECU (read back by BOT) */
+static void LoginEnter_Enter(void)
+{
+    char str_buffer[FMT_U32_DIGITS + 1];
+
+    if (BootTime_IsMarked(BOOT_FIRST_PROMPT))
+        return;
+    BootTime_Mark(BOOT_FIRST_PROMPT);
+    Fmt_U32(str_buffer, BootTime_Get(BOOT_FIRST_PROMPT));
+    Link_Notify("BTM:", str_buffer);
+}
+static void LoginStatus_Enter(void)
+{
+    sts_retries = 0;
+    Link_Request("STS", "", STS_RETRY_MS);
+}
+
+static void LoginStatus_Tick(void)
 {
-    char password[PASSWORD_LENGTH + 1];
-    char response;
-    uint8_t i, attempts = 0;
+    char r = Link_Poll();
+    if (r == LINK_PENDING)
+        return;
 
-    while (attempts < 3)
+    if (r == '1' || (r == LINK_READY && Link_ReadyStatus() == '1'))
+    {
+        UI_Goto(SCR_LOGIN_CHECK);
+    }
+    else if (r == LINK_TIMEOUT && ++sts_retries < STS_RETRIES)
+    {
+        Link_Request("STS", "", STS_RETRY_MS);
+    }
+    else
     {
-        for (i = 0; i < PASSWORD_LENGTH + 1; i++)
-            password[i] = 0;
+        /* No password stored (or no answer): first-time setup */
+        strcpy(new_pass1, password);
+        UI_Goto(SCR_SETUP_CONFIRM);
+    }
+}
 
-        LCD_Clear();
-        LCD_SetCursor(0, 0);
-        LCD_WriteString("Enter Password:");
-        LCD_SetCursor(1, 0);
-        CollectPassword(password);
+static void LoginCheck_Enter(void)
+{
+    Link_Request("CHK:", password, LINK_DEFAULT_TIMEOUT_MS);
+}
 
-        LCD_Clear();
-        LCD_WriteString("Verifying...");
+static void LoginCheck_Tick(void)
+{
+    char r = Link_Poll();
+    if (r == LINK_PENDING)
+        return;
+
+    if (r == '1')
+        UI_Goto(SCR_WELCOME);
+    else if (r == 'G')
+        UI_Goto(SCR_GUEST_OPEN); // One-time PIN: open the door, no menu
+    else if (r == 'L')
+        EnterLockout(SCR_LOGIN_ENTER);
+    else if (r == LINK_TIMEOUT || r == LINK_READY || r == LINK_CORRUPT)
+        UI_Goto(SCR_LOGIN_NO_REPLY); // Not a wrong password
+    else
+        UI_Goto(SCR_LOGIN_WRONG);
+}
 
-        SendCommandToControl("PWD:", password);
-        response = WaitForResponse();
+/*
+ * GuestOpen
+ * A one-time PIN entered at login opens the door with PWD, which uses the
+ * code up, and returns to login: guests never reach the menu.
+ */
+static void GuestOpen_Enter(void)
+{
+    Link_Request("PWD:", password, LINK_DEFAULT_TIMEOUT_MS);
+}
 
-        if (response == '1')
-        {
-            LED_On(LED_GREEN); // Turn on green LED
-            LCD_Clear();
-            LCD_SetCursor(0, 0);
-            LCD_WriteString("Access Granted");
-            LCD_SetCursor(1, 0);
-            LCD_WriteString("Door Unlocking");
-            DelayMs(3000);
-            LED_AllOff(); // Turn off green LED
-            return;
-        }
-        else
-        {
-            LED_On(LED_RED);
-            attempts++;
-            if (attempts < 3)
-            {
-                LCD_Clear();
-                LCD_SetCursor(0, 0);
-                LCD_WriteString("Wrong Password");
-                LCD_SetCursor(1, 0);
-                LCD_WriteString("Try Again");
-                DelayMs(1500);
-                LED_AllOff();
-            }
-            else
-            {
-                SendCommandToControl("ALM", "");
-                LCD_Clear();
-                LCD_SetCursor(0, 0);
-                LCD_WriteString("System Locked!");
-                LCD_SetCursor(1, 0);
-                LCD_WriteString("Wait 20s...");
-                for (i = 0; i < 20; i++)
-                    DelayMs(1000);
-                LED_AllOff();
-            }
-        }
-    }
+static void GuestOpen_Tick(void)
+{
+    char r = Link_Poll();
+    if (r == LINK_PENDING)
+        return;
+
+    if (r == '1')
+        UI_Goto(SCR_GUEST_GRANTED);
+    else if (r == 'S')
+        UI_Goto(SCR_GUEST_DENIED);
+    else if (r == 'L')
+        EnterLockout(SCR_LOGIN_ENTER);
+    else if (r == LINK_TIMEOUT || r == LINK_READY || r == LINK_CORRUPT)
+        UI_Goto(SCR_LOGIN_NO_REPLY);
+    else
+        UI_Goto(SCR_LOGIN_WRONG); // The code expired since CHK
+}
+
+/*
+ * SendNewPassword
+ * Sends SET for new_pass1 if both entries match, else shows mismatch_screen.
+ */
+static void SendNewPassword(UiScreenId mismatch_screen)
+{
+    if (strcmp(new_pass1, new_pass2) != 0)
+        UI_Goto(mismatch_screen);
+    else
+        Link_Request("SET:", new_pass1, LINK_DEFAULT_TIMEOUT_MS);
+}
+
+static void SetupSave_Enter(void)
+{
+    SendNewPassword(SCR_SETUP_MISMATCH);
+}
+
+static void ChgSave_Enter(void)
+{
+    SendNewPassword(SCR_CHG_MISMATCH);
+}
+
+/* Shared by setup and change password */
+static void PasswordSave_Tick(void)
+{
+    bool setup = (UI_Current() == SCR_SETUP_SAVE);
+    char r = Link_Poll();
+    if (r == LINK_PENDING)
+        return;
+
+    if (r == '1')
+        UI_Goto(setup ? SCR_SETUP_DONE : SCR_CHG_DONE);
+    else
+        UI_Goto(setup ? SCR_SETUP_FAILED : SCR_CHG_SAVE_ERR);
 }
 
 /******************************************************************************
- * Step 4: Change Password (Updated: 3 Attempts for Old Password)
+ * Main Menu
  ******************************************************************************/
-void ChangePasswordSequence(void)
+static void Menu_Key(char key)
 {
-    char old_pass[PASSWORD_LENGTH + 1];
-    char new_pass1[PASSWORD_LENGTH + 1];
-    char new_pass2[PASSWORD_LENGTH + 1];
-    uint8_t attempts = 0;
-    uint8_t i;
-    bool old_pass_correct = false;
-
-    // --- Part 1: Verify Old Password (Max 3 Attempts) ---
-    while (attempts < 3)
+    if (key == 'A')
     {
-        // Clear buffer
-        for (i = 0; i < PASSWORD_LENGTH + 1; i++)
-            old_pass[i] = 0;
+        attempts = 0;
+        UI_Goto(SCR_OPEN_ENTER);
+    }
+    else if (key == 'B')
+    {
+        attempts = 0;
+        UI_Goto(SCR_CHG_OLD_ENTER);
+    }
+    else if (key == '*')
+    {
+        UI_Goto(SCR_TMO_ADJUST);
+    }
+    else if (key == 'D')
+    {
+        diag_page = 0;
+        UI_Goto(SCR_DIAG); // Not listed on the menu
+    }
+    else if (key == 'C')
+    {
+        UI_Goto(SCR_BRIDGE); // Not listed on the menu
+    }
+}
 
-        LCD_Clear();
-        LCD_SetCursor(0, 0);
-        LCD_WriteString("Enter Old Pass:");
-        LCD_SetCursor(1, 0);
-        CollectPassword(old_pass);
+/*
+ * AttemptGuard_Enter
+ * Back to the menu after MAX_ATTEMPTS failures that did not end in a
+ * lockout (e.g. no reply from the Control ECU).
+ */
+static void AttemptGuard_Enter(void)
+{
+    if (attempts >= MAX_ATTEMPTS)
+        UI_Goto(SCR_MENU);
+}
 
-        LCD_Clear();
-        LCD_WriteString("Checking...");
+/******************************************************************************
+ * A: Open Door (3 Attempts Logic)
+ ******************************************************************************/
+static void OpenVerify_Enter(void)
+{
+    Link_Request("PWD:", password, LINK_DEFAULT_TIMEOUT_MS);
+}
 
-        SendCommandToControl("CHK:", old_pass);
+static void OpenVerify_Tick(void)
+{
+    char r = Link_Poll();
+    if (r == LINK_PENDING)
+        return;
 
-        if (WaitForResponse() == '1')
-        {
-            LED_On(LED_GREEN);
-            old_pass_correct = true;
-            LED_AllOff();
-            break; // Proceed to Step 2
-        }
-        else
-        {
-            LED_On(LED_RED);
-            attempts++;
-            if (attempts < 3)
-            {
-                LCD_Clear();
-                LCD_WriteString("Wrong Old Pass");
-                DelayMs(1500);
-                LED_AllOff();
-            }
-            else
-            {
-                // 3rd Failure: Alarm + Lockout
-                SendCommandToControl("ALM", "");
-                LCD_Clear();
-                LCD_SetCursor(0, 0);
-                LCD_WriteString("System Locked!");
-                LCD_SetCursor(1, 0);
-                LCD_WriteString("Wait 20s...");
-                for (i = 0; i < 20; i++)
-                    DelayMs(1000);
-                LED_AllOff();
-                return; // Return to Main Menu
-            }
-        }
+    if (r == '1')
+    {
+        UI_Goto(SCR_OPEN_GRANTED);
+    }
+    else if (r == 'L')
+    {
+        // 3rd failure: Control ECU has sounded the alarm and locked out
+        EnterLockout(SCR_MENU);
+    }
+    else if (r == 'S')
+    {
+        // Right password, but the door's access schedule is closed now
+        UI_Goto(SCR_OPEN_DENIED);
+    }
+    else if (r == LINK_TIMEOUT)
+    {
+        // Every resend went unanswered: not an attempt
+        UI_Goto(SCR_NO_REPLY);
     }
+    else
+    {
+        attempts++;
+        UI_Goto(SCR_OPEN_WRONG);
+    }
+}
 
-    // --- Part 2: Set New Password (If old was correct) ---
-    if (old_pass_correct)
+/******************************************************************************
+ * B: Change Password (3 Attempts for Old Password)
+ ******************************************************************************/
+static void ChgOldCheck_Enter(void)
+{
+    Link_Request("CHK:", password, LINK_DEFAULT_TIMEOUT_MS);
+}
+
+static void ChgOldCheck_Tick(void)
+{
+    char r = Link_Poll();
+    if (r == LINK_PENDING)
+        return;
+
+    if (r == '1')
     {
-        bool new_pass_set = false;
-        while (!new_pass_set)
-        {
-            for (i = 0; i < PASSWORD_LENGTH + 1; i++)
-            {
-                new_pass1[i] = 0;
-                new_pass2[i] = 0;
-            }
-
-            LCD_Clear();
-            LCD_SetCursor(0, 0);
-            LCD_WriteString("Enter New Pass:");
-            LCD_SetCursor(1, 0);
-            CollectPassword(new_pass1);
-
-            LCD_Clear();
-            LCD_SetCursor(0, 0);
-            LCD_WriteString("Confirm New:");
-            LCD_SetCursor(1, 0);
-            CollectPassword(new_pass2);
-
-            if (strcmp(new_pass1, new_pass2) == 0)
-            {
-                LCD_Clear();
-                LCD_WriteString("Saving...");
-                SendCommandToControl("SET:", new_pass1);
-
-                if (WaitForResponse() == '1')
-                {
-                    LED_On(LED_GREEN);
-                    LCD_Clear();
-                    LCD_WriteString("Pass Changed!");
-                    DelayMs(2000);
-                    new_pass_set = true;
-                    LED_AllOff();
-                }
-                else
-                {
-                    LED_On(LED_RED);
-                    LCD_Clear();
-                    LCD_WriteString("Save Error!");
-                    DelayMs(2000);
-                    LED_AllOff();
-                }
-            }
-            else
-            {
-                LED_On(LED_RED);
-                LCD_Clear();
-                LCD_WriteString("Mismatch!");
-                DelayMs(2000);
-                LED_AllOff();
-                // Loop repeats to ask for new password again
-            }
-        }
+        UI_Goto(SCR_CHG_NEW_ENTER);
+    }
+    else if (r == 'L')
+    {
+        EnterLockout(SCR_MENU);
+    }
+    else if (r == LINK_TIMEOUT)
+    {
+        UI_Goto(SCR_NO_REPLY);
+    }
+    else
+    {
+        attempts++;
+        UI_Goto(SCR_CHG_OLD_WRONG);
     }
 }
 
 /******************************************************************************
- * Step 5: Set Timeout (Potentiometer)
+ * *: Set Timeout (Potentiometer)
  ******************************************************************************/
-void SetTimeoutSequence(void)
+static void TmoAdjust_Enter(void)
 {
-    char str_buffer[16];
-    char password[PASSWORD_LENGTH + 1];
+    adc_sampled_ms = SysTick_GetMs() - ADC_SAMPLE_MS; // Sample on first tick
+}
+
+static void TmoAdjust_Tick(void)
+{
+    char str_buffer[UI_COLS + 1];
+    FmtBuf f;
     uint32_t adc_val;
-    uint8_t timeout_val;
-    char key;
-    bool confirmed = false;
 
-    // 1. Live Adjust Loop
-    LCD_Clear();
-    LCD_SetCursor(0, 0);
-    LCD_WriteString("Adjust Timeout:");
+    if ((SysTick_GetMs() - adc_sampled_ms) < ADC_SAMPLE_MS)
+        return;
+    adc_sampled_ms = SysTick_GetMs();
 
-    while (!confirmed)
-    {
-        adc_val = ADC_Read();
-        // Map 0-4095 to 5-30 seconds
-        timeout_val = 5 + (adc_val * 25) / 4095;
+    adc_val = ADC_Read();
+    // Map 0-4095 to 5-30 seconds
+    timeout_val = (uint8_t)ADC_Scale(adc_val, 5, 30);
 
-        sprintf(str_buffer, "%d Seconds   ", timeout_val);
-        LCD_SetCursor(1, 0);
-        LCD_WriteString(str_buffer);
+    Fmt_Init(&f, str_buffer, sizeof(str_buffer));
+    Fmt_Dec(&f, timeout_val);
+    Fmt_Str(&f, " Seconds");
+    UI_SetLine(1, str_buffer);
+}
 
-        key = Keypad_GetKey();
-        if (key == '#')
-            confirmed = true;
+static void TmoAdjust_Key(char key)
+{
+    if (key == '#')
+        UI_Goto(SCR_TMO_CONFIRM_MSG);
+}
 
-        DelayMs(100);
-    }
+static void TmoCheck_Enter(void)
+{
+    Link_Request("CHK:", password, LINK_DEFAULT_TIMEOUT_MS);
+}
 
-    // 2. Security Check
-    LCD_Clear();
-    LCD_WriteString("Confirm w/ Pass:");
-    DelayMs(1000);
+static void TmoCheck_Tick(void)
+{
+    char r = Link_Poll();
+    if (r == LINK_PENDING)
+        return;
+
+    if (r == '1')
+        UI_Goto(SCR_TMO_SAVE);
+    else if (r == 'L')
+        EnterLockout(SCR_MENU);
+    else if (r == LINK_TIMEOUT)
+        UI_Goto(SCR_NO_REPLY);
+    else
+        UI_Goto(SCR_TMO_WRONG);
+}
 
-    LCD_Clear();
-    LCD_WriteString("Enter Password:");
-    LCD_SetCursor(1, 0);
+static void TmoSave_Enter(void)
+{
+    char str_buffer[FMT_U32_DIGITS + 1];
+    Fmt_U32(str_buffer, timeout_val);
+    Link_Request("TMO:", str_buffer, LINK_DEFAULT_TIMEOUT_MS);
+}
 
-    for (uint8_t i = 0; i < PASSWORD_LENGTH + 1; i++)
-        password[i] = 0;
-    CollectPassword(password);
+static void TmoSave_Tick(void)
+{
+    char r = Link_Poll();
+    if (r == LINK_PENDING)
+        return;
 
-    SendCommandToControl("CHK:", password);
-    if (WaitForResponse() == '1')
-    {
-        sprintf(str_buffer, "TMO:%d", timeout_val);
-        char *ptr = str_buffer;
-        while (*ptr)
-            UART2_SendChar(*ptr++);
-        UART2_SendChar('\n');
+    UI_Goto(r == '1' ? SCR_TMO_SAVED : SCR_TMO_SAVE_ERR);
+}
 
-        if (WaitForResponse() == '1')
+/******************************************************************************
+ * Lockout: live countdown, enforced by the Control ECU
+ * Keys are discarded by the engine (no handler on this screen).
+ ******************************************************************************/
+static void Lockout_Enter(void)
+{
+    lockout_remaining = LOCKOUT_SECONDS;
+    lockout_start_ms = SysTick_GetMs();
+    lockout_shown = 0xFFFFFFFF;
+    lockout_confirming = false;
+    Link_RequestNumber("LCK", "", LCK_TIMEOUT_MS);
+}
+
+static void Lockout_Tick(void)
+{
+    char str_buffer[UI_COLS + 1];
+    FmtBuf f;
+    uint32_t elapsed, left;
+    char r = Link_Poll();
+
+    if (r == LINK_NUMBER)
+    {
+        // Control ECU's figure replaces ours
+        lockout_remaining = Link_Number();
+        lockout_start_ms = SysTick_GetMs();
+        if (lockout_remaining == 0)
         {
-            LED_On(LED_GREEN);
-            LCD_Clear();
-            LCD_WriteString("Timeout Saved!");
+            UI_Goto(lockout_exit);
+            return;
         }
-        else
+        lockout_confirming = false;
+    }
+    else if (r == LINK_TIMEOUT && lockout_confirming)
+    {
+        UI_Goto(lockout_exit); // Nothing left to enforce against
+        return;
+    }
+
+    elapsed = (SysTick_GetMs() - lockout_start_ms) / 1000;
+    if (elapsed >= lockout_remaining)
+    {
+        // Our count is done; the Control ECU has the final word
+        if (!Link_Busy())
         {
-            LED_On(LED_RED);
-            LCD_Clear();
-            LCD_WriteString("Save Error!");
+            lockout_confirming = true;
+            Link_RequestNumber("LCK", "", LCK_TIMEOUT_MS);
         }
-        DelayMs(1500);
-        LED_AllOff();
+        left = 0;
     }
     else
     {
-        LED_On(LED_RED);
-        LCD_Clear();
-        LCD_WriteString("Wrong Password");
-        DelayMs(1500);
-        LED_AllOff();
+        left = lockout_remaining - elapsed;
+    }
+
+    if (left != lockout_shown)
+    {
+        Fmt_Init(&f, str_buffer, sizeof(str_buffer));
+        Fmt_Str(&f, "Wait ");
+        Fmt_DecPad(&f, left, 2, ' ');
+        Fmt_Str(&f, "s...");
+        UI_SetLine(1, str_buffer);
+        lockout_shown = left;
     }
 }
 
 /******************************************************************************
- * Helper Functions & Drivers
+ * Link lost: shown from any screen once heartbeats go unanswered; the flow
+ * restarts from the boot checks when the Control ECU is back.
  ******************************************************************************/
-/* ADC_Init and ADC_Read moved to adc.c */
+static void CheckLink(void)
+{
+    UiScreenId current = UI_Current();
+
+    // The splash does its own waiting for the Control ECU
+    if (!Link_IsOnline() && current != SCR_OFFLINE && current != SCR_SPLASH)
+        UI_Goto(SCR_OFFLINE);
+}
 
-void CollectPassword(char *password)
+static void Offline_Tick(void)
 {
-    char key;
-    uint8_t count = 0;
-    while (count < PASSWORD_LENGTH)
-    {
-        key = Keypad_GetKey();
-        if (key != 0)
-        {
-            if (key == '#')
-            {
-                count = 0;
-                LCD_SetCursor(1, 0);
-                LCD_WriteString("                ");
-                LCD_SetCursor(1, 0);
-                for (uint8_t j = 0; j < PASSWORD_LENGTH; j++)
-                    password[j] = 0;
-            }
-            else if (key >= '0' && key <= '9')
-            {
-                password[count] = key;
-                LCD_SetCursor(1, count);
-                LCD_WriteChar('*');
-                count++;
-            }
-            DelayMs(300);
-        }
-        DelayMs(50);
-    }
+    if (Link_IsOnline())
+        UI_Goto(SCR_BOOT_LOCK_CHECK);
 }
 
-void SendCommandToControl(const char *prefix, const char *data)
+/******************************************************************************
+ * D (hidden): Diagnostics
+ * D/C: next/previous page, #: refresh STAT, *: back to the menu.
+ * B (PROFILE builds): send the PC-sample histogram to the PC on UART0 for
+ * tools/profile.py (see profile.h).
+ * A (TRACE builds): send the link traffic trace to the PC on UART0 for
+ * tools/replay.py (see trace.h).
+ * 0: send the bounded-wait statistics and last watchdog stall to the PC on
+ * UART0 for tools/waits.py (see wait.h).
+ ******************************************************************************/
+static void ShowDiagPage(void)
 {
-    while (*prefix)
-        UART2_SendChar(*prefix++);
-    while (*data)
-        UART2_SendChar(*data++);
-    UART2_SendChar('\n');
+    char line1[DIAG_LINE_SIZE], line2[DIAG_LINE_SIZE];
+
+    if (diag_page >= Diag_PageCount())
+        diag_page = 0;
+    Diag_FormatPage(diag_page, line1, line2);
+    UI_SetLine(0, line1);
+    UI_SetLine(1, line2);
 }
 
-char CheckSystemStatus(void)
+static void Diag_Enter(void)
 {
-    uint8_t r = 0;
-    while (r < 5)
-    {
-        while (UART2_IsDataAvailable())
-            UART2_ReceiveChar();
-        UART2_SendChar('S');
-        UART2_SendChar('T');
-        UART2_SendChar('S');
-        UART2_SendChar('\n');
-        DelayMs(100);
-        if (UART2_IsDataAvailable())
-            return UART2_ReceiveChar();
-        DelayMs(200);
-        r++;
-    }
-    return '0';
+    Link_RequestBlock("STAT", "", Diag_Buffer(), DIAG_PAYLOAD_MAX, STAT_TIMEOUT_MS);
+    ShowDiagPage(); // Local pages need no reply
 }
 
-char WaitForResponse(void)
+static void Diag_Tick(void)
 {
-    uint16_t t = 0;
-    while (t < 5000)
+    char r = Link_Poll();
+    if (r == LINK_PENDING)
+        return;
+
+    if (r != LINK_BLOCK || !Diag_Load(Link_BlockLength()))
+        Diag_Clear();
+    ShowDiagPage();
+}
+
+static void Diag_Key(char key)
+{
+    uint8_t pages = Diag_PageCount();
+
+    if (key == 'D')
     {
-        if (UART2_IsDataAvailable())
-        {
-            char c = UART2_ReceiveChar();
-            if (c == '0' || c == '1')
-                return c;
-        }
-        DelayMs(1);
-        t++;
+        diag_page = (uint8_t)((diag_page + 1) % pages);
+        ShowDiagPage();
+    }
+    else if (key == 'C')
+    {
+        diag_page = (uint8_t)((diag_page + pages - 1) % pages);
+        ShowDiagPage();
+    }
+    else if (key == '#')
+    {
+        UI_Goto(SCR_DIAG);
+    }
+    else if (key == 'B' && PROFILE)
+    {
+        UART0_Init();
+        Profile_Export(UART0_SendChar);
+    }
+    else if (key == 'A' && TRACE)
+    {
+        UART0_Init();
+        Trace_Export(UART0_SendChar);
+    }
+    else if (key == '0')
+    {
+        UART0_Init();
+        Wait_Export(UART0_SendChar);
+    }
+    else if (key == '*')
+    {
+        UI_Goto(SCR_MENU);
     }
-    return 'X';
 }
 
 /******************************************************************************
- * LED Functions (Green LED on PF3, Red LED on PF1)
+ * C (hidden): Firmware update bridge
+ * Relays bytes between the PC (UART0, USB virtual COM port) and the Control
+ * ECU (UART2) for tools/fwupdate.py. *: back to the boot checks, since the
+ * Control ECU has usually restarted with new firmware by then. The bootloader
+ * only speaks UART2, so CAN builds need the UART2 wires for updates too.
  ******************************************************************************/
-/* LED_Init moved to led.c */
-
-/* LED_AllOff moved to led.c */
+static void Bridge_Enter(void)
+{
+    UART0_Init();
+    if (TRANSPORT_CAN)
+        UART2_Init();
+}
 
-/* LED_PinMask moved to led.c */
+static void Bridge_Tick(void)
+{
+    while (UART0_IsDataAvailable())
+        UART2_SendChar(UART0_ReceiveChar());
+    while (UART2_IsDataAvailable())
+        UART0_SendChar(UART2_ReceiveChar());
+}
 
-/* LED_On moved to led.c */
\ No newline at end of file
+static void Bridge_Key(char key)
+{
+    if (key == '*')
+        UI_Goto(SCR_BOOT_LOCK_CHECK);
+}
@@ -0,0 +1,71 @@
+/******************************************************************************
+ * File: profile.h
+ * Module: PC-Sampling Profiler
+ * Description: Optional statistical profiler (PROFILE = 1 in the IAR
+ *              preprocessor defines). Timer3A interrupts PROFILE_HZ times a
+ *              second and counts the interrupted PC in a histogram of
+ *              2^PROFILE_SHIFT-byte buckets over the code in flash.
+ *              tools/profile.py maps the buckets to functions.
+ *
+ * Export (binary, little-endian, same framing as STAT):
+ *   len        uint16  number of payload bytes that follow
+ *   payload:
+ *     version    uint8   PROFILE_VERSION
+ *     shift      uint8   PROFILE_SHIFT
+ *     base       uint32  PROFILE_BASE
+ *     rate       uint32  samples per second
+ *     samples    uint32  total samples taken
+ *     outside    uint32  samples outside [base, base + PROFILE_SPAN)
+ *     entries    uint16  number of records that follow
+ *     per non-empty bucket:
+ *       bucket   uint16  index; the bucket covers base + (index << shift)
+ *       count    uint16  samples (saturating)
+ *   checksum   uint8   sum of all preceding bytes (len included)
+ *
+ * With PROFILE = 0 nothing is sampled, the histogram takes no RAM and the
+ * export has no entries.
+ ******************************************************************************/
+
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#include <stdint.h>
+
+/******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#ifndef PROFILE
+#define PROFILE 0
+#endif
+
+#define PROFILE_VERSION 1
+#define PROFILE_HZ      4999u           /* Off the 1 kHz SysTick beat */
+#define PROFILE_BASE    0x00000000u     /* Start of flash */
+#define PROFILE_SPAN    0x8000u         /* Code bytes covered */
+#define PROFILE_SHIFT   4               /* 16-byte buckets */
+#define PROFILE_BUCKETS (PROFILE_SPAN >> PROFILE_SHIFT)
+
+/******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+/*
+ * Profile_Init
+ * Starts sampling (PROFILE builds only; otherwise does nothing).
+ */
+void Profile_Init(void);
+
+/*
+ * Profile_Reset
+ * Clears the histogram and the sample counts.
+ */
+void Profile_Reset(void);
+
+/*
+ * Profile_Export
+ * Streams the histogram through put, in the format above.
+ */
+void Profile_Export(void (*put)(char));
+
+#endif /* PROFILE_H_ */
@@ -3,12 +3,9 @@
 #include "systick.h"
 
 volatile uint32_t msTicks = 0;
-static uint8_t interruptMode = 0;
 
 void SysTick_Init(uint32_t reload, uint8_t mode)
 {
-    interruptMode = mode;
-
     NVIC_ST_CTRL_R = 0;               // Disable SysTick
     NVIC_ST_RELOAD_R = reload - 1;    // Set reload value
     NVIC_ST_CURRENT_R = 0;            // Clear current
@@ -23,17 +20,28 @@ void SysTick_Init(uint32_t reload, uint8_t mode)
     }
 }
 
-void DelayMs(uint32_t ms)
+// One tick per reload period (1 ms with reload = 16000 @ 16 MHz)
+void SysTick_Handler(void)
+{
+    msTicks++;
+}
+
+uint32_t SysTick_GetMs(void)
+{
+    return msTicks;
+}
+
+// Microseconds from msTicks plus the SysTick down-counter (wraps after ~71 min)
+uint32_t SysTick_GetUs(void)
 {
-    if (interruptMode == SYSTICK_NOINT)
+    uint32_t ms, current;
+    uint32_t reload = NVIC_ST_RELOAD_R + 1;
+
+    do
     {
-        // POLLING MODE - actively check COUNT flag
-        for (uint32_t i = 0; i < ms; i++)
-        {
-            // Wait until COUNT flag is set (timer reached zero)
-            while ((NVIC_ST_CTRL_R & (1 << 16)) == 0);
-            // Clear the flag by writing to CURRENT register
-            NVIC_ST_CURRENT_R = 0;
-        }
-    }
+        ms = msTicks;
+        current = NVIC_ST_CURRENT_R;
+    } while (ms != msTicks);   // Tick landed between the reads: retry
+
+    return ms * 1000 + ((reload - 1 - current) * 1000) / reload;
 }
@@ -0,0 +1,57 @@
+/******************************************************************************
+ * File: transport.c
+ * Module: Inter-ECU Transport
+ * Description: Dispatch to the UART2 or CAN0 backend
+ ******************************************************************************/
+
+#include "transport.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include "can.h"
+#include "trace.h"
+#include "uart.h"
+
+void Transport_Init(void)
+{
+    if (TRANSPORT_CAN)
+        CAN0_Init();
+    else
+        UART2_Init();
+}
+
+void Transport_SendChar(char data)
+{
+    if (TRACE)
+        Trace_Byte(true, data);
+
+    if (TRANSPORT_CAN)
+        CAN0_SendChar(data);
+    else
+        UART2_SendChar(data);
+}
+
+void Transport_SendString(const char *str)
+{
+    while (*str != '\0')
+        Transport_SendChar(*str++);
+}
+
+void Transport_Flush(void)
+{
+    if (TRANSPORT_CAN)
+        CAN0_Flush();
+}
+
+char Transport_ReceiveChar(void)
+{
+    char c = TRANSPORT_CAN ? CAN0_ReceiveChar() : UART2_ReceiveChar();
+
+    if (TRACE)
+        Trace_Byte(false, c);
+    return c;
+}
+
+uint8_t Transport_IsDataAvailable(void)
+{
+    return TRANSPORT_CAN ? CAN0_IsDataAvailable() : UART2_IsDataAvailable();
+}
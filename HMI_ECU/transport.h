@@ -0,0 +1,35 @@
+/******************************************************************************
+ * File: transport.h
+ * Module: Inter-ECU Transport
+ * Description: One send/receive API for the link to the other ECU, over
+ *              UART2 (default) or CAN0 (TRANSPORT_CAN = 1, see can.h).
+ *
+ * Both backends carry the same byte stream, so the command protocol and
+ * everything above it are unchanged. Call Transport_Flush() at the end of
+ * each reply or request: CAN sends partial frames only then, UART sends
+ * every byte at once anyway.
+ ******************************************************************************/
+
+#ifndef TRANSPORT_H_
+#define TRANSPORT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uart.h"
+
+#ifndef TRANSPORT_CAN
+#define TRANSPORT_CAN 0
+#endif
+
+#if TRANSPORT_CAN && UART2_MULTIDROP
+#error "UART2_MULTIDROP framing needs the UART transport"
+#endif
+
+void Transport_Init(void);
+void Transport_SendChar(char data);
+void Transport_SendString(const char *str);
+void Transport_Flush(void);
+char Transport_ReceiveChar(void);
+uint8_t Transport_IsDataAvailable(void);
+
+#endif /* TRANSPORT_H_ */
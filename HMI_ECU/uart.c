@@ -17,6 +17,7 @@
 #include "uart.h"
 #include <stdint.h>
 #include <stdbool.h>
+#include "wait.h"
 
 /* TivaWare includes */
 #include "inc/hw_memmap.h"
@@ -30,6 +31,188 @@
 /* Desired baud rate */
 #define UART2_BAUD_RATE   115200U
 
+/* Wait limits: a 16-byte FIFO drains in 1.4 ms at 115200 baud; a byte
+ * already announced as available is there at once */
+#define UART_TX_TIMEOUT_US  5000U
+#define UART_RX_TIMEOUT_US  2000U
+
+/******************************************************************************
+ * RS-485 multidrop framing
+ ******************************************************************************/
+#define FRAME_END       0xC0
+#define FRAME_ESC       0xDB
+#define FRAME_ESC_END   0xDC
+#define FRAME_ESC_ESC   0xDD
+#define RX_RING_SIZE    64          /* Decoded payload bytes, power of two */
+
+typedef enum
+{
+    RX_IDLE,        /* Between frames */
+    RX_DEST,
+    RX_SRC,
+    RX_TYPE,
+    RX_PAYLOAD,
+    RX_SKIP         /* Frame for another node */
+} RxState;
+
+static RxState rx_state = RX_IDLE;
+static bool rx_escaped = false;
+static uint8_t rx_src, rx_type;
+static uint8_t rx_ring[RX_RING_SIZE];
+static uint8_t rx_head = 0, rx_tail = 0;
+static bool frame_ended = false;
+static uint8_t frame_src;
+static bool poll_pending = false;
+static bool tx_framing = false;     /* Inside BeginFrame..EndFrame */
+
+static void Frame_Decode(uint8_t b)
+{
+    uint8_t next;
+
+    if (b == FRAME_END)
+    {
+        if (rx_state == RX_PAYLOAD)
+        {
+            if (rx_type == UART2_FRAME_POLL)
+            {
+                poll_pending = true;
+            }
+            else
+            {
+                frame_ended = true;
+                frame_src = rx_src;
+            }
+        }
+        rx_state = RX_DEST;     /* An END may also open the next frame */
+        rx_escaped = false;
+        return;
+    }
+
+    switch (rx_state)
+    {
+    case RX_DEST:
+        rx_state = (b == UART2_NODE_ADDRESS || b == UART2_BROADCAST) ? RX_SRC : RX_SKIP;
+        break;
+    case RX_SRC:
+        rx_src = b;
+        rx_state = RX_TYPE;
+        break;
+    case RX_TYPE:
+        rx_type = b;
+        rx_state = RX_PAYLOAD;
+        break;
+    case RX_PAYLOAD:
+        if (b == FRAME_ESC && !rx_escaped)
+        {
+            rx_escaped = true;
+            break;
+        }
+        if (rx_escaped)
+            b = (b == FRAME_ESC_END) ? FRAME_END : FRAME_ESC;
+        rx_escaped = false;
+
+        next = (uint8_t)((rx_head + 1) & (RX_RING_SIZE - 1));
+        if (rx_type == UART2_FRAME_DATA && next != rx_tail)
+        {
+            rx_ring[rx_head] = b;
+            rx_head = next;
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+/* Runs everything waiting in the RX FIFO through the frame decoder */
+static void Frame_Pump(void)
+{
+    while (UARTCharsAvail(UART2_BASE))
+        Frame_Decode((uint8_t)UARTCharGetNonBlocking(UART2_BASE));
+}
+
+/* Wait_Until conditions */
+static bool TxRoom(void)
+{
+    return UARTSpaceAvail(UART2_BASE);
+}
+
+static bool TxIdle(void)
+{
+    return !UARTBusy(UART2_BASE);
+}
+
+static bool RxFifoReady(void)
+{
+    return UARTCharsAvail(UART2_BASE);
+}
+
+static bool RxRingReady(void)
+{
+    Frame_Pump();
+    return rx_head != rx_tail;
+}
+
+static bool Uart0TxRoom(void)
+{
+    return UARTSpaceAvail(UART0_BASE);
+}
+
+static bool Uart0RxReady(void)
+{
+    return UARTCharsAvail(UART0_BASE);
+}
+
+/* Bytes that find no room within the limit are dropped */
+static void Frame_PutRaw(uint8_t b)
+{
+    if (Wait_Until(WAIT_UART2_TX, TxRoom, UART_TX_TIMEOUT_US))
+        UARTCharPutNonBlocking(UART2_BASE, (char)b);
+}
+
+void UART2_BeginFrame(uint8_t dest, uint8_t type)
+{
+    if (!UART2_MULTIDROP)
+        return;
+
+    GPIOPinWrite(GPIO_PORTD_BASE, GPIO_PIN_2, GPIO_PIN_2);   /* DE on */
+    Frame_PutRaw(FRAME_END);
+    Frame_PutRaw(dest);
+    Frame_PutRaw(UART2_NODE_ADDRESS);
+    Frame_PutRaw(type);
+    tx_framing = true;
+}
+
+void UART2_EndFrame(void)
+{
+    if (!UART2_MULTIDROP)
+        return;
+
+    tx_framing = false;
+    Frame_PutRaw(FRAME_END);
+    Wait_Until(WAIT_UART2_DRAIN, TxIdle, UART_TX_TIMEOUT_US);
+    GPIOPinWrite(GPIO_PORTD_BASE, GPIO_PIN_2, 0);           /* DE off */
+}
+
+bool UART2_TakeFrameEnd(uint8_t *src)
+{
+    Frame_Pump();
+    if (!frame_ended || rx_head != rx_tail)
+        return false;   /* Payload not read yet */
+    frame_ended = false;
+    *src = frame_src;
+    return true;
+}
+
+bool UART2_TakePoll(void)
+{
+    bool polled;
+
+    Frame_Pump();
+    polled = poll_pending;
+    poll_pending = false;
+    return polled;
+}
+
 /*
  * UART2_Init
  * Initializes UART2 on PD6 (RX) and PD7 (TX).
@@ -69,26 +252,60 @@ void UART2_Init(void)
                          UART_CONFIG_STOP_ONE |
                          UART_CONFIG_PAR_NONE));
 
-    /* 6) Enable UART2 module */
+    /* 6) RS-485 driver enable on PD2, receiving */
+    if (UART2_MULTIDROP)
+    {
+        GPIOPinTypeGPIOOutput(GPIO_PORTD_BASE, GPIO_PIN_2);
+        GPIOPinWrite(GPIO_PORTD_BASE, GPIO_PIN_2, 0);
+    }
+
+    /* 7) Enable UART2 module */
     UARTEnable(UART2_BASE);
 }
 
 /*
  * UART2_SendChar
- * Sends a single character (blocking).
+ * Sends a single character (blocking while the TX FIFO is full, at most
+ * UART_TX_TIMEOUT_US; dropped after that).
  */
 void UART2_SendChar(char data)
 {
-    UARTCharPut(UART2_BASE, data);  /* UART2_BASE not UART1_BASE */
+    uint8_t b = (uint8_t)data;
+
+    if (tx_framing && b == FRAME_END)
+    {
+        Frame_PutRaw(FRAME_ESC);
+        b = FRAME_ESC_END;
+    }
+    else if (tx_framing && b == FRAME_ESC)
+    {
+        Frame_PutRaw(FRAME_ESC);
+        b = FRAME_ESC_ESC;
+    }
+    Frame_PutRaw(b);
 }
 
 /*
  * UART2_ReceiveChar
- * Receives a single character (blocking).
+ * Receives a single character (blocking, at most UART_RX_TIMEOUT_US;
+ * '\0' after that). Callers check UART2_IsDataAvailable first.
  */
 char UART2_ReceiveChar(void)
 {
-    return (char)UARTCharGet(UART2_BASE);  /* UART2_BASE not UART1_BASE */
+    char c;
+
+    if (!UART2_MULTIDROP)
+    {
+        if (!Wait_Until(WAIT_UART2_RX, RxFifoReady, UART_RX_TIMEOUT_US))
+            return '\0';
+        return (char)UARTCharGetNonBlocking(UART2_BASE);  /* UART2_BASE not UART1_BASE */
+    }
+
+    if (!Wait_Until(WAIT_UART2_RX, RxRingReady, UART_RX_TIMEOUT_US))
+        return '\0';
+    c = (char)rx_ring[rx_tail];
+    rx_tail = (uint8_t)((rx_tail + 1) & (RX_RING_SIZE - 1));
+    return c;
 }
 
 /*
@@ -115,6 +332,55 @@ void UART2_SendString(const char *str)
  */
 uint8_t UART2_IsDataAvailable(void)
 {
+    if (UART2_MULTIDROP)
+    {
+        Frame_Pump();
+        return (rx_head != rx_tail) ? 1u : 0u;
+    }
+
     /* UARTCharsAvail() returns true if characters are available */
     return (UARTCharsAvail(UART2_BASE)) ? 1u : 0u;  /* UART2_BASE */
-}
\ No newline at end of file
+}
+
+/*
+ * UART0_Init
+ * Initializes UART0 on PA0 (RX) and PA1 (TX). PA2-PA5 (keypad rows) are
+ * left as they are.
+ */
+void UART0_Init(void)
+{
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_UART0));
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOA));
+
+    GPIOPinConfigure(GPIO_PA0_U0RX);
+    GPIOPinConfigure(GPIO_PA1_U0TX);
+    GPIOPinTypeUART(GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+
+    UARTConfigSetExpClk(UART0_BASE,
+                        SysCtlClockGet(),
+                        UART2_BAUD_RATE,
+                        (UART_CONFIG_WLEN_8 |
+                         UART_CONFIG_STOP_ONE |
+                         UART_CONFIG_PAR_NONE));
+    UARTEnable(UART0_BASE);
+}
+
+void UART0_SendChar(char data)
+{
+    if (Wait_Until(WAIT_UART0_TX, Uart0TxRoom, UART_TX_TIMEOUT_US))
+        UARTCharPutNonBlocking(UART0_BASE, data);
+}
+
+char UART0_ReceiveChar(void)
+{
+    if (!Wait_Until(WAIT_UART0_RX, Uart0RxReady, UART_RX_TIMEOUT_US))
+        return '\0';
+    return (char)UARTCharGetNonBlocking(UART0_BASE);
+}
+
+uint8_t UART0_IsDataAvailable(void)
+{
+    return (UARTCharsAvail(UART0_BASE)) ? 1u : 0u;
+}
@@ -31,7 +31,8 @@ void UART2_Init(void);
 
 /*
  * UART2_SendChar
- * Sends a single character over UART2 (blocking).
+ * Sends a single character over UART2 (blocking while the TX FIFO is full,
+ * bounded: see wait.h; dropped if it stays full).
  * 
  * Parameters:
  *   data - Character to send
@@ -40,10 +41,10 @@ void UART2_SendChar(char data);
 
 /*
  * UART2_ReceiveChar
- * Receives a single character from UART2 (blocking).
+ * Receives a single character from UART2 (blocking, bounded: see wait.h).
  * 
  * Returns:
- *   Received character
+ *   Received character, '\0' if none arrived
  */
 char UART2_ReceiveChar(void);
 
@@ -65,4 +66,77 @@ void UART2_SendString(const char *str);
  */
 uint8_t UART2_IsDataAvailable(void);
 
+/*
+ * UART0_Init
+ * Initializes UART0 on PA0 (RX) and PA1 (TX), the LaunchPad's USB virtual
+ * COM port, at the same 115200 8N1 as UART2. Used only by the firmware
+ * update bridge.
+ */
+void UART0_Init(void);
+
+/*
+ * UART0_SendChar
+ * Sends a single character over UART0 (blocking).
+ */
+void UART0_SendChar(char data);
+
+/*
+ * UART0_ReceiveChar / UART0_IsDataAvailable
+ * Same as the UART2 versions, for UART0.
+ */
+char UART0_ReceiveChar(void);
+uint8_t UART0_IsDataAvailable(void);
+
+/******************************************************************************
+ * RS-485 multidrop (UART2_MULTIDROP = 1)
+ *
+ * Half-duplex bus; PD2 drives the transceiver's DE and /RE together (high
+ * while this node transmits). Every transmission is a frame
+ *   END | dest | src | type | payload | END
+ * with SLIP escaping of the payload (END = 0xC0, ESC = 0xDB). The Control
+ * ECU is node 0 and polls the HMI terminals (nodes 1..UART2_MAX_NODE); a
+ * terminal transmits only in answer to a poll addressed to it, so frames
+ * never collide. The receive functions then return only the payload of
+ * data frames addressed to this node or broadcast; all other traffic is
+ * dropped.
+ *
+ * With UART2_MULTIDROP = 0 (point-to-point, the default) the frame calls
+ * do nothing and bytes go over the wire unchanged.
+ ******************************************************************************/
+#ifndef UART2_MULTIDROP
+#define UART2_MULTIDROP 0
+#endif
+
+#define UART2_MAX_NODE      16
+/* This terminal's bus address (1..UART2_MAX_NODE, unique per HMI board;
+ * override in the project's preprocessor defines) */
+#ifndef UART2_NODE_ADDRESS
+#define UART2_NODE_ADDRESS  1
+#endif
+#define UART2_BROADCAST     0xFF
+#define UART2_FRAME_DATA    'D'
+#define UART2_FRAME_POLL    'P'
+
+/*
+ * UART2_BeginFrame / UART2_EndFrame
+ * Enclose one transmission: BeginFrame enables the driver and sends the
+ * header, characters sent until EndFrame are escaped, EndFrame sends the
+ * closing END and releases the bus once the last bit is out.
+ */
+void UART2_BeginFrame(uint8_t dest, uint8_t type);
+void UART2_EndFrame(void);
+
+/*
+ * UART2_TakeFrameEnd
+ * True once a data frame for this node has been received completely (its
+ * payload already read through UART2_ReceiveChar); src is its sender.
+ */
+bool UART2_TakeFrameEnd(uint8_t *src);
+
+/*
+ * UART2_TakePoll
+ * True once a poll addressed to this node has arrived.
+ */
+bool UART2_TakePoll(void);
+
 #endif /* UART_H_ */
\ No newline at end of file
@@ -0,0 +1,208 @@
+/******************************************************************************
+ * File: ui.c
+ * Module: UI Engine
+ * Description: Drives the application's UiScreen table. All LCD output goes
+ *              through a two-row shadow buffer; UI_Service writes only the
+ *              characters that differ from what the LCD already shows.
+ ******************************************************************************/
+
+#include "ui.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "keypad.h"
+#include "lcd.h"
+#include "led.h"
+#include "systick.h"
+
+/* Bound on screen changes chained in one pass (on_enter calling UI_Goto) */
+#define UI_MAX_CHAIN 8
+
+static const UiScreen *screens;
+static UiScreenId current;
+static uint32_t entered_ms;
+static bool goto_pending = false;
+static UiScreenId goto_target;
+static uint8_t entry_count;
+
+static char shadow[UI_ROWS][UI_COLS];   /* What should be on the LCD */
+static char shown[UI_ROWS][UI_COLS];    /* What is on the LCD */
+static uint8_t cursor_row, cursor_col;  /* Where the LCD cursor is */
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+static void UI_Enter(UiScreenId id)
+{
+    const UiScreen *scr = &screens[id];
+
+    current = id;
+    entered_ms = SysTick_GetMs();
+    entry_count = 0;
+
+    UI_SetLine(0, scr->line1);
+    UI_SetLine(1, scr->line2);
+
+    LED_AllOff();
+    if (scr->led != UI_LED_OFF)
+        LED_On((LEDColor)scr->led);
+
+    if (scr->entry != NULL)
+        memset(scr->entry, 0, scr->entry_len + 1);
+
+    if (scr->on_enter != NULL)
+        scr->on_enter();
+}
+
+/*
+ * UI_EntryKey
+ * Password entry: digits fill the buffer, '#' restarts. False if the key
+ * was not taken.
+ */
+static bool UI_EntryKey(const UiScreen *scr, char key)
+{
+    if (key == '#')
+    {
+        entry_count = 0;
+        memset(scr->entry, 0, scr->entry_len + 1);
+        UI_SetLine(1, NULL);
+        return true;
+    }
+    if (key >= '0' && key <= '9' && entry_count < scr->entry_len)
+    {
+        scr->entry[entry_count] = key;
+        shadow[1][entry_count] = '*';
+        entry_count++;
+        if (entry_count == scr->entry_len)
+            UI_Goto(scr->next);
+        return true;
+    }
+    return false;
+}
+
+static void UI_MoveCursor(uint8_t row, uint8_t col)
+{
+    if (row != cursor_row || col != cursor_col)
+    {
+        LCD_SetCursor(row, col);
+        cursor_row = row;
+        cursor_col = col;
+    }
+}
+
+/*
+ * UI_Redraw
+ * Sends only the changed characters, then parks the cursor at the entry
+ * position on entry screens.
+ */
+static void UI_Redraw(void)
+{
+    uint8_t row, col;
+
+    for (row = 0; row < UI_ROWS; row++)
+    {
+        for (col = 0; col < UI_COLS; col++)
+        {
+            if (shadow[row][col] != shown[row][col])
+            {
+                UI_MoveCursor(row, col);
+                LCD_WriteChar(shadow[row][col]);
+                shown[row][col] = shadow[row][col];
+                cursor_col++;
+            }
+        }
+    }
+
+    if (screens[current].entry != NULL && entry_count < UI_COLS)
+        UI_MoveCursor(1, entry_count);
+}
+
+/******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+
+void UI_Init(const UiScreen *table, UiScreenId first)
+{
+    screens = table;
+
+    LCD_Clear();
+    memset(shown, ' ', sizeof(shown));
+    cursor_row = 0;
+    cursor_col = 0;
+
+    UI_Enter(first);
+    UI_Service();
+}
+
+void UI_Service(void)
+{
+    const UiScreen *scr = &screens[current];
+    uint8_t chain = 0;
+    char key;
+
+    /* 1) Key event */
+    key = Keypad_Poll();
+    if (key != 0)
+    {
+        if (scr->entry != NULL)
+        {
+            if (UI_EntryKey(scr, key) && scr->on_key != NULL)
+                scr->on_key(key);
+        }
+        else if (scr->on_key != NULL)
+        {
+            scr->on_key(key);
+        }
+    }
+
+    /* 2) Tick */
+    if (!goto_pending && scr->on_tick != NULL)
+        scr->on_tick();
+
+    /* 3) Timed message */
+    if (!goto_pending && scr->hold_ms != 0 &&
+        (SysTick_GetMs() - entered_ms) >= scr->hold_ms)
+        UI_Goto(scr->next);
+
+    /* 4) Screen changes */
+    while (goto_pending && chain < UI_MAX_CHAIN)
+    {
+        goto_pending = false;
+        UI_Enter(goto_target);
+        chain++;
+    }
+
+    /* 5) Redraw */
+    UI_Redraw();
+}
+
+void UI_Goto(UiScreenId id)
+{
+    goto_target = id;
+    goto_pending = true;
+}
+
+void UI_SetLine(uint8_t row, const char *text)
+{
+    uint8_t col = 0;
+
+    if (row >= UI_ROWS)
+        return;
+
+    if (text != NULL)
+    {
+        while (col < UI_COLS && text[col] != '\0')
+        {
+            shadow[row][col] = text[col];
+            col++;
+        }
+    }
+    while (col < UI_COLS)
+        shadow[row][col++] = ' ';
+}
+
+UiScreenId UI_Current(void)
+{
+    return current;
+}
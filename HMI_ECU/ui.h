@@ -0,0 +1,96 @@
+/******************************************************************************
+ * File: ui.h
+ * Module: UI Engine
+ * Description: Table-driven, non-blocking screen state machine for the 16x2
+ *              LCD. Screens, their text, LED, timed transitions, password
+ *              entry and handlers are declared as data (UiScreen); the engine
+ *              feeds them key events and timer ticks and owns all redraws.
+ ******************************************************************************/
+
+#ifndef UI_H_
+#define UI_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#define UI_COLS 16
+#define UI_ROWS 2
+
+#define UI_LED_OFF  (-1)    /* UiScreen.led: all LEDs off */
+
+typedef uint8_t UiScreenId;
+
+typedef void (*UiAction)(void);
+typedef void (*UiKeyHandler)(char key);
+
+/*
+ * UiScreen
+ * One entry of the application's screen table.
+ *
+ * A screen is one of:
+ *   - timed message : hold_ms != 0, moves to next when it expires
+ *   - entry         : entry != NULL, collects a password into entry
+ *                     ('#' restarts, digits shown as '*' on row 1) and
+ *                     moves to next once entry_len digits are in;
+ *                     on_key, if set, sees each key the entry took,
+ *                     after it is stored (before the move to next)
+ *   - interactive   : on_key / on_tick drive it and call UI_Goto
+ * Keys are discarded on screens with neither entry nor on_key.
+ */
+typedef struct
+{
+    const char *line1;      /* Row 0 text (NULL = blank) */
+    const char *line2;      /* Row 1 text (NULL = blank) */
+    int8_t led;             /* LED_RED / LED_GREEN / LED_BLUE / UI_LED_OFF */
+    uint16_t hold_ms;       /* Timed message duration (0 = not timed) */
+    UiScreenId next;        /* Target after hold_ms or a completed entry */
+    char *entry;            /* Password entry buffer (entry_len + 1 bytes) */
+    uint8_t entry_len;
+    UiAction on_enter;      /* Called once on entry (may call UI_Goto) */
+    UiKeyHandler on_key;    /* Key press events */
+    UiAction on_tick;       /* Called every UI_Service pass */
+} UiScreen;
+
+/******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+/*
+ * UI_Init
+ * Binds the screen table and enters the first screen. LCD, keypad, LEDs
+ * and SysTick (interrupt mode) must already be initialised.
+ */
+void UI_Init(const UiScreen *table, UiScreenId first);
+
+/*
+ * UI_Service
+ * One non-blocking pass: key event, tick handler, timed transition,
+ * pending screen changes, then redraw of whatever changed.
+ * Call continuously from the main loop.
+ */
+void UI_Service(void);
+
+/*
+ * UI_Goto
+ * Requests a screen change; applied by UI_Service (safe from any handler).
+ */
+void UI_Goto(UiScreenId id);
+
+/*
+ * UI_SetLine
+ * Replaces the text of row (padded/truncated to UI_COLS). The LCD is
+ * updated on the next redraw, only where characters differ.
+ */
+void UI_SetLine(uint8_t row, const char *text);
+
+/*
+ * UI_Current
+ * The active screen.
+ */
+UiScreenId UI_Current(void);
+
+#endif /* UI_H_ */
@@ -0,0 +1,318 @@
+/******************************************************************************
+ * File: wait.c (HMI_ECU)
+ * Module: Bounded Waits
+ * Description: Bounded busy-wait primitive, its statistics and CPU
+ *              cycle accounting, and the watchdog with its
+ *              reset-surviving stall record
+ ******************************************************************************/
+
+#include "wait.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include "systick.h"
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/watchdog.h"
+
+#define STALL_MAGIC 0x5741C0DEu
+
+/* Cortex-M4 cycle counter (DWT); not in the TivaWare headers */
+#define DEMCR_R             HWREG(0xE000EDFC)
+#define DEMCR_TRCENA        0x01000000u
+#define DWT_CTRL_R          HWREG(0xE0001000)
+#define DWT_CTRL_CYCCNTENA  0x00000001u
+#define DWT_CYCCNT_R        HWREG(0xE0001004)
+
+typedef struct
+{
+    uint32_t magic;
+    uint32_t resets;
+    uint32_t site;
+    uint32_t pc;
+} WaitStall;
+
+typedef struct
+{
+    uint32_t waits;
+    uint32_t timeouts;
+    uint32_t max_us;
+    uint16_t hist[WAIT_BUCKETS];
+    uint32_t window_cycles;     /* Spun in the current window */
+    uint32_t last_cycles;       /* In the last full one */
+    uint64_t total_cycles;      /* In all full windows */
+} WaitStats;
+
+/* Not initialized by the startup code */
+__no_init static volatile WaitStall stall;
+
+static WaitStats stats[WAIT_SITE_COUNT];
+static volatile uint8_t active = WAIT_SITE_NONE;
+static volatile bool tripped = false;  // Watchdog interrupt masked after a stall
+
+/* CPU accounting in DWT cycles, over windows of about a second */
+static uint32_t cycles_per_second;
+static uint32_t window_start;       // DWT_CYCCNT_R when the window began
+static uint32_t last_window;        // Length of the last full window
+static uint64_t total_window;       // Of all full windows
+static uint32_t nested = 0;         // Spun by waits inside the current one
+
+/* Called from the assembly stub below only */
+void Wait_RecordStall(const uint32_t *frame);
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+/*
+ * Wait_RecordStall
+ * First watchdog time-out: the main loop has not kicked for WATCHDOG_MS.
+ * frame is the exception frame of the interrupted code; its pc and the
+ * active wait site go to the stall record. The interrupt stays pending but
+ * masked, so the second time-out resets the chip unless Wait_Kick runs
+ * first.
+ */
+void Wait_RecordStall(const uint32_t *frame)
+{
+    stall.site = active;
+    stall.pc = frame[6];
+    tripped = true;
+    IntDisable(INT_WATCHDOG);
+}
+
+/*
+ * Wait_WatchdogISR
+ * Stackless, as Profile_TimerISR: passes the exception frame on in r0.
+ */
+static __stackless void Wait_WatchdogISR(void)
+{
+    __asm("TST   LR, #4");
+    __asm("ITE   EQ");
+    __asm("MRSEQ R0, MSP");
+    __asm("MRSNE R0, PSP");
+    __asm("B     Wait_RecordStall");
+}
+
+static void Record(WaitSite site, uint32_t us, bool ok)
+{
+    WaitStats *s = &stats[site];
+    uint8_t bucket = 0;
+
+    s->waits++;
+    if (!ok)
+        s->timeouts++;
+    if (us > s->max_us)
+        s->max_us = us;
+    while (bucket < WAIT_BUCKETS - 1 && (us >> (2 * (bucket + 1))) != 0)
+        bucket++;
+    if (s->hist[bucket] != 0xFFFF)
+        s->hist[bucket]++;
+}
+
+/*
+ * RollWindow
+ * Closes the current accounting window at now (DWT cycles).
+ */
+static void RollWindow(uint32_t now)
+{
+    uint8_t i;
+
+    last_window = now - window_start;
+    total_window += last_window;
+    for (i = 0; i < WAIT_SITE_COUNT; i++)
+    {
+        stats[i].last_cycles = stats[i].window_cycles;
+        stats[i].total_cycles += stats[i].window_cycles;
+        stats[i].window_cycles = 0;
+    }
+    window_start = now;
+}
+
+/* part of whole in parts per million (0 before the first full window) */
+static uint32_t Ppm(uint64_t part, uint64_t whole)
+{
+    return whole ? (uint32_t)((part * 1000000u) / whole) : 0;
+}
+
+static uint8_t SendByte(void (*put)(char), uint8_t value, uint8_t sum)
+{
+    put((char)value);
+    return (uint8_t)(sum + value);
+}
+
+static uint8_t SendU16(void (*put)(char), uint16_t value, uint8_t sum)
+{
+    sum = SendByte(put, (uint8_t)value, sum);
+    return SendByte(put, (uint8_t)(value >> 8), sum);
+}
+
+static uint8_t SendU32(void (*put)(char), uint32_t value, uint8_t sum)
+{
+    sum = SendU16(put, (uint16_t)value, sum);
+    return SendU16(put, (uint16_t)(value >> 16), sum);
+}
+
+/******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+
+void Wait_Init(void)
+{
+    uint32_t cause = SysCtlResetCauseGet();
+
+    if (stall.magic != STALL_MAGIC || (cause & (SYSCTL_CAUSE_POR | SYSCTL_CAUSE_BOR)))
+    {
+        stall.resets = 0;
+        stall.site = WAIT_SITE_NONE;
+        stall.pc = 0;
+        stall.magic = STALL_MAGIC;
+    }
+    if (cause & SYSCTL_CAUSE_WDOG0)
+        stall.resets++;
+    SysCtlResetCauseClear(cause);
+
+    DEMCR_R |= DEMCR_TRCENA;
+    DWT_CYCCNT_R = 0;
+    DWT_CTRL_R |= DWT_CTRL_CYCCNTENA;
+    cycles_per_second = SysCtlClockGet();
+    window_start = DWT_CYCCNT_R;
+
+    if (!WATCHDOG)
+        return;
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_WDOG0);
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_WDOG0))
+        ;
+    WatchdogReloadSet(WATCHDOG0_BASE, (SysCtlClockGet() / 1000) * WATCHDOG_MS);
+    WatchdogStallEnable(WATCHDOG0_BASE);    // Holds while the debugger halts the core
+    WatchdogResetEnable(WATCHDOG0_BASE);
+    WatchdogIntRegister(WATCHDOG0_BASE, Wait_WatchdogISR);
+    WatchdogEnable(WATCHDOG0_BASE);
+}
+
+void Wait_Kick(void)
+{
+    uint32_t now = DWT_CYCCNT_R;
+
+    if (now - window_start >= cycles_per_second)
+        RollWindow(now);
+
+    if (!WATCHDOG)
+        return;
+
+    WatchdogIntClear(WATCHDOG0_BASE);       // Also reloads the counter
+    if (tripped)
+    {
+        // The loop came back before the reset; the stall stays recorded
+        tripped = false;
+        IntEnable(INT_WATCHDOG);
+    }
+}
+
+bool Wait_Until(WaitSite site, bool (*ready)(void), uint32_t limit_us)
+{
+    uint8_t outer = active;
+    uint32_t outer_nested = nested;
+    uint32_t start, elapsed, start_cycles, cycles;
+    bool ok;
+
+    if (ready())
+        return true;
+
+    start = SysTick_GetUs();
+    start_cycles = DWT_CYCCNT_R;
+    active = (uint8_t)site;
+    nested = 0;
+    do
+    {
+        ok = ready();
+        elapsed = SysTick_GetUs() - start;
+    } while (!ok && elapsed < limit_us);
+    cycles = DWT_CYCCNT_R - start_cycles;
+    active = outer;     // ready may wait itself
+    stats[site].window_cycles += cycles - nested;   // Inner waits count there
+    nested = outer_nested + cycles;
+
+    Record(site, elapsed, ok);
+    return ok;
+}
+
+void Wait_Reset(void)
+{
+    uint8_t i, b;
+
+    for (i = 0; i < WAIT_SITE_COUNT; i++)
+    {
+        stats[i].waits = 0;
+        stats[i].timeouts = 0;
+        stats[i].max_us = 0;
+        for (b = 0; b < WAIT_BUCKETS; b++)
+            stats[i].hist[b] = 0;
+        stats[i].window_cycles = 0;
+        stats[i].last_cycles = 0;
+        stats[i].total_cycles = 0;
+    }
+    window_start = DWT_CYCCNT_R;
+    last_window = 0;
+    total_window = 0;
+}
+
+uint32_t Wait_SpinPpm(bool total)
+{
+    uint64_t spin = 0;
+    uint8_t i;
+
+    for (i = 0; i < WAIT_SITE_COUNT; i++)
+        spin += total ? stats[i].total_cycles : stats[i].last_cycles;
+    return Ppm(spin, total ? total_window : last_window);
+}
+
+WaitSite Wait_StallSite(void)
+{
+    return (WaitSite)stall.site;
+}
+
+uint32_t Wait_WatchdogResets(void)
+{
+    return stall.resets;
+}
+
+uint32_t Wait_Timeouts(void)
+{
+    uint32_t total = 0;
+    uint8_t i;
+
+    for (i = 0; i < WAIT_SITE_COUNT; i++)
+        total += stats[i].timeouts;
+    return total;
+}
+
+void Wait_Export(void (*put)(char))
+{
+    uint8_t i, b, sum = 0;
+
+    sum = SendU16(put, (uint16_t)(21 + WAIT_SITE_COUNT * (20 + 2 * WAIT_BUCKETS)), sum);
+    sum = SendByte(put, WAIT_VERSION, sum);
+    sum = SendByte(put, WAIT_ECU, sum);
+    sum = SendByte(put, WAIT_SITE_COUNT, sum);
+    sum = SendByte(put, WAIT_BUCKETS, sum);
+    sum = SendU32(put, stall.resets, sum);
+    sum = SendByte(put, (uint8_t)stall.site, sum);
+    sum = SendU32(put, stall.pc, sum);
+    sum = SendU32(put, Wait_SpinPpm(false), sum);
+    sum = SendU32(put, Wait_SpinPpm(true), sum);
+
+    for (i = 0; i < WAIT_SITE_COUNT; i++)
+    {
+        sum = SendU32(put, stats[i].waits, sum);
+        sum = SendU32(put, stats[i].timeouts, sum);
+        sum = SendU32(put, stats[i].max_us, sum);
+        sum = SendU32(put, Ppm(stats[i].last_cycles, last_window), sum);
+        sum = SendU32(put, Ppm(stats[i].total_cycles, total_window), sum);
+        for (b = 0; b < WAIT_BUCKETS; b++)
+            sum = SendU16(put, stats[i].hist[b], sum);
+    }
+    put((char)sum);
+}
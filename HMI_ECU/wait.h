@@ -0,0 +1,136 @@
+/******************************************************************************
+ * File: wait.h (HMI_ECU)
+ * Module: Bounded Waits
+ * Description: Every hardware busy-wait in the drivers goes through
+ *              Wait_Until, which gives up after a limit and keeps per-site
+ *              statistics. The watchdog backs it: the main loop feeds it
+ *              with Wait_Kick, and if that stops for WATCHDOG_MS the
+ *              watchdog interrupt records the wait site then active and
+ *              the interrupted PC in RAM that survives the reset, which
+ *              follows another WATCHDOG_MS later unless the loop recovers.
+ *
+ * A wait whose condition already holds returns at once and is not counted.
+ *
+ * CPU accounting: the DWT cycle counter times every wait that spins and
+ * files the cycles under its site (a wait inside another's ready callback
+ * under its own site only). Wait_Kick closes a window once a second's
+ * worth of cycles has passed; the figures are the share of the last full
+ * window and of all full windows since boot (or the last reset) spent
+ * spinning. Interrupts are charged to whatever they interrupted.
+ *
+ * Export (D page key 0; binary, little-endian, as the Control ECU's WAI):
+ *   len        uint16  number of payload bytes that follow
+ *   payload:
+ *     version    uint8   WAIT_VERSION
+ *     ecu        uint8   WAIT_ECU: 0 Control ECU, 1 HMI ECU
+ *     sites      uint8   WAIT_SITE_COUNT
+ *     buckets    uint8   WAIT_BUCKETS
+ *     resets     uint32  watchdog resets since power-on
+ *     stall_site uint8   site active at the last watchdog stall
+ *                        (WAIT_SITE_NONE: outside any wait, or none yet)
+ *     stall_pc   uint32  PC the watchdog interrupted then (0: no stall)
+ *     spin_1s    uint32  cycles spent in waits, ppm of the last window
+ *     spin_total uint32  the same over all windows
+ *     per site (WaitSite order):
+ *       waits    uint32  waits that had to spin
+ *       timeouts uint32  of those, gave up at the limit
+ *       max_us   uint32  longest
+ *       spin_1s  uint32  this site's cycles, ppm of the last window
+ *       spin_total uint32  the same over all windows
+ *       hist     uint16  x buckets (saturating)
+ *   checksum   uint8   sum of all preceding bytes (len included)
+ *
+ * Buckets as in stats.h: bucket 0 below 4us, bucket i [4^i, 4^(i+1)) us,
+ * the last one everything longer. Wait statistics start at zero on every
+ * boot; the stall record and the reset count only on power-on.
+ ******************************************************************************/
+
+#ifndef WAIT_H_
+#define WAIT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/******************************************************************************
+ * Definitions
+ ******************************************************************************/
+
+#ifndef WATCHDOG
+#define WATCHDOG 1
+#endif
+
+#define WAIT_VERSION  2
+#define WAIT_ECU      1                 /* HMI ECU */
+#define WAIT_BUCKETS  10
+#define WATCHDOG_MS   2000U             /* Main loop silence before a stall */
+
+typedef enum
+{
+    WAIT_UART2_RX,          /* Byte announced but not in the FIFO/ring */
+    WAIT_UART2_TX,          /* Room in the TX FIFO */
+    WAIT_UART2_DRAIN,       /* Transmitter idle */
+    WAIT_UART0_RX,
+    WAIT_UART0_TX,
+    WAIT_CAN_TX,            /* Transmit object free (acknowledged) */
+    WAIT_CAN_RX,
+    WAIT_ADC,               /* Potentiometer conversion */
+    WAIT_LCD_QUEUE,         /* Room in the LCD nibble queue */
+    WAIT_SITE_COUNT,
+    WAIT_SITE_NONE = 0xFF
+} WaitSite;
+
+/******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+
+/*
+ * Wait_Init
+ * Checks the reset cause against the stall record and starts the watchdog
+ * (WATCHDOG builds). Call once SysTick runs, before the other drivers.
+ */
+void Wait_Init(void);
+
+/*
+ * Wait_Kick
+ * Feeds the watchdog and closes the CPU accounting window when due. Call
+ * once per main loop pass.
+ */
+void Wait_Kick(void);
+
+/*
+ * Wait_Until
+ * Polls ready until it returns true or limit_us pass; true if it did. ready
+ * may do background work. Main loop only.
+ */
+bool Wait_Until(WaitSite site, bool (*ready)(void), uint32_t limit_us);
+
+/*
+ * Wait_Reset
+ * Clears the wait statistics and CPU accounting; the stall record and
+ * reset count stay.
+ */
+void Wait_Reset(void);
+
+/*
+ * Wait_SpinPpm
+ * Cycles spent in waits, in ppm of the last full window or, with total,
+ * of all of them. 0 until the first window closes.
+ */
+uint32_t Wait_SpinPpm(bool total);
+
+/*
+ * Wait_StallSite / Wait_WatchdogResets / Wait_Timeouts
+ * Site of the last watchdog stall (WAIT_SITE_NONE if none or outside any
+ * wait), watchdog resets since power-on, and timeouts of all sites.
+ */
+WaitSite Wait_StallSite(void);
+uint32_t Wait_WatchdogResets(void);
+uint32_t Wait_Timeouts(void);
+
+/*
+ * Wait_Export
+ * Sends the export described above through put.
+ */
+void Wait_Export(void (*put)(char));
+
+#endif /* WAIT_H_ */
@@ -0,0 +1,45 @@
+/******************************************************************************
+ * File: alloc.c
+ * Module: Host Benchmark
+ * Description: Counting malloc/calloc/realloc on top of glibc (see alloc.h)
+ ******************************************************************************/
+
+#include "alloc.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/* glibc's own entry points behind malloc and friends */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static uint64_t allocs = 0;
+
+void *malloc(size_t size)
+{
+    allocs++;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size)
+{
+    allocs++;
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    allocs++;
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr)
+{
+    __libc_free(ptr);
+}
+
+uint64_t Alloc_Count(void)
+{
+    return allocs;
+}
@@ -0,0 +1,19 @@
+/******************************************************************************
+ * File: alloc.h
+ * Module: Host Benchmark
+ * Description: Heap allocation counter for the benchmarks. alloc.c
+ *              replaces malloc, calloc and realloc (glibc) with versions
+ *              that count calls before handing them on, so a case can
+ *              report allocations per operation. The firmware has no heap;
+ *              anything but 0 is a regression.
+ ******************************************************************************/
+
+#ifndef ALLOC_H_
+#define ALLOC_H_
+
+#include <stdint.h>
+
+/* malloc, calloc and realloc calls since the program started */
+uint64_t Alloc_Count(void);
+
+#endif /* ALLOC_H_ */
@@ -0,0 +1,133 @@
+/******************************************************************************
+ * File: bench_hmi.c
+ * Module: Host Benchmark
+ * Description: HMI ECU logic without hardware: password entry through the
+ *              UI engine (ui.c) and the timeout adjust mapping and line
+ *              (see measure.h for the options and the report).
+ *
+ *   bench_hmi [-n iterations] [--json]
+ *
+ * Only ui.c and fmt.c are built (with the real ADC_Scale from adc.h);
+ * the keypad, LCD, LED and SysTick drivers they call are replaced below
+ * by a scripted key source and no-op outputs, so the figures are the
+ * engine's own.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "measure.h"
+#include "adc.h"
+#include "fmt.h"
+#include "keypad.h"
+#include "lcd.h"
+#include "led.h"
+#include "systick.h"
+#include "ui.h"
+
+#define PASSWORD_LENGTH 5
+
+enum
+{
+    SCR_ENTER,
+    SCR_VERIFY,
+    SCR_COUNT
+};
+
+static char password[PASSWORD_LENGTH + 1];
+static const char *keys = "";           /* Next keys Keypad_Poll reports */
+static uint32_t ms = 0;
+static uint32_t adc_value = 0;
+
+/* volatile so the results are not optimised away */
+static volatile uint32_t bench_sink;
+
+/******************************************************************************
+ * Drivers
+ ******************************************************************************/
+
+/* One key per call, each followed by a pass without one (the release) */
+char Keypad_Poll(void)
+{
+    static bool released = true;
+
+    if (*keys == '\0' || !released)
+    {
+        released = true;
+        return 0;
+    }
+    released = false;
+    return *keys++;
+}
+
+void LCD_Clear(void) {}
+void LCD_SetCursor(uint8_t row, uint8_t col) { (void)row; (void)col; }
+void LCD_WriteChar(char c) { bench_sink += (uint8_t)c; }
+void LED_On(LEDColor color) { (void)color; }
+void LED_AllOff(void) {}
+
+uint32_t SysTick_GetMs(void)
+{
+    return ms;
+}
+
+/******************************************************************************
+ * Screens
+ ******************************************************************************/
+
+/* Stands in for the CHK request: counts the entry, then asks again */
+static void Verify_Enter(void)
+{
+    bench_sink += (uint32_t)password[PASSWORD_LENGTH - 1];
+    UI_Goto(SCR_ENTER);
+}
+
+static const UiScreen screens[SCR_COUNT] = {
+    [SCR_ENTER]  = { "Enter Password:", NULL, UI_LED_OFF, 0, SCR_VERIFY, password, PASSWORD_LENGTH, NULL, NULL, NULL },
+    [SCR_VERIFY] = { "Verifying...", NULL, UI_LED_OFF, 0, 0, NULL, 0, Verify_Enter, NULL, NULL },
+};
+
+/******************************************************************************
+ * Cases
+ ******************************************************************************/
+
+/* A five-digit password, key by key, through to the verify screen */
+static void Bench_Entry(void)
+{
+    keys = "12345";
+    while (*keys != '\0')
+    {
+        UI_Service();
+        UI_Service();
+        ms++;
+    }
+}
+
+/* One pass of the timeout adjust screen (TmoAdjust_Tick in main.c) */
+static void Bench_Timeout(void)
+{
+    char str_buffer[UI_COLS + 1];
+    FmtBuf f;
+
+    adc_value = (adc_value + 37u) & 0xFFFu;
+    Fmt_Init(&f, str_buffer, sizeof(str_buffer));
+    Fmt_Dec(&f, (uint8_t)ADC_Scale(adc_value, 5, 30));
+    Fmt_Str(&f, " Seconds");
+    UI_SetLine(1, str_buffer);
+    UI_Service();
+}
+
+static const MeasureCase cases[] = {
+    { "hmi_entry",      Bench_Entry,    NULL },
+    { "hmi_timeout",    Bench_Timeout,  NULL },
+};
+
+/******************************************************************************
+ * Main Function
+ ******************************************************************************/
+
+int main(int argc, char **argv)
+{
+    UI_Init(screens, SCR_ENTER);
+    return Measure_Main(argc, argv, cases, sizeof(cases) / sizeof(cases[0]));
+}
@@ -0,0 +1,196 @@
+/******************************************************************************
+ * File: bench_link.c
+ * Module: Host Benchmark
+ * Description: Request-to-reply latency of the Control ECU over its link,
+ *              built once per backend: bench_link_uart (UART2, 115200 8N1)
+ *              and bench_link_can (CAN0 at 500 kbit/s, TRANSPORT_CAN).
+ *
+ *   bench_link_uart [-n iterations]
+ *   bench_link_can  [-n iterations]
+ *
+ * Requests go out tagged, as the HMI sends them, and are timed in
+ * simulated time from their first byte to the last byte of the reply:
+ * the wire both ways plus the firmware's main loop and command handling.
+ * The table shows the mean and worst round trip per command; run both
+ * builds to compare the backends.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "transport.h"
+#include "can.h"
+
+#define SLICE_US        10u
+#define TIMEOUT_US      500000u
+#define IDLE_US         2000u       /* Between requests */
+
+typedef struct
+{
+    const char *request;
+    uint8_t level;              /* CAN arbitration level of the request */
+    uint8_t reply_len;          /* Characters after the tag; 0: up to '\n' */
+} LinkCase;
+
+static const LinkCase cases[] = {
+    { "STS",        CAN_LEVEL_CONTROL,  1 },
+    { "HBT",        CAN_LEVEL_CONTROL,  1 },
+    { "CHK:12345",  CAN_LEVEL_ACCESS,   1 },
+    { "LCK",        CAN_LEVEL_ACCESS,   0 },
+    { "DOR",        CAN_LEVEL_CONTROL,  0 },
+    { "CLK",        CAN_LEVEL_CONTROL,  0 },
+};
+
+#define CASE_COUNT  (sizeof(cases) / sizeof(cases[0]))
+
+int Control_Main(void);
+
+/******************************************************************************
+ * Link
+ ******************************************************************************/
+
+static void Control_Entry(void)
+{
+    (void)Control_Main();
+}
+
+static void Link_Send(const char *line, uint8_t level)
+{
+    uint32_t len = (uint32_t)strlen(line);
+#if TRANSPORT_CAN
+    uint32_t i, n;
+
+    for (i = 0; i < len; i += n)
+    {
+        n = (len - i < 8u) ? len - i : 8u;
+        Sim_CanSend(0, CAN_ID_TO_CONTROL + CAN_ID_LEVEL(level),
+                    (const uint8_t *)&line[i], (uint8_t)n);
+    }
+#else
+    (void)level;
+    Sim_UartSend(line, len);
+#endif
+}
+
+/* Appends what has arrived to buf; returns the new length */
+static uint32_t Link_Receive(char *buf, uint32_t len, uint32_t size)
+{
+#if TRANSPORT_CAN
+    SimCanFrame f;
+
+    while (Sim_CanReceive(&f))
+    {
+        if (len + f.len <= size)
+        {
+            memcpy(&buf[len], f.data, f.len);
+            len += f.len;
+        }
+    }
+    return len;
+#else
+    return len + Sim_UartReceive(&buf[len], size - len);
+#endif
+}
+
+static bool Reply_Done(const LinkCase *c, const char *reply, uint32_t len)
+{
+    if (c->reply_len != 0)
+        return len >= 2u + c->reply_len;
+    return len > 2u && reply[len - 1] == '\n';
+}
+
+/* One tagged request; its round trip in us, 0 if no reply */
+static uint32_t Round_Trip(const LinkCase *c, char tag)
+{
+    char line[24], reply[32];
+    uint32_t len = 0;
+    uint64_t start;
+
+    snprintf(line, sizeof(line), "^%c%s\n", tag, c->request);
+    start = Sim_NowUs();
+    Link_Send(line, c->level);
+    while (Sim_NowUs() - start < TIMEOUT_US)
+    {
+        if (!Sim_Run(SLICE_US))
+            return 0;
+        len = Link_Receive(reply, len, sizeof(reply));
+        if (len >= 3 && reply[2] == '^')
+        {
+            // Bare tag ahead of a deferred reply (SET)
+            memmove(reply, &reply[2], len - 2);
+            len -= 2;
+        }
+        if (Reply_Done(c, reply, len))
+            return (reply[1] == tag) ? (uint32_t)(Sim_NowUs() - start) : 0;
+    }
+    return 0;
+}
+
+/* Runs us of main loop and drops anything the firmware sent */
+static bool Idle(uint32_t us)
+{
+    char sink[64];
+    bool running = Sim_Run(us);
+
+    while (Link_Receive(sink, 0, sizeof(sink)) != 0)
+        ;
+    return running;
+}
+
+/******************************************************************************
+ * Main Function
+ ******************************************************************************/
+
+int main(int argc, char **argv)
+{
+    uint64_t total[CASE_COUNT] = { 0 };
+    uint32_t worst[CASE_COUNT] = { 0 };
+    uint32_t iterations = 100, i, us;
+    uint8_t k;
+    char tag = 'a';
+
+    if (argc == 3 && strcmp(argv[1], "-n") == 0)
+        iterations = (uint32_t)strtoul(argv[2], NULL, 10);
+    if (iterations == 0 || (argc != 1 && argc != 3))
+    {
+        fprintf(stderr, "usage: %s [-n iterations]\n", argv[0]);
+        return 2;
+    }
+
+    // Boot, then store the password CHK compares against
+    Sim_EraseAll();
+    Sim_Start(Control_Entry);
+    if (!Idle(300000u) || Round_Trip(&(LinkCase){ "SET:12345", 0, 1 }, 'z') == 0)
+    {
+        fprintf(stderr, "%s: the firmware did not answer\n", argv[0]);
+        return 1;
+    }
+
+    for (i = 0; i < iterations; i++)
+    {
+        for (k = 0; k < CASE_COUNT; k++)
+        {
+            tag = (char)((tag - 'a' + 1) % 26 + 'a');
+            us = Round_Trip(&cases[k], tag);
+            if (us == 0 || !Idle(IDLE_US))
+            {
+                fprintf(stderr, "%s: no reply to %s\n", argv[0], cases[k].request);
+                return 1;
+            }
+            total[k] += us;
+            if (us > worst[k])
+                worst[k] = us;
+        }
+    }
+
+    printf("%s, %u iterations\n", TRANSPORT_CAN ? "CAN 500 kbit/s" : "UART 115200",
+           iterations);
+    printf("%-12s %9s %9s\n", "request", "mean us", "worst us");
+    for (k = 0; k < CASE_COUNT; k++)
+        printf("%-12s %9llu %9u\n", cases[k].request,
+               (unsigned long long)(total[k] / iterations), worst[k]);
+    return 0;
+}
@@ -0,0 +1,157 @@
+/******************************************************************************
+ * File: measure.c
+ * Module: Host Benchmark
+ * Description: Timing loop and report shared by the host benchmarks
+ *              (see measure.h)
+ ******************************************************************************/
+
+#include "measure.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "alloc.h"
+#include "sim.h"
+
+typedef struct
+{
+    double mean_ns;
+    uint64_t median_ns;
+    uint64_t worst_ns;
+    uint64_t worst_cycles;
+    double mean_sim;
+    uint64_t worst_sim;
+    double allocs;              /* Per operation */
+} MeasureResult;
+
+/* Per-call times of the case being run, for the median */
+static uint64_t samples[MEASURE_MAX_ITERATIONS];
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+static uint64_t Host_Ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t Host_Cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static int Compare_U64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+static void Run_Case(const MeasureCase *c, uint32_t n, MeasureResult *r)
+{
+    uint64_t total_ns = 0, total_sim = 0, total_allocs = 0;
+    uint64_t ns, cycles, sim, allocs;
+    uint32_t i;
+
+    memset(r, 0, sizeof(*r));
+    for (i = 0; i < MEASURE_WARMUP + n; i++)
+    {
+        allocs = Alloc_Count();
+        sim = Sim_Now();
+        cycles = Host_Cycles();
+        ns = Host_Ns();
+        c->op();
+        ns = Host_Ns() - ns;
+        cycles = Host_Cycles() - cycles;
+        sim = Sim_Now() - sim;
+        allocs = Alloc_Count() - allocs;
+        if (c->between != NULL)
+            c->between();
+
+        if (i < MEASURE_WARMUP)
+            continue;
+        samples[i - MEASURE_WARMUP] = ns;
+        total_ns += ns;
+        total_sim += sim;
+        total_allocs += allocs;
+        if (ns > r->worst_ns)
+            r->worst_ns = ns;
+        if (cycles > r->worst_cycles)
+            r->worst_cycles = cycles;
+        if (sim > r->worst_sim)
+            r->worst_sim = sim;
+    }
+
+    qsort(samples, n, sizeof(samples[0]), Compare_U64);
+    r->median_ns = samples[n / 2];
+    r->mean_ns = (double)total_ns / n;
+    r->mean_sim = (double)total_sim / n;
+    r->allocs = (double)total_allocs / n;
+}
+
+/******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+
+int Measure_Main(int argc, char **argv, const MeasureCase *cases, uint32_t count)
+{
+    uint32_t n = MEASURE_DEFAULT_ITERATIONS;
+    bool json = false;
+    MeasureResult r;
+    uint32_t i;
+    int a;
+
+    for (a = 1; a < argc; a++)
+    {
+        if (strcmp(argv[a], "-n") == 0 && a + 1 < argc)
+            n = (uint32_t)strtoul(argv[++a], NULL, 10);
+        else if (strcmp(argv[a], "--json") == 0)
+            json = true;
+        else
+            n = 0;
+    }
+    if (n == 0 || n > MEASURE_MAX_ITERATIONS)
+    {
+        fprintf(stderr, "usage: %s [-n 1..%u] [--json]\n", argv[0], MEASURE_MAX_ITERATIONS);
+        return 2;
+    }
+
+    if (json)
+        printf("{\n");
+    else
+        printf("%-14s %11s %9s %9s %9s %11s %9s %9s %7s\n", "case", "op/s", "mean ns",
+               "median ns", "worst ns", "worst cyc", "sim cyc", "worst sim", "allocs");
+
+    for (i = 0; i < count; i++)
+    {
+        Run_Case(&cases[i], n, &r);
+        if (json)
+        {
+            printf("  \"%s\": {\"ns\": %llu, \"allocs\": %g}%s\n", cases[i].name,
+                   (unsigned long long)r.median_ns, r.allocs, (i + 1 < count) ? "," : "");
+            continue;
+        }
+        printf("%-14s %11.0f %9.0f %9llu %9llu %11llu %9.0f %9llu %7g\n", cases[i].name,
+               r.mean_ns != 0 ? 1e9 / r.mean_ns : 0.0, r.mean_ns,
+               (unsigned long long)r.median_ns, (unsigned long long)r.worst_ns,
+               (unsigned long long)r.worst_cycles, r.mean_sim,
+               (unsigned long long)r.worst_sim, r.allocs);
+    }
+
+    if (json)
+        printf("}\n");
+    return 0;
+}
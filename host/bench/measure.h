@@ -0,0 +1,41 @@
+/******************************************************************************
+ * File: measure.h
+ * Module: Host Benchmark
+ * Description: Timing loop and report shared by the host benchmarks.
+ *
+ *   bench_<name> [-n iterations] [--json]
+ *
+ * A case is one operation, run n times after a warm-up. For every call
+ * the host time (ns), the host CPU cycles (TSC, x86 only), the simulated
+ * target cycles at 16 MHz and the heap allocations are taken. The table
+ * shows operations per second, mean, median and worst case; --json
+ * prints the median ns and the allocations per operation of every case
+ * for tools/bench.py. Simulated cycles count only the firmware's waits
+ * and driver polls, not its computation.
+ ******************************************************************************/
+
+#ifndef MEASURE_H_
+#define MEASURE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MEASURE_DEFAULT_ITERATIONS  20000u
+#define MEASURE_MAX_ITERATIONS      1000000u
+#define MEASURE_WARMUP              100u
+
+typedef struct
+{
+    const char *name;
+    void (*op)(void);           /* The operation timed */
+    void (*between)(void);      /* Untimed work after each call, or NULL */
+} MeasureCase;
+
+/*
+ * Measure_Main
+ * Parses the command line, runs every case and prints the table or the
+ * JSON. Returns the exit status for main.
+ */
+int Measure_Main(int argc, char **argv, const MeasureCase *cases, uint32_t count);
+
+#endif /* MEASURE_H_ */
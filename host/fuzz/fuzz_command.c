@@ -0,0 +1,120 @@
+/******************************************************************************
+ * File: fuzz_command.c
+ * Module: Host Fuzzing
+ * Description: libFuzzer/AFL target for the Control ECU command parser.
+ *
+ * Input: the first byte picks the session (bus node), the rest is split
+ * into lines at '\n' and each line goes to ProcessCommand as bus.c would
+ * hand it over: at most COMMAND_BUFFER_SIZE - 1 bytes with the terminator,
+ * in a buffer of exactly that size so an over-read hits the sanitizer.
+ * Between lines the main loop's services run and EEPROM writes complete.
+ *
+ * The firmware is booted once (its real main, up to the RDY frame) and
+ * keeps its state from input to input, as on the bench; an input that
+ * resets it (UPD), or keeps a line busy past LINE_BUDGET_MS of simulated
+ * time, is cut off and boots it again for the next one.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+#include "ecu.h"
+#include "command.h"
+#include "eventlog.h"
+#include "motor.h"
+
+#define LINE_GAP_US     500u    /* Main loop time between two lines */
+#define LINE_BUDGET_MS  20u     /* Simulated time one line may take */
+#define WATCH_US        100u
+
+static bool booted = false;
+static const uint8_t *input;
+static size_t input_size;
+static uint64_t line_deadline;          /* Sim_NowUs limit for this line */
+static char *line;                      /* Freed here if the line is cut off */
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+static void Drain(void)
+{
+    char sink[256];
+
+    while (Sim_UartReceive(sink, sizeof(sink)) != 0)
+        ;
+}
+
+static void Budget_Watch(void)
+{
+    if (Sim_NowUs() >= line_deadline)
+        Sim_Stop();
+}
+
+static void Service(void)
+{
+    uint8_t session;
+    char reply;
+
+    Sim_AdvanceUs(LINE_GAP_US);
+    EventLog_Service();
+    motor_service();
+    while (TakeDeferredReply(&session, &reply))
+        ;
+    Drain();
+}
+
+static void Run_Lines(void)
+{
+    uint8_t session = input[0] % COMMAND_SESSIONS;
+    size_t pos = 1;
+
+    while (pos < input_size)
+    {
+        const uint8_t *nl = memchr(&input[pos], '\n', input_size - pos);
+        size_t len = nl ? (size_t)(nl - &input[pos]) + 1u : input_size - pos;
+        size_t keep = (len < COMMAND_BUFFER_SIZE - 1) ? len : COMMAND_BUFFER_SIZE - 1;
+
+        line = malloc(keep + 1);
+        memcpy(line, &input[pos], keep);
+        line[keep] = '\0';
+        line_deadline = Sim_NowUs() + LINE_BUDGET_MS * 1000u;
+        ProcessCommand(session, line);
+        free(line);
+        line = NULL;
+
+        Service();
+        pos += len;
+    }
+}
+
+/******************************************************************************
+ * Fuzz Target
+ ******************************************************************************/
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    if (size == 0)
+        return 0;
+
+    if (!booted)
+    {
+        Sim_UartSetByteCycles(0);   // Replies leave at once; nothing to pace
+        if (!Ecu_Init())
+            abort();
+        booted = true;
+    }
+
+    input = data;
+    input_size = size;
+    Sim_SetPeer(Budget_Watch, WATCH_US);
+    if (Sim_Call(Run_Lines) != SIM_EXIT_RETURN)
+        booted = false;     // Reset or cut off: boot afresh next time
+    Sim_SetPeer(0, 0);
+    free(line);
+    line = NULL;
+    Drain();
+    return 0;
+}
@@ -0,0 +1,194 @@
+/******************************************************************************
+ * File: standalone.c
+ * Module: Host Fuzzing
+ * Description: main for fuzz targets built without libFuzzer (gcc, AFL).
+ *
+ *   fuzz_command [-runs=N] [file|directory ...]
+ *
+ * Every file given, or in a directory given, is run once; with no paths
+ * the input is read from stdin (AFL: afl-fuzz -- ./fuzz_command). With
+ * -runs=N, N more inputs are made by mutating those (bit flips, protocol
+ * tokens, deletions, splices) from a fixed seed, so a ctest run is
+ * repeatable. Other -flag=value options are libFuzzer's and are ignored.
+ ******************************************************************************/
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#define INPUT_SIZE      512u
+#define MAX_SEEDS       256u
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size);
+
+typedef struct
+{
+    uint8_t data[INPUT_SIZE];
+    size_t size;
+} Input;
+
+static Input seeds[MAX_SEEDS];
+static unsigned seed_count = 0;
+static uint32_t rng = 0x2545F491u;
+
+/* Opcodes and fields worth splicing in (see command.dict) */
+static const char *const tokens[] = {
+    "STS", "HBT", "SET:", "CHK:", "PWD:", "LCK", "ALM", "LOG", "LOG:", "BOT",
+    "BTM:", "TMO:", "UPD", "DOR", "CLK", "CLK:", "SCH:", "SCH:0", "PRF", "PRF:0",
+    "OTK:", "OTK:0", "EXP", "IMP:", "TRC", "TRC:0", "WAI", "WAI:0", "ENT",
+    "ENT:", "STAT", "12345", ",1", ",3", "\n", "\r\n", ":", "^a",
+    "1111100", "0700", "2400", "00112233445566778899",
+};
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+static uint32_t Random(void)
+{
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return rng;
+}
+
+static void Add_File(const char *path)
+{
+    FILE *f;
+
+    if (seed_count == MAX_SEEDS)
+        return;
+    f = fopen(path, "rb");
+    if (f == NULL)
+    {
+        fprintf(stderr, "%s: cannot open\n", path);
+        exit(2);
+    }
+    seeds[seed_count].size = fread(seeds[seed_count].data, 1, INPUT_SIZE, f);
+    fclose(f);
+    seed_count++;
+}
+
+static int Compare_Names(const void *a, const void *b)
+{
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+/* Files of a directory in name order, so runs are repeatable */
+static void Add_Directory(const char *path)
+{
+    char *names[MAX_SEEDS];
+    unsigned count = 0, i;
+    struct dirent *e;
+    DIR *d = opendir(path);
+    char file[1024];
+
+    if (d == NULL)
+        return;
+    while ((e = readdir(d)) != NULL && count < MAX_SEEDS)
+    {
+        if (e->d_name[0] != '.')
+            names[count++] = strdup(e->d_name);
+    }
+    closedir(d);
+    qsort(names, count, sizeof(names[0]), Compare_Names);
+    for (i = 0; i < count; i++)
+    {
+        snprintf(file, sizeof(file), "%s/%s", path, names[i]);
+        Add_File(file);
+        free(names[i]);
+    }
+}
+
+static void Insert(Input *in, size_t at, const void *data, size_t len)
+{
+    if (in->size + len > INPUT_SIZE)
+        return;
+    memmove(&in->data[at + len], &in->data[at], in->size - at);
+    memcpy(&in->data[at], data, len);
+    in->size += len;
+}
+
+static void Mutate(Input *in)
+{
+    unsigned n = 1u + Random() % 4u;
+    size_t at, len;
+    const char *token;
+    const Input *other;
+
+    while (n-- > 0)
+    {
+        at = (in->size != 0) ? Random() % in->size : 0;
+        switch (Random() % 5u)
+        {
+        case 0:
+            if (in->size != 0)
+                in->data[at] ^= (uint8_t)(1u << (Random() % 8u));
+            break;
+        case 1:
+            if (in->size != 0)
+                in->data[at] = (uint8_t)("0123456789:,\n^" [Random() % 14u]);
+            break;
+        case 2:
+            token = tokens[Random() % (sizeof(tokens) / sizeof(tokens[0]))];
+            Insert(in, at, token, strlen(token));
+            break;
+        case 3:
+            len = (in->size - at != 0) ? 1u + Random() % (in->size - at) : 0;
+            memmove(&in->data[at], &in->data[at + len], in->size - at - len);
+            in->size -= len;
+            break;
+        default:
+            other = &seeds[Random() % seed_count];
+            len = (other->size != 0) ? Random() % other->size : 0;
+            Insert(in, at, other->data, len);
+            break;
+        }
+    }
+}
+
+/******************************************************************************
+ * Main Function
+ ******************************************************************************/
+
+int main(int argc, char **argv)
+{
+    unsigned long runs = 0, i;
+    struct stat st;
+    Input in;
+    int a;
+
+    for (a = 1; a < argc; a++)
+    {
+        if (strncmp(argv[a], "-runs=", 6) == 0)
+            runs = strtoul(&argv[a][6], NULL, 10);
+        else if (argv[a][0] == '-')
+            continue;
+        else if (stat(argv[a], &st) == 0 && S_ISDIR(st.st_mode))
+            Add_Directory(argv[a]);
+        else
+            Add_File(argv[a]);
+    }
+
+    if (seed_count == 0)
+    {
+        seeds[0].size = fread(seeds[0].data, 1, INPUT_SIZE, stdin);
+        seed_count = 1;
+    }
+
+    for (i = 0; i < seed_count; i++)
+        LLVMFuzzerTestOneInput(seeds[i].data, seeds[i].size);
+
+    for (i = 0; i < runs; i++)
+    {
+        in = seeds[Random() % seed_count];
+        Mutate(&in);
+        LLVMFuzzerTestOneInput(in.data, in.size);
+    }
+
+    printf("%s: %lu inputs\n", argv[0], seed_count + runs);
+    return 0;
+}
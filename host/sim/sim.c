@@ -0,0 +1,435 @@
+/******************************************************************************
+ * File: sim.c
+ * Module: Host Simulator
+ * Description: Simulated time, the register file behind HWREG, SysTick,
+ *              the interrupt controller and Sim_Call
+ ******************************************************************************/
+
+#include "sim.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <setjmp.h>
+#include <ucontext.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_nvic.h"
+#include "driverlib/interrupt.h"
+
+#define REG_SLOTS           512u
+#define VTABLE_SLOT         0u          /* NVIC_VTABLE, checked every advance */
+#define DWT_CYCCNT          0xE0001004u
+#define ST_CTRL_ENABLE      0x00000001u
+#define ST_CTRL_TICKINT     0x00000002u
+#define ST_CTRL_COUNT       0x00010000u
+
+/* The firmware's SysTick handler when it is linked in (systick.c) */
+extern void SysTick_Handler(void) __attribute__((weak));
+
+typedef struct CallFrame
+{
+    jmp_buf env;
+    struct CallFrame *outer;
+} CallFrame;
+
+static uint64_t now = 0;
+static bool advancing = false;
+
+/* Register file: any address the firmware touches gets a slot */
+static uint32_t reg_address[REG_SLOTS] = { [VTABLE_SLOT] = NVIC_VTABLE };
+static volatile uint32_t reg_value[REG_SLOTS];
+static uint32_t reg_count = VTABLE_SLOT + 1u;
+
+/* SysTick */
+static bool tick_running = false;
+static uint64_t tick_last = 0;
+static bool tick_counted = false;       /* COUNTFLAG */
+
+/* Interrupt controller */
+static void (*handlers[NUM_INTERRUPTS])(void);
+static bool enabled[NUM_INTERRUPTS];
+static bool pending[NUM_INTERRUPTS];
+static bool masked = false;             /* PRIMASK */
+static bool in_handler = false;
+
+/* Peer hook */
+static void (*peer)(void) = 0;
+static uint32_t peer_period = 0;
+static uint64_t peer_next = 0;
+static bool in_peer = false;
+
+static CallFrame *calls = 0;
+
+/* Firmware context (Sim_Start/Sim_Run) */
+#define FW_STACK_SIZE       (1u << 20)
+static ucontext_t host_context, fw_context;
+static uint8_t fw_stack[FW_STACK_SIZE] __attribute__((aligned(16)));
+static void (*fw_entry)(void);
+static CallFrame *fw_calls = 0;         /* Its Sim_Call frames while paused */
+static bool fw_alive = false;
+static bool fw_running = false;         /* Executing in the firmware context */
+static uint64_t fw_until = 0;
+static SimExit fw_exit = SIM_EXIT_RETURN;
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+static volatile uint32_t *Reg_Slot(uint32_t address)
+{
+    uint32_t i;
+
+    for (i = 0; i < reg_count; i++)
+    {
+        if (reg_address[i] == address)
+            return &reg_value[i];
+    }
+    if (reg_count == REG_SLOTS)
+    {
+        fprintf(stderr, "sim: register file full at 0x%08X\n", (unsigned)address);
+        abort();
+    }
+    reg_address[reg_count] = address;
+    reg_value[reg_count] = 0;
+    return &reg_value[reg_count++];
+}
+
+static uint32_t Tick_Period(void)
+{
+    return *Reg_Slot(NVIC_ST_RELOAD) + 1u;
+}
+
+/*
+ * Dispatch
+ * Takes the pending, enabled interrupts, lowest number first, unless
+ * masked or already in a handler (no nesting).
+ */
+static void Dispatch(void)
+{
+    uint32_t i;
+    bool taken = true;
+
+    while (taken && !masked && !in_handler)
+    {
+        taken = false;
+        for (i = 0; i < NUM_INTERRUPTS && !taken; i++)
+        {
+            if (!pending[i] || !enabled[i] || handlers[i] == 0)
+                continue;
+            pending[i] = false;
+            in_handler = true;
+            handlers[i]();
+            in_handler = false;
+            taken = true;
+        }
+    }
+}
+
+/*
+ * Tick
+ * Runs SysTick up to target, one period at a time.
+ */
+static void Tick(uint64_t target)
+{
+    uint32_t ctrl = *Reg_Slot(NVIC_ST_CTRL);
+    uint32_t period = Tick_Period();
+
+    if (!(ctrl & ST_CTRL_ENABLE) || period < 2)
+    {
+        tick_running = false;
+        return;
+    }
+    if (!tick_running)
+    {
+        tick_running = true;
+        tick_last = now;
+    }
+
+    while (tick_last + period <= target)
+    {
+        tick_last += period;
+        now = tick_last;
+        tick_counted = true;
+        if (ctrl & ST_CTRL_TICKINT)
+        {
+            handlers[FAULT_SYSTICK] = SysTick_Handler;
+            enabled[FAULT_SYSTICK] = true;
+            pending[FAULT_SYSTICK] = true;
+            Dispatch();
+        }
+    }
+}
+
+static void Run_Peer(void)
+{
+    if (peer == 0 || in_peer || now < peer_next)
+        return;
+    in_peer = true;
+    peer_next = now + (uint64_t)peer_period * SIM_CYCLES_PER_US;
+    peer();
+    in_peer = false;
+}
+
+static void Fw_Main(void)
+{
+    fw_exit = Sim_Call(fw_entry);
+    fw_alive = false;
+    // Returns to host_context through uc_link
+}
+
+/* Hands the CPU back to Sim_Run once the firmware's time slice is over */
+static void Fw_Yield(void)
+{
+    if (fw_running && !in_handler && !in_peer && now >= fw_until)
+        swapcontext(&fw_context, &host_context);
+}
+
+/******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+
+uint64_t Sim_Now(void)
+{
+    return now;
+}
+
+uint64_t Sim_NowUs(void)
+{
+    return now / SIM_CYCLES_PER_US;
+}
+
+void Sim_Advance(uint32_t cycles)
+{
+    uint64_t target = now + cycles;
+
+    if (advancing)
+    {
+        now = target;   // Polled from an interrupt handler taken meanwhile
+        return;
+    }
+
+    advancing = true;
+    Tick(target);
+    now = target;
+    SimUart_Service();
+    SimCan_Service();
+    SimEeprom_Service();
+    advancing = false;
+
+    if (reg_value[VTABLE_SLOT] != 0)
+    {
+        reg_value[VTABLE_SLOT] = 0;     // Image_Jump: the application starts
+        Sim_Exit(SIM_EXIT_JUMP);
+    }
+    Dispatch();
+    Run_Peer();
+    Fw_Yield();
+}
+
+void Sim_AdvanceUs(uint32_t us)
+{
+    Sim_Advance(us * SIM_CYCLES_PER_US);
+}
+
+void Sim_Poll(void)
+{
+    Sim_Advance(SIM_POLL_CYCLES);
+}
+
+void Sim_Raise(uint32_t interrupt)
+{
+    pending[interrupt] = true;
+    if (!advancing)
+        Dispatch();
+}
+
+void Sim_SetPeer(void (*service)(void), uint32_t period_us)
+{
+    peer = service;
+    peer_period = period_us;
+    peer_next = now;
+}
+
+SimExit Sim_Call(void (*entry)(void))
+{
+    CallFrame frame;
+    volatile SimExit how = SIM_EXIT_RETURN;
+    int code;
+
+    frame.outer = calls;
+    calls = &frame;
+    code = setjmp(frame.env);
+    if (code == 0)
+        entry();
+    else
+        how = (SimExit)(code - 1);
+    calls = frame.outer;
+
+    in_peer = false;
+    in_handler = false;
+    advancing = false;
+    if (how == SIM_EXIT_RESET || how == SIM_EXIT_POWER_CUT)
+        Sim_ResetPeripherals();
+    return how;
+}
+
+void Sim_Start(void (*entry)(void))
+{
+    fw_entry = entry;
+    fw_calls = 0;
+    fw_alive = true;
+    getcontext(&fw_context);
+    fw_context.uc_stack.ss_sp = fw_stack;
+    fw_context.uc_stack.ss_size = sizeof(fw_stack);
+    fw_context.uc_link = &host_context;
+    makecontext(&fw_context, Fw_Main, 0);
+}
+
+bool Sim_Run(uint32_t us)
+{
+    CallFrame *host_calls = calls;
+
+    if (!fw_alive)
+        return false;
+
+    fw_until = now + (uint64_t)us * SIM_CYCLES_PER_US;
+    calls = fw_calls;
+    fw_running = true;
+    swapcontext(&host_context, &fw_context);
+    fw_running = false;
+    fw_calls = calls;
+    calls = host_calls;
+    return fw_alive;
+}
+
+SimExit Sim_LastExit(void)
+{
+    return fw_exit;
+}
+
+void Sim_Exit(SimExit how)
+{
+    if (calls == 0)
+    {
+        fprintf(stderr, "sim: firmware exit %d outside Sim_Call\n", (int)how);
+        abort();
+    }
+    longjmp(calls->env, (int)how + 1);
+}
+
+void Sim_Stop(void)
+{
+    Sim_Exit(SIM_EXIT_STOP);
+}
+
+void Sim_ResetPeripherals(void)
+{
+    uint32_t i;
+
+    reg_count = VTABLE_SLOT + 1u;
+    reg_value[VTABLE_SLOT] = 0;
+    tick_running = false;
+    tick_counted = false;
+    for (i = 0; i < NUM_INTERRUPTS; i++)
+    {
+        handlers[i] = 0;
+        enabled[i] = false;
+        pending[i] = false;
+    }
+    masked = false;
+    in_handler = false;
+
+    SimUart_Reset();
+    SimCan_Reset();
+    SimEeprom_Reset();
+    SimFlash_Reset();
+    SimPeriph_Reset();
+}
+
+uint32_t Sim_Random(uint32_t *state)
+{
+    uint32_t x = (*state != 0) ? *state : 0x9E3779B9u;
+
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/******************************************************************************
+ * Register file (HWREG and the device header registers)
+ ******************************************************************************/
+
+volatile uint32_t *Sim_Reg(uint32_t address)
+{
+    volatile uint32_t *slot = Reg_Slot(address);
+    uint32_t period;
+
+    switch (address)
+    {
+    case NVIC_ST_CURRENT:
+        period = Tick_Period();
+        *slot = tick_running ? period - 1u - (uint32_t)(now - tick_last) : 0;
+        break;
+    case NVIC_ST_CTRL:
+        Sim_Poll();
+        *slot = (*slot & ~ST_CTRL_COUNT) | (tick_counted ? ST_CTRL_COUNT : 0);
+        tick_counted = false;
+        break;
+    case DWT_CYCCNT:
+        *slot = (uint32_t)now;
+        break;
+    default:
+        if ((address & ~0xFFFu) == UART2_BASE)
+            return SimUart_Reg(address, slot);
+        if ((address & ~0xFFFu) == FLASH_CTRL_BASE)
+            return SimFlash_Reg(address, slot);
+        break;
+    }
+    return slot;
+}
+
+/******************************************************************************
+ * driverlib/interrupt.h
+ ******************************************************************************/
+
+bool IntMasterEnable(void)
+{
+    bool was = masked;
+
+    masked = false;
+    Dispatch();
+    return was;
+}
+
+bool IntMasterDisable(void)
+{
+    bool was = masked;
+
+    masked = true;
+    return was;
+}
+
+void IntEnable(uint32_t ui32Interrupt)
+{
+    enabled[ui32Interrupt] = true;
+    Dispatch();
+}
+
+void IntDisable(uint32_t ui32Interrupt)
+{
+    enabled[ui32Interrupt] = false;
+}
+
+void IntRegister(uint32_t ui32Interrupt, void (*pfnHandler)(void))
+{
+    handlers[ui32Interrupt] = pfnHandler;
+}
+
+void IntPrioritySet(uint32_t ui32Interrupt, uint8_t ui8Priority)
+{
+    (void)ui32Interrupt;
+    (void)ui8Priority;
+}
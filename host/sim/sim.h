@@ -0,0 +1,246 @@
+/******************************************************************************
+ * File: sim.h
+ * Module: Host Simulator
+ * Description: Cycle-counted stand-in for the TM4C123 peripherals the
+ *              firmware uses, so its sources run unchanged on a PC
+ *              (see host/CMakeLists.txt).
+ *
+ * Time is a 16 MHz cycle counter that only moves when something asks it
+ * to: every driverlib status poll costs SIM_POLL_CYCLES, so the
+ * firmware's bounded waits make progress, and harnesses advance it
+ * between main loop passes. As time passes the SysTick, timers, EEPROM,
+ * UART2 wire and CAN bus catch up, interrupts are taken, and the peer
+ * hook (the other end of the link) gets to run.
+ *
+ * The far end of UART2 and of the CAN bus belongs to the harness: it
+ * sends with Sim_UartSend / Sim_CanSend and takes what the firmware sent
+ * with Sim_UartReceive / Sim_CanReceive.
+ *
+ * Resets: SysCtlReset, a power cut (Sim_FlashCutAfter) or Sim_Stop leave
+ * the firmware through longjmp back to Sim_Call. RAM keeps its contents,
+ * as after a warm reset that skipped the startup code; after a reset or
+ * power cut the peripherals go back to their reset state, EEPROM, flash
+ * and the RTC keep theirs.
+ ******************************************************************************/
+
+#ifndef SIM_H_
+#define SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SIM_CLOCK_HZ        16000000u
+#define SIM_CYCLES_PER_US   (SIM_CLOCK_HZ / 1000000u)
+#define SIM_POLL_CYCLES     16u             /* One status register poll */
+
+#define SIM_FLASH_SIZE      0x40000u        /* 256 KB */
+#define SIM_EEPROM_SIZE     2048u           /* Bytes */
+
+/******************************************************************************
+ * Time and interrupts
+ ******************************************************************************/
+
+/* Cycles since the simulator started (never wraps in practice) */
+uint64_t Sim_Now(void);
+uint64_t Sim_NowUs(void);
+
+/*
+ * Sim_Advance
+ * Lets cycles pass: SysTick interrupts, peripheral events, pending
+ * interrupts, then the peer hook.
+ */
+void Sim_Advance(uint32_t cycles);
+void Sim_AdvanceUs(uint32_t us);
+
+/* Sim_Advance(SIM_POLL_CYCLES); called by every driverlib status read */
+void Sim_Poll(void);
+
+/*
+ * Sim_Raise
+ * Marks an interrupt (INT_*) pending; taken at once when it is enabled
+ * and interrupts are not masked, else when that changes.
+ */
+void Sim_Raise(uint32_t interrupt);
+
+/*
+ * Sim_SetPeer
+ * service runs after every Sim_Advance, at most every period_us of
+ * simulated time, never nested: the other ECU, the bus nodes, or a test
+ * script. NULL removes it.
+ */
+void Sim_SetPeer(void (*service)(void), uint32_t period_us);
+
+/******************************************************************************
+ * Running firmware
+ ******************************************************************************/
+
+typedef enum
+{
+    SIM_EXIT_RETURN,        /* entry returned */
+    SIM_EXIT_RESET,         /* SysCtlReset */
+    SIM_EXIT_POWER_CUT,     /* Sim_FlashCutAfter ran out */
+    SIM_EXIT_STOP,          /* Sim_Stop, e.g. from the peer hook */
+    SIM_EXIT_JUMP           /* Vector table moved: the bootloader started
+                               the application */
+} SimExit;
+
+/*
+ * Sim_Call
+ * Runs entry (usually a firmware main renamed by the build) until it
+ * returns or leaves through one of the exits above. Peripherals are reset
+ * after a reset or power cut; after SIM_EXIT_STOP they are left as they
+ * are, so a harness can boot the firmware and then call into it, and
+ * after SIM_EXIT_JUMP, as the application would find them.
+ */
+SimExit Sim_Call(void (*entry)(void));
+
+/*
+ * Sim_Start / Sim_Run
+ * Runs entry as the firmware in a context of its own (under Sim_Call), so
+ * a harness can take turns with it: Sim_Run lets it run for us of
+ * simulated time, pausing it at its next poll, and returns false once it
+ * has left (Sim_LastExit says how). Sim_Start again to boot it afresh; a
+ * paused firmware is simply abandoned.
+ */
+void Sim_Start(void (*entry)(void));
+bool Sim_Run(uint32_t us);
+SimExit Sim_LastExit(void);
+
+/* Leaves the innermost Sim_Call with SIM_EXIT_STOP */
+void Sim_Stop(void);
+
+/* Internal: leaves the innermost Sim_Call with how */
+void Sim_Exit(SimExit how);
+
+/* Peripherals back to their reset state; non-volatile memory is kept */
+void Sim_ResetPeripherals(void);
+
+/* Value SysCtlResetCauseGet reports after the next reset */
+void Sim_SetResetCause(uint32_t cause);
+
+/******************************************************************************
+ * Memories
+ ******************************************************************************/
+
+/* Flash and EEPROM back to erased (all ones) */
+void Sim_EraseAll(void);
+
+/* Internal flash contents (SIM_FLASH_SIZE bytes); the harness may read
+ * and write it directly, e.g. to place an application image */
+extern uint8_t Sim_Flash[];
+
+/* Raw EEPROM, bypassing the controller (no time, no faults) */
+void Sim_EepromPeek(uint32_t address, void *data, uint32_t count);
+void Sim_EepromPoke(uint32_t address, const void *data, uint32_t count);
+
+/*
+ * Sim_EepromFailWords
+ * The next words programmed are stored with bit 0 inverted, so their
+ * read-back fails.
+ */
+void Sim_EepromFailWords(uint32_t words);
+
+/* Word programs since start (blocking and non-blocking) */
+uint32_t Sim_EepromWordsProgrammed(void);
+
+/*
+ * Sim_FlashCutAfter
+ * Power fails in place of the flash operation (page erase or word
+ * program) after the next ops; 0 disarms.
+ */
+void Sim_FlashCutAfter(uint32_t ops);
+
+/******************************************************************************
+ * UART2 (far end)
+ ******************************************************************************/
+
+/* Cycles per byte on the wire: 1389 at 115200 8N1; 0 delivers at once */
+void Sim_UartSetByteCycles(uint32_t cycles);
+uint32_t Sim_UartByteCycles(void);
+
+/* Bytes from the far end, paced at the wire rate behind earlier ones */
+void Sim_UartSend(const void *data, uint32_t len);
+
+/* Bytes the firmware sent that have fully arrived; returns the count */
+uint32_t Sim_UartReceive(void *data, uint32_t size);
+
+/*
+ * Sim_UartSetLoss
+ * Each byte, in either direction, is dropped with probability drop_ppm
+ * and otherwise has one bit flipped with probability flip_ppm per
+ * million. Deterministic for a given seed.
+ */
+void Sim_UartSetLoss(uint32_t drop_ppm, uint32_t flip_ppm, uint32_t seed);
+
+/* Cycles the wire carried a byte, either direction (utilisation) */
+uint64_t Sim_UartBusyCycles(void);
+
+/* Received bytes the firmware lost to a full RX FIFO */
+uint32_t Sim_UartOverruns(void);
+
+/******************************************************************************
+ * CAN bus (far end)
+ ******************************************************************************/
+
+#define SIM_CAN_NODES       16      /* Far-end nodes, each with its own queue */
+
+typedef struct
+{
+    uint32_t id;
+    uint8_t len;
+    uint8_t data[8];
+    uint64_t done;          /* Cycle the frame finished on the bus */
+} SimCanFrame;
+
+/* Bus time of a standard data frame with len bytes, worst-case stuffing */
+uint32_t Sim_CanFrameCycles(uint8_t len);
+
+/* Queues a frame from far-end node (0..SIM_CAN_NODES-1); arbitrates by id */
+void Sim_CanSend(uint8_t node, uint32_t id, const uint8_t *data, uint8_t len);
+
+/* Next frame the firmware put on the bus; false if none */
+bool Sim_CanReceive(SimCanFrame *frame);
+
+/* Whether far-end nodes acknowledge the firmware's frames (default yes) */
+void Sim_CanSetAck(bool ack);
+
+uint64_t Sim_CanBusyCycles(void);
+
+/*
+ * Sim_CanOpenSocket
+ * Connects the firmware's controller to a SocketCAN interface (vcan0)
+ * instead of the simulated far end. False if it cannot be opened.
+ */
+bool Sim_CanOpenSocket(const char *ifname);
+
+/******************************************************************************
+ * GPIO and RTC
+ ******************************************************************************/
+
+/* Pin levels of a port as last written by the firmware or set here */
+uint8_t Sim_GpioGet(uint32_t port);
+void Sim_GpioSet(uint32_t port, uint8_t pins, uint8_t value);
+
+/* Hibernation RTC seconds (battery backed: survives resets) */
+void Sim_RtcSet(uint32_t seconds, bool running);
+
+/******************************************************************************
+ * Internal: peripheral hooks called by sim.c
+ ******************************************************************************/
+
+/* Register behind HWREG(address) (also declared in stubs/host.h) */
+volatile uint32_t *Sim_Reg(uint32_t address);
+void SimUart_Reset(void);
+void SimUart_Service(void);
+volatile uint32_t *SimUart_Reg(uint32_t address, volatile uint32_t *slot);
+void SimCan_Reset(void);
+void SimCan_Service(void);
+void SimEeprom_Reset(void);
+void SimEeprom_Service(void);
+void SimEeprom_Erase(void);
+void SimFlash_Reset(void);
+volatile uint32_t *SimFlash_Reg(uint32_t address, volatile uint32_t *slot);
+void SimPeriph_Reset(void);
+uint32_t Sim_Random(uint32_t *state);
+
+#endif /* SIM_H_ */
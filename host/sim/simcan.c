@@ -0,0 +1,424 @@
+/******************************************************************************
+ * File: simcan.c
+ * Module: Host Simulator
+ * Description: CAN0 message objects and the bus they share with the far-end
+ *              nodes: arbitration by identifier, frame times at 500 kbit/s,
+ *              receive FIFOs, or a bridge to a SocketCAN interface
+ ******************************************************************************/
+
+#include "sim.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+#include "driverlib/can.h"
+
+#define OBJECTS         32u
+#define BIT_CYCLES      (SIM_CLOCK_HZ / 500000u)
+#define NODE_QUEUE      256u            /* Frames per far-end node, power of two */
+#define SENT_QUEUE      4096u           /* Frames the harness has not taken yet */
+#define DEVICE          0xFFu           /* Sender: the firmware's controller */
+
+typedef struct
+{
+    bool valid;
+    bool tx;
+    bool fifo;
+    bool filter;
+    uint32_t id, mask;
+    uint8_t len;
+    uint8_t data[8];
+    bool txrqst, newdat, lost;
+    uint64_t ready;                     /* Cycle the transmit request was set */
+} MsgObject;
+
+typedef struct
+{
+    SimCanFrame frame[NODE_QUEUE];
+    uint64_t ready[NODE_QUEUE];
+    uint32_t head, tail;
+} NodeQueue;
+
+static MsgObject objects[OBJECTS];
+static bool enabled = false;
+static NodeQueue nodes[SIM_CAN_NODES];
+static SimCanFrame sent[SENT_QUEUE];
+static uint32_t sent_head = 0, sent_tail = 0;
+static bool ack = true;
+static int sock = -1;
+
+/* The frame on the bus */
+static bool on_bus = false;
+static uint8_t on_bus_from;             /* Node, or DEVICE with the object in on_bus_obj */
+static uint8_t on_bus_obj;
+static SimCanFrame on_bus_frame;
+static uint64_t bus_free = 0;
+static uint64_t busy_cycles = 0;
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+/*
+ * Deliver
+ * A frame another node sent arrives at the controller: the first matching
+ * object with room, or the last one of a full FIFO, overwritten.
+ */
+static void Deliver(const SimCanFrame *f)
+{
+    uint32_t i;
+    int32_t last = -1;
+
+    if (!enabled)
+        return;
+
+    for (i = 0; i < OBJECTS; i++)
+    {
+        MsgObject *o = &objects[i];
+
+        if (!o->valid || o->tx)
+            continue;
+        if (o->filter && ((f->id ^ o->id) & o->mask & 0x7FFu) != 0)
+            continue;
+        last = (int32_t)i;
+        if (!o->newdat)
+            break;
+        if (!o->fifo)
+            break;      // End of a full FIFO: overwrite it
+    }
+    if (last < 0)
+        return;
+
+    MsgObject *o = &objects[last];
+    if (o->newdat)
+        o->lost = true;
+    o->id = f->id;
+    o->len = f->len;
+    memcpy(o->data, f->data, 8);
+    o->newdat = true;
+}
+
+static void Complete(void)
+{
+    on_bus = false;
+    bus_free = on_bus_frame.done;
+
+    if (on_bus_from != DEVICE)
+    {
+        nodes[on_bus_from].tail++;
+        Deliver(&on_bus_frame);
+        return;
+    }
+
+    objects[on_bus_obj].txrqst = false;
+    if (sock >= 0)
+    {
+        struct can_frame cf;
+
+        memset(&cf, 0, sizeof(cf));
+        cf.can_id = on_bus_frame.id;
+        cf.can_dlc = on_bus_frame.len;
+        memcpy(cf.data, on_bus_frame.data, 8);
+        (void)write(sock, &cf, sizeof(cf));
+    }
+    else if (sent_head - sent_tail < SENT_QUEUE)
+    {
+        sent[sent_head % SENT_QUEUE] = on_bus_frame;
+        sent_head++;
+    }
+}
+
+/*
+ * Arbitrate
+ * Starts the next frame: of everything waiting when the bus goes idle,
+ * the lowest identifier wins. The firmware's frames only go out when
+ * somebody acknowledges them.
+ */
+static bool Arbitrate(void)
+{
+    uint64_t start = UINT64_MAX;
+    uint32_t best_id = UINT32_MAX;
+    uint32_t i;
+
+    // The bus starts when the earliest waiting frame is ready
+    for (i = 0; i < OBJECTS; i++)
+    {
+        if (objects[i].txrqst && (ack || sock >= 0) && objects[i].ready < start)
+            start = objects[i].ready;
+    }
+    for (i = 0; i < SIM_CAN_NODES; i++)
+    {
+        NodeQueue *q = &nodes[i];
+        if (q->head != q->tail && q->ready[q->tail % NODE_QUEUE] < start)
+            start = q->ready[q->tail % NODE_QUEUE];
+    }
+    if (start == UINT64_MAX)
+        return false;
+    if (start < bus_free)
+        start = bus_free;
+    if (start > Sim_Now())
+        return false;
+
+    for (i = 0; i < OBJECTS; i++)
+    {
+        MsgObject *o = &objects[i];
+        if (o->txrqst && (ack || sock >= 0) && o->ready <= start && o->id < best_id)
+        {
+            best_id = o->id;
+            on_bus_from = DEVICE;
+            on_bus_obj = (uint8_t)i;
+        }
+    }
+    for (i = 0; i < SIM_CAN_NODES; i++)
+    {
+        NodeQueue *q = &nodes[i];
+        SimCanFrame *f = &q->frame[q->tail % NODE_QUEUE];
+        if (q->head != q->tail && q->ready[q->tail % NODE_QUEUE] <= start && f->id < best_id)
+        {
+            best_id = f->id;
+            on_bus_from = (uint8_t)i;
+        }
+    }
+
+    if (on_bus_from == DEVICE)
+    {
+        MsgObject *o = &objects[on_bus_obj];
+        on_bus_frame.id = o->id;
+        on_bus_frame.len = o->len;
+        memcpy(on_bus_frame.data, o->data, 8);
+    }
+    else
+    {
+        NodeQueue *q = &nodes[on_bus_from];
+        on_bus_frame = q->frame[q->tail % NODE_QUEUE];
+    }
+    on_bus_frame.done = start + Sim_CanFrameCycles(on_bus_frame.len);
+    busy_cycles += Sim_CanFrameCycles(on_bus_frame.len);
+    on_bus = true;
+    return true;
+}
+
+static void Socket_Read(void)
+{
+    struct can_frame cf;
+
+    while (read(sock, &cf, sizeof(cf)) == (ssize_t)sizeof(cf))
+    {
+        if (cf.can_id & (CAN_EFF_FLAG | CAN_RTR_FLAG | CAN_ERR_FLAG))
+            continue;
+        Sim_CanSend(0, cf.can_id, cf.data, cf.can_dlc);
+    }
+}
+
+/******************************************************************************
+ * Simulator
+ ******************************************************************************/
+
+void SimCan_Reset(void)
+{
+    memset(objects, 0, sizeof(objects));
+    enabled = false;
+    if (on_bus && on_bus_from == DEVICE)
+        on_bus = false;     // Aborted mid-frame
+}
+
+void SimCan_Service(void)
+{
+    if (sock >= 0)
+        Socket_Read();
+
+    for (;;)
+    {
+        if (on_bus)
+        {
+            if (on_bus_frame.done > Sim_Now())
+                return;
+            Complete();
+        }
+        if (!Arbitrate())
+            return;
+    }
+}
+
+uint32_t Sim_CanFrameCycles(uint8_t len)
+{
+    uint32_t bits = 47u + 8u * len;
+
+    bits += (34u + 8u * len - 1u) / 4u;     // Worst-case stuff bits
+    return bits * BIT_CYCLES;
+}
+
+void Sim_CanSend(uint8_t node, uint32_t id, const uint8_t *data, uint8_t len)
+{
+    NodeQueue *q = &nodes[node % SIM_CAN_NODES];
+    SimCanFrame *f;
+
+    if (q->head - q->tail == NODE_QUEUE)
+        return;
+    f = &q->frame[q->head % NODE_QUEUE];
+    f->id = id & 0x7FFu;
+    f->len = (len > 8) ? 8 : len;
+    memset(f->data, 0, 8);
+    memcpy(f->data, data, f->len);
+    f->done = 0;
+    q->ready[q->head % NODE_QUEUE] = Sim_Now();
+    q->head++;
+}
+
+bool Sim_CanReceive(SimCanFrame *frame)
+{
+    if (sent_head == sent_tail)
+        return false;
+    *frame = sent[sent_tail % SENT_QUEUE];
+    sent_tail++;
+    return true;
+}
+
+void Sim_CanSetAck(bool on)
+{
+    ack = on;
+}
+
+uint64_t Sim_CanBusyCycles(void)
+{
+    return busy_cycles;
+}
+
+bool Sim_CanOpenSocket(const char *ifname)
+{
+    struct sockaddr_can addr;
+    struct ifreq ifr;
+    int s;
+
+    s = socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK, CAN_RAW);
+    if (s < 0)
+        return false;
+
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, ifname, IFNAMSIZ - 1);
+    if (ioctl(s, SIOCGIFINDEX, &ifr) < 0)
+    {
+        close(s);
+        return false;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if (bind(s, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        close(s);
+        return false;
+    }
+    sock = s;
+    return true;
+}
+
+/******************************************************************************
+ * driverlib/can.h
+ ******************************************************************************/
+
+void CANInit(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    memset(objects, 0, sizeof(objects));
+    enabled = false;
+}
+
+uint32_t CANBitRateSet(uint32_t ui32Base, uint32_t ui32SourceClock, uint32_t ui32BitRate)
+{
+    (void)ui32Base;
+    (void)ui32SourceClock;
+    return ui32BitRate;     // Frame times assume 500 kbit/s
+}
+
+void CANEnable(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    enabled = true;
+}
+
+void CANDisable(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    enabled = false;
+}
+
+void CANMessageSet(uint32_t ui32Base, uint32_t ui32ObjID, tCANMsgObject *psMsgObject,
+                   tMsgObjType eMsgType)
+{
+    MsgObject *o = &objects[(ui32ObjID - 1u) % OBJECTS];
+
+    (void)ui32Base;
+    o->valid = true;
+    o->tx = (eMsgType == MSG_OBJ_TYPE_TX);
+    o->fifo = (psMsgObject->ui32Flags & MSG_OBJ_FIFO) != 0;
+    o->filter = (psMsgObject->ui32Flags & MSG_OBJ_USE_ID_FILTER) != 0;
+    o->id = psMsgObject->ui32MsgID & 0x7FFu;
+    o->mask = psMsgObject->ui32MsgIDMask;
+    o->len = (psMsgObject->ui32MsgLen > 8) ? 8 : (uint8_t)psMsgObject->ui32MsgLen;
+    o->newdat = false;
+    o->lost = false;
+    o->txrqst = false;
+    if (o->tx)
+    {
+        memset(o->data, 0, 8);
+        memcpy(o->data, psMsgObject->pui8MsgData, o->len);
+        o->txrqst = true;
+        o->ready = Sim_Now();
+    }
+}
+
+void CANMessageGet(uint32_t ui32Base, uint32_t ui32ObjID, tCANMsgObject *psMsgObject,
+                   bool bClrPendingInt)
+{
+    MsgObject *o = &objects[(ui32ObjID - 1u) % OBJECTS];
+
+    (void)ui32Base;
+    (void)bClrPendingInt;
+    psMsgObject->ui32MsgID = o->id;
+    psMsgObject->ui32MsgIDMask = o->mask;
+    psMsgObject->ui32MsgLen = o->len;
+    psMsgObject->ui32Flags = (o->newdat ? MSG_OBJ_NEW_DATA : 0) |
+                             (o->lost ? MSG_OBJ_DATA_LOST : 0);
+    if (psMsgObject->pui8MsgData != 0)
+        memcpy(psMsgObject->pui8MsgData, o->data, o->len);
+    o->newdat = false;
+    o->lost = false;
+}
+
+uint32_t CANStatusGet(uint32_t ui32Base, tCANStsReg eStatusReg)
+{
+    uint32_t bits = 0;
+    uint32_t i;
+
+    (void)ui32Base;
+    Sim_Poll();
+    for (i = 0; i < OBJECTS; i++)
+    {
+        bool set = false;
+
+        switch (eStatusReg)
+        {
+        case CAN_STS_TXREQUEST:
+            set = objects[i].txrqst;
+            break;
+        case CAN_STS_NEWDAT:
+            set = objects[i].newdat;
+            break;
+        case CAN_STS_MSGVAL:
+            set = objects[i].valid;
+            break;
+        default:
+            break;
+        }
+        if (set)
+            bits |= 1UL << i;
+    }
+    return bits;
+}
@@ -0,0 +1,180 @@
+/******************************************************************************
+ * File: simeeprom.c
+ * Module: Host Simulator
+ * Description: EEPROM controller: word programs that take time, the done
+ *              interrupt on the flash vector, read-back fault injection
+ ******************************************************************************/
+
+#include "sim.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "inc/hw_ints.h"
+#include "driverlib/eeprom.h"
+#include "driverlib/flash.h"
+#include "driverlib/interrupt.h"
+
+#define WORD_CYCLES     (110u * SIM_CYCLES_PER_US)     /* One word program */
+#define EEPROM_WORDS    (SIM_EEPROM_SIZE / 4u)
+
+static uint32_t words[EEPROM_WORDS];
+static bool erased = false;
+
+/* Non-blocking program in progress */
+static bool working = false;
+static uint64_t working_done;
+static uint32_t working_address;
+static uint32_t working_data;
+
+static bool int_enabled = false;
+static uint32_t int_status = 0;
+static uint32_t fail_words = 0;
+static uint32_t programmed = 0;
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+static void Erase_Once(void)
+{
+    if (!erased)
+    {
+        memset(words, 0xFF, sizeof(words));
+        erased = true;
+    }
+}
+
+static void Store(uint32_t address, uint32_t data)
+{
+    Erase_Once();
+    if (fail_words != 0)
+    {
+        fail_words--;
+        data ^= 1u;
+    }
+    words[(address / 4u) % EEPROM_WORDS] = data;
+    programmed++;
+}
+
+/******************************************************************************
+ * Simulator
+ ******************************************************************************/
+
+void SimEeprom_Reset(void)
+{
+    working = false;
+    int_enabled = false;
+    int_status = 0;
+}
+
+void SimEeprom_Service(void)
+{
+    if (!working || Sim_Now() < working_done)
+        return;
+
+    working = false;
+    Store(working_address, working_data);
+    int_status |= EEPROM_INT_PROGRAM;
+    if (int_enabled)
+        Sim_Raise(INT_FLASH);
+}
+
+void Sim_EepromPeek(uint32_t address, void *data, uint32_t count)
+{
+    Erase_Once();
+    memcpy(data, (const uint8_t *)words + address, count);
+}
+
+void Sim_EepromPoke(uint32_t address, const void *data, uint32_t count)
+{
+    Erase_Once();
+    memcpy((uint8_t *)words + address, data, count);
+}
+
+void Sim_EepromFailWords(uint32_t n)
+{
+    fail_words = n;
+}
+
+uint32_t Sim_EepromWordsProgrammed(void)
+{
+    return programmed;
+}
+
+void SimEeprom_Erase(void)
+{
+    erased = false;
+    Erase_Once();
+}
+
+/******************************************************************************
+ * driverlib/eeprom.h
+ ******************************************************************************/
+
+uint32_t EEPROMInit(void)
+{
+    Erase_Once();
+    return EEPROM_INIT_OK;
+}
+
+uint32_t EEPROMSizeGet(void)
+{
+    return SIM_EEPROM_SIZE;
+}
+
+void EEPROMRead(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count)
+{
+    Sim_EepromPeek(ui32Address, pui32Data, ui32Count);
+    Sim_Advance(SIM_POLL_CYCLES * (ui32Count / 4u));
+}
+
+uint32_t EEPROMProgram(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count)
+{
+    while (working)
+        Sim_Poll();
+    for (; ui32Count >= 4; ui32Count -= 4, ui32Address += 4)
+    {
+        Sim_Advance(WORD_CYCLES);
+        Store(ui32Address, *pui32Data++);
+    }
+    return 0;
+}
+
+uint32_t EEPROMProgramNonBlocking(uint32_t ui32Data, uint32_t ui32Address)
+{
+    if (working)
+        return EEPROM_RC_WORKING;
+    working = true;
+    working_done = Sim_Now() + WORD_CYCLES;
+    working_address = ui32Address;
+    working_data = ui32Data;
+    return 0;
+}
+
+uint32_t EEPROMStatusGet(void)
+{
+    Sim_Poll();
+    return working ? EEPROM_RC_WORKING : 0;
+}
+
+void EEPROMIntEnable(uint32_t ui32IntFlags)
+{
+    (void)ui32IntFlags;
+    int_enabled = true;
+}
+
+void EEPROMIntDisable(uint32_t ui32IntFlags)
+{
+    (void)ui32IntFlags;
+    int_enabled = false;
+}
+
+uint32_t EEPROMIntStatus(bool bMasked)
+{
+    return (bMasked && !int_enabled) ? 0 : int_status;
+}
+
+void EEPROMIntClear(uint32_t ui32IntFlags)
+{
+    int_status &= ~ui32IntFlags;
+}
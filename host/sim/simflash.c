@@ -0,0 +1,162 @@
+/******************************************************************************
+ * File: simflash.c
+ * Module: Host Simulator
+ * Description: Internal flash: driverlib erase/program, the FMA/FMD/FMC
+ *              register sequence, and power cuts between operations
+ ******************************************************************************/
+
+#include "sim.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "inc/hw_flash.h"
+#include "inc/hw_ints.h"
+#include "driverlib/flash.h"
+#include "driverlib/interrupt.h"
+
+#define PAGE_SIZE       0x400u
+#define ERASE_CYCLES    (10000u * SIM_CYCLES_PER_US)   /* Page erase */
+#define WORD_CYCLES     (50u * SIM_CYCLES_PER_US)      /* Word program */
+#define FMC_KEY_LEGACY  0x71D50000u
+
+uint8_t Sim_Flash[SIM_FLASH_SIZE] __attribute__((aligned(PAGE_SIZE)));
+
+static bool erased = false;
+static uint32_t cut_after = 0;      /* Operations left before the power fails */
+static uint32_t fma = 0, fmd = 0;
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+static void Erase_Once(void)
+{
+    if (!erased)
+    {
+        memset(Sim_Flash, 0xFF, SIM_FLASH_SIZE);
+        erased = true;
+    }
+}
+
+/* Counts down a power cut; does not return when it fires */
+static void Operation(uint32_t cycles)
+{
+    Erase_Once();
+    if (cut_after != 0 && --cut_after == 0)
+        Sim_Exit(SIM_EXIT_POWER_CUT);
+    Sim_Advance(cycles);
+}
+
+static void Erase_Page(uint32_t address)
+{
+    Operation(ERASE_CYCLES);
+    memset(&Sim_Flash[(address % SIM_FLASH_SIZE) & ~(PAGE_SIZE - 1u)], 0xFF, PAGE_SIZE);
+}
+
+/* Programming can only clear bits */
+static void Program_Word(uint32_t address, uint32_t data)
+{
+    uint32_t word;
+
+    Operation(WORD_CYCLES);
+    address = (address % SIM_FLASH_SIZE) & ~3u;
+    memcpy(&word, &Sim_Flash[address], 4);
+    word &= data;
+    memcpy(&Sim_Flash[address], &word, 4);
+}
+
+/******************************************************************************
+ * Simulator
+ ******************************************************************************/
+
+void SimFlash_Reset(void)
+{
+    fma = 0;
+    fmd = 0;
+}
+
+/*
+ * SimFlash_Reg
+ * FMA/FMD are latched as they are written; an ERASE or WRITE command in
+ * FMC is carried out when FMC is next read (the firmware's busy poll)
+ * and its bit cleared.
+ */
+volatile uint32_t *SimFlash_Reg(uint32_t address, volatile uint32_t *slot)
+{
+    volatile uint32_t *reg;
+    uint32_t fmc;
+
+    if (address != FLASH_FMC)
+        return slot;
+
+    reg = Sim_Reg(FLASH_FMA);
+    fma = *reg;
+    reg = Sim_Reg(FLASH_FMD);
+    fmd = *reg;
+
+    fmc = *slot;
+    if ((fmc & 0xFFFF0000u) == FLASH_FMC_WRKEY || (fmc & 0xFFFF0000u) == FMC_KEY_LEGACY)
+    {
+        if (fmc & FLASH_FMC_ERASE)
+            Erase_Page(fma);
+        else if (fmc & FLASH_FMC_WRITE)
+            Program_Word(fma, fmd);
+    }
+    *slot = 0;
+    return slot;
+}
+
+void Sim_FlashCutAfter(uint32_t ops)
+{
+    cut_after = (ops != 0) ? ops + 1u : 0;
+}
+
+void Sim_EraseAll(void)
+{
+    erased = false;
+    Erase_Once();
+    SimEeprom_Erase();
+}
+
+/******************************************************************************
+ * driverlib/flash.h
+ ******************************************************************************/
+
+int32_t FlashErase(uint32_t ui32Address)
+{
+    if (ui32Address & (PAGE_SIZE - 1u))
+        return -1;
+    Erase_Page(ui32Address);
+    return 0;
+}
+
+int32_t FlashProgram(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count)
+{
+    if ((ui32Address & 3u) || (ui32Count & 3u))
+        return -1;
+    for (; ui32Count != 0; ui32Count -= 4, ui32Address += 4)
+        Program_Word(ui32Address, *pui32Data++);
+    return 0;
+}
+
+void FlashIntRegister(void (*pfnHandler)(void))
+{
+    IntRegister(INT_FLASH, pfnHandler);
+    IntEnable(INT_FLASH);
+}
+
+void FlashIntEnable(uint32_t ui32IntFlags)
+{
+    (void)ui32IntFlags;
+}
+
+void FlashIntClear(uint32_t ui32IntFlags)
+{
+    (void)ui32IntFlags;
+}
+
+uint32_t FlashIntStatus(bool bMasked)
+{
+    (void)bMasked;
+    return 0;
+}
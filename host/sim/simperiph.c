@@ -0,0 +1,393 @@
+/******************************************************************************
+ * File: simperiph.c
+ * Module: Host Simulator
+ * Description: System control, GPIO, general-purpose timers, the
+ *              hibernation RTC and the watchdog
+ *
+ * Timer and watchdog interrupts are not raised: their handlers
+ * (Profile_TimerISR, Wait_WatchdogISR) are Cortex-M assembly that
+ * compiles to nothing here. Polled timers (buzzer, bootloader) work.
+ ******************************************************************************/
+
+#include "sim.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "inc/hw_memmap.h"
+#include "driverlib/gpio.h"
+#include "driverlib/hibernate.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/timer.h"
+#include "driverlib/watchdog.h"
+
+#define GPIO_PORTS      6u
+#define TIMERS          64u             /* Indexed by base address bits 17:12 */
+#define HIB_WORDS       16u
+#define CAUSE_SW        0x00000010u
+
+typedef struct
+{
+    uint32_t config;
+    uint32_t load;
+    bool running;
+    uint64_t start;                     /* Cycle the timer was enabled */
+    uint64_t cleared;                   /* Cycle of the last TimerIntClear */
+} Timer;
+
+static uint8_t gpio[GPIO_PORTS];
+static Timer timers[TIMERS];
+static uint32_t reset_cause = SYSCTL_CAUSE_POR;
+
+/* Hibernation module: battery backed, not touched by a reset */
+static bool hib_active = false;
+static bool rtc_running = false;
+static uint32_t rtc_base = 0;           /* Seconds at rtc_since */
+static uint64_t rtc_since = 0;
+static uint32_t hib_data[HIB_WORDS];
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+static uint8_t *Gpio_Port(uint32_t base)
+{
+    switch (base)
+    {
+    case GPIO_PORTA_BASE: return &gpio[0];
+    case GPIO_PORTB_BASE: return &gpio[1];
+    case GPIO_PORTC_BASE: return &gpio[2];
+    case GPIO_PORTD_BASE: return &gpio[3];
+    case GPIO_PORTE_BASE: return &gpio[4];
+    default:              return &gpio[5];
+    }
+}
+
+static Timer *Timer_Of(uint32_t base)
+{
+    return &timers[(base >> 12) % TIMERS];
+}
+
+static bool Timer_Periodic(const Timer *t)
+{
+    return (t->config & 0xFFu) != (TIMER_CFG_ONE_SHOT & 0xFFu);
+}
+
+/* Cycles since the timer was enabled */
+static uint64_t Timer_Elapsed(const Timer *t)
+{
+    return t->running ? Sim_Now() - t->start : 0;
+}
+
+/******************************************************************************
+ * Simulator
+ ******************************************************************************/
+
+void SimPeriph_Reset(void)
+{
+    memset(gpio, 0, sizeof(gpio));
+    memset(timers, 0, sizeof(timers));
+}
+
+void Sim_SetResetCause(uint32_t cause)
+{
+    reset_cause = cause;
+}
+
+uint8_t Sim_GpioGet(uint32_t port)
+{
+    return *Gpio_Port(port);
+}
+
+void Sim_GpioSet(uint32_t port, uint8_t pins, uint8_t value)
+{
+    uint8_t *p = Gpio_Port(port);
+
+    *p = (uint8_t)((*p & ~pins) | (value & pins));
+}
+
+void Sim_RtcSet(uint32_t seconds, bool running)
+{
+    hib_active = true;
+    rtc_base = seconds;
+    rtc_since = Sim_Now();
+    rtc_running = running;
+}
+
+/******************************************************************************
+ * driverlib/sysctl.h
+ ******************************************************************************/
+
+void SysCtlClockSet(uint32_t ui32Config)
+{
+    (void)ui32Config;
+}
+
+uint32_t SysCtlClockGet(void)
+{
+    return SIM_CLOCK_HZ;
+}
+
+void SysCtlPeripheralEnable(uint32_t ui32Peripheral)
+{
+    (void)ui32Peripheral;
+}
+
+bool SysCtlPeripheralReady(uint32_t ui32Peripheral)
+{
+    (void)ui32Peripheral;
+    Sim_Poll();
+    return true;
+}
+
+uint32_t SysCtlResetCauseGet(void)
+{
+    return reset_cause;
+}
+
+void SysCtlResetCauseClear(uint32_t ui32Causes)
+{
+    reset_cause &= ~ui32Causes;
+}
+
+void SysCtlReset(void)
+{
+    reset_cause |= CAUSE_SW;
+    Sim_Exit(SIM_EXIT_RESET);
+}
+
+/* Three cycles per count, as the loop on the chip */
+void SysCtlDelay(uint32_t ui32Count)
+{
+    Sim_Advance(3u * ui32Count);
+}
+
+/******************************************************************************
+ * driverlib/gpio.h
+ ******************************************************************************/
+
+void GPIOPinTypeGPIOOutput(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    (void)ui32Port;
+    (void)ui8Pins;
+}
+
+void GPIOPinTypeGPIOInput(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    (void)ui32Port;
+    (void)ui8Pins;
+}
+
+void GPIOPinTypeUART(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    (void)ui32Port;
+    (void)ui8Pins;
+}
+
+void GPIOPinTypeCAN(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    (void)ui32Port;
+    (void)ui8Pins;
+}
+
+void GPIOPadConfigSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32Strength,
+                      uint32_t ui32PadType)
+{
+    (void)ui32Port;
+    (void)ui8Pins;
+    (void)ui32Strength;
+    (void)ui32PadType;
+}
+
+void GPIOPinConfigure(uint32_t ui32PinConfig)
+{
+    (void)ui32PinConfig;
+}
+
+void GPIOPinWrite(uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val)
+{
+    Sim_GpioSet(ui32Port, ui8Pins, ui8Val);
+}
+
+int32_t GPIOPinRead(uint32_t ui32Port, uint8_t ui8Pins)
+{
+    return *Gpio_Port(ui32Port) & ui8Pins;
+}
+
+/******************************************************************************
+ * driverlib/timer.h (free-running or polled; see the file header)
+ ******************************************************************************/
+
+void TimerConfigure(uint32_t ui32Base, uint32_t ui32Config)
+{
+    Timer *t = Timer_Of(ui32Base);
+
+    t->config = ui32Config;
+    t->running = false;
+}
+
+void TimerLoadSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value)
+{
+    (void)ui32Timer;
+    Timer_Of(ui32Base)->load = ui32Value;
+}
+
+uint32_t TimerValueGet(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    Timer *t = Timer_Of(ui32Base);
+    uint64_t period = (uint64_t)t->load + 1u;
+    uint64_t elapsed;
+
+    (void)ui32Timer;
+    Sim_Poll();
+    elapsed = Timer_Elapsed(t);
+    if (t->config == TIMER_CFG_PERIODIC_UP)
+        return (uint32_t)(elapsed % period);
+    if (!Timer_Periodic(t) && elapsed >= period)
+        return 0;
+    return (uint32_t)(t->load - elapsed % period);
+}
+
+void TimerEnable(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    Timer *t = Timer_Of(ui32Base);
+
+    (void)ui32Timer;
+    t->running = true;
+    t->start = Sim_Now();
+}
+
+void TimerDisable(uint32_t ui32Base, uint32_t ui32Timer)
+{
+    (void)ui32Timer;
+    Timer_Of(ui32Base)->running = false;
+}
+
+void TimerIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    (void)ui32Base;
+    (void)ui32IntFlags;
+}
+
+void TimerIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    (void)ui32Base;
+    (void)ui32IntFlags;
+}
+
+/* Timeout: the last expiry since enabling came after the last clear */
+uint32_t TimerIntStatus(uint32_t ui32Base, bool bMasked)
+{
+    Timer *t = Timer_Of(ui32Base);
+    uint64_t period = (uint64_t)t->load + 1u;
+    uint64_t expiries, last;
+
+    (void)bMasked;
+    Sim_Poll();
+    if (!t->running)
+        return 0;
+    expiries = Timer_Elapsed(t) / period;
+    if (expiries == 0)
+        return 0;
+    if (!Timer_Periodic(t))
+        expiries = 1;
+    last = t->start + expiries * period;
+    return (last > t->cleared) ? TIMER_TIMA_TIMEOUT : 0;
+}
+
+void TimerIntClear(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    (void)ui32IntFlags;
+    Timer_Of(ui32Base)->cleared = Sim_Now();
+}
+
+void TimerIntRegister(uint32_t ui32Base, uint32_t ui32Timer, void (*pfnHandler)(void))
+{
+    (void)ui32Base;
+    (void)ui32Timer;
+    (void)pfnHandler;
+}
+
+/******************************************************************************
+ * driverlib/hibernate.h
+ ******************************************************************************/
+
+void HibernateEnableExpClk(uint32_t ui32HibClk)
+{
+    (void)ui32HibClk;
+    hib_active = true;
+}
+
+void HibernateClockConfig(uint32_t ui32Config)
+{
+    (void)ui32Config;
+}
+
+void HibernateRTCEnable(void)
+{
+    if (!rtc_running)
+        Sim_RtcSet(rtc_base, true);
+}
+
+bool HibernateIsActive(void)
+{
+    return hib_active;
+}
+
+uint32_t HibernateRTCGet(void)
+{
+    if (!rtc_running)
+        return rtc_base;
+    return rtc_base + (uint32_t)((Sim_Now() - rtc_since) / SIM_CLOCK_HZ);
+}
+
+void HibernateRTCSet(uint32_t ui32RTCValue)
+{
+    Sim_RtcSet(ui32RTCValue, rtc_running);
+}
+
+void HibernateDataSet(uint32_t *pui32Data, uint32_t ui32Count)
+{
+    memcpy(hib_data, pui32Data, 4u * (ui32Count < HIB_WORDS ? ui32Count : HIB_WORDS));
+}
+
+void HibernateDataGet(uint32_t *pui32Data, uint32_t ui32Count)
+{
+    memcpy(pui32Data, hib_data, 4u * (ui32Count < HIB_WORDS ? ui32Count : HIB_WORDS));
+}
+
+/******************************************************************************
+ * driverlib/watchdog.h (never fires; see the file header)
+ ******************************************************************************/
+
+void WatchdogReloadSet(uint32_t ui32Base, uint32_t ui32LoadVal)
+{
+    (void)ui32Base;
+    (void)ui32LoadVal;
+}
+
+void WatchdogResetEnable(uint32_t ui32Base)
+{
+    (void)ui32Base;
+}
+
+void WatchdogStallEnable(uint32_t ui32Base)
+{
+    (void)ui32Base;
+}
+
+void WatchdogEnable(uint32_t ui32Base)
+{
+    (void)ui32Base;
+}
+
+void WatchdogIntClear(uint32_t ui32Base)
+{
+    (void)ui32Base;
+}
+
+void WatchdogIntRegister(uint32_t ui32Base, void (*pfnHandler)(void))
+{
+    (void)ui32Base;
+    (void)pfnHandler;
+}
@@ -0,0 +1,313 @@
+/******************************************************************************
+ * File: simuart.c
+ * Module: Host Simulator
+ * Description: UART2 and the wire to its far end: 16-byte FIFOs, the
+ *              byte time at the configured rate, overruns, loss injection
+ ******************************************************************************/
+
+#include "sim.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_uart.h"
+#include "driverlib/interrupt.h"
+#include "driverlib/uart.h"
+
+#define FIFO_SIZE           16u
+#define WIRE_SIZE           8192u   /* Bytes in flight per direction, power of two */
+#define BYTE_CYCLES_115200  1389u   /* 10 bits at 115200 baud, 16 MHz */
+
+typedef struct
+{
+    uint8_t byte[WIRE_SIZE];
+    uint64_t done[WIRE_SIZE];       /* Cycle the stop bit ends */
+    uint32_t head, tail;
+    uint64_t line_free;             /* Cycle the sender's line goes idle */
+} Wire;
+
+static uint32_t byte_cycles = BYTE_CYCLES_115200;
+static Wire to_device;              /* Far end -> firmware */
+static Wire to_peer;                /* Firmware -> far end */
+
+static uint8_t rx_fifo[FIFO_SIZE];
+static uint32_t rx_head = 0, rx_tail = 0;
+static uint32_t rx_errors = 0;
+static uint32_t overruns = 0;
+static uint32_t int_mask = 0;
+static bool enabled = false;
+
+static uint32_t drop_ppm = 0, flip_ppm = 0, loss_state = 0;
+static uint64_t busy_cycles = 0;
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+/*
+ * Wire_Put
+ * Queues a byte behind the ones already on the line. A byte the loss
+ * model drops still takes its line time.
+ */
+static void Wire_Put(Wire *w, uint8_t b)
+{
+    uint64_t start = (w->line_free > Sim_Now()) ? w->line_free : Sim_Now();
+    uint32_t r;
+
+    w->line_free = start + byte_cycles;
+    busy_cycles += byte_cycles;
+
+    if (drop_ppm != 0 || flip_ppm != 0)
+    {
+        r = Sim_Random(&loss_state) % 1000000u;
+        if (r < drop_ppm)
+            return;
+        if (r < drop_ppm + flip_ppm)
+            b ^= (uint8_t)(1u << (Sim_Random(&loss_state) & 7u));
+    }
+
+    if (w->head - w->tail == WIRE_SIZE)
+        return;     // Far more than any test sends unread
+    w->byte[w->head & (WIRE_SIZE - 1)] = b;
+    w->done[w->head & (WIRE_SIZE - 1)] = w->line_free;
+    w->head++;
+}
+
+static bool Wire_Take(Wire *w, uint8_t *b)
+{
+    if (w->head == w->tail || w->done[w->tail & (WIRE_SIZE - 1)] > Sim_Now())
+        return false;
+    *b = w->byte[w->tail & (WIRE_SIZE - 1)];
+    w->tail++;
+    return true;
+}
+
+/* Bytes queued for transmission not yet in the shift register */
+static uint32_t Tx_Queued(void)
+{
+    uint64_t t = Sim_Now();
+
+    if (byte_cycles == 0 || to_peer.line_free <= t)
+        return 0;
+    return (uint32_t)((to_peer.line_free - t - 1) / byte_cycles);
+}
+
+static bool Rx_Empty(void)
+{
+    return rx_head == rx_tail;
+}
+
+static uint8_t Rx_Pop(void)
+{
+    uint8_t b = rx_fifo[rx_tail % FIFO_SIZE];
+    rx_tail++;
+    return b;
+}
+
+/******************************************************************************
+ * Simulator
+ ******************************************************************************/
+
+void SimUart_Reset(void)
+{
+    rx_head = rx_tail = 0;
+    rx_errors = 0;
+    int_mask = 0;
+    enabled = false;    // Bytes still arriving are lost until UARTEnable
+}
+
+void SimUart_Service(void)
+{
+    uint8_t b;
+
+    // At byte_cycles 0 the far end waits for room instead of overrunning
+    while ((byte_cycles != 0 || rx_head - rx_tail < FIFO_SIZE) &&
+           Wire_Take(&to_device, &b))
+    {
+        if (!enabled)
+            continue;
+        if (rx_head - rx_tail == FIFO_SIZE)
+        {
+            rx_errors |= UART_RXERROR_OVERRUN;
+            overruns++;
+            continue;
+        }
+        rx_fifo[rx_head % FIFO_SIZE] = b;
+        rx_head++;
+    }
+
+    if (!Rx_Empty() && (int_mask & (UART_INT_RX | UART_INT_RT)))
+        Sim_Raise(INT_UART2);
+}
+
+/* Register-level access (the bootloader's receive ISR) */
+volatile uint32_t *SimUart_Reg(uint32_t address, volatile uint32_t *slot)
+{
+    switch (address - UART2_BASE)
+    {
+    case UART_O_DR:
+        *slot = Rx_Empty() ? 0 : Rx_Pop();
+        break;
+    case UART_O_FR:
+        *slot = (Rx_Empty() ? UART_FR_RXFE : 0) |
+                (Tx_Queued() >= FIFO_SIZE ? UART_FR_TXFF : 0) |
+                (to_peer.line_free > Sim_Now() ? UART_FR_BUSY : 0);
+        break;
+    default:
+        break;
+    }
+    return slot;
+}
+
+void Sim_UartSetByteCycles(uint32_t cycles)
+{
+    byte_cycles = cycles;
+}
+
+uint32_t Sim_UartByteCycles(void)
+{
+    return byte_cycles;
+}
+
+void Sim_UartSend(const void *data, uint32_t len)
+{
+    const uint8_t *p = (const uint8_t *)data;
+
+    while (len-- > 0)
+        Wire_Put(&to_device, *p++);
+}
+
+uint32_t Sim_UartReceive(void *data, uint32_t size)
+{
+    uint8_t *p = (uint8_t *)data;
+    uint32_t n = 0;
+
+    while (n < size && Wire_Take(&to_peer, &p[n]))
+        n++;
+    return n;
+}
+
+void Sim_UartSetLoss(uint32_t drop, uint32_t flip, uint32_t seed)
+{
+    drop_ppm = drop;
+    flip_ppm = flip;
+    loss_state = seed;
+}
+
+uint64_t Sim_UartBusyCycles(void)
+{
+    return busy_cycles;
+}
+
+uint32_t Sim_UartOverruns(void)
+{
+    return overruns;
+}
+
+/******************************************************************************
+ * driverlib/uart.h
+ ******************************************************************************/
+
+void UARTConfigSetExpClk(uint32_t ui32Base, uint32_t ui32UARTClk, uint32_t ui32Baud,
+                         uint32_t ui32Config)
+{
+    (void)ui32Base;
+    (void)ui32UARTClk;
+    (void)ui32Config;
+    if (byte_cycles != 0)
+        byte_cycles = (SIM_CLOCK_HZ * 10u + ui32Baud / 2) / ui32Baud;
+}
+
+void UARTFIFOLevelSet(uint32_t ui32Base, uint32_t ui32TxLevel, uint32_t ui32RxLevel)
+{
+    (void)ui32Base;
+    (void)ui32TxLevel;
+    (void)ui32RxLevel;
+}
+
+void UARTEnable(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    enabled = true;
+}
+
+void UARTDisable(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    enabled = false;
+}
+
+bool UARTCharsAvail(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    Sim_Poll();
+    return !Rx_Empty();
+}
+
+bool UARTSpaceAvail(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    Sim_Poll();
+    return Tx_Queued() < FIFO_SIZE;
+}
+
+int32_t UARTCharGetNonBlocking(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    return Rx_Empty() ? -1 : (int32_t)Rx_Pop();
+}
+
+bool UARTCharPutNonBlocking(uint32_t ui32Base, unsigned char ucData)
+{
+    (void)ui32Base;
+    if (Tx_Queued() >= FIFO_SIZE)
+        return false;
+    Wire_Put(&to_peer, ucData);
+    return true;
+}
+
+void UARTCharPut(uint32_t ui32Base, unsigned char ucData)
+{
+    while (!UARTSpaceAvail(ui32Base))
+        ;
+    Wire_Put(&to_peer, ucData);
+}
+
+bool UARTBusy(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    Sim_Poll();
+    return to_peer.line_free > Sim_Now();
+}
+
+uint32_t UARTRxErrorGet(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    return rx_errors;
+}
+
+void UARTRxErrorClear(uint32_t ui32Base)
+{
+    (void)ui32Base;
+    rx_errors = 0;
+}
+
+void UARTIntRegister(uint32_t ui32Base, void (*pfnHandler)(void))
+{
+    (void)ui32Base;
+    IntRegister(INT_UART2, pfnHandler);
+    IntEnable(INT_UART2);
+}
+
+void UARTIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    (void)ui32Base;
+    int_mask |= ui32IntFlags;
+}
+
+void UARTIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags)
+{
+    (void)ui32Base;
+    int_mask &= ~ui32IntFlags;
+}
@@ -0,0 +1,53 @@
+/* Host build: TivaWare CAN API (implemented in host/sim/simcan.c) */
+#ifndef DRIVERLIB_CAN_H_
+#define DRIVERLIB_CAN_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define MSG_OBJ_NO_FLAGS        0x00000000
+#define MSG_OBJ_TX_INT_ENABLE   0x00000001
+#define MSG_OBJ_RX_INT_ENABLE   0x00000002
+#define MSG_OBJ_EXTENDED_ID     0x00000004
+#define MSG_OBJ_USE_ID_FILTER   0x00000008
+#define MSG_OBJ_NEW_DATA        0x00000080
+#define MSG_OBJ_DATA_LOST       0x00000100
+#define MSG_OBJ_FIFO            0x00000200
+
+typedef struct
+{
+    uint32_t ui32MsgID;
+    uint32_t ui32MsgIDMask;
+    uint32_t ui32Flags;
+    uint32_t ui32MsgLen;
+    uint8_t *pui8MsgData;
+} tCANMsgObject;
+
+typedef enum
+{
+    MSG_OBJ_TYPE_TX,
+    MSG_OBJ_TYPE_TX_REMOTE,
+    MSG_OBJ_TYPE_RX,
+    MSG_OBJ_TYPE_RX_REMOTE,
+    MSG_OBJ_TYPE_RXTX_REMOTE
+} tMsgObjType;
+
+typedef enum
+{
+    CAN_STS_CONTROL,
+    CAN_STS_TXREQUEST,
+    CAN_STS_NEWDAT,
+    CAN_STS_MSGVAL
+} tCANStsReg;
+
+void CANInit(uint32_t ui32Base);
+uint32_t CANBitRateSet(uint32_t ui32Base, uint32_t ui32SourceClock, uint32_t ui32BitRate);
+void CANEnable(uint32_t ui32Base);
+void CANDisable(uint32_t ui32Base);
+void CANMessageSet(uint32_t ui32Base, uint32_t ui32ObjID, tCANMsgObject *psMsgObject,
+                   tMsgObjType eMsgType);
+void CANMessageGet(uint32_t ui32Base, uint32_t ui32ObjID, tCANMsgObject *psMsgObject,
+                   bool bClrPendingInt);
+uint32_t CANStatusGet(uint32_t ui32Base, tCANStsReg eStatusReg);
+
+#endif /* DRIVERLIB_CAN_H_ */
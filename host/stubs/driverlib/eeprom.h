@@ -0,0 +1,25 @@
+/* Host build: TivaWare EEPROM API (implemented in host/sim/simeeprom.c) */
+#ifndef DRIVERLIB_EEPROM_H_
+#define DRIVERLIB_EEPROM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define EEPROM_INIT_OK          0
+#define EEPROM_INIT_ERROR       2
+#define EEPROM_RC_WRBUSY        0x00000020
+#define EEPROM_RC_WORKING       0x00000001
+#define EEPROM_INT_PROGRAM      0x00000004
+
+uint32_t EEPROMInit(void);
+uint32_t EEPROMSizeGet(void);
+void EEPROMRead(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count);
+uint32_t EEPROMProgram(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count);
+uint32_t EEPROMProgramNonBlocking(uint32_t ui32Data, uint32_t ui32Address);
+uint32_t EEPROMStatusGet(void);
+void EEPROMIntEnable(uint32_t ui32IntFlags);
+void EEPROMIntDisable(uint32_t ui32IntFlags);
+uint32_t EEPROMIntStatus(bool bMasked);
+void EEPROMIntClear(uint32_t ui32IntFlags);
+
+#endif /* DRIVERLIB_EEPROM_H_ */
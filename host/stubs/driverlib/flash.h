@@ -0,0 +1,18 @@
+/* Host build: TivaWare flash API (implemented in host/sim/simflash.c) */
+#ifndef DRIVERLIB_FLASH_H_
+#define DRIVERLIB_FLASH_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define FLASH_INT_PROGRAM       0x00000002
+#define FLASH_INT_EEPROM        0x00000004
+
+int32_t FlashErase(uint32_t ui32Address);
+int32_t FlashProgram(uint32_t *pui32Data, uint32_t ui32Address, uint32_t ui32Count);
+void FlashIntRegister(void (*pfnHandler)(void));
+void FlashIntEnable(uint32_t ui32IntFlags);
+void FlashIntClear(uint32_t ui32IntFlags);
+uint32_t FlashIntStatus(bool bMasked);
+
+#endif /* DRIVERLIB_FLASH_H_ */
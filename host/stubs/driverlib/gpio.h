@@ -0,0 +1,32 @@
+/* Host build: TivaWare GPIO API (implemented in host/sim/simperiph.c) */
+#ifndef DRIVERLIB_GPIO_H_
+#define DRIVERLIB_GPIO_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define GPIO_PIN_0              0x00000001
+#define GPIO_PIN_1              0x00000002
+#define GPIO_PIN_2              0x00000004
+#define GPIO_PIN_3              0x00000008
+#define GPIO_PIN_4              0x00000010
+#define GPIO_PIN_5              0x00000020
+#define GPIO_PIN_6              0x00000040
+#define GPIO_PIN_7              0x00000080
+
+#define GPIO_STRENGTH_2MA       0x00000001
+#define GPIO_STRENGTH_8MA_SC    0x0000000E
+#define GPIO_PIN_TYPE_STD       0x00000008
+#define GPIO_PIN_TYPE_STD_WPU   0x0000000A
+
+void GPIOPinTypeGPIOOutput(uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinTypeGPIOInput(uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinTypeUART(uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPinTypeCAN(uint32_t ui32Port, uint8_t ui8Pins);
+void GPIOPadConfigSet(uint32_t ui32Port, uint8_t ui8Pins, uint32_t ui32Strength,
+                      uint32_t ui32PadType);
+void GPIOPinConfigure(uint32_t ui32PinConfig);
+void GPIOPinWrite(uint32_t ui32Port, uint8_t ui8Pins, uint8_t ui8Val);
+int32_t GPIOPinRead(uint32_t ui32Port, uint8_t ui8Pins);
+
+#endif /* DRIVERLIB_GPIO_H_ */
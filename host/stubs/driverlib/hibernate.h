@@ -0,0 +1,19 @@
+/* Host build: TivaWare hibernation API (implemented in host/sim/simperiph.c) */
+#ifndef DRIVERLIB_HIBERNATE_H_
+#define DRIVERLIB_HIBERNATE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HIBERNATE_OSC_LOWDRIVE  0x00010000
+
+void HibernateEnableExpClk(uint32_t ui32HibClk);
+void HibernateClockConfig(uint32_t ui32Config);
+void HibernateRTCEnable(void);
+bool HibernateIsActive(void);
+uint32_t HibernateRTCGet(void);
+void HibernateRTCSet(uint32_t ui32RTCValue);
+void HibernateDataSet(uint32_t *pui32Data, uint32_t ui32Count);
+void HibernateDataGet(uint32_t *pui32Data, uint32_t ui32Count);
+
+#endif /* DRIVERLIB_HIBERNATE_H_ */
@@ -0,0 +1,16 @@
+/* Host build: TivaWare interrupt API (implemented in host/sim/sim.c) */
+#ifndef DRIVERLIB_INTERRUPT_H_
+#define DRIVERLIB_INTERRUPT_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Both return true if interrupts were disabled before the call */
+bool IntMasterEnable(void);
+bool IntMasterDisable(void);
+void IntEnable(uint32_t ui32Interrupt);
+void IntDisable(uint32_t ui32Interrupt);
+void IntRegister(uint32_t ui32Interrupt, void (*pfnHandler)(void));
+void IntPrioritySet(uint32_t ui32Interrupt, uint8_t ui8Priority);
+
+#endif /* DRIVERLIB_INTERRUPT_H_ */
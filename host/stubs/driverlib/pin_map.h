@@ -0,0 +1,14 @@
+/* Host build: the pin configurations the firmware uses */
+#ifndef DRIVERLIB_PIN_MAP_H_
+#define DRIVERLIB_PIN_MAP_H_
+
+#define GPIO_PA0_U0RX           0x00000001
+#define GPIO_PA1_U0TX           0x00000401
+#define GPIO_PB4_CAN0RX         0x00051008
+#define GPIO_PB5_CAN0TX         0x00051408
+#define GPIO_PD6_U2RX           0x00031801
+#define GPIO_PD7_U2TX           0x00031C01
+#define GPIO_PE4_CAN0RX         0x00041008
+#define GPIO_PE5_CAN0TX         0x00041408
+
+#endif /* DRIVERLIB_PIN_MAP_H_ */
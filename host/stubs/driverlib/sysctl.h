@@ -0,0 +1,48 @@
+/* Host build: TivaWare system control API (implemented in host/sim/simperiph.c) */
+#ifndef DRIVERLIB_SYSCTL_H_
+#define DRIVERLIB_SYSCTL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SYSCTL_SYSDIV_1         0x07800000
+#define SYSCTL_USE_OSC          0x00003800
+#define SYSCTL_XTAL_16MHZ       0x00000540
+#define SYSCTL_OSC_MAIN         0x00000000
+
+#define SYSCTL_PERIPH_WDOG0     0xf0000000
+#define SYSCTL_PERIPH_TIMER0    0xf0000400
+#define SYSCTL_PERIPH_TIMER1    0xf0000401
+#define SYSCTL_PERIPH_TIMER2    0xf0000402
+#define SYSCTL_PERIPH_TIMER3    0xf0000403
+#define SYSCTL_PERIPH_TIMER4    0xf0000404
+#define SYSCTL_PERIPH_TIMER5    0xf0000405
+#define SYSCTL_PERIPH_GPIOA     0xf0000800
+#define SYSCTL_PERIPH_GPIOB     0xf0000801
+#define SYSCTL_PERIPH_GPIOC     0xf0000802
+#define SYSCTL_PERIPH_GPIOD     0xf0000803
+#define SYSCTL_PERIPH_GPIOE     0xf0000804
+#define SYSCTL_PERIPH_GPIOF     0xf0000805
+#define SYSCTL_PERIPH_HIBERNATE 0xf0001400
+#define SYSCTL_PERIPH_UART0     0xf0001800
+#define SYSCTL_PERIPH_UART2     0xf0001802
+#define SYSCTL_PERIPH_CAN0      0xf0003400
+#define SYSCTL_PERIPH_ADC0      0xf0003800
+#define SYSCTL_PERIPH_EEPROM0   0xf0005800
+#define SYSCTL_PERIPH_WTIMER0   0xf0005c00
+#define SYSCTL_PERIPH_WTIMER5   0xf0005c05
+
+#define SYSCTL_CAUSE_WDOG0      0x00000008
+#define SYSCTL_CAUSE_BOR        0x00000004
+#define SYSCTL_CAUSE_POR        0x00000002
+
+void SysCtlClockSet(uint32_t ui32Config);
+uint32_t SysCtlClockGet(void);
+void SysCtlPeripheralEnable(uint32_t ui32Peripheral);
+bool SysCtlPeripheralReady(uint32_t ui32Peripheral);
+uint32_t SysCtlResetCauseGet(void);
+void SysCtlResetCauseClear(uint32_t ui32Causes);
+void SysCtlReset(void);
+void SysCtlDelay(uint32_t ui32Count);
+
+#endif /* DRIVERLIB_SYSCTL_H_ */
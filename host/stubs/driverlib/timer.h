@@ -0,0 +1,28 @@
+/* Host build: TivaWare timer API (implemented in host/sim/simperiph.c) */
+#ifndef DRIVERLIB_TIMER_H_
+#define DRIVERLIB_TIMER_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TIMER_A                 0x000000FF
+#define TIMER_B                 0x0000FF00
+#define TIMER_BOTH              0x0000FFFF
+#define TIMER_CFG_ONE_SHOT      0x00000021
+#define TIMER_CFG_PERIODIC      0x00000022
+#define TIMER_CFG_PERIODIC_UP   0x00000032
+#define TIMER_CFG_A_ONE_SHOT    0x00000021
+#define TIMER_TIMA_TIMEOUT      0x00000001
+
+void TimerConfigure(uint32_t ui32Base, uint32_t ui32Config);
+void TimerLoadSet(uint32_t ui32Base, uint32_t ui32Timer, uint32_t ui32Value);
+uint32_t TimerValueGet(uint32_t ui32Base, uint32_t ui32Timer);
+void TimerEnable(uint32_t ui32Base, uint32_t ui32Timer);
+void TimerDisable(uint32_t ui32Base, uint32_t ui32Timer);
+void TimerIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags);
+void TimerIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags);
+uint32_t TimerIntStatus(uint32_t ui32Base, bool bMasked);
+void TimerIntClear(uint32_t ui32Base, uint32_t ui32IntFlags);
+void TimerIntRegister(uint32_t ui32Base, uint32_t ui32Timer, void (*pfnHandler)(void));
+
+#endif /* DRIVERLIB_TIMER_H_ */
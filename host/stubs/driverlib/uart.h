@@ -0,0 +1,46 @@
+/* Host build: TivaWare UART API (implemented in host/sim/simuart.c) */
+#ifndef DRIVERLIB_UART_H_
+#define DRIVERLIB_UART_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UART_CONFIG_WLEN_8      0x00000060
+#define UART_CONFIG_STOP_ONE    0x00000000
+#define UART_CONFIG_PAR_NONE    0x00000000
+
+#define UART_INT_OE             0x400
+#define UART_INT_BE             0x200
+#define UART_INT_PE             0x100
+#define UART_INT_FE             0x080
+#define UART_INT_RT             0x040
+#define UART_INT_TX             0x020
+#define UART_INT_RX             0x010
+
+#define UART_RXERROR_OVERRUN    0x00000008
+#define UART_RXERROR_BREAK      0x00000004
+#define UART_RXERROR_PARITY     0x00000002
+#define UART_RXERROR_FRAMING    0x00000001
+
+#define UART_FIFO_TX1_8         0x00000000
+#define UART_FIFO_RX1_8         0x00000000
+#define UART_FIFO_RX4_8         0x00000010
+
+void UARTConfigSetExpClk(uint32_t ui32Base, uint32_t ui32UARTClk, uint32_t ui32Baud,
+                         uint32_t ui32Config);
+void UARTFIFOLevelSet(uint32_t ui32Base, uint32_t ui32TxLevel, uint32_t ui32RxLevel);
+void UARTEnable(uint32_t ui32Base);
+void UARTDisable(uint32_t ui32Base);
+bool UARTCharsAvail(uint32_t ui32Base);
+bool UARTSpaceAvail(uint32_t ui32Base);
+int32_t UARTCharGetNonBlocking(uint32_t ui32Base);
+bool UARTCharPutNonBlocking(uint32_t ui32Base, unsigned char ucData);
+void UARTCharPut(uint32_t ui32Base, unsigned char ucData);
+bool UARTBusy(uint32_t ui32Base);
+uint32_t UARTRxErrorGet(uint32_t ui32Base);
+void UARTRxErrorClear(uint32_t ui32Base);
+void UARTIntRegister(uint32_t ui32Base, void (*pfnHandler)(void));
+void UARTIntEnable(uint32_t ui32Base, uint32_t ui32IntFlags);
+void UARTIntDisable(uint32_t ui32Base, uint32_t ui32IntFlags);
+
+#endif /* DRIVERLIB_UART_H_ */
@@ -0,0 +1,15 @@
+/* Host build: TivaWare watchdog API (implemented in host/sim/simperiph.c) */
+#ifndef DRIVERLIB_WATCHDOG_H_
+#define DRIVERLIB_WATCHDOG_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+void WatchdogReloadSet(uint32_t ui32Base, uint32_t ui32LoadVal);
+void WatchdogResetEnable(uint32_t ui32Base);
+void WatchdogStallEnable(uint32_t ui32Base);
+void WatchdogEnable(uint32_t ui32Base);
+void WatchdogIntClear(uint32_t ui32Base);
+void WatchdogIntRegister(uint32_t ui32Base, void (*pfnHandler)(void));
+
+#endif /* DRIVERLIB_WATCHDOG_H_ */
@@ -0,0 +1,28 @@
+/******************************************************************************
+ * File: host.h
+ * Module: Host Build
+ * Description: Included ahead of every firmware source in the host build
+ *              (see host/CMakeLists.txt). IAR keywords and Cortex-M
+ *              assembly compile to nothing; register and flash accesses
+ *              go to the simulator in host/sim.
+ ******************************************************************************/
+
+#ifndef HOST_H_
+#define HOST_H_
+
+#include <stdint.h>
+
+#define __no_init
+#define __stackless
+#define __ramfunc
+#define __root
+#define __weak
+#define __asm(instruction)
+
+/* Register at address (HWREG and the tm4c123gh6pm.h registers) */
+volatile uint32_t *Sim_Reg(uint32_t address);
+
+/* Internal flash, read through FLASH_MEMORY_BASE */
+extern uint8_t Sim_Flash[];
+
+#endif /* HOST_H_ */
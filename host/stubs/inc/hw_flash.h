@@ -0,0 +1,15 @@
+/* Host build: flash memory controller registers */
+#ifndef HW_FLASH_H_
+#define HW_FLASH_H_
+
+#define FLASH_FMA           0x400FD000
+#define FLASH_FMD           0x400FD004
+#define FLASH_FMC           0x400FD008
+#define FLASH_BOOTCFG       0x400FE1D0
+#define FLASH_FMC_WRKEY     0xA4420000
+#define FLASH_FMC_ERASE     0x00000002
+#define FLASH_FMC_WRITE     0x00000001
+#define FLASH_BOOTCFG_KEY   0x00000010
+#define FLASH_ERASE_SIZE    0x400
+
+#endif /* HW_FLASH_H_ */
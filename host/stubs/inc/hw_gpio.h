@@ -0,0 +1,9 @@
+/* Host build: GPIO register offsets */
+#ifndef HW_GPIO_H_
+#define HW_GPIO_H_
+
+#define GPIO_O_LOCK         0x520
+#define GPIO_O_CR           0x524
+#define GPIO_LOCK_KEY       0x4C4F434B
+
+#endif /* HW_GPIO_H_ */
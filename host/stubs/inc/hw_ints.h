@@ -0,0 +1,22 @@
+/* Host build: interrupt numbers (vector table positions) */
+#ifndef HW_INTS_H_
+#define HW_INTS_H_
+
+#define FAULT_SYSTICK       15
+#define INT_UART0           21
+#define INT_WATCHDOG        34
+#define INT_TIMER0A         35
+#define INT_TIMER1A         37
+#define INT_TIMER2A         39
+#define INT_FLASH           45
+#define INT_UART2           49
+#define INT_TIMER3A         51
+#define INT_CAN0            55
+#define INT_HIBERNATE       59
+#define INT_TIMER4A         86
+#define INT_TIMER5A         108
+#define INT_WTIMER0A        110
+#define INT_WTIMER5A        120
+#define NUM_INTERRUPTS      155
+
+#endif /* HW_INTS_H_ */
@@ -0,0 +1,29 @@
+/* Host build: TM4C123GH6PM peripheral base addresses */
+#ifndef HW_MEMMAP_H_
+#define HW_MEMMAP_H_
+
+#define WATCHDOG0_BASE      0x40000000
+#define GPIO_PORTA_BASE     0x40004000
+#define GPIO_PORTB_BASE     0x40005000
+#define GPIO_PORTC_BASE     0x40006000
+#define GPIO_PORTD_BASE     0x40007000
+#define UART0_BASE          0x4000C000
+#define UART2_BASE          0x4000E000
+#define GPIO_PORTE_BASE     0x40024000
+#define GPIO_PORTF_BASE     0x40025000
+#define TIMER0_BASE         0x40030000
+#define TIMER1_BASE         0x40031000
+#define TIMER2_BASE         0x40032000
+#define TIMER3_BASE         0x40033000
+#define TIMER4_BASE         0x40034000
+#define TIMER5_BASE         0x40035000
+#define WTIMER0_BASE        0x40036000
+#define ADC0_BASE           0x40038000
+#define CAN0_BASE           0x40040000
+#define WTIMER5_BASE        0x4004F000
+#define EEPROM_BASE         0x400AF000
+#define HIB_BASE            0x400FC000
+#define FLASH_CTRL_BASE     0x400FD000
+#define SYSCTL_BASE         0x400FE000
+
+#endif /* HW_MEMMAP_H_ */
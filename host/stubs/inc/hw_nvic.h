@@ -0,0 +1,11 @@
+/* Host build: NVIC and SysTick registers */
+#ifndef HW_NVIC_H_
+#define HW_NVIC_H_
+
+#define NVIC_ST_CTRL        0xE000E010
+#define NVIC_ST_RELOAD      0xE000E014
+#define NVIC_ST_CURRENT     0xE000E018
+#define NVIC_VTABLE         0xE000ED08
+#define NVIC_DBG_INT        0xE000EDF0
+
+#endif /* HW_NVIC_H_ */
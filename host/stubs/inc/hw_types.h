@@ -0,0 +1,12 @@
+/* Host build: register access goes to the simulator (see host.h) */
+#ifndef HW_TYPES_H_
+#define HW_TYPES_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define HWREG(x)    (*Sim_Reg(x))
+#define HWREGH(x)   (*(volatile uint16_t *)Sim_Reg(x))
+#define HWREGB(x)   (*(volatile uint8_t *)Sim_Reg(x))
+
+#endif /* HW_TYPES_H_ */
@@ -0,0 +1,19 @@
+/* Host build: UART register offsets and bits */
+#ifndef HW_UART_H_
+#define HW_UART_H_
+
+#define UART_O_DR           0x000
+#define UART_O_FR           0x018
+#define UART_O_RIS          0x03C
+#define UART_O_MIS          0x040
+#define UART_O_ICR          0x044
+#define UART_FR_TXFE        0x080
+#define UART_FR_RXFF        0x040
+#define UART_FR_TXFF        0x020
+#define UART_FR_RXFE        0x010
+#define UART_FR_BUSY        0x008
+#define UART_ICR_OEIC       0x400
+#define UART_ICR_RTIC       0x040
+#define UART_ICR_RXIC       0x010
+
+#endif /* HW_UART_H_ */
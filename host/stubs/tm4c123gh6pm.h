@@ -0,0 +1,11 @@
+/* Host build: the SysTick registers of the device header */
+#ifndef TM4C123GH6PM_H_
+#define TM4C123GH6PM_H_
+
+#include <stdint.h>
+
+#define NVIC_ST_CTRL_R      (*Sim_Reg(0xE000E010))
+#define NVIC_ST_RELOAD_R    (*Sim_Reg(0xE000E014))
+#define NVIC_ST_CURRENT_R   (*Sim_Reg(0xE000E018))
+
+#endif /* TM4C123GH6PM_H_ */
@@ -0,0 +1,43 @@
+/******************************************************************************
+ * File: check.h
+ * Module: Host Tests
+ * Description: Minimal assertions: a failed CHECK is reported and counted,
+ *              the test goes on; main returns Check_Result().
+ ******************************************************************************/
+
+#ifndef CHECK_H_
+#define CHECK_H_
+
+#include <stdio.h>
+#include <string.h>
+
+static unsigned check_failures = 0;
+
+#define CHECK(cond)                                                         \
+    do                                                                      \
+    {                                                                       \
+        if (!(cond))                                                        \
+        {                                                                   \
+            printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            check_failures++;                                               \
+        }                                                                   \
+    } while (0)
+
+#define CHECK_STR(actual, expected)                                         \
+    do                                                                      \
+    {                                                                       \
+        if (strcmp((actual), (expected)) != 0)                              \
+        {                                                                   \
+            printf("%s:%d: \"%s\", expected \"%s\"\n", __FILE__, __LINE__,  \
+                   (actual), (expected));                                   \
+            check_failures++;                                               \
+        }                                                                   \
+    } while (0)
+
+static inline int Check_Result(const char *name)
+{
+    printf("%s: %s (%u failed)\n", name, check_failures ? "FAIL" : "ok", check_failures);
+    return check_failures ? 1 : 0;
+}
+
+#endif /* CHECK_H_ */
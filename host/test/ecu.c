@@ -0,0 +1,131 @@
+/******************************************************************************
+ * File: ecu.c
+ * Module: Host Tests
+ * Description: Control ECU driver for the host tests (see ecu.h)
+ ******************************************************************************/
+
+#include "ecu.h"
+#include "sim.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+#define SLICE_US        100u
+#define RDY_PREFIX      "RDY:"
+
+static char boot_line[16];
+static uint8_t boot_len = 0;
+static uint64_t init_deadline;          /* Ecu_Init gives up at this us */
+static bool init_ready;
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+static void Control_Entry(void)
+{
+    (void)Control_Main();
+}
+
+/* Collects one line; true once it is a RDY frame */
+static bool Boot_SawReady(void)
+{
+    char c;
+
+    while (Sim_UartReceive(&c, 1) == 1)
+    {
+        if (c != '\n')
+        {
+            if (boot_len < sizeof(boot_line) - 1)
+                boot_line[boot_len++] = c;
+            continue;
+        }
+        boot_line[boot_len] = '\0';
+        boot_len = 0;
+        if (strncmp(boot_line, RDY_PREFIX, strlen(RDY_PREFIX)) == 0)
+            return true;
+    }
+    return false;
+}
+
+static void Init_Watch(void)
+{
+    init_ready = Boot_SawReady();
+    if (init_ready || Sim_NowUs() >= init_deadline)
+        Sim_Stop();
+}
+
+/******************************************************************************
+ * Public Functions
+ ******************************************************************************/
+
+bool Ecu_Boot(void)
+{
+    uint64_t deadline = Sim_NowUs() + ECU_BOOT_TIMEOUT_MS * 1000u;
+
+    boot_len = 0;
+    Sim_Start(Control_Entry);
+    while (Sim_NowUs() < deadline)
+    {
+        if (!Sim_Run(SLICE_US))
+            return false;
+        if (Boot_SawReady())
+            return true;
+    }
+    return false;
+}
+
+bool Ecu_Init(void)
+{
+    SimExit how;
+
+    boot_len = 0;
+    init_ready = false;
+    init_deadline = Sim_NowUs() + ECU_BOOT_TIMEOUT_MS * 1000u;
+    Sim_SetPeer(Init_Watch, SLICE_US);
+    how = Sim_Call(Control_Entry);
+    Sim_SetPeer(0, 0);
+    return how == SIM_EXIT_STOP && init_ready;
+}
+
+bool Ecu_Run(uint32_t us)
+{
+    return Sim_Run(us);
+}
+
+void Ecu_Send(const char *line)
+{
+    Sim_UartSend(line, (uint32_t)strlen(line));
+    Sim_UartSend("\n", 1);
+}
+
+uint32_t Ecu_Receive(char *reply, uint32_t size)
+{
+    uint64_t start = Sim_NowUs();
+    uint64_t last = 0;
+    uint32_t len = 0;
+
+    while (Sim_NowUs() - start < ECU_REPLY_TIMEOUT_MS * 1000u)
+    {
+        uint32_t n;
+
+        if (!Sim_Run(SLICE_US))
+            break;
+        n = Sim_UartReceive(&reply[len], size - 1 - len);
+        if (n != 0)
+        {
+            len += n;
+            last = Sim_NowUs();
+        }
+        if (len == size - 1 || (len != 0 && Sim_NowUs() - last >= ECU_REPLY_QUIET_US))
+            break;
+    }
+    reply[len] = '\0';
+    return len;
+}
+
+char Ecu_Request(const char *line, char *reply, uint32_t size)
+{
+    Ecu_Send(line);
+    return (Ecu_Receive(reply, size) != 0) ? reply[0] : '\0';
+}
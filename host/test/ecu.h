@@ -0,0 +1,57 @@
+/******************************************************************************
+ * File: ecu.h
+ * Module: Host Tests
+ * Description: Drives the Control ECU firmware (its real main, renamed
+ *              Control_Main by the host build) from the HMI's side of the
+ *              link: boot, send request lines, collect the replies.
+ ******************************************************************************/
+
+#ifndef ECU_H_
+#define ECU_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define ECU_BOOT_TIMEOUT_MS     2000u
+#define ECU_REPLY_TIMEOUT_MS    1000u
+#define ECU_REPLY_QUIET_US      3000u   /* Silence that ends a reply */
+
+/* The firmware's main, renamed by the build */
+int Control_Main(void);
+
+/*
+ * Ecu_Boot
+ * Starts Control_Main in the simulator and runs it until its RDY frame
+ * has arrived, which is consumed. False if none came.
+ */
+bool Ecu_Boot(void);
+
+/* Runs the firmware for us; false if it has reset or returned meanwhile */
+bool Ecu_Run(uint32_t us);
+
+/* Sends line followed by '\n' */
+void Ecu_Send(const char *line);
+
+/*
+ * Ecu_Receive
+ * Runs the firmware until something arrives and then ECU_REPLY_QUIET_US
+ * pass without more, or ECU_REPLY_TIMEOUT_MS. The bytes are NUL-terminated
+ * in reply; returns their count.
+ */
+uint32_t Ecu_Receive(char *reply, uint32_t size);
+
+/*
+ * Ecu_Request
+ * Ecu_Send then Ecu_Receive. Returns the reply's first byte, or 0 if
+ * there was none.
+ */
+char Ecu_Request(const char *line, char *reply, uint32_t size);
+
+/*
+ * Ecu_Boot without the simulator's firmware context: Control_Main runs
+ * under Sim_Call until RDY and is then left, so the harness can call
+ * ProcessCommand and friends directly on initialised drivers.
+ */
+bool Ecu_Init(void);
+
+#endif /* ECU_H_ */
@@ -0,0 +1,42 @@
+/******************************************************************************
+ * File: hmi_link.h
+ * Module: Host Tests
+ * Description: Included ahead of the HMI's link.c so it can be linked next
+ *              to the Control ECU: the HMI drivers it calls, which share
+ *              their names with the Control ECU's, become HmiLink_*
+ *              functions the harness provides (the wire is the far end of
+ *              the simulated UART2). fmt.c is the same on both ECUs and is
+ *              taken from the Control ECU build.
+ ******************************************************************************/
+
+#ifndef HMI_LINK_H_
+#define HMI_LINK_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define SysTick_GetMs               HmiLink_GetMs
+#define SysTick_GetUs               HmiLink_GetUs
+#define Transport_Init              HmiLink_Init
+#define Transport_SendChar          HmiLink_SendChar
+#define Transport_SendString        HmiLink_SendString
+#define Transport_Flush             HmiLink_Flush
+#define Transport_ReceiveChar       HmiLink_ReceiveChar
+#define Transport_IsDataAvailable   HmiLink_IsDataAvailable
+#define UART2_SendChar              HmiLink_FrameChar
+#define UART2_BeginFrame            HmiLink_BeginFrame
+#define UART2_EndFrame              HmiLink_EndFrame
+#define UART2_TakePoll              HmiLink_TakePoll
+
+uint32_t HmiLink_GetMs(void);
+uint32_t HmiLink_GetUs(void);
+void HmiLink_SendString(const char *str);
+void HmiLink_Flush(void);
+char HmiLink_ReceiveChar(void);
+uint8_t HmiLink_IsDataAvailable(void);
+void HmiLink_FrameChar(char data);
+void HmiLink_BeginFrame(uint8_t dest, uint8_t type);
+void HmiLink_EndFrame(void);
+bool HmiLink_TakePoll(void);
+
+#endif /* HMI_LINK_H_ */
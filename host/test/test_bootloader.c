@@ -0,0 +1,258 @@
+/******************************************************************************
+ * File: test_bootloader.c
+ * Module: Host Tests
+ * Description: Control_Bootloader's update path end to end: transfers as
+ *              tools/fwupdate.py sends them, lost acknowledgements and
+ *              markers, a CRC mismatch, and a power cut during the copy
+ *              recovered on the next boot.
+ ******************************************************************************/
+
+#include "check.h"
+#include "sim.h"
+#include "crc32.h"
+#include "flashmap.h"
+#include "image.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#define SLICE_US        100u
+#define BLOCK_DATA      FLASH_PAGE_SIZE
+
+int Bootloader_Main(void);
+
+static uint8_t image_a[70 * BLOCK_DATA];
+static uint8_t image_b[3 * BLOCK_DATA];
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+static void Boot_Entry(void)
+{
+    (void)Bootloader_Main();
+}
+
+/* An application image: stack and reset vector, then a pattern */
+static void Make_Image(uint8_t *image, uint32_t size, uint8_t salt)
+{
+    const uint32_t vectors[2] = { 0x20008000u, APP_BASE + 0x101u };
+    uint32_t i;
+
+    for (i = 0; i < size; i++)
+        image[i] = (uint8_t)(i * 7u + (i >> 10) + salt);
+    memcpy(image, vectors, sizeof(vectors));
+}
+
+static uint32_t Crc(const uint8_t *data, uint32_t len)
+{
+    return CRC32_Update(CRC32_INIT, data, len);
+}
+
+static const BootDescriptor *Descriptor(void)
+{
+    return (const BootDescriptor *)&Sim_Flash[DESCRIPTOR_ADDRESS];
+}
+
+/* Runs the bootloader until it has left (true) or ms have passed */
+static bool Run_Until_Exit(uint32_t ms)
+{
+    uint64_t deadline = Sim_NowUs() + (uint64_t)ms * 1000u;
+
+    while (Sim_NowUs() < deadline)
+    {
+        if (!Sim_Run(SLICE_US))
+            return true;
+    }
+    return false;
+}
+
+/* The next '0' or '1', skipping announcements; '\0' on timeout or exit */
+static char Reply(uint32_t ms)
+{
+    uint64_t deadline = Sim_NowUs() + (uint64_t)ms * 1000u;
+    char c;
+
+    while (Sim_NowUs() < deadline)
+    {
+        while (Sim_UartReceive(&c, 1) == 1)
+        {
+            if (c == '0' || c == '1')
+                return c;
+        }
+        if (!Sim_Run(SLICE_US))
+            break;
+    }
+    return '\0';
+}
+
+/* Waits for the "BLD" announcement */
+static bool Announced(void)
+{
+    char line[4] = { 0 };
+    uint64_t deadline = Sim_NowUs() + 100000u;
+    char c;
+
+    while (Sim_NowUs() < deadline)
+    {
+        while (Sim_UartReceive(&c, 1) == 1)
+        {
+            memmove(line, &line[1], 2);
+            line[2] = c;
+            if (strcmp(line, "BLD") == 0)
+                return true;
+        }
+        if (!Sim_Run(SLICE_US))
+            break;
+    }
+    return false;
+}
+
+static char Send_Line(const char *line)
+{
+    Sim_UartSend(line, (uint32_t)strlen(line));
+    Sim_UartSend("\n", 1);
+    return Reply(1000);
+}
+
+static char Send_Header(uint32_t size, uint32_t crc)
+{
+    char line[32];
+
+    snprintf(line, sizeof(line), "IMG:%u,%u", (unsigned)size, (unsigned)crc);
+    return Send_Line(line);
+}
+
+/* Block seq of image as fwupdate.py frames it, optionally without its 'B' */
+static char Send_Block(const uint8_t *image, uint32_t size, uint16_t seq,
+                       bool with_marker)
+{
+    uint8_t frame[1 + 2 + BLOCK_DATA + 1];
+    uint32_t offset = (uint32_t)seq * BLOCK_DATA;
+    uint32_t len = (size - offset < BLOCK_DATA) ? size - offset : BLOCK_DATA;
+    uint8_t sum = 0;
+    uint32_t i;
+
+    frame[0] = 'B';
+    frame[1] = (uint8_t)seq;
+    frame[2] = (uint8_t)(seq >> 8);
+    memset(&frame[3], 0xFF, BLOCK_DATA);
+    memcpy(&frame[3], &image[offset], len);
+    for (i = 1; i < sizeof(frame) - 1; i++)
+        sum += frame[i];
+    frame[sizeof(frame) - 1] = sum;
+
+    if (with_marker)
+        Sim_UartSend(frame, sizeof(frame));
+    else
+        Sim_UartSend(&frame[1], sizeof(frame) - 1);
+    return Reply(2500);
+}
+
+static bool Send_Blocks(const uint8_t *image, uint32_t size)
+{
+    uint16_t seq;
+
+    for (seq = 0; seq * BLOCK_DATA < size; seq++)
+    {
+        if (Send_Block(image, size, seq, true) != '1')
+            return false;
+    }
+    return true;
+}
+
+/* Boots with the application's update request set in EEPROM */
+static void Boot_Requested(void)
+{
+    const uint32_t flag = UPDATE_REQUESTED;
+
+    Sim_EepromPoke(UPDATE_FLAG_ADDRESS, &flag, sizeof(flag));
+    Sim_Start(Boot_Entry);
+}
+
+/******************************************************************************
+ * Main Function
+ ******************************************************************************/
+
+int main(void)
+{
+    uint32_t size_a = 69u * BLOCK_DATA + 100u;      /* Last block: seq 69, 'E' */
+    uint32_t size_b = sizeof(image_b);
+    uint32_t crc_a, crc_b, ops;
+    uint32_t flag;
+
+    Make_Image(image_a, size_a, 0);
+    image_a[69u * BLOCK_DATA] = 'E';
+    Make_Image(image_b, size_b, 0x5A);
+    crc_a = Crc(image_a, size_a);
+    crc_b = Crc(image_b, size_b);
+
+    // Blank chip: no application, so the bootloader waits for one
+    Sim_EraseAll();
+    Sim_Start(Boot_Entry);
+    CHECK(Announced());
+
+    // A full transfer. The last block's sequence number starts with 'E'
+    // (69 = 0x45); its acknowledgement is lost and it comes again, which
+    // must be acknowledged, not read as the start of "END"
+    CHECK(Send_Header(size_a, crc_a) == '1');
+    CHECK(Send_Blocks(image_a, size_a));
+    CHECK(Send_Block(image_a, size_a, 69, true) == '1');
+    CHECK(Send_Line("END") == '1');
+    CHECK(Run_Until_Exit(5000) && Sim_LastExit() == SIM_EXIT_RESET);
+    CHECK(memcmp(&Sim_Flash[APP_BASE], image_a, size_a) == 0);
+    CHECK(Descriptor()->state == IMAGE_APP_VALID);
+    CHECK(Descriptor()->app_len == size_a && Descriptor()->app_crc == crc_a);
+
+    // The installed application is started straight away
+    Sim_Start(Boot_Entry);
+    CHECK(Run_Until_Exit(100) && Sim_LastExit() == SIM_EXIT_JUMP);
+
+    // Update requested by the application (UPD); the request is cleared
+    Boot_Requested();
+    CHECK(Announced());
+    Sim_EepromPeek(UPDATE_FLAG_ADDRESS, &flag, sizeof(flag));
+    CHECK(flag == 0);
+
+    // A block whose marker is lost is not acknowledged; after the silence
+    // the resend is taken
+    CHECK(Send_Header(size_b, crc_b ^ 1u) == '1');
+    CHECK(Send_Block(image_b, size_b, 0, false) == '\0');
+    CHECK(Send_Blocks(image_b, size_b));
+
+    // CRC mismatch: nothing installed, the old application still starts
+    CHECK(Send_Line("END") == '0');
+    CHECK(memcmp(&Sim_Flash[APP_BASE], image_a, size_a) == 0);
+    CHECK(Descriptor()->state == IMAGE_APP_VALID && Descriptor()->app_crc == crc_a);
+    Sim_Start(Boot_Entry);
+    CHECK(Run_Until_Exit(100) && Sim_LastExit() == SIM_EXIT_JUMP);
+
+    // Power fails in the middle of the copy's second page
+    Boot_Requested();
+    CHECK(Announced());
+    CHECK(Send_Header(size_b, crc_b) == '1');
+    CHECK(Send_Blocks(image_b, size_b));
+    ops = 1u + sizeof(BootDescriptor) / 4u      /* SLOT_READY descriptor */
+        + 1u + BLOCK_DATA / 4u                  /* First page */
+        + 1u + 100u;                            /* Into the second */
+    Sim_FlashCutAfter(ops);
+    CHECK(Send_Line("END") == '1');
+    CHECK(Run_Until_Exit(5000) && Sim_LastExit() == SIM_EXIT_POWER_CUT);
+    Sim_FlashCutAfter(0);
+    CHECK(Descriptor()->state == IMAGE_SLOT_READY);
+    CHECK(memcmp(&Sim_Flash[APP_BASE], image_b, size_b) != 0);
+
+    // The next boot finishes the copy from the slot and starts it
+    Sim_Start(Boot_Entry);
+    CHECK(Run_Until_Exit(1000) && Sim_LastExit() == SIM_EXIT_JUMP);
+    CHECK(memcmp(&Sim_Flash[APP_BASE], image_b, size_b) == 0);
+    CHECK(Descriptor()->state == IMAGE_APP_VALID && Descriptor()->app_crc == crc_b);
+
+    // A damaged application is not started; the bootloader waits instead
+    Sim_Flash[APP_BASE + 2000u] ^= 0x01;
+    Sim_Start(Boot_Entry);
+    CHECK(Announced());
+
+    return Check_Result("test_bootloader");
+}
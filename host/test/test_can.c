@@ -0,0 +1,306 @@
+/******************************************************************************
+ * File: test_can.c
+ * Module: Host Tests
+ * Description: The Control ECU built with TRANSPORT_CAN on the simulated
+ *              bus: identifiers and arbitration levels per request and
+ *              reply, and a PWD-class exchange overtaking other traffic.
+ *
+ *   test_can            simulated far end (node 0 plays the HMI)
+ *   test_can <ifname>   bridged to a SocketCAN interface, e.g. after
+ *                       "ip link add vcan0 type vcan && ip link set vcan0 up";
+ *                       exits 77 (skipped) if it cannot be opened
+ ******************************************************************************/
+
+#include "check.h"
+#include "sim.h"
+#include "can.h"
+#include "eventlog.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/ioctl.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+#define SLICE_US        20u
+#define HMI             0
+#define OTHER           1           /* Another device streaming on the bus */
+#define OTHER_ID        0x340u      /* Between the control and bulk levels */
+#define FLOOD_FRAMES    20u         /* Under CAN_TX_TIMEOUT_MS of bus time */
+#define SKIPPED         77
+
+int Control_Main(void);
+
+/* Frames the firmware sent since the last Reply_Reset */
+typedef struct
+{
+    uint8_t data[256];
+    uint32_t len;
+    uint32_t frames;
+    uint32_t id;                /* Of the first frame */
+    bool mixed;                 /* A later frame had another identifier */
+    uint64_t first_us;          /* End of the first frame on the bus */
+    uint64_t last_us;
+} Reply;
+
+static Reply reply;
+static int sock = -1;           /* The test's own end of the interface */
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+static void Control_Entry(void)
+{
+    (void)Control_Main();
+}
+
+static uint32_t Request_Id(uint8_t level)
+{
+    return CAN_ID_TO_CONTROL + CAN_ID_LEVEL(level);
+}
+
+static uint32_t Reply_Id(uint8_t level)
+{
+    return CAN_ID_TO_HMI + CAN_ID_LEVEL(level);
+}
+
+static void Reply_Reset(void)
+{
+    memset(&reply, 0, sizeof(reply));
+}
+
+static void Reply_Take(uint32_t id, const uint8_t *data, uint8_t len, uint64_t done_us)
+{
+    if (reply.frames == 0)
+    {
+        reply.id = id;
+        reply.first_us = done_us;
+    }
+    else if (id != reply.id)
+    {
+        reply.mixed = true;
+    }
+    reply.frames++;
+    reply.last_us = done_us;
+    if (reply.len + len <= sizeof(reply.data))
+    {
+        memcpy(&reply.data[reply.len], data, len);
+        reply.len += len;
+    }
+}
+
+/* Collects what the firmware put on the bus (or the interface) */
+static void Bus_Collect(void)
+{
+    SimCanFrame f;
+    struct can_frame cf;
+
+    if (sock >= 0)
+    {
+        while (read(sock, &cf, sizeof(cf)) == (ssize_t)sizeof(cf))
+            Reply_Take(cf.can_id & CAN_SFF_MASK, cf.data, cf.can_dlc, Sim_NowUs());
+        return;
+    }
+    while (Sim_CanReceive(&f))
+        Reply_Take(f.id, f.data, f.len, f.done * 1000000u / SIM_CLOCK_HZ);
+}
+
+/* Sends a line as the HMI does, in frames of up to 8 bytes */
+static void Send_Line(uint32_t id, const char *line)
+{
+    uint32_t len = (uint32_t)strlen(line);
+    uint32_t i, n;
+    struct can_frame cf;
+
+    for (i = 0; i < len; i += n)
+    {
+        n = (len - i < 8u) ? len - i : 8u;
+        if (sock < 0)
+        {
+            Sim_CanSend(HMI, id, (const uint8_t *)&line[i], (uint8_t)n);
+            continue;
+        }
+        memset(&cf, 0, sizeof(cf));
+        cf.can_id = id;
+        cf.can_dlc = (uint8_t)n;
+        memcpy(cf.data, &line[i], n);
+        (void)write(sock, &cf, sizeof(cf));
+    }
+}
+
+/* Runs until the reply holds at least len bytes (true) or ms have passed */
+static bool Wait_Bytes(uint32_t len, uint32_t ms)
+{
+    uint64_t deadline = Sim_NowUs() + (uint64_t)ms * 1000u;
+
+    while (Sim_NowUs() < deadline)
+    {
+        Bus_Collect();
+        if (reply.len >= len)
+            return true;
+        if (!Sim_Run(SLICE_US))
+            return false;
+    }
+    Bus_Collect();
+    return reply.len >= len;
+}
+
+/* A tagged request and its one-character reply ("^<tag><c>"). A deferred
+ * reply (SET) comes as the bare tag first, then the tag and the result. */
+static char Request(uint8_t level, char tag, const char *command)
+{
+    char line[24];
+
+    snprintf(line, sizeof(line), "^%c%s\n", tag, command);
+    Reply_Reset();
+    Send_Line(Request_Id(level), line);
+    if (!Wait_Bytes(3, 600) || reply.data[0] != '^' || reply.data[1] != (uint8_t)tag)
+        return '\0';
+    if (reply.data[2] == '^' && !Wait_Bytes(5, 600))
+        return '\0';
+    return (char)reply.data[reply.len - 1];
+}
+
+/* Keeps the bus busy with frames the Control ECU does not listen to */
+static void Flood(uint32_t frames)
+{
+    static const uint8_t data[8] = { 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55, 0x55 };
+    uint32_t i;
+
+    for (i = 0; i < frames; i++)
+        Sim_CanSend(OTHER, OTHER_ID, data, sizeof(data));
+}
+
+static bool Boot(void)
+{
+    uint64_t deadline;
+
+    Reply_Reset();
+    Sim_EraseAll();
+    Sim_Start(Control_Entry);
+    deadline = Sim_NowUs() + 500000u;
+    while (Sim_NowUs() < deadline)
+    {
+        if (!Sim_Run(SLICE_US))
+            return false;
+        Bus_Collect();
+        if (reply.len > 0 && reply.data[reply.len - 1] == '\n')
+            return strncmp((const char *)reply.data, "RDY:", 4) == 0;
+    }
+    return false;
+}
+
+static int Open_Interface(const char *ifname)
+{
+    struct sockaddr_can addr;
+    struct ifreq ifr;
+    int s;
+
+    s = socket(PF_CAN, SOCK_RAW | SOCK_NONBLOCK, CAN_RAW);
+    if (s < 0)
+        return -1;
+    memset(&ifr, 0, sizeof(ifr));
+    strncpy(ifr.ifr_name, ifname, IFNAMSIZ - 1);
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    if (ioctl(s, SIOCGIFINDEX, &ifr) < 0)
+    {
+        close(s);
+        return -1;
+    }
+    addr.can_ifindex = ifr.ifr_ifindex;
+    if (bind(s, (struct sockaddr *)&addr, sizeof(addr)) < 0)
+    {
+        close(s);
+        return -1;
+    }
+    return s;
+}
+
+/* The same exchanges over a SocketCAN interface */
+static int Run_Interface(const char *ifname)
+{
+    if (!Sim_CanOpenSocket(ifname) || (sock = Open_Interface(ifname)) < 0)
+    {
+        printf("test_can: %s cannot be opened, skipped\n", ifname);
+        return SKIPPED;
+    }
+
+    CHECK(Boot());
+    CHECK(reply.id == Reply_Id(CAN_LEVEL_CONTROL));
+    CHECK(Request(CAN_LEVEL_CONTROL, 'a', "STS") == '0');
+    CHECK(reply.id == Reply_Id(CAN_LEVEL_CONTROL));
+    CHECK(Request(CAN_LEVEL_CONTROL, 'b', "SET:12345") == '1');
+    CHECK(Request(CAN_LEVEL_ACCESS, 'c', "CHK:12345") == '1');
+    CHECK(reply.id == Reply_Id(CAN_LEVEL_ACCESS));
+
+    close(sock);
+    return Check_Result("test_can (SocketCAN)");
+}
+
+/******************************************************************************
+ * Main Function
+ ******************************************************************************/
+
+int main(int argc, char **argv)
+{
+    uint64_t frame_us = Sim_CanFrameCycles(8) * 1000000ull / SIM_CLOCK_HZ;
+    uint64_t start;
+    uint32_t expect;
+    uint16_t count;
+
+    if (argc > 1)
+        return Run_Interface(argv[1]);
+
+    // RDY, before anything was received, goes at the control level
+    CHECK(Boot());
+    CHECK(reply.id == Reply_Id(CAN_LEVEL_CONTROL) && !reply.mixed);
+
+    // Each reply takes its request's level
+    CHECK(Request(CAN_LEVEL_CONTROL, 'a', "STS") == '0');
+    CHECK(reply.id == Reply_Id(CAN_LEVEL_CONTROL));
+    CHECK(Request(CAN_LEVEL_CONTROL, 'b', "SET:12345") == '1');
+    CHECK(reply.id == Reply_Id(CAN_LEVEL_CONTROL));
+    CHECK(Request(CAN_LEVEL_ACCESS, 'c', "CHK:12345") == '1');
+    CHECK(reply.id == Reply_Id(CAN_LEVEL_ACCESS));
+    CHECK(Request(CAN_LEVEL_ACCESS, 'd', "CHK:54321") == '0');
+    CHECK(reply.id == Reply_Id(CAN_LEVEL_ACCESS));
+
+    // A multi-frame bulk reply keeps its level on every frame
+    Sim_AdvanceUs(EVENTLOG_FLUSH_DELAY_MS * 1000u);
+    Reply_Reset();
+    Send_Line(Request_Id(CAN_LEVEL_BULK), "^eLOG\n");
+    CHECK(Wait_Bytes(4, 600));
+    memcpy(&count, &reply.data[2], sizeof(count));
+    expect = 2u + 2u + count * (uint32_t)sizeof(EventRecord) + 1u;
+    CHECK(count > 0 && Wait_Bytes(expect, 600) && reply.len == expect);
+    CHECK(reply.frames > 1 && reply.id == Reply_Id(CAN_LEVEL_BULK) && !reply.mixed);
+
+    // With another device streaming, the access exchange still only waits
+    // for the frame on the bus at each step: two request frames, one reply
+    Flood(FLOOD_FRAMES);
+    CHECK(Sim_Run(100));
+    start = Sim_NowUs();
+    CHECK(Request(CAN_LEVEL_ACCESS, 'f', "CHK:12345") == '1');
+    printf("CHK under load: %llu us (frame %llu us)\n",
+           (unsigned long long)(reply.last_us - start), (unsigned long long)frame_us);
+    CHECK(reply.last_us - start <= 6u * frame_us + 1000u);
+
+    // ... while a bulk reply waits for the stream to end
+    CHECK(Sim_Run(20000));
+    Flood(FLOOD_FRAMES);
+    CHECK(Sim_Run(100));
+    start = Sim_NowUs();
+    Reply_Reset();
+    Send_Line(Request_Id(CAN_LEVEL_BULK), "^gLOG:1\n");
+    CHECK(Wait_Bytes(2u + 2u + sizeof(EventRecord) + 1u, 50));
+    CHECK(reply.id == Reply_Id(CAN_LEVEL_BULK));
+    CHECK(reply.first_us - start >= (FLOOD_FRAMES - 2u) * frame_us);
+
+    return Check_Result("test_can");
+}
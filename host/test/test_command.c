@@ -0,0 +1,107 @@
+/******************************************************************************
+ * File: test_command.c
+ * Module: Host Tests
+ * Description: The Control ECU's request/reply protocol end to end: the
+ *              real main loop, UART driver and EEPROM queue on the
+ *              simulator, driven as the HMI would.
+ ******************************************************************************/
+
+#include "check.h"
+#include "ecu.h"
+#include "sim.h"
+#include "eventlog.h"
+#include <string.h>
+
+#define CLOCK_SET   1700000000u
+
+/* The newest access log record, through LOG:1 */
+static bool Last_Record(EventRecord *rec)
+{
+    char reply[32];
+
+    Ecu_Send("LOG:1");
+    if (Ecu_Receive(reply, sizeof(reply)) != 2u + sizeof(*rec) + 1u)
+        return false;
+    memcpy(rec, &reply[2], sizeof(*rec));
+    return true;
+}
+
+int main(void)
+{
+    char reply[64];
+    EventRecord rec;
+    uint32_t i;
+
+    Sim_EraseAll();
+    CHECK(Ecu_Boot());
+
+    CHECK(Ecu_Request("STS", reply, sizeof(reply)) == '0');
+    CHECK(Ecu_Request("HBT", reply, sizeof(reply)) == '1');
+
+    // SET answers once the EEPROM write is read back
+    CHECK(Ecu_Request("SET:12345", reply, sizeof(reply)) == '1');
+    CHECK(Ecu_Request("STS", reply, sizeof(reply)) == '1');
+    CHECK(Ecu_Request("SET:123", reply, sizeof(reply)) == '0');
+
+    CHECK(Ecu_Request("CHK:12345", reply, sizeof(reply)) == '1');
+    CHECK(Ecu_Request("CHK:54321", reply, sizeof(reply)) == '0');
+    // A password that is not 5 digits was garbled on the wire: no reply
+    CHECK(Ecu_Request("CHK:12a45", reply, sizeof(reply)) == '\0');
+
+    // The auto-lock timeout takes 5-30 s
+    CHECK(Ecu_Request("TMO:10", reply, sizeof(reply)) == '1');
+    CHECK(Ecu_Request("TMO:4", reply, sizeof(reply)) == '0');
+
+    // Unknown and overlong lines are ignored
+    CHECK(Ecu_Request("XYZ", reply, sizeof(reply)) == '\0');
+    CHECK(Ecu_Request("CHK:1234512345123451234512345123451234", reply, sizeof(reply)) == '\0');
+
+    // Tagged requests come back behind their tag and are replayed, not rerun
+    Ecu_Request("^aCHK:12345", reply, sizeof(reply));
+    CHECK_STR(reply, "^a1");
+    Ecu_Request("^aCHK:12345", reply, sizeof(reply));
+    CHECK_STR(reply, "^a1");
+    // An untagged copy of the cached line is a resend that lost its tag
+    CHECK(Ecu_Request("CHK:12345", reply, sizeof(reply)) == '\0');
+    Ecu_Request("^bHBT", reply, sizeof(reply));
+    CHECK_STR(reply, "^b1");
+
+    CHECK(Ecu_Request("PWD:12345", reply, sizeof(reply)) == '1');
+
+    // Third consecutive failure locks out, even the right password
+    CHECK(Ecu_Request("CHK:00000", reply, sizeof(reply)) == '0');
+    CHECK(Ecu_Request("CHK:00000", reply, sizeof(reply)) == '0');
+    CHECK(Ecu_Request("CHK:00000", reply, sizeof(reply)) == 'L');
+    CHECK(Ecu_Request("CHK:12345", reply, sizeof(reply)) == 'L');
+    Ecu_Request("LCK", reply, sizeof(reply));
+    CHECK(reply[0] >= '1' && reply[0] <= '2' && strchr(reply, '\n') != NULL);
+
+    // The lockout ends after 20 s
+    for (i = 0; i < 21; i++)
+        Ecu_Run(1000000);
+    Sim_UartReceive(reply, sizeof(reply));
+    CHECK(Ecu_Request("CHK:12345", reply, sizeof(reply)) == '1');
+
+    // The password survives a restart
+    CHECK(Ecu_Boot());
+    CHECK(Ecu_Request("STS", reply, sizeof(reply)) == '1');
+    CHECK(Ecu_Request("CHK:12345", reply, sizeof(reply)) == '1');
+
+    // A door with a schedule stays shut while the clock is unset
+    CHECK(Ecu_Request("SCH:111111109001000", reply, sizeof(reply)) == '1');
+    CHECK(Ecu_Request("PWD:12345", reply, sizeof(reply)) == 'S');
+    CHECK(Last_Record(&rec) && rec.type == EVT_UNLOCK);
+    CHECK(rec.result == EVT_RESULT_DENIED);
+    CHECK(Ecu_Request("SCH:0", reply, sizeof(reply)) == '1');
+    CHECK(Ecu_Request("CHK:12345", reply, sizeof(reply)) == '1');
+
+    // Log records carry the uptime, flagged, until CLK sets the RTC
+    CHECK(Last_Record(&rec) && rec.type == EVT_VERIFY);
+    CHECK((rec.time & EVT_TIME_UPTIME) != 0 && (rec.time & ~EVT_TIME_UPTIME) < 60u);
+    CHECK(Ecu_Request("CLK:1700000000", reply, sizeof(reply)) == '1');
+    CHECK(Ecu_Request("CHK:12345", reply, sizeof(reply)) == '1');
+    CHECK(Last_Record(&rec) && rec.type == EVT_VERIFY);
+    CHECK(rec.time >= CLOCK_SET && rec.time <= CLOCK_SET + 2u);
+
+    return Check_Result("test_command");
+}
@@ -0,0 +1,162 @@
+/******************************************************************************
+ * File: test_config.c
+ * Module: Host Tests
+ * Description: Configuration export and import (config.c) over the link:
+ *              an image round trip, the configuration written back when
+ *              END does not match or the host goes quiet, and one-time
+ *              PIN codes staying used across an import of an old backup.
+ ******************************************************************************/
+
+#include "check.h"
+#include "ecu.h"
+#include "sim.h"
+#include "config.h"
+#include "crc32.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#define EXP_REPLY_LEN   (2u + 1u + CONFIG_IMAGE_SIZE + 4u + 1u)
+
+/* The RFC 6238 key "12345678901234567890" in two OTK parts, and the code
+ * for the step of 1111111111 (see test_totp.c) */
+#define OTK_PART0       "OTK:31323334353637383930"
+#define OTK_PART1       "OTK:31323334353637383930,1"
+#define CLOCK_SET       "CLK:1111111111"
+#define CODE            "50471"
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+/* EXP: the image, checked against its CRC-32 */
+static bool Export(uint8_t *image)
+{
+    char reply[EXP_REPLY_LEN + 1];
+    uint32_t crc;
+
+    Ecu_Send("EXP");
+    if (Ecu_Receive(reply, sizeof(reply)) != EXP_REPLY_LEN || reply[2] != CONFIG_VERSION)
+        return false;
+    memcpy(image, &reply[3], CONFIG_IMAGE_SIZE);
+    memcpy(&crc, &reply[3 + CONFIG_IMAGE_SIZE], sizeof(crc));
+    return crc == CRC32_Update(CRC32_INIT, image, CONFIG_IMAGE_SIZE);
+}
+
+/* One block of image, framed as tools/config.py sends it; the reply */
+static char Send_Block(const uint8_t *image, uint16_t seq)
+{
+    uint8_t frame[1 + 2 + CONFIG_BLOCK_SIZE + 4] = { 0 };
+    uint32_t offset = (uint32_t)seq * CONFIG_BLOCK_SIZE;
+    uint32_t n = CONFIG_IMAGE_SIZE - offset, crc;
+    char reply[8];
+
+    if (n > CONFIG_BLOCK_SIZE)
+        n = CONFIG_BLOCK_SIZE;
+    frame[0] = CONFIG_BLOCK_MARKER;
+    frame[1] = (uint8_t)seq;
+    frame[2] = (uint8_t)(seq >> 8);
+    memcpy(&frame[3], &image[offset], n);
+    crc = CRC32_Update(CRC32_INIT, &frame[1], 2u + CONFIG_BLOCK_SIZE);
+    memcpy(&frame[3 + CONFIG_BLOCK_SIZE], &crc, sizeof(crc));
+    Sim_UartSend(frame, sizeof(frame));
+    return (Ecu_Receive(reply, sizeof(reply)) == 1) ? reply[0] : '\0';
+}
+
+static bool Begin(uint32_t crc)
+{
+    char line[32], reply[8];
+
+    snprintf(line, sizeof(line), "IMP:%u,%u", (unsigned)CONFIG_IMAGE_SIZE, (unsigned)crc);
+    return Ecu_Request(line, reply, sizeof(reply)) == '1';
+}
+
+/* A whole import announcing crc; END's reply */
+static char Import(const uint8_t *image, uint32_t crc)
+{
+    char reply[8];
+    uint16_t seq;
+
+    if (!Begin(crc))
+        return '\0';
+    for (seq = 0; seq < CONFIG_BLOCKS; seq++)
+    {
+        if (Send_Block(image, seq) != '1')
+            return '\0';
+    }
+    return Ecu_Request("END", reply, sizeof(reply));
+}
+
+static char Request(const char *line)
+{
+    char reply[16];
+
+    return Ecu_Request(line, reply, sizeof(reply));
+}
+
+/******************************************************************************
+ * Main Function
+ ******************************************************************************/
+
+int main(void)
+{
+    static uint8_t backup[CONFIG_IMAGE_SIZE], image[CONFIG_IMAGE_SIZE];
+    uint32_t crc;
+    uint16_t seq;
+    char reply[8];
+
+    Sim_EraseAll();
+    CHECK(Ecu_Boot());
+    CHECK(Request("SET:12345") == '1');
+    CHECK(Request(CLOCK_SET) == '1');
+    CHECK(Request(OTK_PART0) == '1' && Request(OTK_PART1) == '1');
+
+    // The backup is taken before the code is used
+    CHECK(Export(backup));
+    crc = CRC32_Update(CRC32_INIT, backup, CONFIG_IMAGE_SIZE);
+    CHECK(Request("CHK:" CODE) == 'G');
+    CHECK(Request("PWD:" CODE) == '1');
+    CHECK(Request("PWD:" CODE) == '0');
+    CHECK(Request("CHK:12345") == '1');
+
+    // Restoring it brings the configuration back but not the used step
+    CHECK(Import(backup, crc) == '1');
+    CHECK(Export(image) && memcmp(image, backup, CONFIG_IMAGE_SIZE) == 0);
+    CHECK(Request("CHK:12345") == '1');
+    CHECK(Request("PWD:" CODE) == '0');
+    CHECK(Request("CHK:12345") == '1');
+
+    // END with another CRC-32 than announced: the old configuration is
+    // written back
+    memcpy(image, backup, CONFIG_IMAGE_SIZE);
+    memcpy(image, "54321", 5);
+    CHECK(Import(image, crc) == '0');
+    CHECK(Request("CHK:12345") == '1');
+    CHECK(Request("CHK:54321") == '0');
+    CHECK(Request("CHK:12345") == '1');
+
+    // A resent last block (its acknowledgement lost) is acknowledged
+    // again, and END still follows it
+    crc = CRC32_Update(CRC32_INIT, image, CONFIG_IMAGE_SIZE);
+    CHECK(Begin(crc));
+    for (seq = 0; seq < CONFIG_BLOCKS; seq++)
+        CHECK(Send_Block(image, seq) == '1');
+    CHECK(Send_Block(image, CONFIG_BLOCKS - 1u) == '1');
+    CHECK(Ecu_Request("END", reply, sizeof(reply)) == '1');
+    CHECK(Request("CHK:54321") == '1');
+
+    // END before the last block, then a host that goes quiet halfway:
+    // both leave the configuration as it was
+    CHECK(Begin(CRC32_Update(CRC32_INIT, backup, CONFIG_IMAGE_SIZE)));
+    CHECK(Send_Block(backup, 0) == '1');
+    CHECK(Ecu_Request("END", reply, sizeof(reply)) == '0');
+    CHECK(Request("CHK:54321") == '1');
+    CHECK(Begin(CRC32_Update(CRC32_INIT, backup, CONFIG_IMAGE_SIZE)));
+    CHECK(Send_Block(backup, 0) == '1');
+    CHECK(Ecu_Run(CONFIG_TRANSFER_TIMEOUT_MS * 1000u + 100000u));
+    CHECK(Request("CHK:54321") == '1');
+    CHECK(Request("CHK:12345") == '0');
+
+    return Check_Result("test_config");
+}
@@ -0,0 +1,115 @@
+/******************************************************************************
+ * File: test_eeprom.c
+ * Module: Host Tests
+ * Description: eeprom.c's background write queue on the simulated EEPROM
+ *              controller: coalescing, reads that see pending writes, the
+ *              done interrupt draining the queue, and giving up after
+ *              EEPROM_VERIFY_RETRIES.
+ ******************************************************************************/
+
+#include "check.h"
+#include "ecu.h"
+#include "sim.h"
+#include "eeprom.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Past everything eeprom.h places */
+#define SCRATCH_A   0x0400u
+#define SCRATCH_B   0x0410u
+#define SCRATCH_C   0x0420u
+#define ERASED      0xFFFFFFFFu
+
+/* Lets the done interrupt work through the queue */
+static bool Drain(uint32_t ticket)
+{
+    uint32_t i;
+
+    for (i = 0; i < 1000u && !EEPROM_IsWritten(ticket); i++)
+        Sim_AdvanceUs(100);
+    return EEPROM_IsWritten(ticket);
+}
+
+static uint32_t Peek(uint32_t address)
+{
+    uint32_t word;
+
+    Sim_EepromPeek(address, &word, sizeof(word));
+    return word;
+}
+
+/******************************************************************************
+ * Main Function
+ ******************************************************************************/
+
+int main(void)
+{
+    const uint32_t one = 0x11111111u;
+    const uint32_t first[2] = { 0x22222222u, 0x33333333u };
+    const uint32_t second[2] = { 0x44444444u, 0x55555555u };
+    uint32_t words[8];
+    uint32_t programmed, failures, head, ticket;
+
+    Sim_EraseAll();
+    CHECK(Ecu_Init());
+    EEPROM_Flush();
+
+    // The head write starts at once; a second write to a waiting entry's
+    // address replaces its data and is only programmed once
+    programmed = Sim_EepromWordsProgrammed();
+    head = EEPROM_QueueWrite(SCRATCH_A, &one, 1);
+    ticket = EEPROM_QueueWrite(SCRATCH_B, first, 2);
+    CHECK(ticket == head + 1u);
+    ticket = EEPROM_QueueWrite(SCRATCH_B, second, 2);
+    CHECK(ticket == head + 2u && EEPROM_LastTicket() == ticket);
+    CHECK(!EEPROM_IsWritten(head) && !EEPROM_IsWritten(ticket));
+
+    // Reads see the pending data, patched into a wider read
+    CHECK(Peek(SCRATCH_B) == ERASED);
+    EEPROM_ReadWords(words, SCRATCH_A, 8u * 4u);
+    CHECK(words[0] == one);
+    CHECK(words[1] == ERASED && words[3] == ERASED);
+    CHECK(words[4] == second[0] && words[5] == second[1]);
+    CHECK(words[6] == ERASED);
+    EEPROM_ReadWords(words, SCRATCH_B + 4u, 4u);
+    CHECK(words[0] == second[1]);
+
+    // The done interrupt drains the queue without a flush
+    CHECK(Drain(ticket));
+    CHECK(Sim_EepromWordsProgrammed() - programmed == 3u);
+    CHECK(Peek(SCRATCH_A) == one);
+    CHECK(Peek(SCRATCH_B) == second[0] && Peek(SCRATCH_B + 4u) == second[1]);
+
+    // The head may be half programmed: the same address queues behind it
+    ticket = EEPROM_QueueWrite(SCRATCH_C, first, 2);
+    CHECK(EEPROM_QueueWrite(SCRATCH_C, second, 2) == ticket + 1u);
+    EEPROM_ReadWords(words, SCRATCH_C, 8u);
+    CHECK(words[0] == second[0] && words[1] == second[1]);
+    CHECK(Drain(ticket + 1u));
+    CHECK(Peek(SCRATCH_C) == second[0] && Peek(SCRATCH_C + 4u) == second[1]);
+
+    // A bad read-back is programmed again, and passes the second time
+    failures = EEPROM_WriteFailures();
+    programmed = Sim_EepromWordsProgrammed();
+    Sim_EepromFailWords(1);
+    CHECK(Drain(EEPROM_QueueWrite(SCRATCH_A, &first[0], 1)));
+    CHECK(Sim_EepromWordsProgrammed() - programmed == 2u);
+    CHECK(Peek(SCRATCH_A) == first[0] && EEPROM_WriteFailures() == failures);
+
+    // Still wrong after EEPROM_VERIFY_RETRIES: given up, counted, and the
+    // next write goes through
+    programmed = Sim_EepromWordsProgrammed();
+    Sim_EepromFailWords(1000);
+    ticket = EEPROM_QueueWrite(SCRATCH_A, &second[0], 1);
+    CHECK(Drain(ticket));
+    CHECK(Sim_EepromWordsProgrammed() - programmed == 1u + EEPROM_VERIFY_RETRIES);
+    CHECK(EEPROM_WriteFailures() == failures + 1u);
+    CHECK(Peek(SCRATCH_A) == (second[0] ^ 1u));
+    Sim_EepromFailWords(0);
+    ticket = EEPROM_QueueWrite(SCRATCH_A, &one, 1);
+    EEPROM_Flush();
+    CHECK(EEPROM_IsWritten(ticket) && Peek(SCRATCH_A) == one);
+    CHECK(EEPROM_WriteFailures() == failures + 1u);
+
+    return Check_Result("test_eeprom");
+}
@@ -0,0 +1,209 @@
+/******************************************************************************
+ * File: test_lossy.c
+ * Module: Host Tests
+ * Description: The HMI's link (link.c, retransmission included) against
+ *              the Control ECU over a UART2 wire that drops bytes.
+ *
+ *   test_lossy <drop ppm> <min goodput req/s> <max p99 ms> [seconds]
+ *
+ * Each byte, either way, is lost with the given probability. The HMI
+ * side issues CHK and STS back to back, as the keypad flows do, for the
+ * given simulated time (default 20 s). Goodput counts requests that got their
+ * right reply; the latency runs from Link_Request to the reply in
+ * Link_Poll, resends included.
+ *
+ * Fails on any wrong reply (a lost byte must never turn into another
+ * command or a failed password), on more than 1% of requests timing out,
+ * on goodput below the minimum, or on a p99 latency above the maximum.
+ ******************************************************************************/
+
+#include "check.h"
+#include "sim.h"
+#include "hmi_link.h"
+#include "link.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SLICE_US        100u
+#define MAX_SAMPLES     8192u
+#define RX_SIZE         256u        /* Power of two */
+#define SEED            42u
+
+int Control_Main(void);
+
+typedef struct
+{
+    const char *prefix;
+    const char *data;
+    char reply;
+} Request;
+
+static const Request requests[] = {
+    { "CHK:", "12345", '1' },
+    { "STS", "", '1' },
+};
+
+static char rx[RX_SIZE];
+static uint32_t rx_head = 0, rx_tail = 0;
+static uint32_t latency[MAX_SAMPLES];   /* us */
+
+/******************************************************************************
+ * HMI drivers (hmi_link.h)
+ ******************************************************************************/
+
+uint32_t HmiLink_GetMs(void)
+{
+    return (uint32_t)(Sim_NowUs() / 1000u);
+}
+
+uint32_t HmiLink_GetUs(void)
+{
+    return (uint32_t)Sim_NowUs();
+}
+
+void HmiLink_SendString(const char *str)
+{
+    Sim_UartSend(str, (uint32_t)strlen(str));
+}
+
+void HmiLink_Flush(void) {}
+
+static void Wire_Take(void)
+{
+    char c;
+
+    while (rx_head - rx_tail < RX_SIZE && Sim_UartReceive(&c, 1) == 1)
+        rx[rx_head++ % RX_SIZE] = c;
+}
+
+uint8_t HmiLink_IsDataAvailable(void)
+{
+    Wire_Take();
+    return (rx_head != rx_tail) ? 1u : 0u;
+}
+
+char HmiLink_ReceiveChar(void)
+{
+    return HmiLink_IsDataAvailable() ? rx[rx_tail++ % RX_SIZE] : '\0';
+}
+
+/* Point-to-point: never called */
+void HmiLink_FrameChar(char data) { (void)data; }
+void HmiLink_BeginFrame(uint8_t dest, uint8_t type) { (void)dest; (void)type; }
+void HmiLink_EndFrame(void) {}
+bool HmiLink_TakePoll(void) { return false; }
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+static void Control_Entry(void)
+{
+    (void)Control_Main();
+}
+
+/* Runs both ends until the outstanding request has its result */
+static char Exchange(const Request *r, uint32_t *us)
+{
+    uint64_t start = Sim_NowUs();
+    char result;
+
+    Link_Request(r->prefix, r->data, LINK_DEFAULT_TIMEOUT_MS);
+    do
+    {
+        if (!Sim_Run(SLICE_US))
+            return '\0';
+        Link_Service();
+        result = Link_Poll();
+    } while (result == LINK_PENDING);
+    *us = (uint32_t)(Sim_NowUs() - start);
+    return result;
+}
+
+static int Compare_U32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/******************************************************************************
+ * Main Function
+ ******************************************************************************/
+
+int main(int argc, char **argv)
+{
+    uint32_t drop_ppm, min_goodput, max_p99_ms, seconds;
+    uint32_t good = 0, wrong = 0, timeouts = 0, samples = 0, us, p99, k = 0;
+    uint64_t end;
+    char result, name[40];
+    const LinkRttStats *stats;
+
+    if (argc < 4)
+    {
+        fprintf(stderr, "usage: %s <drop ppm> <min goodput req/s> <max p99 ms> [seconds]\n",
+                argv[0]);
+        return 2;
+    }
+    drop_ppm = (uint32_t)strtoul(argv[1], NULL, 10);
+    min_goodput = (uint32_t)strtoul(argv[2], NULL, 10);
+    max_p99_ms = (uint32_t)strtoul(argv[3], NULL, 10);
+    seconds = (argc > 4) ? (uint32_t)strtoul(argv[4], NULL, 10) : 20u;
+
+    // Boot and store the password on a clean wire
+    Sim_EraseAll();
+    Sim_Start(Control_Entry);
+    CHECK(Sim_Run(300000u));
+    CHECK(Exchange(&(Request){ "SET:", "12345", '1' }, &us) == '1');
+
+    // A request sent over an outstanding heartbeat counts it as lost
+    CHECK(Sim_Run(LINK_HEARTBEAT_MS * 1000u));
+    Link_Service();
+    CHECK(Exchange(&(Request){ "STS", "", '1' }, &us) == '1');
+    stats = Link_RttStats();
+    CHECK(stats->lost == 1 && stats->count == 0);
+
+    Sim_UartSetLoss(drop_ppm, 0, SEED);
+    end = Sim_NowUs() + (uint64_t)seconds * 1000000u;
+    while (Sim_NowUs() < end)
+    {
+        const Request *r = &requests[k++ % (sizeof(requests) / sizeof(requests[0]))];
+
+        result = Exchange(r, &us);
+        if (result == r->reply)
+        {
+            good++;
+            if (samples < MAX_SAMPLES)
+                latency[samples++] = us;
+        }
+        else if (result == LINK_TIMEOUT)
+        {
+            timeouts++;
+        }
+        else
+        {
+            printf("%s%s -> 0x%02X\n", r->prefix, r->data, (unsigned)(uint8_t)result);
+            wrong++;
+        }
+    }
+
+    qsort(latency, samples, sizeof(latency[0]), Compare_U32);
+    p99 = samples ? latency[(samples * 99u) / 100u] : UINT32_MAX;
+    stats = Link_RttStats();
+    printf("drop %u ppm, %u s: %u good (%u req/s), %u timed out, %u wrong\n",
+           drop_ppm, seconds, good, good / seconds, timeouts, wrong);
+    printf("latency median %u us, p99 %u us, worst %u us; %u resends\n",
+           samples ? latency[samples / 2] : 0, p99,
+           samples ? latency[samples - 1] : 0, stats->retransmits);
+
+    CHECK(wrong == 0);
+    CHECK(timeouts * 100u <= good);
+    CHECK(good / seconds >= min_goodput);
+    CHECK(p99 <= max_p99_ms * 1000u);
+
+    snprintf(name, sizeof(name), "test_lossy %u", drop_ppm);
+    return Check_Result(name);
+}
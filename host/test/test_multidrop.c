@@ -0,0 +1,265 @@
+/******************************************************************************
+ * File: test_multidrop.c
+ * Module: Host Tests
+ * Description: RS-485 multidrop bus with virtual HMI terminals, run
+ *              against the Control ECU built with UART2_MULTIDROP.
+ *
+ *   test_multidrop <nodes> [seconds]
+ *
+ * Nodes 1..<nodes> answer polls as the HMI's link does: each keeps one
+ * tagged request queued (STS and HBT in turn, its own tag sequence) and
+ * queues the next one as soon as the reply arrives, so every terminal
+ * runs flat out. After a warm-up the bus is measured for the given
+ * simulated time (default 5 s); the table shows per node the requests
+ * answered, requests per second and the mean, p99 and worst latency from
+ * queuing a request to its reply, then the wire utilisation.
+ *
+ * Fails if a node is never answered, if the slowest node gets less than
+ * 80% of the fastest one's throughput (polling must be fair), or if the
+ * p99 latency exceeds what one full polling round may take.
+ ******************************************************************************/
+
+#include "check.h"
+#include "sim.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SLICE_US        50u
+#define WARMUP_US       500000u
+#define MAX_NODES       16u
+#define MAX_SAMPLES     4096u
+
+#define FRAME_END       0xC0
+#define FRAME_ESC       0xDB
+#define FRAME_ESC_END   0xDC
+#define FRAME_ESC_ESC   0xDD
+#define FRAME_DATA      'D'
+#define FRAME_POLL      'P'
+#define MASTER          0
+
+/* Poll of one node carrying a request and its answer, at 115200 8N1:
+ * poll 5 bytes, request frame 11, reply frame 8, plus turnarounds */
+#define BUSY_POLL_US    2400u
+
+int Control_Main(void);
+
+typedef struct
+{
+    uint64_t queued;                /* When the pending request was queued */
+    uint8_t tag;                    /* 0..25: 'a'..'z' */
+    uint8_t opcode;                 /* 0: STS, 1: HBT */
+    bool measuring;
+    uint32_t answered;
+    uint32_t samples;
+    uint32_t latency[MAX_SAMPLES];  /* us */
+} Node;
+
+static Node nodes[MAX_NODES + 1];
+static uint8_t node_count;
+
+/* Frame coming from the Control ECU */
+static uint8_t rx[64];
+static uint8_t rx_len = 0;
+static bool rx_escaped = false;
+
+/******************************************************************************
+ * Private Functions
+ ******************************************************************************/
+
+static void Control_Entry(void)
+{
+    (void)Control_Main();
+}
+
+static void Put_Escaped(uint8_t *frame, uint8_t *len, uint8_t b)
+{
+    if (b == FRAME_END || b == FRAME_ESC)
+    {
+        frame[(*len)++] = FRAME_ESC;
+        b = (b == FRAME_END) ? FRAME_ESC_END : FRAME_ESC_ESC;
+    }
+    frame[(*len)++] = b;
+}
+
+/* Answers a poll with the node's pending request */
+static void Node_Answer(uint8_t n)
+{
+    static const char *const opcodes[] = { "STS", "HBT" };
+    Node *node = &nodes[n];
+    uint8_t frame[32];
+    uint8_t len = 0;
+    char line[16];
+    uint8_t i;
+
+    snprintf(line, sizeof(line), "^%c%s\n", 'a' + node->tag, opcodes[node->opcode]);
+    frame[len++] = FRAME_END;
+    frame[len++] = MASTER;
+    frame[len++] = n;
+    frame[len++] = FRAME_DATA;
+    for (i = 0; line[i] != '\0'; i++)
+        Put_Escaped(frame, &len, (uint8_t)line[i]);
+    frame[len++] = FRAME_END;
+    Sim_UartSend(frame, len);
+}
+
+/* A reply for node n: "^<tag><reply>" ends its pending request */
+static void Node_Reply(uint8_t n, const uint8_t *payload, uint8_t len)
+{
+    Node *node = &nodes[n];
+    uint32_t us;
+
+    if (len < 3 || payload[0] != '^' || payload[1] != 'a' + node->tag)
+        return;     // Not the reply to the pending request
+
+    us = (uint32_t)(Sim_NowUs() - node->queued);
+    if (node->measuring)
+    {
+        node->answered++;
+        if (node->samples < MAX_SAMPLES)
+            node->latency[node->samples++] = us;
+    }
+    node->tag = (uint8_t)((node->tag + 1u) % 26u);
+    node->opcode ^= 1u;
+    node->queued = Sim_NowUs();
+}
+
+static void Frame_Done(void)
+{
+    uint8_t dest, src, type;
+
+    if (rx_len < 3)
+        return;
+    dest = rx[0];
+    src = rx[1];
+    type = rx[2];
+    if (src != MASTER || dest == 0 || dest > node_count)
+        return;     // Broadcasts and absent nodes
+    if (type == FRAME_POLL)
+        Node_Answer(dest);
+    else if (type == FRAME_DATA)
+        Node_Reply(dest, &rx[3], (uint8_t)(rx_len - 3));
+}
+
+/* The terminals' side of the wire: decodes the Control ECU's frames */
+static void Bus_Listen(void)
+{
+    uint8_t b;
+
+    while (Sim_UartReceive(&b, 1) == 1)
+    {
+        if (b == FRAME_END)
+        {
+            Frame_Done();
+            rx_len = 0;
+            rx_escaped = false;
+            continue;
+        }
+        if (b == FRAME_ESC)
+        {
+            rx_escaped = true;
+            continue;
+        }
+        if (rx_escaped)
+            b = (b == FRAME_ESC_END) ? FRAME_END : FRAME_ESC;
+        rx_escaped = false;
+        if (rx_len < sizeof(rx))
+            rx[rx_len++] = b;
+    }
+}
+
+static bool Run_For(uint64_t us)
+{
+    uint64_t until = Sim_NowUs() + us;
+
+    while (Sim_NowUs() < until)
+    {
+        if (!Sim_Run(SLICE_US))
+            return false;
+        Bus_Listen();
+    }
+    return true;
+}
+
+static int Compare_U32(const void *a, const void *b)
+{
+    uint32_t x = *(const uint32_t *)a, y = *(const uint32_t *)b;
+
+    return (x > y) - (x < y);
+}
+
+/******************************************************************************
+ * Main Function
+ ******************************************************************************/
+
+int main(int argc, char **argv)
+{
+    uint32_t seconds = (argc > 2) ? (uint32_t)strtoul(argv[2], NULL, 10) : 5u;
+    uint32_t min_rate = UINT32_MAX, max_rate = 0, worst_p99 = 0, answered = 0;
+    uint32_t round_us, rate, p99, i;
+    uint64_t total, mean, busy, start;
+    char name[32];
+    uint8_t n;
+
+    node_count = (argc > 1) ? (uint8_t)strtoul(argv[1], NULL, 10) : 0;
+    if (node_count == 0 || node_count > MAX_NODES || seconds == 0)
+    {
+        fprintf(stderr, "usage: %s <nodes 1..%u> [seconds]\n", argv[0], MAX_NODES);
+        return 2;
+    }
+
+    Sim_EraseAll();
+    Sim_Start(Control_Entry);
+    CHECK(Run_For(WARMUP_US));
+    for (n = 1; n <= node_count; n++)
+        nodes[n].measuring = true;
+
+    busy = Sim_UartBusyCycles();
+    start = Sim_Now();
+    CHECK(Run_For((uint64_t)seconds * 1000000u));
+    busy = Sim_UartBusyCycles() - busy;
+
+    printf("%u nodes, %u s\n", node_count, seconds);
+    printf("%-5s %8s %8s %9s %9s %9s\n", "node", "replies", "req/s", "mean us", "p99 us",
+           "worst us");
+    for (n = 1; n <= node_count; n++)
+    {
+        Node *node = &nodes[n];
+
+        total = 0;
+        for (i = 0; i < node->samples; i++)
+            total += node->latency[i];
+        qsort(node->latency, node->samples, sizeof(node->latency[0]), Compare_U32);
+        mean = node->samples ? total / node->samples : 0;
+        p99 = node->samples ? node->latency[(node->samples * 99u) / 100u] : 0;
+        rate = node->answered / seconds;
+        answered += node->answered;
+        printf("%-5u %8u %8u %9llu %9u %9u\n", n, node->answered, rate,
+               (unsigned long long)mean, p99,
+               node->samples ? node->latency[node->samples - 1] : 0);
+
+        if (rate < min_rate)
+            min_rate = rate;
+        if (rate > max_rate)
+            max_rate = rate;
+        if (p99 > worst_p99)
+            worst_p99 = p99;
+    }
+    printf("bus utilisation %.1f%%, %u req/s in total\n",
+           100.0 * (double)busy / (double)(Sim_Now() - start),
+           answered / seconds);
+
+    // A request waits at most for the round it just missed and its own
+    // poll; while addresses are empty, each round probes one (10 ms)
+    round_us = node_count * BUSY_POLL_US;
+    if (node_count < MAX_NODES)
+        round_us += 10000u;
+    CHECK(min_rate > 0);
+    CHECK(min_rate * 10u >= max_rate * 8u);
+    CHECK(worst_p99 <= 2u * round_us + 10000u);
+
+    snprintf(name, sizeof(name), "test_multidrop %u", node_count);
+    return Check_Result(name);
+}
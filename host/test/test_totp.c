@@ -0,0 +1,108 @@
+/******************************************************************************
+ * File: test_totp.c
+ * Module: Host Tests
+ * Description: totp.c against the RFC 6238 SHA-1 test vectors, truncated
+ *              to the keypad's PASSWORD_LENGTH digits, the edges of the
+ *              accepted window, and the rule that each step is used once.
+ ******************************************************************************/
+
+#include "check.h"
+#include "ecu.h"
+#include "sim.h"
+#include "eeprom.h"
+#include "rtc.h"
+#include "totp.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+/* RFC 6238 appendix B: the SHA-1 key, and per time the 8-digit code's
+ * last PASSWORD_LENGTH (5) digits */
+static const char rfc_key[] = "12345678901234567890";
+
+static const struct
+{
+    uint64_t time;
+    const char *code;
+} vectors[] = {
+    { 59u,          "87082" },      /* 94287082 */
+    { 1111111109u,  "81804" },      /* 07081804 */
+    { 1111111111u,  "50471" },      /* 14050471 */
+    { 1234567890u,  "05924" },      /* 89005924 */
+    { 2000000000u,  "79037" },      /* 69279037 */
+    { 20000000000u, "53130" },      /* 65353130 */
+};
+
+/* 1111111109 and 1111111111 fall in consecutive steps */
+#define STEP_A      37037036u       /* 1111111109 / 30: "81804" */
+#define STEP_B      37037037u       /* 1111111111 / 30: "50471" */
+
+/******************************************************************************
+ * Main Function
+ ******************************************************************************/
+
+int main(void)
+{
+    const uint8_t *key = (const uint8_t *)rfc_key;
+    uint32_t matched;
+    uint8_t i;
+
+    Sim_EraseAll();
+    CHECK(Ecu_Init());
+
+    // The 20-byte key goes in as two OTK parts
+    CHECK(Totp_SetKey(0, key, TOTP_KEY_CHUNK));
+    CHECK(Totp_SetKey(1, &key[TOTP_KEY_CHUNK], TOTP_KEY_CHUNK));
+    CHECK(!Totp_SetKey(2, key, 1));
+
+    // Until the RTC is set no code is accepted
+    CHECK(!RTC_IsSet() && !Totp_Check("50471", false));
+
+    for (i = 0; i < sizeof(vectors) / sizeof(vectors[0]); i++)
+    {
+        uint32_t step = (uint32_t)(vectors[i].time / TOTP_STEP_S);
+
+        matched = 0;
+        CHECK(Totp_Match(vectors[i].code, step, &matched) && matched == step);
+    }
+
+    // Window edges: one step either side, and no further
+    CHECK(Totp_Match("81804", STEP_A - 1u, &matched) && matched == STEP_A);
+    CHECK(Totp_Match("81804", STEP_A + 1u, &matched) && matched == STEP_A);
+    CHECK(!Totp_Match("81804", STEP_A - 2u, &matched));
+    CHECK(!Totp_Match("81804", STEP_A + 2u, &matched));
+    CHECK(Totp_Match("87082", 0u, &matched) && matched == 1u);  /* No step -1 */
+
+    // A wrong code, and not exactly PASSWORD_LENGTH digits
+    CHECK(!Totp_Match("81805", STEP_A, &matched));
+    CHECK(!Totp_Match("8108", STEP_A, &matched));
+    CHECK(!Totp_Match("818040", STEP_A, &matched));
+    CHECK(!Totp_Match("8180a", STEP_A, &matched));
+
+    // CHK only looks; PWD uses the step up, and every step before it
+    RTC_Set(1111111111u);
+    CHECK(Totp_Check("50471", false));
+    CHECK(Totp_Check("50471", false));
+    CHECK(Totp_Check("50471", true));
+    CHECK(!Totp_Check("50471", true));
+    CHECK(!Totp_Check("50471", false));
+    CHECK(!Totp_Check("81804", true));      /* Older step, still in the window */
+
+    // Next step: the used code is still in the window, and still refused
+    RTC_Set(1111111111u + TOTP_STEP_S);
+    CHECK(!Totp_Check("50471", true));
+
+    // The used step survives a restart
+    EEPROM_Flush();
+    CHECK(EEPROM_ReadTotpStep() == STEP_B);
+    Totp_Init();
+    RTC_Set(1111111111u);
+    CHECK(!Totp_Check("50471", true));
+
+    // Without the key nothing matches
+    RTC_Set(1234567890u);
+    CHECK(Totp_Check("05924", false));
+    Totp_ClearKey();
+    CHECK(!Totp_Check("05924", false));
+
+    return Check_Result("test_totp");
+}
@@ -0,0 +1,96 @@
+#!/usr/bin/env python3
+"""
+Run the host micro-benchmarks and compare them with a checked-in baseline.
+
+bench_command and bench_hmi (host/bench) print the median ns and the
+allocations per operation of each case as JSON.
+
+A case is a regression when it is more than --tolerance percent slower
+than its baseline, allocates more often, or has no baseline at all. Any
+regression makes the exit status 1.
+
+Usage:
+    bench.py --host build            run the benchmarks built in build/ and
+                                     compare them with
+                                     host/bench/bench_baseline.json
+    bench.py --host build --save     record the baseline
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+
+# Host benchmark executables in the build directory
+HOST_BENCHMARKS = ["bench_command", "bench_hmi"]
+
+TOOLS_DIR = os.path.dirname(os.path.abspath(__file__))
+HOST_BASELINE = os.path.join(TOOLS_DIR, "..", "host", "bench", "bench_baseline.json")
+
+
+def read_from_host(build_dir, iterations):
+    results = {}
+    for name in HOST_BENCHMARKS:
+        out = subprocess.run([os.path.join(build_dir, name), "-n", str(iterations), "--json"],
+                             check=True, stdout=subprocess.PIPE, universal_newlines=True).stdout
+        results.update(json.loads(out))
+    return results
+
+
+def compare(results, baseline, tolerance):
+    """Print a table; returns the number of regressions."""
+    regressions = 0
+    print("%-18s %10s %10s %8s %7s %7s" % ("case", "ns/op", "baseline", "change",
+                                           "allocs", "base"))
+    for case, result in results.items():
+        ns, allocs = result["ns"], result["allocs"]
+        base = baseline.get(case)
+        if not base or not base.get("ns"):
+            print("%-18s %10d %10s %8s %7g %7s  NO BASELINE" % (case, ns, "-", "", allocs, "-"))
+            regressions += 1
+            continue
+        change = (ns - base["ns"]) * 100.0 / base["ns"]
+        flag = ""
+        if change > tolerance or allocs > base.get("allocs", 0):
+            flag = "  REGRESSION"
+            regressions += 1
+        print("%-18s %10d %10d %+7.1f%% %7g %7g%s" % (case, ns, base["ns"], change, allocs,
+                                                     base.get("allocs", 0), flag))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", metavar="BUILD_DIR", required=True,
+                        help="run the host benchmarks built in BUILD_DIR")
+    parser.add_argument("--iterations", type=int, default=20000,
+                        help="host calls per case (default 20000)")
+    parser.add_argument("--baseline",
+                        help="default: host/bench/bench_baseline.json")
+    parser.add_argument("--tolerance", type=float, default=10.0,
+                        help="allowed slowdown in percent (default 10)")
+    parser.add_argument("--save", action="store_true", help="write results as the baseline")
+    args = parser.parse_args()
+
+    results = read_from_host(args.host, args.iterations)
+    baseline_path = args.baseline or os.path.normpath(HOST_BASELINE)
+
+    if args.save:
+        with open(baseline_path, "w") as f:
+            json.dump(results, f, indent=2, sort_keys=True)
+            f.write("\n")
+        print("baseline written to %s" % baseline_path)
+        return
+
+    if not os.path.exists(baseline_path):
+        sys.exit("bench: no baseline at %s (record one with --save)" % baseline_path)
+    with open(baseline_path) as f:
+        baseline = json.load(f)
+    if compare(results, baseline, args.tolerance):
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
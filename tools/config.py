@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+"""
+Back up, clone and verify the Control ECU's persistent configuration
+(config.h): PIN, door timeouts, setup flag, access schedules and the
+one-time PIN key. The last one-time PIN step used stays with the board.
+
+    -> EXP\\n                         len | version | image | crc32 | sum8
+    -> IMP:<size>,<crc32>\\n          '1' ready
+    -> 'B' | seq (uint16 LE) | 32 data bytes (0 padded) | crc32 of seq and data
+                                     '1' ack, '0' resend
+    -> END\\n                         '1' written and read back
+
+A saved file is the EXP payload (version, image, CRC-32). The export holds
+the PIN and the one-time PIN key in clear: keep backups safe.
+
+The port is wired straight to the Control ECU UART2, or is the HMI
+LaunchPad's virtual COM port with the HMI on its bridge screen (hidden
+menu key C). Imports need the point-to-point link.
+
+Usage:
+    config.py --port /dev/ttyUSB0 --export unit.cfg
+    config.py --port /dev/ttyUSB0 --import unit.cfg      (then verifies)
+    config.py --port /dev/ttyUSB0 --verify unit.cfg
+    config.py --show unit.cfg
+(--port requires pyserial)
+"""
+
+import argparse
+import struct
+import sys
+import time
+import zlib
+
+VERSION = 2
+BLOCK_SIZE = 32         # CONFIG_BLOCK_SIZE
+BLOCK_MARKER = b"B"     # CONFIG_BLOCK_MARKER
+RETRIES = 5
+
+# Image layout, as config.c's region table (MOTOR_DOOR_COUNT 2, TIMEOUT_SLOTS 4)
+TIMEOUT_SLOTS = 4
+DOORS = 2
+SCHEDULE_BYTES = 84
+TOTP_KEY_BYTES = 24
+IMAGE_SIZE = 8 + 4 * TIMEOUT_SLOTS + 4 + SCHEDULE_BYTES * DOORS + TOTP_KEY_BYTES
+
+
+def read_block(ser):
+    """Reads len, payload, checksum of a binary reply; returns the payload."""
+    head = ser.read(2)
+    if len(head) != 2:
+        raise RuntimeError("no reply")
+    length = head[0] | (head[1] << 8)
+    payload = ser.read(length)
+    tail = ser.read(1)
+    if len(payload) != length or len(tail) != 1:
+        raise RuntimeError("reply truncated (%d of %d bytes)" % (len(payload), length))
+    if (sum(head) + sum(payload)) & 0xFF != tail[0]:
+        raise RuntimeError("checksum mismatch")
+    return payload
+
+
+def split(payload):
+    """(image, crc) of an EXP payload, checked."""
+    if len(payload) < 5 or payload[0] != VERSION:
+        raise ValueError("not a version %d configuration" % VERSION)
+    image, crc = payload[1:-4], struct.unpack("<I", payload[-4:])[0]
+    if len(image) != IMAGE_SIZE:
+        raise ValueError("image is %d bytes, expected %d" % (len(image), IMAGE_SIZE))
+    if zlib.crc32(image) & 0xFFFFFFFF != crc:
+        raise ValueError("image CRC-32 mismatch")
+    return image, crc
+
+
+def export(ser):
+    ser.reset_input_buffer()
+    ser.write(b"EXP\n")
+    return read_block(ser)
+
+
+def read_reply(ser, timeout):
+    """Next '0' or '1'; None on timeout."""
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        c = ser.read(1)
+        if c in (b"0", b"1"):
+            return c
+    return None
+
+
+def blocks(image):
+    for seq, offset in enumerate(range(0, len(image), BLOCK_SIZE)):
+        frame = struct.pack("<H", seq) + image[offset:offset + BLOCK_SIZE].ljust(BLOCK_SIZE, b"\0")
+        yield seq, BLOCK_MARKER + frame + struct.pack("<I", zlib.crc32(frame) & 0xFFFFFFFF)
+
+
+def import_image(ser, image, crc):
+    ser.reset_input_buffer()
+    ser.write(b"IMP:%d,%d\n" % (len(image), crc))
+    if read_reply(ser, 2) != b"1":
+        raise RuntimeError("import refused (size, lockout or multidrop bus)")
+
+    for seq, frame in blocks(image):
+        for _ in range(RETRIES):
+            ser.write(frame)
+            if read_reply(ser, 3) == b"1":
+                break
+        else:
+            raise RuntimeError("block %d not acknowledged" % seq)
+
+    ser.write(b"END\n")
+    if read_reply(ser, 5) != b"1":
+        raise RuntimeError("read-back mismatch on the ECU; previous configuration restored")
+
+
+def show(image):
+    password = image[0:8].split(b"\0")[0].decode("ascii", "replace")
+    timeouts = struct.unpack_from("<%dI" % TIMEOUT_SLOTS, image, 8)
+    flag, = struct.unpack_from("<I", image, 8 + 4 * TIMEOUT_SLOTS)
+    print("setup complete: %s" % ("yes" if flag == 0x55 else "no"))
+    print("PIN: %s" % ("*" * len(password) if flag == 0x55 else "-"))
+    for door in range(DOORS):
+        t = timeouts[door]
+        sched = image[28 + SCHEDULE_BYTES * door:28 + SCHEDULE_BYTES * (door + 1)]
+        print("door %d: timeout %s, %s" % (
+            door, "%d s" % t if 5 <= t <= 30 else "default",
+            "unrestricted" if sched == b"\xff" * SCHEDULE_BYTES else
+            "%d of 672 quarter-hours allowed" % sum(bin(b).count("1") for b in sched)))
+    key_len, = struct.unpack_from("<I", image, 28 + SCHEDULE_BYTES * DOORS)
+    print("one-time PIN key: %s" % ("%d bytes" % key_len if 1 <= key_len <= 20 else "none"))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", help="serial port to the Control ECU link")
+    parser.add_argument("--baud", type=int, default=115200)
+    group = parser.add_mutually_exclusive_group(required=True)
+    group.add_argument("--export", metavar="FILE", help="save the configuration")
+    group.add_argument("--import", dest="import_", metavar="FILE", help="write FILE to the ECU")
+    group.add_argument("--verify", metavar="FILE", help="compare the ECU's digest with FILE")
+    group.add_argument("--show", metavar="FILE", help="summarise a saved configuration")
+    args = parser.parse_args()
+
+    if args.show:
+        with open(args.show, "rb") as f:
+            show(split(f.read())[0])
+        return
+    if not args.port:
+        parser.error("--port is required")
+
+    import serial  # pyserial
+
+    with serial.Serial(args.port, args.baud, timeout=2) as ser:
+        if args.export:
+            payload = export(ser)
+            image, crc = split(payload)
+            with open(args.export, "wb") as f:
+                f.write(payload)
+            print("saved %d bytes, CRC-32 %08X" % (len(image), crc))
+            return
+
+        with open(args.import_ or args.verify, "rb") as f:
+            image, crc = split(f.read())
+        if args.import_:
+            start = time.monotonic()
+            import_image(ser, image, crc)
+            print("imported in %.2f s" % (time.monotonic() - start))
+        _, device_crc = split(export(ser))
+        if device_crc != crc:
+            print("MISMATCH: ECU %08X, file %08X" % (device_crc, crc))
+            sys.exit(1)
+        print("match, CRC-32 %08X" % crc)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,132 @@
+#!/usr/bin/env python3
+"""
+Flash a new Control ECU application through Control_Bootloader over UART.
+
+The image is the raw binary of Control_ECU linked with app.icf (starts at
+0x4000). The tool sends `UPD` so the running application restarts into the
+bootloader (skip with --no-upd if the bootloader is already announcing
+itself), then streams the image:
+
+    <- BLD\\n                       bootloader is listening
+    -> IMG:<size>,<crc32>\\n         '1' accepted
+    -> 'B' | seq (uint16 LE) | 1024 data bytes (0xFF padded) | sum8
+                                   '1' ack, '0' resend; sum8 covers seq
+                                   and data
+    -> END\\n                        '1' verified and installing
+
+The port is either wired straight to the Control ECU UART2 or is the HMI
+LaunchPad's virtual COM port with the HMI on its update bridge screen
+(hidden menu key C).
+
+Usage:
+    fwupdate.py app.bin --port /dev/ttyACM0 [--no-upd]   (requires pyserial)
+"""
+
+import argparse
+import struct
+import sys
+import time
+import zlib
+
+APP_BASE = 0x4000
+IMAGE_MAX_SIZE = 0x20000 - APP_BASE
+BLOCK_SIZE = 1024
+BLOCK_MARKER = b"B"
+RETRIES = 5
+
+
+def check_image(image):
+    """Reject images that cannot be a Control ECU application at APP_BASE."""
+    if not image or len(image) > IMAGE_MAX_SIZE:
+        raise ValueError("image size %d outside 1..%d" % (len(image), IMAGE_MAX_SIZE))
+    sp, reset = struct.unpack_from("<II", image)
+    if not 0x20000000 < sp <= 0x20008000:
+        raise ValueError("initial stack 0x%08X not in SRAM" % sp)
+    if not APP_BASE < reset < APP_BASE + IMAGE_MAX_SIZE:
+        raise ValueError("reset vector 0x%08X outside the application area "
+                         "(was it linked with app.icf?)" % reset)
+
+
+def blocks(image):
+    """Yield the framed transfer blocks."""
+    for seq, offset in enumerate(range(0, len(image), BLOCK_SIZE)):
+        data = image[offset:offset + BLOCK_SIZE].ljust(BLOCK_SIZE, b"\xff")
+        frame = struct.pack("<H", seq) + data
+        yield seq, BLOCK_MARKER + frame + bytes([sum(frame) & 0xFF])
+
+
+def wait_for(ser, token, timeout):
+    """Read until token is seen or timeout seconds pass."""
+    seen = b""
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        seen = (seen + ser.read(1))[-len(token):]
+        if seen == token:
+            return True
+    return False
+
+
+def read_reply(ser, timeout):
+    """Next '0' or '1', skipping announcements; None on timeout."""
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        c = ser.read(1)
+        if c in (b"0", b"1"):
+            return c
+    return None
+
+
+def update(port, baud, image, send_upd):
+    import serial  # pyserial
+
+    crc = zlib.crc32(image) & 0xFFFFFFFF
+    total = (len(image) + BLOCK_SIZE - 1) // BLOCK_SIZE
+
+    with serial.Serial(port, baud, timeout=0.1) as ser:
+        ser.reset_input_buffer()
+        if send_upd:
+            ser.write(b"UPD\n")
+        if not wait_for(ser, b"BLD\n", 10):
+            raise RuntimeError("no bootloader announcement")
+
+        ser.write(b"IMG:%d,%d\n" % (len(image), crc))
+        if read_reply(ser, 2) != b"1":
+            raise RuntimeError("image header rejected")
+
+        for seq, frame in blocks(image):
+            for _ in range(RETRIES):
+                ser.write(frame)
+                if read_reply(ser, 3) == b"1":
+                    break
+            else:
+                raise RuntimeError("block %d not acknowledged" % seq)
+            sys.stderr.write("\r%d/%d blocks" % (seq + 1, total))
+        sys.stderr.write("\n")
+
+        ser.write(b"END\n")
+        if read_reply(ser, 5) != b"1":
+            raise RuntimeError("image CRC mismatch on the ECU; application unchanged")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("image", help="Control ECU binary linked with app.icf")
+    parser.add_argument("--port", required=True, help="serial port to the Control ECU link")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--no-upd", action="store_true",
+                        help="bootloader already running; do not send UPD")
+    args = parser.parse_args()
+
+    with open(args.image, "rb") as f:
+        image = f.read()
+    try:
+        check_image(image)
+        update(args.port, args.baud, image, not args.no_upd)
+    except (ValueError, RuntimeError) as e:
+        sys.exit("fwupdate: %s" % e)
+    print("installed %d bytes, CRC-32 0x%08X" % (len(image), zlib.crc32(image) & 0xFFFFFFFF))
+
+
+if __name__ == "__main__":
+    main()
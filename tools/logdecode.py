@@ -0,0 +1,118 @@
+#!/usr/bin/env python3
+"""
+Decode a Control ECU access-event log export (reply to the `LOG` or `LOG:n`
+command) into CSV.
+
+The export is: count (uint16 LE) | count * 8-byte records | checksum (uint8).
+Each record is: time (uint32 LE), type, slot, result, boot. The time is the
+Control ECU's RTC local time in seconds since 1970; with bit 31 set, the RTC
+had not been set and the low bits are seconds since boot instead.
+
+Usage:
+    logdecode.py dump.bin [-o out.csv]
+    logdecode.py --port /dev/ttyUSB0 [--last N] [-o out.csv]   (requires pyserial)
+"""
+
+import argparse
+import csv
+import datetime
+import struct
+import sys
+
+RECORD = struct.Struct("<IBBBB")
+TIME_UPTIME = 0x80000000
+
+EVENT_TYPES = {
+    0x00: "CORRUPT",
+    0x01: "BOOT",
+    0x02: "UNLOCK",
+    0x03: "VERIFY",
+    0x04: "PASSWORD_SET",
+    0x05: "TIMEOUT_SET",
+    0x06: "ALARM",
+    0x07: "CONFIG_IMPORT",
+}
+
+RESULTS = {0x00: "FAIL", 0x01: "OK", 0x02: "LOCKED", 0x03: "DENIED"}
+
+
+def slot_name(slot):
+    if slot == 0xFF:
+        return ""
+    if slot == 0x00:
+        return "PIN"
+    if slot == 0x01:
+        return "OTP"
+    return str(slot)
+
+
+def time_columns(time_s):
+    """(local time, uptime) CSV cells for a record's time field."""
+    if time_s & TIME_UPTIME:
+        return "", time_s & ~TIME_UPTIME
+    local = datetime.datetime(1970, 1, 1) + datetime.timedelta(seconds=time_s)
+    return local.strftime("%Y-%m-%d %H:%M:%S"), ""
+
+
+def read_export(read):
+    """Read one export frame using read(n) -> bytes; returns list of records."""
+    header = read(2)
+    if len(header) != 2:
+        raise ValueError("truncated header")
+    (count,) = struct.unpack("<H", header)
+    body = read(count * RECORD.size)
+    if len(body) != count * RECORD.size:
+        raise ValueError("truncated body: expected %d records" % count)
+    trailer = read(1)
+    if len(trailer) != 1:
+        raise ValueError("missing checksum")
+    if (sum(header) + sum(body)) & 0xFF != trailer[0]:
+        raise ValueError("checksum mismatch")
+    return [RECORD.unpack_from(body, i * RECORD.size) for i in range(count)]
+
+
+def read_from_port(port, baud, last):
+    import serial  # pyserial
+
+    with serial.Serial(port, baud, timeout=2) as ser:
+        ser.reset_input_buffer()
+        ser.write(b"LOG:%d\n" % last if last else b"LOG\n")
+
+        def read(n):
+            return ser.read(n)
+
+        return read_export(read)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("dump", nargs="?", help="raw LOG export captured to a file")
+    parser.add_argument("--port", help="serial port wired to the Control ECU UART2")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--last", type=int, default=0, help="only the newest N events")
+    parser.add_argument("-o", "--output", help="CSV file (default: stdout)")
+    args = parser.parse_args()
+
+    if args.port:
+        records = read_from_port(args.port, args.baud, args.last)
+    elif args.dump:
+        with open(args.dump, "rb") as f:
+            records = read_export(f.read)
+    else:
+        parser.error("give a dump file or --port")
+
+    out = open(args.output, "w", newline="") if args.output else sys.stdout
+    writer = csv.writer(out)
+    writer.writerow(["boot", "local_time", "uptime_s", "event", "slot", "result"])
+    for time_s, etype, slot, result, boot in records:
+        writer.writerow([boot, *time_columns(time_s),
+                         EVENT_TYPES.get(etype, "0x%02X" % etype),
+                         slot_name(slot),
+                         RESULTS.get(result, str(result))])
+    if out is not sys.stdout:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()
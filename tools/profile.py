@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+"""
+Flat profile from the PC-sampling profiler (profile.h, PROFILE = 1 builds).
+
+The histogram counts interrupted PCs in 2^shift-byte buckets. Each bucket
+is charged to the function it overlaps most, using the symbols of the IAR
+build: the ELF output (`Debug/Exe/embProj.out`) or the linker map
+(`Debug/List/embProj.map`, entry list).
+
+Sources:
+    --port DEV           Control ECU UART2: sends `PRF` and reads the reply
+    --port DEV --hmi     HMI UART0 (USB): press B on the D page to send
+    --file FILE          a reply saved earlier with --save
+
+Usage:
+    profile.py --port /dev/ttyUSB0 --reset --seconds 10 --elf embProj.out
+    profile.py --file prf.bin --map embProj.map --top 20
+(--port requires pyserial)
+"""
+
+import argparse
+import bisect
+import re
+import struct
+import sys
+import time
+
+HEADER = struct.Struct("<BBIIIIH")     # version .. entries, see profile.h
+VERSION = 1
+
+
+def read_reply(stream_read):
+    """Reads len, payload, checksum; returns the payload."""
+    head = stream_read(2)
+    if len(head) != 2:
+        raise ValueError("no reply")
+    length = head[0] | (head[1] << 8)
+    payload = stream_read(length)
+    tail = stream_read(1)
+    if len(payload) != length or len(tail) != 1:
+        raise ValueError("reply truncated (%d of %d bytes)" % (len(payload), length))
+    if (sum(head) + sum(payload)) & 0xFF != tail[0]:
+        raise ValueError("checksum mismatch")
+    return head + payload + tail
+
+
+def read_from_port(port, baud, hmi, reset, seconds):
+    import serial  # pyserial
+
+    with serial.Serial(port, baud, timeout=2) as ser:
+        if hmi:
+            ser.timeout = 60
+            print("press B on the HMI's D page...", file=sys.stderr)
+            return read_reply(ser.read)
+        if reset:
+            ser.reset_input_buffer()
+            ser.write(b"PRF:0\n")
+            if ser.read(1) != b"1":
+                raise ValueError("PRF:0 not acknowledged")
+            time.sleep(seconds)
+        ser.reset_input_buffer()
+        ser.write(b"PRF\n")
+        return read_reply(ser.read)
+
+
+def parse(raw):
+    payload = raw[2:-1]
+    version, shift, base, rate, samples, outside, entries = HEADER.unpack_from(payload)
+    if version != VERSION:
+        raise ValueError("unknown profile version %d" % version)
+    buckets = []
+    for i in range(entries):
+        index, count = struct.unpack_from("<HH", payload, HEADER.size + 4 * i)
+        buckets.append((base + (index << shift), count))
+    return {"shift": shift, "rate": rate, "samples": samples,
+            "outside": outside, "buckets": buckets}
+
+
+def symbols_from_elf(path):
+    """Function symbols (start, end, name) from an ELF32 file."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"\x7fELF" or data[4] != 1:
+        raise ValueError("%s is not a 32-bit ELF file" % path)
+    shoff, = struct.unpack_from("<I", data, 0x20)
+    shentsize, shnum = struct.unpack_from("<HH", data, 0x2E)
+    sections = [struct.unpack_from("<IIIIIIIIII", data, shoff + i * shentsize)
+                for i in range(shnum)]
+
+    funcs = []
+    for sh in sections:
+        if sh[1] != 2:          # SHT_SYMTAB
+            continue
+        strtab = sections[sh[6]]
+        for off in range(sh[4], sh[4] + sh[5], 16):
+            name_off, value, size, info, _, _ = struct.unpack_from("<IIIBBH", data, off)
+            if info & 0x0F != 2 or size == 0:    # STT_FUNC
+                continue
+            start = strtab[4] + name_off
+            name = data[start:data.index(b"\0", start)].decode("ascii", "replace")
+            funcs.append((value & ~1, (value & ~1) + size, name))
+    return funcs
+
+
+MAP_ENTRY = re.compile(r"^\s*(\S+)\s+0x([0-9a-fA-F']+)\s+(?:0x([0-9a-fA-F']+)\s+)?Code\b")
+
+
+def symbols_from_map(path):
+    """Function symbols (start, end, name) from an IAR linker map entry list.
+    Entries without a size run up to the next entry."""
+    entries = []
+    with open(path, errors="replace") as f:
+        for line in f:
+            m = MAP_ENTRY.match(line)
+            if not m:
+                continue
+            start = int(m.group(2).replace("'", ""), 16) & ~1
+            size = int(m.group(3).replace("'", ""), 16) if m.group(3) else None
+            entries.append((start, size, m.group(1)))
+    entries.sort()
+
+    funcs = []
+    for i, (start, size, name) in enumerate(entries):
+        if size is None:
+            size = entries[i + 1][0] - start if i + 1 < len(entries) else 0x10
+        funcs.append((start, start + size, name))
+    return funcs
+
+
+def symbolize(profile, funcs):
+    """Samples per function name; buckets go to the function they overlap most."""
+    funcs = sorted(funcs)
+    starts = [f[0] for f in funcs]
+    width = 1 << profile["shift"]
+    per_func = {}
+
+    for address, count in profile["buckets"]:
+        best, best_overlap = "?0x%08x" % address, 0
+        i = max(bisect.bisect_right(starts, address) - 1, 0)
+        while i < len(funcs) and funcs[i][0] < address + width:
+            overlap = min(funcs[i][1], address + width) - max(funcs[i][0], address)
+            if overlap > best_overlap:
+                best, best_overlap = funcs[i][2], overlap
+            i += 1
+        per_func[best] = per_func.get(best, 0) + count
+    return per_func
+
+
+def print_flat(profile, per_func, top):
+    total = profile["samples"]
+    if total == 0:
+        print("no samples (built without PROFILE = 1?)")
+        return
+    if profile["outside"]:
+        per_func["(outside code range)"] = profile["outside"]
+
+    print("%d samples at %d Hz (%.1f s)" % (total, profile["rate"],
+                                           total / float(profile["rate"] or 1)))
+    print("%7s %7s %8s  %s" % ("self%", "cumul%", "samples", "function"))
+    cumulative = 0
+    rows = sorted(per_func.items(), key=lambda kv: -kv[1])
+    for name, count in rows[:top] if top else rows:
+        cumulative += count
+        print("%6.2f%% %6.2f%% %8d  %s" % (count * 100.0 / total,
+                                           cumulative * 100.0 / total, count, name))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", help="serial port (Control ECU UART2, or HMI UART0 with --hmi)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--hmi", action="store_true", help="wait for the HMI's export")
+    parser.add_argument("--reset", action="store_true",
+                        help="Control ECU: clear the histogram, then sample for --seconds")
+    parser.add_argument("--seconds", type=float, default=10.0)
+    parser.add_argument("--file", help="a saved reply instead of --port")
+    parser.add_argument("--save", help="also write the raw reply here")
+    parser.add_argument("--elf", help="IAR ELF output (.out) for symbols")
+    parser.add_argument("--map", help="IAR linker map (.map) for symbols")
+    parser.add_argument("--top", type=int, default=0, help="show only the first N functions")
+    args = parser.parse_args()
+
+    if args.port:
+        raw = read_from_port(args.port, args.baud, args.hmi, args.reset, args.seconds)
+    elif args.file:
+        with open(args.file, "rb") as f:
+            raw = read_reply(f.read)
+    else:
+        parser.error("give --port or --file")
+
+    if args.save:
+        with open(args.save, "wb") as f:
+            f.write(raw)
+
+    if args.elf:
+        funcs = symbols_from_elf(args.elf)
+    elif args.map:
+        funcs = symbols_from_map(args.map)
+    else:
+        funcs = []
+    profile = parse(raw)
+    print_flat(profile, symbolize(profile, funcs), args.top)
+
+
+if __name__ == "__main__":
+    main()
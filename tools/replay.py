@@ -0,0 +1,296 @@
+#!/usr/bin/env python3
+"""
+Show and replay a link traffic trace (trace.h, TRACE = 1 builds).
+
+Either ECU records every byte it sends or receives on the link with its
+SysTick microsecond time. The Control ECU's requests are the lines it
+received (sent, on an HMI trace); each request's reply is what the Control
+ECU sent after it, its latency the time from the line's '\\n' to the first
+reply byte (on an HMI trace this includes the wire both ways).
+
+Replay sends the requests to a Control ECU again, with the original gaps
+(--timing original) or each one as soon as the previous reply is in
+(--timing fast), and compares the replies with the recorded ones. The
+target runs the commands: use a bench unit, started in the state of the
+recorded one (tools/config.py --import), or replies legitimately differ.
+Tagged lines go out with their recorded tags, so resends are resends
+again. If the target is a TRACE build too, the reply latencies are taken
+from its own trace afterwards (TRC); otherwise they are host round trips.
+
+Latency percentiles are compared with --baseline (record one with --save)
+or, without one, with the trace's own; a percentile more than --tolerance
+percent slower is a regression.
+
+Sources:
+    --port DEV           Control ECU UART2: sends `TRC` and reads the reply
+    --port DEV --hmi     HMI UART0 (USB): press A on the D page to send
+    --file FILE          a reply saved earlier with --save-trace
+
+Usage:
+    replay.py --port /dev/ttyUSB0 --save-trace session.trc
+    replay.py --file session.trc --show
+    replay.py --file session.trc --target /dev/ttyUSB1 --timing fast
+    replay.py --file session.trc --target /dev/ttyUSB1 --save
+(--port and --target require pyserial)
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+import time
+
+HEADER = struct.Struct("<BBHI")     # version, ecu, count, dropped (trace.h)
+RECORD = struct.Struct("<IB")
+VERSION = 1
+ECU_CONTROL = 0
+SENT = 0x80000000
+WRAP = 0x80000000                   # time field is 31 bits
+
+PERCENTILES = [50, 90, 99, 100]
+DEFAULT_BASELINE = os.path.join(os.path.dirname(os.path.abspath(__file__)),
+                                "replay_baseline.json")
+
+
+def read_reply(stream_read):
+    """Reads len, payload, checksum; returns all of it."""
+    head = stream_read(2)
+    if len(head) != 2:
+        raise ValueError("no reply")
+    length = head[0] | (head[1] << 8)
+    payload = stream_read(length)
+    tail = stream_read(1)
+    if len(payload) != length or len(tail) != 1:
+        raise ValueError("reply truncated (%d of %d bytes)" % (len(payload), length))
+    if (sum(head) + sum(payload)) & 0xFF != tail[0]:
+        raise ValueError("checksum mismatch")
+    return head + payload + tail
+
+
+def fetch_trace(ser):
+    ser.reset_input_buffer()
+    ser.write(b"TRC\n")
+    return read_reply(ser.read)
+
+
+def read_from_port(port, baud, hmi):
+    import serial  # pyserial
+
+    with serial.Serial(port, baud, timeout=2) as ser:
+        if hmi:
+            ser.timeout = 60
+            print("press A on the HMI's D page...", file=sys.stderr)
+            return read_reply(ser.read)
+        return fetch_trace(ser)
+
+
+def parse(raw):
+    """(ecu, dropped, records); records are (us, to_control, byte) with
+    the time unwrapped and starting at 0."""
+    payload = raw[2:-1]
+    version, ecu, count, dropped = HEADER.unpack_from(payload)
+    if version != VERSION:
+        raise ValueError("unknown trace version %d" % version)
+    records, last, offset = [], None, 0
+    for i in range(count):
+        field, byte = RECORD.unpack_from(payload, HEADER.size + RECORD.size * i)
+        us = field & (WRAP - 1)
+        if last is not None:
+            offset += (us - last) % WRAP
+        last = us
+        sent = bool(field & SENT)
+        # Received by the Control ECU: on its own trace not sent, on the HMI's sent
+        to_control = sent if ecu != ECU_CONTROL else not sent
+        records.append((offset, to_control, byte))
+    return ecu, dropped, records
+
+
+def requests(records):
+    """Requests as dicts: line (bytes, '\\n' included), start and end time
+    of the line, reply (bytes) and latency (us, None without a reply)."""
+    result, line, start = [], b"", None
+    for us, to_control, byte in records:
+        if to_control:
+            if not line:
+                start = us
+            line += bytes([byte])
+            if byte == ord("\n"):
+                result.append({"line": line, "start": start, "end": us,
+                               "reply": b"", "latency": None})
+                line = b""
+        elif result and not line:
+            req = result[-1]
+            if req["latency"] is None:
+                req["latency"] = us - req["end"]
+            req["reply"] += bytes([byte])
+    return result
+
+
+def show(reqs):
+    print("%10s  %-24s %-16s %10s" % ("ms", "request", "reply", "latency us"))
+    for req in reqs:
+        print("%10.1f  %-24s %-16s %10s" % (
+            req["start"] / 1000.0, printable(req["line"].rstrip(b"\r\n")),
+            printable(req["reply"][:16]) + ("..." if len(req["reply"]) > 16 else ""),
+            "-" if req["latency"] is None else req["latency"]))
+
+
+def printable(data):
+    return "".join(chr(b) if 32 <= b < 127 else "\\x%02x" % b for b in data)
+
+
+def percentiles(latencies):
+    if not latencies:
+        return {}
+    ordered = sorted(latencies)
+    return {"p%d" % p: ordered[min(len(ordered) - 1, (len(ordered) * p) // 100)]
+            for p in PERCENTILES}
+
+
+def read_until(ser, count, timeout):
+    """Up to count bytes, then whatever follows within a short quiet gap;
+    (data, arrival time of the first byte or None)."""
+    data, first = b"", None
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        if len(data) >= count:
+            deadline = min(deadline, time.monotonic() + 0.02)
+        c = ser.read(1)
+        if c:
+            if first is None:
+                first = time.monotonic()
+            data += c
+    return data, first
+
+
+def replay(ser, reqs, timing, reply_timeout):
+    """Sends the requests; returns (replies, host round trips in us)."""
+    replies, round_trips = [], []
+    began = time.monotonic()
+    first_start = reqs[0]["start"] if reqs else 0
+    ser.timeout = 0.005
+    for req in reqs:
+        if timing == "original":
+            delay = began + (req["start"] - first_start) / 1e6 - time.monotonic()
+            if delay > 0:
+                time.sleep(delay)
+        ser.write(req["line"])
+        sent = time.monotonic()
+        expect = len(req["reply"])
+        data, first = read_until(ser, expect, reply_timeout if expect else 0.05)
+        replies.append(data)
+        round_trips.append(None if first is None else int((first - sent) * 1e6))
+    return replies, round_trips
+
+
+def compare_latency(stats, reference, tolerance):
+    """Print a table; returns the number of regressions."""
+    regressions = 0
+    print("%-6s %10s %10s %8s" % ("", "us", "reference", "change"))
+    for key in ("p%d" % p for p in PERCENTILES):
+        us, base = stats.get(key), reference.get(key)
+        if us is None:
+            continue
+        if not base:
+            print("%-6s %10d %10s %8s" % (key, us, "-", ""))
+            continue
+        change = (us - base) * 100.0 / base
+        flag = ""
+        if change > tolerance:
+            flag = "  REGRESSION"
+            regressions += 1
+        print("%-6s %10d %10d %+7.1f%%%s" % (key, us, base, change, flag))
+    return regressions
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", help="serial port the trace is read from")
+    parser.add_argument("--hmi", action="store_true", help="--port is the HMI's UART0")
+    parser.add_argument("--file", help="a trace saved with --save-trace")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--save-trace", metavar="FILE", help="write the raw trace")
+    parser.add_argument("--show", action="store_true", help="print the request timeline")
+    parser.add_argument("--target", help="serial port to a Control ECU's UART2 to replay to")
+    parser.add_argument("--timing", choices=["original", "fast"], default="original")
+    parser.add_argument("--reply-timeout", type=float, default=1.0, help="seconds per reply")
+    parser.add_argument("--baseline", default=DEFAULT_BASELINE)
+    parser.add_argument("--tolerance", type=float, default=10.0,
+                        help="allowed slowdown in percent (default 10)")
+    parser.add_argument("--save", action="store_true",
+                        help="write the replay's latencies as the baseline")
+    args = parser.parse_args()
+
+    if args.port:
+        raw = read_from_port(args.port, args.baud, args.hmi)
+    elif args.file:
+        with open(args.file, "rb") as f:
+            raw = f.read()
+    else:
+        parser.error("give --port or --file")
+
+    if args.save_trace:
+        with open(args.save_trace, "wb") as f:
+            f.write(raw)
+        print("trace written to %s" % args.save_trace)
+
+    ecu, dropped, records = parse(raw)
+    reqs = requests(records)
+    print("%s trace: %d bytes, %d requests, %d overwritten" % (
+        "Control ECU" if ecu == ECU_CONTROL else "HMI ECU", len(records), len(reqs), dropped))
+    if args.show:
+        show(reqs)
+    if not args.target:
+        return
+
+    import serial  # pyserial
+
+    with serial.Serial(args.target, args.baud, timeout=2) as ser:
+        ser.reset_input_buffer()
+        ser.write(b"TRC:0\n")
+        traced = ser.read(1) == b"1"
+        replies, round_trips = replay(ser, reqs, args.timing, args.reply_timeout)
+        latencies = [us for us in round_trips if us is not None]
+        if traced:
+            ser.timeout = 2
+            # The target's own view, less the TRC that fetched it. Anything
+            # else on its link (or an overrun ring) and the requests no
+            # longer line up: fall back to the round trips
+            target = [r for r in requests(parse(fetch_trace(ser))[2])
+                      if r["line"] != b"TRC\n"]
+            if len(target) == len(reqs):
+                latencies = [r["latency"] for r in target if r["latency"] is not None]
+            else:
+                traced = False
+        print("latency: %s" % ("target trace" if traced else "host round trip"))
+
+    mismatches = 0
+    for req, reply in zip(reqs, replies):
+        if reply != req["reply"]:
+            mismatches += 1
+            print("MISMATCH %-24s recorded %s, got %s" % (
+                printable(req["line"].rstrip(b"\r\n")),
+                printable(req["reply"]), printable(reply)))
+    print("%d of %d replies match" % (len(reqs) - mismatches, len(reqs)))
+
+    stats = percentiles(latencies)
+    if args.save:
+        with open(args.baseline, "w") as f:
+            json.dump(stats, f, indent=2)
+            f.write("\n")
+        print("baseline written to %s" % args.baseline)
+        return
+
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as f:
+            reference = json.load(f)
+    else:
+        reference = percentiles([r["latency"] for r in reqs if r["latency"] is not None])
+    if compare_latency(stats, reference, args.tolerance) or mismatches:
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
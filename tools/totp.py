@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""
+Guest one-time PINs for the Control ECU (totp.h): RFC 6238 TOTP with
+HMAC-SHA1 and 30 s steps, truncated to the keypad's 5 digits.
+
+The Control ECU counts time steps from its RTC, which holds local time
+(`CLK:s`), so codes are computed from UTC plus --offset seconds. The
+default is this machine's UTC offset, which matches an RTC set from it.
+
+Usage:
+    totp.py --key 3132333435363738393031323334353637383930      current code
+    totp.py --key ... --at 1700000000 --count 4                 codes from a time
+    totp.py --key ... --provision                               print the OTK lines
+    totp.py --key ... --provision --port /dev/ttyUSB0           send them
+    totp.py --selftest                                          RFC 6238 vectors
+(--port requires pyserial)
+"""
+
+import argparse
+import hashlib
+import hmac
+import struct
+import sys
+import time
+
+STEP_S = 30
+DIGITS = 5          # PASSWORD_LENGTH
+KEY_CHUNK = 10      # TOTP_KEY_CHUNK: key bytes per OTK line
+
+# RFC 6238 appendix B, SHA-1 rows: (unix time, 8-digit code)
+RFC6238_KEY = b"12345678901234567890"
+RFC6238_VECTORS = [
+    (59, "94287082"),
+    (1111111109, "07081804"),
+    (1111111111, "14050471"),
+    (1234567890, "89005924"),
+    (2000000000, "69279037"),
+    (20000000000, "65353130"),
+]
+
+
+def hotp(key, counter, digits):
+    digest = hmac.new(key, struct.pack(">Q", counter), hashlib.sha1).digest()
+    offset = digest[19] & 0x0F
+    value = struct.unpack(">I", digest[offset:offset + 4])[0] & 0x7FFFFFFF
+    return "%0*d" % (digits, value % 10 ** digits)
+
+
+def totp(key, seconds, digits=DIGITS):
+    return hotp(key, int(seconds) // STEP_S, digits)
+
+
+def provision_lines(key):
+    if not 1 <= len(key) <= 2 * KEY_CHUNK:
+        raise ValueError("key must be 1..%d bytes" % (2 * KEY_CHUNK))
+    lines = ["OTK:%s" % key[:KEY_CHUNK].hex().upper()]
+    if len(key) > KEY_CHUNK:
+        lines.append("OTK:%s,1" % key[KEY_CHUNK:].hex().upper())
+    return lines
+
+
+def send_lines(port, baud, lines):
+    import serial  # pyserial
+
+    with serial.Serial(port, baud, timeout=2) as ser:
+        for line in lines:
+            ser.reset_input_buffer()
+            ser.write(line.encode("ascii") + b"\n")
+            if ser.read(1) != b"1":
+                raise ValueError("%s not accepted" % line)
+
+
+def selftest():
+    failures = 0
+    for seconds, expected in RFC6238_VECTORS:
+        got = totp(RFC6238_KEY, seconds, 8)
+        status = "ok" if got == expected else "FAIL"
+        failures += got != expected
+        print("%12d  %s  %s  (keypad: %s)" % (seconds, got, status,
+                                              totp(RFC6238_KEY, seconds)))
+    # The keypad code is the low DIGITS digits of the 8-digit one
+    for seconds, expected in RFC6238_VECTORS:
+        if totp(RFC6238_KEY, seconds) != expected[-DIGITS:]:
+            failures += 1
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--key", help="shared key as hex, up to 20 bytes (20 recommended)")
+    parser.add_argument("--at", type=float, help="unix time (default: now)")
+    parser.add_argument("--offset", type=int, default=None,
+                        help="seconds added to UTC to get RTC time (default: local UTC offset)")
+    parser.add_argument("--count", type=int, default=1, help="consecutive steps to print")
+    parser.add_argument("--provision", action="store_true", help="OTK lines for the key")
+    parser.add_argument("--port", help="with --provision: send the lines to the Control ECU")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--selftest", action="store_true", help="check the RFC 6238 vectors")
+    args = parser.parse_args()
+
+    if args.selftest:
+        sys.exit(1 if selftest() else 0)
+    if not args.key:
+        parser.error("give --key or --selftest")
+    key = bytes.fromhex(args.key)
+
+    if args.provision:
+        lines = provision_lines(key)
+        if args.port:
+            send_lines(args.port, args.baud, lines)
+            print("key stored")
+        else:
+            print("\n".join(lines))
+        return
+
+    now = time.time() if args.at is None else args.at
+    offset = args.offset
+    if offset is None:
+        offset = time.localtime(now).tm_gmtoff
+    rtc = int(now) + offset
+    for i in range(args.count):
+        start = (rtc // STEP_S + i) * STEP_S
+        print("%s  valid %s - %s (RTC time)" % (
+            totp(key, start),
+            time.strftime("%Y-%m-%d %H:%M:%S", time.gmtime(start)),
+            time.strftime("%H:%M:%S", time.gmtime(start + STEP_S - 1))))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,181 @@
+#!/usr/bin/env python3
+"""
+Bounded-wait statistics and the last watchdog stall of either ECU (wait.h).
+
+Every hardware busy-wait in the drivers is timed per call site. A wait
+that had to spin is counted in a 4^i us histogram; one that reached its
+limit is a timeout. The stall record survives the watchdog reset: it
+names the wait site active when the main loop stopped (or "-" when it
+stopped outside one) and the PC the watchdog interrupted, to look up in
+the linker map.
+
+CPU accounting: the cycles each site spent spinning, from the DWT cycle
+counter, as a share of the last second and of all whole seconds since
+boot (or --reset). "work" is everything else: the time the ECU was not
+spinning in a bounded wait. Each wait moved from polling to an interrupt
+shows up as less spin here.
+
+Sources:
+    --port DEV           Control ECU UART2: sends `WAI` and reads the reply
+    --port DEV --hmi     HMI UART0 (USB): press 0 on the D page to send
+    --file FILE          a reply saved earlier with --save
+
+Usage:
+    waits.py --port /dev/ttyUSB0 --reset --seconds 60
+    waits.py --port /dev/ttyUSB0 --check        exit 1 on timeouts or resets
+    waits.py --file wai.bin
+(--port requires pyserial)
+"""
+
+import argparse
+import struct
+import sys
+import time
+
+HEADER = struct.Struct("<BBBBIBIII")  # version .. spin_total, see wait.h
+SITE = struct.Struct("<IIIII")         # waits .. spin_total
+VERSION = 2
+SITE_NONE = 0xFF
+
+# WaitSite order in each ECU's wait.h
+SITES = {
+    0: ["UART2 RX", "UART2 TX", "UART2 drain", "CAN TX", "CAN RX",
+        "buzzer", "EEPROM"],
+    1: ["UART2 RX", "UART2 TX", "UART2 drain", "UART0 RX", "UART0 TX",
+        "CAN TX", "CAN RX", "ADC", "LCD queue"],
+}
+
+
+def read_reply(stream_read):
+    """Reads len, payload, checksum; returns all of it."""
+    head = stream_read(2)
+    if len(head) != 2:
+        raise ValueError("no reply")
+    length = head[0] | (head[1] << 8)
+    payload = stream_read(length)
+    tail = stream_read(1)
+    if len(payload) != length or len(tail) != 1:
+        raise ValueError("reply truncated (%d of %d bytes)" % (len(payload), length))
+    if (sum(head) + sum(payload)) & 0xFF != tail[0]:
+        raise ValueError("checksum mismatch")
+    return head + payload + tail
+
+
+def read_from_port(port, baud, hmi, reset, seconds):
+    import serial  # pyserial
+
+    with serial.Serial(port, baud, timeout=2) as ser:
+        if hmi:
+            ser.timeout = 60
+            print("press 0 on the HMI's D page...", file=sys.stderr)
+            return read_reply(ser.read)
+        if reset:
+            ser.reset_input_buffer()
+            ser.write(b"WAI:0\n")
+            if ser.read(1) != b"1":
+                raise ValueError("WAI:0 not acknowledged")
+            time.sleep(seconds)
+        ser.reset_input_buffer()
+        ser.write(b"WAI\n")
+        return read_reply(ser.read)
+
+
+def parse(raw):
+    payload = raw[2:-1]
+    version, ecu, n_sites, n_buckets, resets, stall_site, stall_pc, spin_1s, spin_total = \
+        HEADER.unpack_from(payload)
+    if version != VERSION:
+        raise ValueError("unknown wait statistics version %d" % version)
+    names = SITES.get(ecu, [])
+    sites, offset = [], HEADER.size
+    for i in range(n_sites):
+        waits, timeouts, max_us, site_1s, site_total = SITE.unpack_from(payload, offset)
+        hist = struct.unpack_from("<%dH" % n_buckets, payload, offset + SITE.size)
+        offset += SITE.size + 2 * n_buckets
+        name = names[i] if i < len(names) else "site %d" % i
+        sites.append({"name": name, "waits": waits, "timeouts": timeouts,
+                      "max_us": max_us, "hist": hist,
+                      "spin_1s": site_1s, "spin_total": site_total})
+    stall = None
+    if stall_pc != 0:
+        stall = (sites[stall_site]["name"] if stall_site < len(sites) else "-", stall_pc)
+    return {"ecu": ecu, "resets": resets, "stall": stall, "sites": sites,
+            "spin_1s": spin_1s, "spin_total": spin_total}
+
+
+def percentile(hist, pct):
+    """Upper edge in us of the bucket holding the pct-th percentile; None
+    for the open last bucket."""
+    total = sum(hist)
+    seen = 0
+    for b, count in enumerate(hist[:-1]):
+        seen += count
+        if seen * 100 >= total * pct:
+            return 4 << (2 * b)
+    return None
+
+
+def edge(us):
+    return "-" if us is None else "<%d" % us
+
+
+def pct(ppm):
+    return "%.3f%%" % (ppm / 10000.0)
+
+
+def report(stats):
+    print("%s: %d watchdog reset(s) since power-on" % (
+        "Control ECU" if stats["ecu"] == 0 else "HMI ECU", stats["resets"]))
+    if stats["stall"]:
+        print("last stall: wait site %s, pc 0x%08X" % stats["stall"])
+    else:
+        print("last stall: none recorded")
+    print("work: %s of the last second, %s overall" % (
+        pct(1000000 - stats["spin_1s"]), pct(1000000 - stats["spin_total"])))
+    print()
+    print("%-12s %8s %8s %8s %8s %10s %8s %8s" % (
+        "site", "waits", "timeouts", "p50 us", "p99 us", "max us", "spin 1s", "spin all"))
+    for s in stats["sites"]:
+        if s["waits"] == 0:
+            print("%-12s %8d" % (s["name"], 0))
+            continue
+        print("%-12s %8d %8d %8s %8s %10d %8s %8s" % (
+            s["name"], s["waits"], s["timeouts"],
+            edge(percentile(s["hist"], 50)), edge(percentile(s["hist"], 99)), s["max_us"],
+            pct(s["spin_1s"]), pct(s["spin_total"])))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--port", help="serial port (Control ECU UART2, or HMI UART0 with --hmi)")
+    parser.add_argument("--hmi", action="store_true", help="--port is the HMI's UART0")
+    parser.add_argument("--file", help="a reply saved with --save")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--reset", action="store_true", help="clear the statistics first (WAI:0)")
+    parser.add_argument("--seconds", type=float, default=10, help="collection time after --reset")
+    parser.add_argument("--save", metavar="FILE", help="write the raw reply")
+    parser.add_argument("--check", action="store_true",
+                        help="exit 1 if any wait timed out or the watchdog reset the ECU")
+    args = parser.parse_args()
+
+    if args.port:
+        raw = read_from_port(args.port, args.baud, args.hmi, args.reset, args.seconds)
+    elif args.file:
+        with open(args.file, "rb") as f:
+            raw = f.read()
+    else:
+        parser.error("give --port or --file")
+
+    if args.save:
+        with open(args.save, "wb") as f:
+            f.write(raw)
+
+    stats = parse(raw)
+    report(stats)
+    if args.check and (stats["resets"] or any(s["timeouts"] for s in stats["sites"])):
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()